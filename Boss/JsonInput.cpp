@@ -24,6 +24,9 @@ public:
 	      { }
 
 	Ev::Io<void> run() {
+		/* Everything else waits on us reading commands
+		 * and responses, so do not queue up behind bulk
+		 * background work.  */
 		return threadpool.background<std::unique_ptr<Jsmn::Object>>([this]() {
 			auto obj = Jsmn::Object();
 			cin >> std::ws;
@@ -33,7 +36,7 @@ public:
 			if (!cin || cin.eof())
 				return std::unique_ptr<Jsmn::Object>();
 			return Util::make_unique<Jsmn::Object>(std::move(obj));
-		}).then([this](std::unique_ptr<Jsmn::Object> pobj) {
+		}, Ev::ThreadPool::Interactive).then([this](std::unique_ptr<Jsmn::Object> pobj) {
 			if (!pobj)
 				/* Exit loop.  */
 				return Ev::lift();
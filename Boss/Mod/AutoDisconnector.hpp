@@ -14,6 +14,10 @@ namespace Boss { namespace Mod {
  * @brief disconnects from peers if we are connected
  * to too many that do not have channels to us anyway.
  * This limits the number of connections we have.
+ *
+ * @desc It only checks at the periodic listing, not on
+ * every change, as other modules connect to peers a
+ * few seconds before opening channels to them.
  */
 class AutoDisconnector {
 private:
@@ -12,7 +12,9 @@
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"Ln/Amount.hpp"
+#include"Ln/GossipGraph.hpp"
 #include"Ln/NodeId.hpp"
+#include"Ln/RouteFinder.hpp"
 #include"S/Bus.hpp"
 #include<memory>
 #include<sstream>
@@ -25,6 +27,8 @@ class ChannelCandidateMatchmaker::Run
 private:
 	S::Bus& bus;
 	Boss::Mod::Rpc& rpc;
+	/* Null if we should use `getroute` instead.  */
+	std::shared_ptr<Ln::RouteFinder> finder;
 
 	Ln::NodeId proposal;
 	std::queue<Ln::NodeId> guide;
@@ -34,11 +38,13 @@ private:
 	explicit
 	Run( S::Bus& bus_
 	   , Boss::Mod::Rpc& rpc_
+	   , std::shared_ptr<Ln::RouteFinder> finder_
 	   , Ln::NodeId proposal_
 	   , std::queue<Ln::NodeId> guide_
 	   , Ln::Amount min_channel_
 	   ) : bus(bus_)
 	     , rpc(rpc_)
+	     , finder(std::move(finder_))
 	     , proposal(std::move(proposal_))
 	     , guide(std::move(guide_))
 	     , min_channel(min_channel_)
@@ -53,6 +59,7 @@ public:
 	std::shared_ptr<Run>
 	create( S::Bus& bus
 	      , Boss::Mod::Rpc& rpc
+	      , std::shared_ptr<Ln::RouteFinder> finder
 	      , Ln::NodeId proposal
 	      , std::queue<Ln::NodeId> guide
 	      , Ln::Amount min_channel
@@ -60,6 +67,7 @@ public:
 		return std::shared_ptr<Run>(
 			new Run( bus
 			       , rpc
+			       , std::move(finder)
 			       , std::move(proposal)
 			       , std::move(guide)
 			       , min_channel
@@ -93,6 +101,21 @@ private:
 		auto target = std::move(guide.front());
 		guide.pop();
 
+		if (finder) {
+			auto q = Ln::RouteFinder::Query();
+			q.source = proposal;
+			q.destination = target;
+			/* 2x because the dowser will halve the channel
+			 * capacity of the first hop.
+			 */
+			q.amount = 2.0 * min_channel;
+			auto routes = finder->find(q);
+			if (routes.empty())
+				/* Try next.  */
+				return core_run();
+			return matched(routes[0].hops[0].id);
+		}
+
 		auto parms = Json::Out()
 			.start_object()
 				.field("id", std::string(target))
@@ -130,27 +153,30 @@ private:
 						      );
 				});
 			}
-			auto act = Ev::lift();
-			act += Boss::log( bus, Debug
-					, "ChannelCandidateMatchmaker: "
-					  "Matched proposal %s to patron %s."
-					, std::string(proposal).c_str()
-					, std::string(patron).c_str()
-					);
-			auto propose = Msg::ProposeChannelCandidates{
-				std::move(proposal), std::move(patron)
-			};
-			auto preinv = Msg::PreinvestigateChannelCandidates{
-				{std::move(propose)},
-				1
-			};
-			act += bus.raise(std::move(preinv));
-			return act;
+			return matched(std::move(patron));
 		}).catching<RpcError>([this](RpcError const&) {
 			/* Try next.  */
 			return core_run();
 		});
 	}
+	Ev::Io<void> matched(Ln::NodeId patron) {
+		auto act = Ev::lift();
+		act += Boss::log( bus, Debug
+				, "ChannelCandidateMatchmaker: "
+				  "Matched proposal %s to patron %s."
+				, std::string(proposal).c_str()
+				, std::string(patron).c_str()
+				);
+		auto propose = Msg::ProposeChannelCandidates{
+			std::move(proposal), std::move(patron)
+		};
+		auto preinv = Msg::PreinvestigateChannelCandidates{
+			{std::move(propose)},
+			1
+		};
+		act += bus.raise(std::move(preinv));
+		return act;
+	}
 };
 
 void ChannelCandidateMatchmaker::start() {
@@ -173,11 +199,25 @@ void ChannelCandidateMatchmaker::start() {
 		auto q = std::queue<Ln::NodeId>();
 		for (auto const& n : m.guide)
 			q.push(n);
-		/* Create run object.  */
-		auto run = Run::create( bus, *rpc, m.proposal, std::move(q)
-				      , min_channel
-				      );
-		return Boss::concurrent(run->run());
+		auto proposal = m.proposal;
+		return Boss::concurrent(graph_rr.execute(Msg::RequestGossipGraph{
+			nullptr
+		}).then([ this
+			, proposal
+			, q
+			](Msg::ResponseGossipGraph g) {
+			auto finder = std::shared_ptr<Ln::RouteFinder>();
+			if (g.graph->num_channels() != 0)
+				finder = std::make_shared<Ln::RouteFinder>(
+					std::move(g.graph)
+				);
+			/* Create run object.  */
+			auto run = Run::create( bus, *rpc, std::move(finder)
+					      , proposal, q
+					      , min_channel
+					      );
+			return run->run();
+		}));
 	});
 }
 
@@ -1,7 +1,10 @@
 #ifndef BOSS_MOD_CHANNELCANDIDATEMATCHMAKER_HPP
 #define BOSS_MOD_CHANNELCANDIDATEMATCHMAKER_HPP
 
+#include"Boss/ModG/ReqResp.hpp"
 #include"Boss/Msg/PatronizeChannelCandidate.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
 #include"Ln/Amount.hpp"
 #include<queue>
 
@@ -25,6 +28,10 @@ namespace Boss { namespace Mod {
  *
  * If it is able to find a patron, this module emits
  * `Boss::Msg::ProposeChannelCandidates`.
+ *
+ * Routes are searched on the gossip graph snapshot
+ * from `Boss::Mod::GossipGraphTracker`, falling back
+ * to `getroute` if the snapshot is empty.
  */
 class ChannelCandidateMatchmaker {
 private:
@@ -35,6 +42,10 @@ private:
 
 	Ln::Amount min_channel;
 
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
+
 	void start();
 
 public:
@@ -46,6 +57,7 @@ public:
 	ChannelCandidateMatchmaker(S::Bus& bus_
 				  ) : bus(bus_)
 				    , rpc(nullptr)
+				    , graph_rr(bus_)
 				    { start(); }
 };
 
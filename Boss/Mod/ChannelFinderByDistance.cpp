@@ -8,19 +8,19 @@
 #include"Boss/log.hpp"
 #include"Boss/random_engine.hpp"
 #include"Ev/Io.hpp"
-#include"Ev/now.hpp"
-#include"Ev/yield.hpp"
-#include"Graph/Dijkstra.hpp"
+#include"Ev/ThreadPool.hpp"
+#include"Graph/IndexedDijkstra.hpp"
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"Ln/Amount.hpp"
+#include"Ln/GossipGraph.hpp"
 #include"S/Bus.hpp"
 #include"Stats/ReservoirSampler.hpp"
 #include"Util/stringify.hpp"
 #include<algorithm>
 #include<math.h>
 #include<memory>
-#include<queue>
+#include<vector>
 
 namespace {
 
@@ -51,42 +51,121 @@ auto const initial_startup_delay = double(30.0);
 
 namespace Boss { namespace Mod {
 
+class ChannelFinderByDistance::Tree {
+public:
+	/* A leaf of the shortest-path tree from our node,
+	 * excluding our direct peers.  */
+	struct Leaf {
+		Ln::NodeId node;
+		/* The node before it in the tree.  */
+		Ln::NodeId parent;
+		Ln::Amount cost;
+	};
+
+	/* Generation of the gossip graph this was
+	 * computed from.  */
+	std::uint64_t generation;
+	std::vector<Leaf> leaves;
+
+	/* Only reads the graph, so this can run in a
+	 * background thread.  */
+	static
+	std::shared_ptr<Tree> compute( Ln::GossipGraph const& graph
+				     , Ln::GossipGraph::Index self_index
+				     );
+};
+
+std::shared_ptr<ChannelFinderByDistance::Tree>
+ChannelFinderByDistance::Tree::compute( Ln::GossipGraph const& graph
+				      , Ln::GossipGraph::Index self_index
+				      ) {
+	typedef Graph::IndexedDijkstra<Ln::Amount> Dijkstra;
+	typedef Ln::GossipGraph::Index Index;
+
+	auto djk = Dijkstra( self_index, Ln::Amount::sat(0)
+			   , graph.num_nodes()
+			   );
+	for (;;) {
+		auto u = djk.current();
+		if (u == Dijkstra::none)
+			break;
+		for (auto const& c : graph.outgoing(u)) {
+			if (!c.active)
+				continue;
+			auto cost = Ln::Amount::msat(c.base_fee)
+				  + ( reference_amount
+				    * ( double(c.proportional_fee)
+				      / 1000000.0
+				      ))
+				  + Ln::Amount::msat(
+					msat_per_block * double(c.delay)
+				    )
+				  ;
+			if (cost > max_fee)
+				continue;
+			djk.neighbor(c.destination, cost);
+		}
+		djk.end_neighbors();
+	}
+
+	auto tree = std::make_shared<Tree>();
+	tree->generation = graph.generation();
+
+	/* A leaf is a reached node that is not
+	 * the parent of any other.  */
+	auto n = djk.size();
+	auto has_child = std::vector<bool>(n, false);
+	for (auto i = Index(0); i < n; ++i) {
+		auto p = djk.parent(i);
+		if (p != Dijkstra::none)
+			has_child[p] = true;
+	}
+	for (auto i = Index(0); i < n; ++i) {
+		if (!djk.reached(i) || has_child[i])
+			continue;
+		auto p = djk.parent(i);
+		/* Ignore self and direct channels of self.  */
+		if (p == Dijkstra::none || p == self_index)
+			continue;
+		tree->leaves.push_back(Leaf{
+			graph.node(i), graph.node(p), djk.cost(i)
+		});
+	}
+
+	return tree;
+}
+
 class ChannelFinderByDistance::Run : public std::enable_shared_from_this<Run> {
 private:
 	S::Bus& bus;
 	Boss::Mod::Rpc& rpc;
 	Boss::Mod::Waiter& waiter;
+	Ev::ThreadPool& threadpool;
 	Ln::NodeId self_id;
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   >& graph_rr;
 
-	typedef 
-	Graph::Dijkstra< Ln::NodeId
-		       , Ln::Amount
-		       > Dijkstra;
-	typedef Dijkstra::TreeNode TreeNode;
-	typedef Dijkstra::Result DijkstraResult;
-
-	Dijkstra djk;
-	/* Resulting navigation guide.  */
-	DijkstraResult nav;
+	std::shared_ptr<Tree>& cache;
 
-	/* Progress reporting.  */
-	double prev_time;
-	std::size_t progress_count;
-
-	/* Used to extact leaf nodes in the Dijkstra run.  */
-	std::queue<TreeNode const*> extract_q;
-	/* Actual leaf nodes.  */
-	std::vector<TreeNode const*> leaves;
+	std::shared_ptr<Tree> tree;
 
 	Run( S::Bus& bus_
 	   , Boss::Mod::Rpc& rpc_
 	   , Boss::Mod::Waiter& waiter_
+	   , Ev::ThreadPool& threadpool_
 	   , Ln::NodeId const& self_id_
+	   , Boss::ModG::ReqResp< Msg::RequestGossipGraph
+				, Msg::ResponseGossipGraph
+				>& graph_rr_
+	   , std::shared_ptr<Tree>& cache_
 	   ) : bus(bus_)
 	     , rpc(rpc_)
 	     , waiter(waiter_)
+	     , threadpool(threadpool_)
 	     , self_id(self_id_)
-	     , djk(self_id_, Ln::Amount::sat(0))
+	     , graph_rr(graph_rr_)
+	     , cache(cache_)
 	     { }
 
 public:
@@ -99,10 +178,17 @@ public:
 	create( S::Bus& bus
 	      , Boss::Mod::Rpc& rpc
 	      , Boss::Mod::Waiter& waiter
+	      , Ev::ThreadPool& threadpool
 	      , Ln::NodeId const& self_id
+	      , Boss::ModG::ReqResp< Msg::RequestGossipGraph
+				   , Msg::ResponseGossipGraph
+				   >& graph_rr
+	      , std::shared_ptr<Tree>& cache
 	      ) {
 		return std::shared_ptr<Run>(
-			new Run(bus, rpc, waiter, self_id)
+			new Run( bus, rpc, waiter, threadpool
+				, self_id, graph_rr, cache
+				)
 		);
 	}
 
@@ -172,139 +258,51 @@ private:
 
 	Ev::Io<void> start_processing() {
 		return Ev::lift().then([this]() {
-			prev_time = Ev::now();
-			progress_count = 0;
-			return Boss::log( bus, Debug
-					, "ChannelFinderByDistance: "
-					  "Starting Dijkstra."
-					)
-			     + loop()
-			     + find_leaves()
-			     + analyze()
-			     ;
-		});
-	}
-	Ev::Io<void> loop() {
-		auto act = Ev::yield();
-		if (Ev::now() - prev_time >= 5.0) {
-			prev_time = Ev::now();
-			act += Boss::log( bus, Info
-					, "ChannelFinderByDistance: "
-					  "Dijkstra progress: "
-					  "%zu nodes scanned."
-					, progress_count
-					);
-		}
-
-		return std::move(act).then([this]() {
-			auto n = djk.current();
-			if (!n)
+			return graph_rr.execute(Msg::RequestGossipGraph{
+				nullptr
+			});
+		}).then([this](Msg::ResponseGossipGraph r) {
+			auto graph = std::move(r.graph);
+			if (cache && cache->generation == graph->generation()) {
+				/* Network unchanged since the last run,
+				 * so only redo the random selection.  */
+				tree = cache;
 				return Boss::log( bus, Debug
 						, "ChannelFinderByDistance: "
-						  "Dijkstra complete."
-						);
-			return step(*n);
-		});
-	}
-	Ev::Io<void> step(Ln::NodeId const& n) {
-		++progress_count;
-		auto parms = Json::Out()
-			.start_object()
-				.field("source", std::string(n))
-			.end_object()
-			;
-		return rpc.command("listchannels", std::move(parms)
-				  ).then([this](Jsmn::Object res) {
-			try {
-				auto cs = res["channels"];
-				for (auto c : cs) {
-					if (!c["active"])
-						continue;
-					/* Neighbor.  */
-					auto n = Ln::NodeId(std::string(
-						c["destination"]
-					));
-					/* (b)ase and (p)roportional fees.  */
-					auto b = Ln::Amount::msat(double(
-						c["base_fee_millisatoshi"]
-					));
-					auto p = double(
-						c["fee_per_millionth"]
-					);
-					/* (d)elay in blocks.  */
-					auto d = double(
-						c["delay"]
-					);
-					auto cost = b
-						  + ( reference_amount
-						    * ( p
-						      / 1000000.0
-						      ))
-						  + Ln::Amount::msat(
-							msat_per_block * d
-						    )
-						  ;
-					if (cost > max_fee)
-						continue;
-					djk.neighbor(n, cost);
-				}
-			} catch (Jsmn::TypeError const&) {
-				return Boss::log( bus, Error
+						  "Reusing %zu leaves from "
+						  "previous run."
+						, tree->leaves.size()
+						)
+				     + analyze()
+				     ;
+			}
+			auto self_index = graph->lookup(self_id);
+			if (self_index == Ln::GossipGraph::none)
+				return Boss::log( bus, Info
 						, "ChannelFinderByDistance: "
-						  "Unexpected listchannels "
-						  "result: %s"
-						, Util::stringify(res)
-							.c_str()
+						  "We are not yet on the "
+						  "network snapshot."
 						);
-			}
-
-			djk.end_neighbors();
-			return loop();
-		});
-	}
-
-	Ev::Io<void> find_leaves() {
-		return Ev::lift().then([this]() {
-			prev_time = Ev::now();
-			progress_count = 0;
-
-			nav = std::move(djk).finalize();
-			auto n = nav[self_id].get();
-			extract_q.push(n);
-			return find_leaves_loop();
-		});
-	}
-	Ev::Io<void> find_leaves_loop() {
-		auto act = Ev::yield();
-		if (Ev::now() - prev_time >= 5.0) {
-			prev_time = Ev::now();
-			act += Boss::log( bus, Info
+			auto compute = [graph, self_index]() {
+				return Tree::compute(*graph, self_index);
+			};
+			return Boss::log( bus, Debug
 					, "ChannelFinderByDistance: "
-					  "Leaf progress: %zu nodes scanned."
-					, progress_count
-					);
-		}
-
-		return std::move(act).then([this]() {
-			if (extract_q.empty())
+					  "Starting Dijkstra."
+					)
+			     + threadpool.background<std::shared_ptr<Tree>>(
+					compute
+			       ).then([this](std::shared_ptr<Tree> t) {
+				tree = std::move(t);
+				cache = tree;
 				return Boss::log( bus, Debug
 						, "ChannelFinderByDistance: "
 						  "Found %zu leaves."
-						, leaves.size()
-						);
-
-			auto n = extract_q.front();
-			extract_q.pop();
-			++progress_count;
-			/* Is it a leaf?  */
-			if (n->children.empty())
-				leaves.push_back(n);
-			else
-				/* Push the children.  */
-				for (auto c : n->children)
-					extract_q.push(c);
-
-			return find_leaves_loop();
+						, tree->leaves.size()
+						)
+				     + analyze()
+				     ;
+			});
 		});
 	}
 
@@ -322,15 +320,10 @@ private:
 			auto rsv = Stats::ReservoirSampler<Entry>(
 				max_preinvestigate
 			);
-			for (auto n : leaves) {
-				/* Ignore self and direct channels of self.  */
-				if (!n->parent)
-					continue;
-				if (*n->parent->data.first == self_id)
-					continue;
-				auto cost = n->data.second;
-				auto e = Entry{ *n->data.first
-					      , *n->parent->data.first
+			for (auto const& n : tree->leaves) {
+				auto cost = n.cost;
+				auto e = Entry{ n.node
+					      , n.parent
 					      , cost
 					      };
 				rsv.add( std::move(e)
@@ -413,7 +406,10 @@ void ChannelFinderByDistance::start() {
 			return Ev::lift();
 
 		running = true;
-		auto run = Run::create(bus, *rpc, waiter, self_id);
+		auto run = Run::create( bus, *rpc, waiter, threadpool
+				      , self_id
+				      , graph_rr, tree
+				      );
 		return Boss::concurrent(run->run().then([this]() {
 			running = false;
 			return Ev::lift();
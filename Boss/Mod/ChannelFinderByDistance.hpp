@@ -1,10 +1,15 @@
 #ifndef BOSS_MOD_CHANNELFINDERBYDISTANCE_HPP
 #define BOSS_MOD_CHANNELFINDERBYDISTANCE_HPP
 
+#include"Boss/ModG/ReqResp.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
 #include"Ln/NodeId.hpp"
+#include<memory>
 
 namespace Boss { namespace Mod { class Rpc; }}
 namespace Boss { namespace Mod { class Waiter; }}
+namespace Ev { class ThreadPool; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod {
@@ -14,15 +19,29 @@ namespace Boss { namespace Mod {
  * @brief Finds channel candidates according to
  * distance from our node: the more distant, the
  * more desirable we consider them.
+ *
+ * @desc the shortest-path tree is computed in a
+ * background thread, from an immutable snapshot
+ * of the gossip graph.
  */
 class ChannelFinderByDistance {
 private:
 	S::Bus& bus;
 	Boss::Mod::Rpc* rpc;
 	Boss::Mod::Waiter& waiter;
+	Ev::ThreadPool& threadpool;
 	Ln::NodeId self_id;
 	bool running;
 
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
+
+	class Tree;
+	/* Result of the last run, reused until the
+	 * gossip graph changes.  */
+	std::shared_ptr<Tree> tree;
+
 	class Run;
 
 	void start();
@@ -35,10 +54,13 @@ public:
 	explicit
 	ChannelFinderByDistance( S::Bus& bus_
 			       , Boss::Mod::Waiter& waiter_
+			       , Ev::ThreadPool& threadpool_
 			       ) : bus(bus_)
 				 , rpc(nullptr)
 				 , waiter(waiter_)
+				 , threadpool(threadpool_)
 				 , running(false)
+				 , graph_rr(bus_)
 				 { start(); }
 };
 
@@ -1,6 +1,7 @@
 #include"Boss/Mod/ChannelFinderByPopularity.hpp"
 #include"Boss/Mod/Rpc.hpp"
 #include"Boss/Mod/Waiter.hpp"
+#include"Boss/ModG/ReqResp.hpp"
 #include"Boss/Msg/Block.hpp"
 #include"Boss/Msg/CommandRequest.hpp"
 #include"Boss/Msg/CommandResponse.hpp"
@@ -14,6 +15,8 @@
 #include"Boss/Msg/Option.hpp"
 #include"Boss/Msg/PreinvestigateChannelCandidates.hpp"
 #include"Boss/Msg/ProposeChannelCandidates.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
 #include"Boss/Msg/SolicitChannelCandidates.hpp"
 #include"Boss/Msg/TaskCompletion.hpp"
 #include"Boss/Msg/Timer10Minutes.hpp"
@@ -21,19 +24,19 @@
 #include"Boss/log.hpp"
 #include"Boss/random_engine.hpp"
 #include"Ev/Io.hpp"
+#include"Ev/ThreadPool.hpp"
 #include"Ev/map.hpp"
-#include"Ev/now.hpp"
-#include"Ev/yield.hpp"
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"Ln/Amount.hpp"
+#include"Ln/GossipGraph.hpp"
 #include"Ln/NodeId.hpp"
 #include"S/Bus.hpp"
 #include"Sqlite3.hpp"
+#include"Stats/ReservoirSampler.hpp"
 #include"Util/make_unique.hpp"
 #include<algorithm>
 #include<iterator>
-#include<queue>
 #include<random>
 #include<set>
 #include<sstream>
@@ -82,6 +85,51 @@ auto const seconds_after_connect = double(210);
  */
 auto const become_aggressive_percent = double(25.0);
 
+/** popularity_chunk
+ *
+ * @brief number of nodes whose peers are counted
+ * by each background thread.
+ */
+auto const popularity_chunk = std::size_t(2000);
+
+typedef Ln::GossipGraph::Index Index;
+
+/* A node, and its number of distinct peers other
+ * than us.  */
+typedef std::pair<Index, std::size_t> Count;
+
+/* Counts the peers of the nodes in [begin, end),
+ * skipping us and nodes without any other peers.
+ * Only reads the graph, so several chunks can be
+ * counted at the same time.  */
+std::vector<Count>
+count_peers( Ln::GossipGraph const& graph
+	   , Index self_index
+	   , Index begin, Index end
+	   ) {
+	auto rv = std::vector<Count>();
+	auto peers = std::vector<Index>();
+	for (auto n = begin; n < end; ++n) {
+		if (n == self_index)
+			continue;
+		peers.clear();
+		for (auto const& c : graph.outgoing(n)) {
+			if (c.destination == self_index)
+				continue;
+			peers.push_back(c.destination);
+		}
+		std::sort(peers.begin(), peers.end());
+		auto num = std::size_t(
+			std::unique(peers.begin(), peers.end())
+		      - peers.begin()
+		);
+		if (num == 0)
+			continue;
+		rv.emplace_back(n, num);
+	}
+	return rv;
+}
+
 }
 
 namespace Boss { namespace Mod {
@@ -90,10 +138,15 @@ class ChannelFinderByPopularity::Impl {
 private:
 	S::Bus& bus;
 	Boss::Mod::Waiter& waiter;
+	Ev::ThreadPool& threadpool;
 	void* this_ptr;
 	Boss::Mod::Rpc* rpc;
 	Ln::NodeId self;
 
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
+
 	/* Set if we are already running.  */
 	bool running;
 	/* Set if we are waiting for a while.  */
@@ -106,11 +159,6 @@ private:
 	/* Access to the database.  */
 	Sqlite3::Db db;
 
-	/* Progress tracking.  */
-	double prev_time;
-	std::size_t count;
-	std::size_t all_nodes_count;
-
 	/* Set if we should not enter single-proposal mode yet.  */
 	bool become_aggressive;
 	/* Previous total_owend amount.  */
@@ -246,9 +294,8 @@ private:
 			return Boss::concurrent(on_new_connect());
 		});
 		bus.subscribe< Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& r) {
-			if (r.command != "clboss-findbypopularity")
-				return Ev::lift();
+			     >( "clboss-findbypopularity"
+			      , [this](Msg::CommandRequest const& r) {
 			return bus.raise(Msg::CommandResponse{
 				r.id,
 				Json::Out::empty_object()
@@ -296,19 +343,16 @@ private:
 		}));
 	}
 
-	/* List of all nodes (self excluded).  */
-	std::queue<Ln::NodeId> all_nodes;
-
 	struct Popular {
 		Ln::NodeId node;
 		std::set<Ln::NodeId> peers;
 	};
-	/* Number of nodes with at least one peer that passed through
-	 * the A-Chao algorithm.  */
-	std::size_t num_processed;
-	/* A-Chao algorithm.  */
-	double wsum;
-	std::vector<Popular> selected;
+	struct Selection {
+		/* Number of nodes with at least one peer that
+		 * passed through the A-Chao algorithm.  */
+		std::size_t num_processed;
+		std::vector<Popular> selected;
+	};
 
 	/* Called after a new connection while we were deferring
 	 * a solicitation.  */
@@ -382,46 +426,24 @@ private:
 	}
 
 	Ev::Io<void> continue_solicit() {
-		/* Now do listnodes for everything.  */
-		return rpc->command( "listnodes"
-				   , Json::Out::empty_object()
-				   ).then([this](Jsmn::Object res){
-			if (!res.is_object() || !res.has("nodes"))
-				return fail_solicit("Unexpected result from listnodes.");
-
-			auto nodes = res["nodes"];
-			if (!nodes.is_array())
-				return fail_solicit("Unexpected result from listnodes.");
-
-			if (nodes.size() < min_nodes_to_process)
-				return defer_solicit(nodes.size());
-			all_nodes = std::queue<Ln::NodeId>();
-			for (auto node : nodes) {
-				if (!node.is_object() || !node.has("nodeid"))
-					continue;
-				auto id = node["nodeid"];
-				if (!id.is_string())
-					continue;
-				auto nid = Ln::NodeId(std::string(id));
-				if (nid == self)
-					continue;
-				all_nodes.emplace(std::move(nid));
-			}
-			/* Initialize the A-Chao algorithm.  */
-			num_processed = 0;
-			wsum = 0;
-			selected.clear();
-			/* Initialize progress tracking.  */
-			prev_time = Ev::now();
-			count = 0;
-			all_nodes_count = all_nodes.size();
+		/* Now get the entire network.  */
+		return graph_rr.execute(Msg::RequestGossipGraph{
+			nullptr
+		}).then([this](Msg::ResponseGossipGraph r) {
+			auto graph = std::move(r.graph);
+			if (graph->num_nodes() < min_nodes_to_process)
+				return defer_solicit(graph->num_nodes());
+			auto self_index = graph->lookup(self);
+			auto all_nodes_count = graph->num_nodes();
+			if (self_index != Ln::GossipGraph::none)
+				--all_nodes_count;
 			/* Print details.  */
 			return Boss::log( bus, Debug
 					, "ChannelFinderByPopularity: "
 					  "%zu nodes to be evaluated."
-					, all_nodes.size()
-					).then([this]() {
-				return select_by_popularity();
+					, all_nodes_count
+					).then([this, graph, self_index]() {
+				return select_by_popularity(graph, self_index);
 			});
 		});
 	}
@@ -437,118 +459,97 @@ private:
 				);
 	}
 
-	Ev::Io<void> fail_solicit(std::string const& reason) {
-		return Boss::log( bus, Error
-				, "ChannelFinderByPopularity: "
-				  "Failed: %s"
-				, reason.c_str()
-				).then([this]() {
-			/* Failed!  */
-			return signal_task_completion(true);
+	Ev::Io<void>
+	select_by_popularity( std::shared_ptr<Ln::GossipGraph const> graph
+			    , Index self_index
+			    ) {
+		/* Count the peers of each node, in chunks, in
+		 * parallel.  */
+		auto chunks = std::vector<Index>();
+		for ( auto b = Index(0)
+		    ; b < graph->num_nodes()
+		    ; b += popularity_chunk
+		    )
+			chunks.push_back(b);
+		auto f = [this, graph, self_index](Index b) {
+			auto e = Index(std::min( b + popularity_chunk
+					       , graph->num_nodes()
+					       ));
+			return threadpool.background<std::vector<Count>>(
+				[graph, self_index, b, e]() {
+				return count_peers(*graph, self_index, b, e);
+			});
+		};
+		auto actual_max_proposals = max_proposals;
+		if (single_proposal_only)
+			actual_max_proposals = 1;
+		/* Our random engine is not shared with the
+		 * background thread.  */
+		auto seed = Boss::random_engine();
+		return Ev::map(f, std::move(chunks)
+			      ).then([ this
+				     , graph
+				     , self_index
+				     , actual_max_proposals
+				     , seed
+				     ](std::vector<std::vector<Count>> counts) {
+			auto select = [ graph
+				      , self_index
+				      , actual_max_proposals
+				      , seed
+				      , counts = std::move(counts)
+				      ]() {
+				return sample( *graph, self_index
+					     , counts
+					     , actual_max_proposals
+					     , seed
+					     );
+			};
+			return threadpool.background<Selection>(select);
+		}).then([this](Selection sel) {
+			return complete_select_by_popularity(std::move(sel));
 		});
 	}
-
-	/* A-Chao Reservoir sampling algorithm.  */
-	Ev::Io<void> select_by_popularity() {
-		auto act = Ev::yield();
-		if (Ev::now() - prev_time >= 5.0) {
-			prev_time = Ev::now();
-			act += Boss::log( bus, Info
-					, "ChannelFinderByPopularity: "
-					  "Progress: %zu / %zu (%f)"
-					, count, all_nodes_count
-					, ( double(count)
-					  / double(all_nodes_count)
-					  )
-					);
+	/* A-Chao Reservoir sampling algorithm, with the number
+	 * of peers as the weight.  */
+	static
+	Selection sample( Ln::GossipGraph const& graph
+			, Index self_index
+			, std::vector<std::vector<Count>> const& counts
+			, std::size_t max_selected
+			, std::default_random_engine::result_type seed
+			) {
+		auto engine = std::default_random_engine(seed);
+		auto rsv = Stats::ReservoirSampler<Index>(max_selected);
+		auto rv = Selection();
+		rv.num_processed = 0;
+		for (auto const& chunk : counts) {
+			for (auto const& c : chunk) {
+				++rv.num_processed;
+				rsv.add(c.first, double(c.second), engine);
+			}
 		}
-
-		return std::move(act).then([this]() {
-
-		/* This is a loop.  */
-		if (all_nodes.empty())
-			return complete_select_by_popularity();
-		/* Get channels of the current node.  */
-		auto const& curr = all_nodes.front();
-		return rpc->command( "listchannels"
-				   , Json::Out()
-					.start_object()
-						.field( "source"
-						      , std::string(curr)
-						      )
-					.end_object()
-				   ).then([this](Jsmn::Object res) {
+		for (auto n : std::move(rsv).finalize()) {
 			auto entry = Popular();
-			/* Now move the current node off the queue.  */
-			entry.node = std::move(all_nodes.front());
-			all_nodes.pop();
-			++count;
-
-			/* Now fill in the entry.  */
-			if (!res.is_object() || !res.has("channels"))
-				/* Skip.  */
-				return select_by_popularity();
-			auto channels = res["channels"];
-			if (!channels.is_array())
-				return select_by_popularity();
-			for (auto channel : channels) {
-				if ( !channel.is_object()
-				  || !channel.has("destination")
-				   )
-					continue;
-				auto destination = channel["destination"];
-				if (!destination.is_string())
-					continue;
-				auto dest = Ln::NodeId(std::string(destination));
-				if (dest == self)
+			entry.node = graph.node(n);
+			for (auto const& c : graph.outgoing(n)) {
+				if (c.destination == self_index)
 					continue;
-				entry.peers.emplace(std::move(dest));
+				entry.peers.emplace(graph.node(c.destination));
 			}
-
-			if (entry.peers.size() == 0)
-				return select_by_popularity();
-
-			++num_processed;
-
-			/* ***Finally*** determine if we should select
-			 * this entry.  */
-			wsum += entry.peers.size();
-			/* If fewer are selected than max proposals, go extend
-			 * it.  */
-			auto actual_max_proposals = max_proposals;
-			if (single_proposal_only)
-				actual_max_proposals = 1;
-			if (selected.size() < actual_max_proposals) {
-				selected.emplace_back(std::move(entry));
-				return select_by_popularity();
-			}
-			/* Otherwise see if we should replace.  */
-			auto dist = std::uniform_real_distribution<double>(
-				0, 1
-			);
-			auto p = double(entry.peers.size()) / wsum;
-			auto j = dist(Boss::random_engine);
-			if (j <= p) {
-				/* Randomly replace an existing selection.  */
-				auto dist_i = std::uniform_int_distribution<size_t>(
-					0, selected.size() - 1
-				);
-				auto i = dist_i(Boss::random_engine);
-				selected[i] = std::move(entry);
-			}
-
-			return select_by_popularity();
-		});
-
-		});
+			rv.selected.emplace_back(std::move(entry));
+		}
+		return rv;
 	}
 
-	Ev::Io<void> complete_select_by_popularity() {
+	Ev::Io<void> complete_select_by_popularity(Selection sel) {
+		auto num_processed = sel.num_processed;
+		auto& selected = sel.selected;
+
 		/* Did the number of number of nodes processed
 		 * even reach the min_nodes_to_process?
 		 */
 		if (num_processed < min_nodes_to_process) {
-			selected.clear();
 			try_later = true;
 			return Boss::log( bus, Info
 					, "ChannelFinderByPopularity: "
@@ -578,7 +579,8 @@ private:
 		}
 		return Boss::log( bus, Info
 				, "%s", log.str().c_str()
-				).then([this]() {
+				).then([this, selected = std::move(selected)
+				       ]() mutable {
 			/* Preinvestigate the selected nodes.  */
 			return Ev::map( std::bind( &Impl::preinvestigate
 						 , this
@@ -663,11 +665,14 @@ private:
 public:
 	Impl( S::Bus& bus_
 	    , Boss::Mod::Waiter& waiter_
+	    , Ev::ThreadPool& threadpool_
 	    , void* this_ptr_
 	    ) : bus(bus_)
 	      , waiter(waiter_)
+	      , threadpool(threadpool_)
 	      , this_ptr(this_ptr_)
 	      , rpc(nullptr)
+	      , graph_rr(bus_)
 	      , running(false)
 	      { start(); }
 
@@ -676,7 +681,10 @@ public:
 ChannelFinderByPopularity::ChannelFinderByPopularity
 		( S::Bus& bus
 		, Boss::Mod::Waiter& waiter
-		) : pimpl(Util::make_unique<Impl>(bus, waiter, this)) { }
+		, Ev::ThreadPool& threadpool
+		) : pimpl(Util::make_unique<Impl>( bus, waiter, threadpool
+						 , this
+						 )) { }
 ChannelFinderByPopularity::ChannelFinderByPopularity
 		( ChannelFinderByPopularity&& o
 		) : pimpl(std::move(o.pimpl)) { }
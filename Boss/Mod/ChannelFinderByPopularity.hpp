@@ -4,6 +4,7 @@
 #include<memory>
 
 namespace Boss { namespace Mod { class Waiter; }}
+namespace Ev { class ThreadPool; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod {
@@ -16,6 +17,9 @@ namespace Boss { namespace Mod {
  * Instead, after locating some popular nodes, we select
  * one of *its* peers as the proposal, with the popular
  * node as the patron.
+ *
+ * The popularity of each node is counted, and the
+ * popular nodes sampled, in background threads.
  */
 class ChannelFinderByPopularity {
 private:
@@ -26,7 +30,9 @@ public:
 	ChannelFinderByPopularity() =delete;
 	ChannelFinderByPopularity(ChannelFinderByPopularity const&) =delete;
 
-	ChannelFinderByPopularity(S::Bus&, Boss::Mod::Waiter&);
+	ChannelFinderByPopularity( S::Bus&, Boss::Mod::Waiter&
+				 , Ev::ThreadPool&
+				 );
 	ChannelFinderByPopularity(ChannelFinderByPopularity&&);
 	~ChannelFinderByPopularity();
 };
@@ -1,6 +1,7 @@
 #include"Boss/Mod/ChannelFundsComputer.hpp"
 #include"Boss/Msg/ChannelFunds.hpp"
 #include"Boss/Msg/ListfundsResult.hpp"
+#include"Boss/Msg/ListpeersChanged.hpp"
 #include"Jsmn/Object.hpp"
 #include"Ln/Amount.hpp"
 #include"S/Bus.hpp"
@@ -12,6 +13,8 @@ void ChannelFundsComputer::start() {
 	using std::placeholders::_1;
 	bus.subscribe< Msg::ListfundsResult
 		     >(std::bind(&This::on_listfunds, this, _1));
+	bus.subscribe< Msg::ListpeersChanged
+		     >(std::bind(&This::on_listpeers_changed, this, _1));
 }
 Ev::Io<void>
 ChannelFundsComputer::on_listfunds(Msg::ListfundsResult const& r) {
@@ -41,5 +44,27 @@ ChannelFundsComputer::on_listfunds(Msg::ListfundsResult const& r) {
 		return bus.raise(Msg::ChannelFunds{total, connected});
 	});
 }
+Ev::Io<void>
+ChannelFundsComputer::on_listpeers_changed(Msg::ListpeersChanged const& m) {
+	/* Same sums, from the `listpeerchannels` we already
+	 * have, so that a new or closed channel shows up
+	 * before the next `listfunds`.  */
+	auto total = Ln::Amount::sat(0);
+	auto connected = Ln::Amount::sat(0);
+	for (auto const& p : m.cpeers) {
+		for (auto const& chan : p.second.channels) {
+			if (!chan.is_object() || !chan.has("to_us_msat"))
+				continue;
+			auto amount_j = chan["to_us_msat"];
+			if (!Ln::Amount::valid_object(amount_j))
+				continue;
+			auto amount = Ln::Amount::object(amount_j);
+			total += amount;
+			if (p.second.connected)
+				connected += amount;
+		}
+	}
+	return bus.raise(Msg::ChannelFunds{total, connected});
+}
 
 }}
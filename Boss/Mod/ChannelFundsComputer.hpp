@@ -2,6 +2,7 @@
 #define BOSS_MOD_CHANNELFUNDSCOMPUTER_HPP
 
 namespace Boss { namespace Msg { struct ListfundsResult; }}
+namespace Boss { namespace Msg { struct ListpeersChanged; }}
 namespace Ev { template<typename a> class Io; }
 namespace S { class Bus; }
 
@@ -13,6 +14,7 @@ private:
 
 	void start();
 	Ev::Io<void> on_listfunds(Msg::ListfundsResult const&);
+	Ev::Io<void> on_listpeers_changed(Msg::ListpeersChanged const&);
 
 public:
 	ChannelFundsComputer() =delete;
@@ -0,0 +1,258 @@
+#include"Boss/Mod/DbMaintainer.hpp"
+#include"Boss/Mod/Waiter.hpp"
+#include"Boss/Msg/CommandRequest.hpp"
+#include"Boss/Msg/CommandResponse.hpp"
+#include"Boss/Msg/DbResource.hpp"
+#include"Boss/Msg/ManifestCommand.hpp"
+#include"Boss/Msg/Manifestation.hpp"
+#include"Boss/Msg/Timer10Minutes.hpp"
+#include"Boss/Shutdown.hpp"
+#include"Boss/concurrent.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/now.hpp"
+#include"Json/Out.hpp"
+#include"S/Bus.hpp"
+#include"Sqlite3.hpp"
+#include"Stats/RunningMean.hpp"
+#include"Util/date.hpp"
+#include"Util/make_unique.hpp"
+#include<algorithm>
+#include<sys/stat.h>
+
+namespace {
+
+/* How long to let write_behind mutations queue up,
+ * from the first one, before flushing them.  */
+auto constexpr flush_interval = double(0.5);
+
+/* Size of the given file, or 0 if it does not exist.  */
+std::int64_t file_size(std::string const& filename) {
+	struct stat st;
+	if (filename == "" || stat(filename.c_str(), &st) != 0)
+		return 0;
+	return std::int64_t(st.st_size);
+}
+
+}
+
+namespace Boss { namespace Mod {
+
+class DbMaintainer::Impl {
+private:
+	S::Bus& bus;
+	Boss::Mod::Waiter& waiter;
+	Sqlite3::Db db;
+
+	bool checkpointing;
+
+	/* Statistics of checkpoints since we started.  */
+	std::size_t checkpoints;
+	double last_time;
+	Sqlite3::Db::Checkpoint last;
+	Stats::RunningMean mean_seconds;
+	double max_seconds;
+
+	void start() {
+		bus.subscribe<Msg::DbResource
+			     >([this](Msg::DbResource const& m) {
+			db = m.db;
+			return Boss::concurrent(flush_loop());
+		});
+		bus.subscribe<Boss::Shutdown
+			     >([this](Boss::Shutdown const& _) {
+			if (!db || db.write_behind_pending() == 0)
+				return Ev::lift();
+			return db.flush();
+		});
+		bus.subscribe<Msg::Timer10Minutes
+			     >([this](Msg::Timer10Minutes const& _) {
+			if (!db || checkpointing)
+				return Ev::lift();
+			checkpointing = true;
+			return Boss::concurrent(checkpoint());
+		});
+
+		bus.subscribe<Msg::Manifestation
+			     >([this](Msg::Manifestation const& _) {
+			return bus.raise(Msg::ManifestCommand{
+				"clboss-dbstats", "",
+				"Report statistics about the CLBOSS database.",
+				false
+			});
+		});
+		bus.subscribe<Msg::CommandRequest
+			     >("clboss-dbstats", [this](Msg::CommandRequest const& r) {
+			auto id = r.id;
+			if (!db)
+				return bus.raise(Msg::CommandResponse{
+					id,
+					Json::Out()
+						.start_object()
+						.field("error", "db not yet available")
+						.end_object()
+				});
+			return db.transact().then([this, id](Sqlite3::Tx tx) {
+				auto report = make_report(tx);
+				tx.commit();
+				return bus.raise(Msg::CommandResponse{
+					id, std::move(report)
+				});
+			});
+		});
+	}
+
+	Ev::Io<void> flush_loop() {
+		return db.wait_write_behind().then([this]() {
+			if (db.write_behind_pending() == 0)
+				return Ev::lift();
+			return waiter.wait(flush_interval).then([this]() {
+				return db.flush();
+			});
+		}).catching<std::exception>([this](std::exception const& e) {
+			return Boss::log( bus, Error
+					, "DbMaintainer: Flush failed: %s"
+					, e.what()
+					);
+		}).then([this]() {
+			return report_failures();
+		}).then([this]() {
+			return flush_loop();
+		});
+	}
+	Ev::Io<void> report_failures() {
+		auto failures = db.take_write_behind_failures();
+		auto act = Ev::lift();
+		for (auto const& f : failures)
+			act += Boss::log( bus, Error
+					, "DbMaintainer: Dropped a queued "
+					  "write: %s"
+					, f.c_str()
+					);
+		return act;
+	}
+
+	Ev::Io<void> checkpoint() {
+		return db.checkpoint().then([this](Sqlite3::Db::Checkpoint c) {
+			if (c.wal_frames < 0)
+				return Ev::lift();
+
+			++checkpoints;
+			last_time = Ev::now();
+			last = c;
+			mean_seconds.sample(c.seconds);
+			max_seconds = std::max(max_seconds, c.seconds);
+
+			return Boss::log( bus, Debug
+					, "DbMaintainer: Checkpointed %d of "
+					  "%d frames in %f seconds."
+					, c.checkpointed_frames
+					, c.wal_frames
+					, c.seconds
+					);
+		}).catching<std::exception>([this](std::exception const& e) {
+			return Boss::log( bus, Error
+					, "DbMaintainer: Checkpoint failed: %s"
+					, e.what()
+					);
+		}).then([this]() {
+			checkpointing = false;
+			return Ev::lift();
+		});
+	}
+
+	template<typename a>
+	static
+	a get_pragma(Sqlite3::Tx& tx, char const* sql) {
+		auto rv = a();
+		auto fetch = tx.query(sql).execute();
+		for (auto& r : fetch)
+			rv = r.get<a>(0);
+		return rv;
+	}
+
+	Json::Out make_report(Sqlite3::Tx& tx) {
+		auto journal_mode = get_pragma<std::string>(
+			tx, "PRAGMA journal_mode;"
+		);
+		auto page_size = get_pragma<std::int64_t>(
+			tx, "PRAGMA page_size;"
+		);
+		auto page_count = get_pragma<std::int64_t>(
+			tx, "PRAGMA page_count;"
+		);
+		auto freelist_count = get_pragma<std::int64_t>(
+			tx, "PRAGMA freelist_count;"
+		);
+
+		auto filename = db.filename();
+		auto wal_size = std::int64_t(0);
+		if (filename != "")
+			wal_size = file_size(filename + "-wal");
+
+		auto rv = Json::Out();
+		auto obj = rv.start_object();
+		obj
+			.field("journal_mode", journal_mode)
+			.field("page_size", page_size)
+			.field("page_count", page_count)
+			.field("freelist_count", freelist_count)
+			.field("db_size", page_size * page_count)
+			.field("wal_size", wal_size)
+			.field("checkpoints", std::uint64_t(checkpoints))
+			.field( "write_behind_pending"
+			      , std::uint64_t(db.write_behind_pending())
+			      )
+			;
+		auto cache = db.statement_cache_stats();
+		obj.start_object("statement_cache")
+			.field("hits", cache.hits)
+			.field("misses", cache.misses)
+			.field("size", std::uint64_t(cache.size))
+		.end_object();
+		if (checkpoints != 0) {
+			obj.start_object("last_checkpoint")
+				.field("time", last_time)
+				.field("time_human", Util::date(last_time))
+				.field("wal_frames", std::int64_t(last.wal_frames))
+				.field( "checkpointed_frames"
+				      , std::int64_t(last.checkpointed_frames)
+				      )
+				.field("seconds", last.seconds)
+			.end_object();
+			obj
+				.field( "checkpoint_mean_seconds"
+				      , mean_seconds.get()
+				      )
+				.field("checkpoint_max_seconds", max_seconds)
+				;
+		}
+		obj.end_object();
+
+		return rv;
+	}
+
+public:
+	Impl() =delete;
+	Impl(Impl&&) =delete;
+
+	Impl( S::Bus& bus_
+	    , Boss::Mod::Waiter& waiter_
+	    ) : bus(bus_)
+	      , waiter(waiter_)
+	      , checkpointing(false)
+	      , checkpoints(0)
+	      , last_time(0)
+	      , last{0, 0, 0}
+	      , max_seconds(0)
+	      { start(); }
+};
+
+DbMaintainer::DbMaintainer(DbMaintainer&&) =default;
+DbMaintainer::~DbMaintainer() =default;
+
+DbMaintainer::DbMaintainer( S::Bus& bus
+			  , Boss::Mod::Waiter& waiter
+			  ) : pimpl(Util::make_unique<Impl>(bus, waiter)) { }
+
+}}
@@ -0,0 +1,38 @@
+#ifndef BOSS_MOD_DBMAINTAINER_HPP
+#define BOSS_MOD_DBMAINTAINER_HPP
+
+#include<memory>
+
+namespace Boss { namespace Mod { class Waiter; }}
+namespace S { class Bus; }
+
+namespace Boss { namespace Mod {
+
+/** class Boss::Mod::DbMaintainer
+ *
+ * @brief Checkpoints the write-ahead log of the database
+ * every 10 minutes, in the database thread, and reports
+ * database and statement cache statistics on
+ * `clboss-dbstats`.
+ *
+ * @desc Also flushes mutations queued by
+ * `Sqlite3::Db::write_behind` shortly after the first
+ * of them is queued, and on shutdown, and logs those
+ * that failed.
+ */
+class DbMaintainer {
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	DbMaintainer() =delete;
+	DbMaintainer(DbMaintainer&&);
+	~DbMaintainer();
+
+	DbMaintainer(S::Bus&, Boss::Mod::Waiter&);
+};
+
+}}
+
+#endif /* !defined(BOSS_MOD_DBMAINTAINER_HPP) */
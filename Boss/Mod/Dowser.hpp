@@ -1,10 +1,17 @@
 #ifndef BOSS_MOD_DOWSER_HPP
 #define BOSS_MOD_DOWSER_HPP
 
+#include"Boss/ModG/ReqResp.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
+#include"Ln/Amount.hpp"
 #include"Ln/NodeId.hpp"
+#include<map>
 #include<memory>
+#include<utility>
 
-namespace Boss { namespace Mod { class Rpc; }}
+namespace Ln { class FlowEstimator; }
+namespace Ln { class GossipGraph; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod {
@@ -14,19 +21,33 @@ namespace Boss { namespace Mod {
  * @brief Determines the amount of plausible flow between two nodes.
  *
  * @desc This module responds to `Boss::Msg::RequestDowser`.
+ *
+ * The estimate is a bounded-hop flow over the gossip graph
+ * snapshot from `Boss::Mod::GossipGraphTracker`, and is
+ * cached until the graph changes.
  */
 class Dowser {
 private:
 	S::Bus& bus;
-	Boss::Mod::Rpc* rpc;
 	Ln::NodeId self_id;
 
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
+
 	class CommandImpl;
 	std::unique_ptr<CommandImpl> cmdimpl;
 
-	class Run;
+	/* Estimator over the last graph we got.  */
+	std::unique_ptr<Ln::FlowEstimator> estimator;
+	/* Estimates on that graph, by (fromid, toid).  */
+	std::map<std::pair<Ln::NodeId, Ln::NodeId>, Ln::Amount> cache;
 
 	void start();
+	Ln::Amount dowse( std::shared_ptr<Ln::GossipGraph const> graph
+			, Ln::NodeId const& fromid
+			, Ln::NodeId const& toid
+			);
 
 public:
 	Dowser() =delete;
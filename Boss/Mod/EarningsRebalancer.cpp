@@ -153,9 +153,7 @@ private:
                                          (unsigned)ppm );
                 });
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& c) {
-			if (c.command != "clboss-earnings-rebalancer")
-				return Ev::lift();
+			     >("clboss-earnings-rebalancer", [this](Msg::CommandRequest const& c) {
 			return Boss::concurrent(bus.raise(SelfTrigger{}))
 			     + bus.raise(Msg::CommandResponse{
 					c.id, Json::Out::empty_object()
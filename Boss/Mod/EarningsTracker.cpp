@@ -13,8 +13,11 @@
 #include"Boss/Msg/ResponseMoveFunds.hpp"
 #include"Boss/Msg/SolicitStatus.hpp"
 #include"Boss/concurrent.hpp"
+#include"Boss/log.hpp"
+#include"Boss/migrate_hex_to_blob.hpp"
 #include"Ev/Io.hpp"
 #include"Json/Out.hpp"
+#include"Ln/NodeId.hpp"
 #include"S/Bus.hpp"
 #include"Sqlite3.hpp"
 #include"Util/make_unique.hpp"
@@ -131,82 +134,82 @@ private:
 				false
 			});
 		});
-		bus.subscribe<Msg::CommandRequest>([this](Msg::CommandRequest const& req) {
+		bus.subscribe<Msg::CommandRequest
+			     >("clboss-recent-earnings", [this](Msg::CommandRequest const& req) {
 			auto id = req.id;
 			auto paramfail = [this, id]() {
-				return bus.raise(Msg::CommandFail{
-						id, -32602,
-						"Parameter failure",
-						Json::Out::empty_object()
-					});
+				return command_paramfail(id);
 			};
-			if (req.command == "clboss-recent-earnings") {
-				auto days = double(14.0);
-				auto days_j = Jsmn::Object();
-				auto params = req.params;
-				if (params.is_object()) {
-					if (params.size() > 1)
-						return paramfail();
-					if (params.size() == 1) {
-						if (!params.has("days"))
-							return paramfail();
-						days_j = params["days"];
-					}
-				} else if (params.is_array()) {
-					if (params.size() > 1)
-						return paramfail();
-					if (params.size() == 1)
-						days_j = params[0];
-				}
-				if (!days_j.is_null()) {
-					if (!days_j.is_number())
-						return paramfail();
-					days = (double) days_j;
-				}
-				return db.transact().then([this, id, days](Sqlite3::Tx tx) {
-					auto report = recent_earnings_report(tx, days);
-					tx.commit();
-					return bus.raise(Msg::CommandResponse{
-							id, report
-						});
-				});
-			} else if (req.command == "clboss-earnings-history") {
-				auto nodeid = std::string("");
-				auto nodeid_j = Jsmn::Object();
-				auto by_node = false;
-				auto params = req.params;
-				if (params.is_object()) {
-					if (params.size() > 1)
-						return paramfail();
-					if (params.size() == 1) {
-						if (!params.has("nodeid"))
-							return paramfail();
-						nodeid_j = params["nodeid"];
-					}
-				} else if (params.is_array()) {
-					if (params.size() > 1)
+			auto days = double(14.0);
+			auto days_j = Jsmn::Object();
+			auto params = req.params;
+			if (params.is_object()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1) {
+					if (!params.has("days"))
 						return paramfail();
-					if (params.size() == 1)
-						nodeid_j = params[0];
+					days_j = params["days"];
 				}
-				if (!nodeid_j.is_null()) {
-					if (!nodeid_j.is_string())
+			} else if (params.is_array()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1)
+					days_j = params[0];
+			}
+			if (!days_j.is_null()) {
+				if (!days_j.is_number())
+					return paramfail();
+				days = (double) days_j;
+			}
+			return db.transact().then([this, id, days](Sqlite3::Tx tx) {
+				auto report = recent_earnings_report(tx, days);
+				tx.commit();
+				return bus.raise(Msg::CommandResponse{
+						id, report
+					});
+			});
+		});
+		bus.subscribe<Msg::CommandRequest
+			     >("clboss-earnings-history", [this](Msg::CommandRequest const& req) {
+			auto id = req.id;
+			auto paramfail = [this, id]() {
+				return command_paramfail(id);
+			};
+			auto nodeid = std::string("");
+			auto nodeid_j = Jsmn::Object();
+			auto by_node = false;
+			auto params = req.params;
+			if (params.is_object()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1) {
+					if (!params.has("nodeid"))
 						return paramfail();
-					nodeid = (std::string) nodeid_j;
-				}
-				if (nodeid == "all") {
-					by_node = true;
-					nodeid.clear();
+					nodeid_j = params["nodeid"];
 				}
-				return db.transact().then([this, id, nodeid, by_node](Sqlite3::Tx tx) {
-					auto report = earnings_history_report(tx, nodeid, by_node);
-					tx.commit();
-					return bus.raise(Msg::CommandResponse{
-							id, report
-						});
-				});
+			} else if (params.is_array()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1)
+					nodeid_j = params[0];
 			}
-			return Ev::lift();
+			if (!nodeid_j.is_null()) {
+				if (!nodeid_j.is_string())
+					return paramfail();
+				nodeid = (std::string) nodeid_j;
+			}
+			if (nodeid == "all") {
+				by_node = true;
+				nodeid.clear();
+			}
+			return db.transact().then([this, id, nodeid, by_node](Sqlite3::Tx tx) {
+				auto report = earnings_history_report(tx, nodeid, by_node);
+				tx.commit();
+				return bus.raise(Msg::CommandResponse{
+						id, report
+					});
+			});
 		});
 		bus.subscribe<Msg::SolicitStatus
 			     >([this](Msg::SolicitStatus const& _) {
@@ -216,22 +219,31 @@ private:
 		});
 	}
 
+	Ev::Io<void> command_paramfail(Ln::CommandId id) {
+		return bus.raise(Msg::CommandFail{
+				id, -32602,
+				"Parameter failure",
+				Json::Out::empty_object()
+			});
+	}
+
 	Ev::Io<void> init() {
-		return db.transact().then([](Sqlite3::Tx tx) {
+		return db.transact().then([this](Sqlite3::Tx tx) {
 			// NOTE - we can't just alter table here because we
 			// are changing the primary key.
 
 			// If we already have a bucket schema we're done
 			if (have_bucket_table(tx)) {
 				add_missing_columns(tx);
+				auto migrated = migrate_blob(tx);
 				tx.commit();
-				return Ev::lift();
+				return log_migrated(migrated);
 			}
 
 			// Create the bucket table w/ a temp name
 			tx.query_execute(R"QRY(
 			CREATE TABLE IF NOT EXISTS EarningsTracker_New
-			     ( node TEXT NOT NULL
+			     ( node BLOB NOT NULL
 			     , time_bucket REAL NOT NULL
 			     , in_earnings INTEGER NOT NULL
 			     , in_forwarded INTEGER NOT NULL
@@ -268,8 +280,9 @@ private:
 			    idx_earnings_tracker_time_node ON EarningsTracker (time_bucket, node);
 			)QRY");
 
+			auto migrated = migrate_blob(tx);
 			tx.commit();
-			return Ev::lift();
+			return log_migrated(migrated);
 		});
 
 		// These statements revert the schema to before time buckets:
@@ -297,6 +310,22 @@ private:
 		*/
 	}
 
+	// Older versions stored node IDs as hex text.
+	static std::size_t migrate_blob(Sqlite3::Tx& tx) {
+		return migrate_hex_to_blob(tx, "EarningsTracker_blob", {
+			{"EarningsTracker", "node"}
+		});
+	}
+	Ev::Io<void> log_migrated(std::size_t migrated) {
+		if (migrated == 0)
+			return Ev::lift();
+		return Boss::log( bus, Info
+				, "EarningsTracker: Migrated %zu "
+				  "node IDs to binary."
+				, migrated
+				);
+	}
+
 	static bool have_bucket_table(Sqlite3::Tx& tx) {
 		auto fetch = tx.query(R"QRY(
 			SELECT 1
@@ -351,7 +380,7 @@ private:
                        0, 0, 0, 0,
                        0, 0, 0, 0);
 		)QRY")
-			.bind(":node", std::string(node))
+			.bind(":node", node)
 			.bind(":bucket", bucket)
 			.execute()
 			;
@@ -361,9 +390,9 @@ private:
 				, Ln::Amount fee
 				, Ln::Amount amount
 				) {
-		return db.transact().then([this, in, out, fee, amount
-					  ](Sqlite3::Tx tx) {
-			auto bucket = bucket_time(get_now());
+		auto bucket = bucket_time(get_now());
+		return db.write_behind([this, in, out, fee, amount, bucket
+				       ](Sqlite3::Tx& tx) {
 			ensure(tx, in, bucket);
 			ensure(tx, out, bucket);
 
@@ -377,7 +406,7 @@ private:
 			)QRY")
 				.bind(":fee", fee.to_msat())
 				.bind(":amount", amount.to_msat())
-				.bind(":node", std::string(in))
+				.bind(":node", in)
 				.bind(":bucket", bucket)
 				.execute()
 				;
@@ -391,13 +420,10 @@ private:
 			)QRY")
 				.bind(":fee", fee.to_msat())
 				.bind(":amount", amount.to_msat())
-				.bind(":node", std::string(out))
+				.bind(":node", out)
 				.bind(":bucket", bucket)
 				.execute()
 				;
-
-			tx.commit();
-			return Ev::lift();
 		});
 	}
 	Ev::Io<void>
@@ -435,7 +461,7 @@ private:
 			   AND time_bucket = :bucket
 			     ;
 			)QRY")
-				.bind(":node", std::string(pending.source))
+				.bind(":node", pending.source)
 				.bind(":bucket", bucket)
 				.bind(":fee", fee.to_msat())
 				.bind(":amount", amount.to_msat())
@@ -452,9 +478,7 @@ private:
 			   AND time_bucket = :bucket
 			     ;
 			)QRY")
-				.bind( ":node"
-				     , std::string(pending.destination)
-				     )
+				.bind(":node", pending.destination)
 				.bind(":bucket", bucket)
 				.bind(":fee", fee.to_msat())
 				.bind(":amount", amount.to_msat())
@@ -487,7 +511,7 @@ private:
 			  FROM "EarningsTracker"
 			 WHERE node = :node;
 			)QRY")
-				.bind(":node", std::string(node))
+				.bind(":node", node)
 				.execute()
 				;
 
@@ -533,9 +557,9 @@ private:
 			auto obj = out.start_object();
 			for (auto& r : fetch) {
 				size_t ndx = 0;
-				auto node = r.get<std::string>(ndx++);
+				auto node = r.get<Ln::NodeId>(ndx++);
 				auto earnings = EarningsData::from_row(r, ndx);
-				auto sub = obj.start_object(node);
+				auto sub = obj.start_object(std::string(node));
 				earnings.to_json(sub);
 				sub.end_object();
 				total_earnings += earnings;
@@ -582,9 +606,9 @@ private:
 		auto recent = top.start_object("recent");
 		for (auto& r : fetch) {
 			size_t ndx = 0;
-			auto node = r.get<std::string>(ndx++);
+			auto node = r.get<Ln::NodeId>(ndx++);
 			auto earnings = EarningsData::from_row(r, ndx);
-			auto sub = recent.start_object(node);
+			auto sub = recent.start_object(std::string(node));
 			earnings.to_json(sub);
 			sub.end_object();
 			total_earnings += earnings;
@@ -648,7 +672,10 @@ private:
 		        )QRY";
 		}
 		auto query = tx.query(sql.c_str());
-		if (!nodeid.empty()) {
+		if (Ln::NodeId::valid_string(nodeid)) {
+			query.bind(":nodeid", Ln::NodeId(nodeid));
+		} else if (!nodeid.empty()) {
+			/* Matches nothing.  */
 			query.bind(":nodeid", nodeid);
 		}
 		auto fetch = query.execute();
@@ -662,7 +689,9 @@ private:
 			auto bucket_time = r.get<double>(ndx++);
 			std::string row_node;
 			if (by_node) {
-				row_node = r.get<std::string>(ndx++);
+				row_node = std::string(
+					r.get<Ln::NodeId>(ndx++)
+				);
 			}
 			auto earnings = EarningsData::from_row(r, ndx);
 			auto sub = history.start_object();
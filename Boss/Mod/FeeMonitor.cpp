@@ -11,6 +11,8 @@
 #include"Boss/Msg/MonitorFeeSetChannel.hpp"
 #include"Boss/Msg/MonitorFeeBySize.hpp"
 #include"Boss/Msg/PeerMedianChannelFee.hpp"
+#include"Boss/log.hpp"
+#include"Boss/migrate_hex_to_blob.hpp"
 #include"Ev/Io.hpp"
 #include"Ev/coroutine.hpp"
 #include"Ev/now.hpp"
@@ -122,7 +124,7 @@ void FeeMonitor::start() {
 		});
 	});
 	bus.subscribe<Msg::CommandRequest
-		     >([this](Msg::CommandRequest const& req) {
+		     >("clboss-feemon-history", [this](Msg::CommandRequest const& req) {
 		auto id = req.id;
 		auto paramfail = [this, id]() {
 			return bus.raise(Msg::CommandFail{
@@ -132,208 +134,217 @@ void FeeMonitor::start() {
 			});
 		};
 
-		if (req.command == "clboss-feemon-history") {
-			auto nodeid_j = Jsmn::Object();
-			auto since_j = Jsmn::Object();
-			auto before_j = Jsmn::Object();
-			auto params = req.params;
-			if (params.is_object()) {
-				auto has_nodeid = params.has("nodeid");
-				auto has_since = params.has("since");
-				auto has_before = params.has("before");
-				if (!has_nodeid)
-					return paramfail();
-				if (params.size() != std::size_t(
-					has_nodeid + has_since + has_before
-				))
-					return paramfail();
-				nodeid_j = params["nodeid"];
-				if (has_since)
-					since_j = params["since"];
-				if (has_before)
-					before_j = params["before"];
-			} else if (params.is_array()) {
-				if (params.size() < 1 || params.size() > 3)
-					return paramfail();
-				nodeid_j = params[0];
-				if (params.size() >= 2)
-					since_j = params[1];
-				if (params.size() >= 3)
-					before_j = params[2];
-			} else {
+		auto nodeid_j = Jsmn::Object();
+		auto since_j = Jsmn::Object();
+		auto before_j = Jsmn::Object();
+		auto params = req.params;
+		if (params.is_object()) {
+			auto has_nodeid = params.has("nodeid");
+			auto has_since = params.has("since");
+			auto has_before = params.has("before");
+			if (!has_nodeid)
 				return paramfail();
-			}
-
-			if (!nodeid_j.is_string())
+			if (params.size() != std::size_t(
+				has_nodeid + has_since + has_before
+			))
 				return paramfail();
-			auto nodeid_s = std::string(nodeid_j);
-			if (!Ln::NodeId::valid_string(nodeid_s))
-				return paramfail();
-			nodeid_s = std::string(Ln::NodeId(nodeid_s));
-
-			auto since = std::optional<double>();
-			auto before = std::optional<double>();
-			if (!parse_optional_number(since_j, since))
-				return paramfail();
-			if (!parse_optional_number(before_j, before))
-				return paramfail();
-			if (since && before && *since > *before)
+			nodeid_j = params["nodeid"];
+			if (has_since)
+				since_j = params["since"];
+			if (has_before)
+				before_j = params["before"];
+		} else if (params.is_array()) {
+			if (params.size() < 1 || params.size() > 3)
 				return paramfail();
+			nodeid_j = params[0];
+			if (params.size() >= 2)
+				since_j = params[1];
+			if (params.size() >= 3)
+				before_j = params[2];
+		} else {
+			return paramfail();
+		}
 
-			return db_transact().then([this, id, nodeid_s, since, before](Sqlite3::Tx tx) {
-				auto q = tx.query(R"QRY(
-				SELECT e.id,
-				       e.ts,
-				       e.peer_id,
-				       e.set_base,
-				       e.set_base IS NULL,
-				       e.set_ppm,
-				       e.set_ppm IS NULL,
-				       e.baseline_base,
-				       e.baseline_base IS NULL,
-				       e.baseline_ppm,
-				       e.baseline_ppm IS NULL,
-				       e.size_mult,
-				       e.size_mult IS NULL,
-				       e.size_total_peers,
-				       e.size_total_peers IS NULL,
-				       e.size_less_peers,
-				       e.size_less_peers IS NULL,
-				       e.balance_mult,
-				       e.balance_mult IS NULL,
-				       e.balance_our_msat,
-				       e.balance_our_msat IS NULL,
-				       e.balance_total_msat,
-				       e.balance_total_msat IS NULL,
-				       e.price_level,
-				       e.price_level IS NULL,
-				       e.price_mult,
-				       e.price_mult IS NULL,
-				       e.price_cards_left,
-				       e.price_cards_left IS NULL,
-				       e.price_center,
-				       e.price_center IS NULL,
-				       e.mult_product,
-				       e.mult_product IS NULL,
-				       e.est_base,
-				       e.est_base IS NULL,
-				       e.est_ppm,
-				       e.est_ppm IS NULL
-				  FROM feemon_change_events e
-				  JOIN feemon_peers p
-				    ON e.peer_id = p.id
-				 WHERE p.node_id = :node_id
-				   AND (:since IS NULL OR e.ts >= :since)
-				   AND (:before IS NULL OR e.ts <= :before)
-				 ORDER BY e.ts ASC;
-				)QRY");
-				q.bind(":node_id", nodeid_s);
-				bind_optional(q, ":since", since);
-				bind_optional(q, ":before", before);
-				auto fetch = q.execute();
-
-				auto out = Json::Out();
-				auto top = out.start_object();
-				top.field("nodeid", nodeid_s);
-				if (since)
-					top.field("since", *since);
-				if (before)
-					top.field("before", *before);
-				auto history = top.start_array("history");
-				for (auto& r : fetch) {
-					auto row = history.start_object();
-					auto idx = std::size_t(0);
-					row.field("id", r.get<std::uint64_t>(idx++));
-					row.field("ts", static_cast<std::uint64_t>(r.get<double>(idx++)));
-					row.field("peer_id", r.get<std::uint64_t>(idx++));
-					add_optional_int(row, "set_base", r, idx);
-					add_optional_int(row, "set_ppm", r, idx);
-					add_optional_int(row, "baseline_base", r, idx);
-					add_optional_int(row, "baseline_ppm", r, idx);
-					add_optional_double(row, "size_mult", r, idx);
-					add_optional_int(row, "size_total_peers", r, idx);
-					add_optional_int(row, "size_less_peers", r, idx);
-					add_optional_double(row, "balance_mult", r, idx);
-					add_optional_int(row, "balance_our_msat", r, idx);
-					add_optional_int(row, "balance_total_msat", r, idx);
-					add_optional_int(row, "price_level", r, idx);
-					add_optional_double(row, "price_mult", r, idx);
-					add_optional_int(row, "price_cards_left", r, idx);
-					add_optional_int(row, "price_center", r, idx);
-					add_optional_double(row, "mult_product", r, idx);
-					add_optional_int(row, "est_base", r, idx);
-					add_optional_int(row, "est_ppm", r, idx);
-					row.end_object();
-				}
-				history.end_array();
-				top.end_object();
-				tx.commit();
-				return bus.raise(Msg::CommandResponse{id, out});
-			});
-		} else if (req.command == "clboss-feemon-peers") {
-			auto since_j = Jsmn::Object();
-			auto before_j = Jsmn::Object();
-			auto params = req.params;
-			if (params.is_object()) {
-				auto has_since = params.has("since");
-				auto has_before = params.has("before");
-				if (params.size() != std::size_t(has_since + has_before))
-					return paramfail();
-				if (has_since)
-					since_j = params["since"];
-				if (has_before)
-					before_j = params["before"];
-			} else if (params.is_array()) {
-				if (params.size() > 2)
-					return paramfail();
-				if (params.size() >= 1)
-					since_j = params[0];
-				if (params.size() >= 2)
-					before_j = params[1];
-			} else if (!params.is_null()) {
-				return paramfail();
+		if (!nodeid_j.is_string())
+			return paramfail();
+		auto nodeid_s = std::string(nodeid_j);
+		if (!Ln::NodeId::valid_string(nodeid_s))
+			return paramfail();
+		nodeid_s = std::string(Ln::NodeId(nodeid_s));
+
+		auto since = std::optional<double>();
+		auto before = std::optional<double>();
+		if (!parse_optional_number(since_j, since))
+			return paramfail();
+		if (!parse_optional_number(before_j, before))
+			return paramfail();
+		if (since && before && *since > *before)
+			return paramfail();
+
+		return db_transact().then([this, id, nodeid_s, since, before](Sqlite3::Tx tx) {
+			auto q = tx.query(R"QRY(
+			SELECT e.id,
+			       e.ts,
+			       e.peer_id,
+			       e.set_base,
+			       e.set_base IS NULL,
+			       e.set_ppm,
+			       e.set_ppm IS NULL,
+			       e.baseline_base,
+			       e.baseline_base IS NULL,
+			       e.baseline_ppm,
+			       e.baseline_ppm IS NULL,
+			       e.size_mult,
+			       e.size_mult IS NULL,
+			       e.size_total_peers,
+			       e.size_total_peers IS NULL,
+			       e.size_less_peers,
+			       e.size_less_peers IS NULL,
+			       e.balance_mult,
+			       e.balance_mult IS NULL,
+			       e.balance_our_msat,
+			       e.balance_our_msat IS NULL,
+			       e.balance_total_msat,
+			       e.balance_total_msat IS NULL,
+			       e.price_level,
+			       e.price_level IS NULL,
+			       e.price_mult,
+			       e.price_mult IS NULL,
+			       e.price_cards_left,
+			       e.price_cards_left IS NULL,
+			       e.price_center,
+			       e.price_center IS NULL,
+			       e.mult_product,
+			       e.mult_product IS NULL,
+			       e.est_base,
+			       e.est_base IS NULL,
+			       e.est_ppm,
+			       e.est_ppm IS NULL
+			  FROM feemon_change_events e
+			  JOIN feemon_peers p
+			    ON e.peer_id = p.id
+			 WHERE p.node_id = :node_id
+			   AND (:since IS NULL OR e.ts >= :since)
+			   AND (:before IS NULL OR e.ts <= :before)
+			 ORDER BY e.ts ASC;
+			)QRY");
+			q.bind(":node_id", Ln::NodeId(nodeid_s));
+			bind_optional(q, ":since", since);
+			bind_optional(q, ":before", before);
+			auto fetch = q.execute();
+
+			auto out = Json::Out();
+			auto top = out.start_object();
+			top.field("nodeid", nodeid_s);
+			if (since)
+				top.field("since", *since);
+			if (before)
+				top.field("before", *before);
+			auto history = top.start_array("history");
+			for (auto& r : fetch) {
+				auto row = history.start_object();
+				auto idx = std::size_t(0);
+				row.field("id", r.get<std::uint64_t>(idx++));
+				row.field("ts", static_cast<std::uint64_t>(r.get<double>(idx++)));
+				row.field("peer_id", r.get<std::uint64_t>(idx++));
+				add_optional_int(row, "set_base", r, idx);
+				add_optional_int(row, "set_ppm", r, idx);
+				add_optional_int(row, "baseline_base", r, idx);
+				add_optional_int(row, "baseline_ppm", r, idx);
+				add_optional_double(row, "size_mult", r, idx);
+				add_optional_int(row, "size_total_peers", r, idx);
+				add_optional_int(row, "size_less_peers", r, idx);
+				add_optional_double(row, "balance_mult", r, idx);
+				add_optional_int(row, "balance_our_msat", r, idx);
+				add_optional_int(row, "balance_total_msat", r, idx);
+				add_optional_int(row, "price_level", r, idx);
+				add_optional_double(row, "price_mult", r, idx);
+				add_optional_int(row, "price_cards_left", r, idx);
+				add_optional_int(row, "price_center", r, idx);
+				add_optional_double(row, "mult_product", r, idx);
+				add_optional_int(row, "est_base", r, idx);
+				add_optional_int(row, "est_ppm", r, idx);
+				row.end_object();
 			}
+			history.end_array();
+			top.end_object();
+			tx.commit();
+			return bus.raise(Msg::CommandResponse{id, out});
+		});
+	});
+	bus.subscribe<Msg::CommandRequest
+		     >("clboss-feemon-peers", [this](Msg::CommandRequest const& req) {
+		auto id = req.id;
+		auto paramfail = [this, id]() {
+			return bus.raise(Msg::CommandFail{
+				id, -32602,
+				"Parameter failure",
+				Json::Out::empty_object()
+			});
+		};
 
-			auto since = std::optional<double>();
-			auto before = std::optional<double>();
-			if (!parse_optional_number(since_j, since))
+		auto since_j = Jsmn::Object();
+		auto before_j = Jsmn::Object();
+		auto params = req.params;
+		if (params.is_object()) {
+			auto has_since = params.has("since");
+			auto has_before = params.has("before");
+			if (params.size() != std::size_t(has_since + has_before))
 				return paramfail();
-			if (!parse_optional_number(before_j, before))
+			if (has_since)
+				since_j = params["since"];
+			if (has_before)
+				before_j = params["before"];
+		} else if (params.is_array()) {
+			if (params.size() > 2)
 				return paramfail();
-			if (since && before && *since > *before)
-				return paramfail();
-
-			return db_transact().then([this, id, since, before](Sqlite3::Tx tx) {
-				auto q = tx.query(R"QRY(
-				SELECT DISTINCT p.node_id
-				  FROM feemon_change_events e
-				  JOIN feemon_peers p
-				    ON e.peer_id = p.id
-				 WHERE (:since IS NULL OR e.ts >= :since)
-				   AND (:before IS NULL OR e.ts <= :before)
-				 ORDER BY p.node_id ASC;
-				)QRY");
-				bind_optional(q, ":since", since);
-				bind_optional(q, ":before", before);
-				auto fetch = q.execute();
-
-				auto out = Json::Out();
-				auto top = out.start_object();
-				if (since)
-					top.field("since", *since);
-				if (before)
-					top.field("before", *before);
-				auto peers = top.start_array("peers");
-				for (auto& r : fetch)
-					peers.entry(r.get<std::string>(0));
-				peers.end_array();
-				top.end_object();
-				tx.commit();
-				return bus.raise(Msg::CommandResponse{id, out});
-			});
+			if (params.size() >= 1)
+				since_j = params[0];
+			if (params.size() >= 2)
+				before_j = params[1];
+		} else if (!params.is_null()) {
+			return paramfail();
 		}
 
-		return Ev::lift();
+		auto since = std::optional<double>();
+		auto before = std::optional<double>();
+		if (!parse_optional_number(since_j, since))
+			return paramfail();
+		if (!parse_optional_number(before_j, before))
+			return paramfail();
+		if (since && before && *since > *before)
+			return paramfail();
+
+		return db_transact().then([this, id, since, before](Sqlite3::Tx tx) {
+			auto q = tx.query(R"QRY(
+			SELECT DISTINCT p.node_id
+			  FROM feemon_change_events e
+			  JOIN feemon_peers p
+			    ON e.peer_id = p.id
+			 WHERE (:since IS NULL OR e.ts >= :since)
+			   AND (:before IS NULL OR e.ts <= :before)
+			 ORDER BY p.node_id ASC;
+			)QRY");
+			bind_optional(q, ":since", since);
+			bind_optional(q, ":before", before);
+			auto fetch = q.execute();
+
+			auto out = Json::Out();
+			auto top = out.start_object();
+			if (since)
+				top.field("since", *since);
+			if (before)
+				top.field("before", *before);
+			auto peers = top.start_array("peers");
+			for (auto& r : fetch)
+				peers.entry(std::string(
+					r.get<Ln::NodeId>(0)
+				));
+			peers.end_array();
+			top.end_object();
+			tx.commit();
+			return bus.raise(Msg::CommandResponse{id, out});
+		});
 	});
 }
 
@@ -348,7 +359,7 @@ Ev::Io<void> FeeMonitor::initialize_db() {
 	tx.query_execute(R"QRY(
 	CREATE TABLE IF NOT EXISTS feemon_peers (
 		id INTEGER PRIMARY KEY,
-		node_id TEXT NOT NULL UNIQUE
+		node_id BLOB NOT NULL UNIQUE
 	);
 	CREATE TABLE IF NOT EXISTS feemon_change_events (
 		id INTEGER PRIMARY KEY,
@@ -378,7 +389,18 @@ Ev::Io<void> FeeMonitor::initialize_db() {
 	CREATE INDEX IF NOT EXISTS feemon_change_events_ts_peer_idx
 	ON feemon_change_events(ts, peer_id);
 	)QRY");
+	/* Older versions stored node IDs as hex text.  */
+	auto migrated = migrate_hex_to_blob(tx, "feemon_blob", {
+		{"feemon_peers", "node_id"}
+	});
 	tx.commit();
+	tx = Sqlite3::Tx();
+	if (migrated != 0)
+		co_await Boss::log( bus, Info
+				  , "FeeMonitor: Migrated %zu node IDs "
+				    "to binary."
+				  , migrated
+				  );
 	co_return;
 }
 
@@ -397,7 +419,7 @@ FeeMonitor::get_peer_id(Sqlite3::Tx& tx, Ln::NodeId const& node) {
 	 WHERE node_id = :node_id
 	     ;
 	)QRY")
-		.bind(":node_id", std::string(node))
+		.bind(":node_id", node)
 		.execute()
 		;
 	for (auto& r : fetch)
@@ -407,7 +429,7 @@ FeeMonitor::get_peer_id(Sqlite3::Tx& tx, Ln::NodeId const& node) {
 	INSERT OR IGNORE INTO feemon_peers
 	VALUES(NULL, :node_id);
 	)QRY")
-		.bind(":node_id", std::string(node))
+		.bind(":node_id", node)
 		.execute()
 		;
 
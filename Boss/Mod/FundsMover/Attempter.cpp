@@ -8,14 +8,18 @@
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"Ln/Amount.hpp"
+#include"Ln/GossipGraph.hpp"
 #include"Ln/NodeId.hpp"
 #include"Ln/Preimage.hpp"
+#include"Ln/RouteFinder.hpp"
 #include"Ln/Scid.hpp"
 #include"Sha256/Hash.hpp"
 #include"Util/stringify.hpp"
+#include<algorithm>
 #include<assert.h>
 #include<random>
 #include<string>
+#include<utility>
 #include<vector>
 
 namespace {
@@ -23,6 +27,10 @@ namespace {
 auto initial_fuzzpercent = double(11.0);
 auto step_fuzzpercent = double(11.0);
 
+/* Number of alternative routes to get from the local route
+ * finder at a time.  */
+auto const local_route_count = std::size_t(5);
+
 }
 
 namespace Boss { namespace Mod { namespace FundsMover {
@@ -47,11 +55,17 @@ private:
 	std::uint32_t cltv_delta;
 	/* Details of the first channel from us to source.  */
 	Ln::Scid first_scid;
+	std::shared_ptr<Ln::RouteFinder> finder;
 
 	bool ok;
 
 	double fuzzpercent;
-	std::vector<std::string> excludes;
+	std::vector<Ln::NodeId> exclude_nodes;
+	std::vector<std::pair<Ln::Scid, int>> exclude_channels;
+	/* Routes from the local route finder not yet tried.  */
+	std::vector<Ln::RouteFinder::Route> alternatives;
+	/* Whether the local route finder found any route.  */
+	bool found_local;
 	Ln::Amount dest_amount;
 	Ln::Amount source_amount;
 	std::uint32_t source_delay;
@@ -80,6 +94,7 @@ public:
 	    , std::uint32_t proportional_fee_
 	    , std::uint32_t cltv_delta_
 	    , Ln::Scid first_scid_
+	    , std::shared_ptr<Ln::RouteFinder> finder_
 	    ) : bus(bus_)
 	      , rpc(rpc_)
 	      , self_id(std::move(self_id_))
@@ -95,7 +110,9 @@ public:
 	      , proportional_fee(proportional_fee_)
 	      , cltv_delta(cltv_delta_)
 	      , first_scid(first_scid_)
+	      , finder(std::move(finder_))
 	      , ok(false)
+	      , found_local(false)
 	      { }
 	Ev::Io<bool> run() {
 		auto self = shared_from_this();
@@ -108,7 +125,7 @@ private:
 	Ev::Io<void> core_run() {
 		return Ev::lift().then([this]() {
 			/* Initialize.  */
-			excludes.push_back(std::string(self_id));
+			exclude_nodes.push_back(self_id);
 			dest_amount = amount + base_fee
 				    + (amount * ( double(proportional_fee)
 						/ 1000000
@@ -121,6 +138,77 @@ private:
 		});
 	}
 	Ev::Io<void> getroute() {
+		if (finder)
+			return local_route();
+		return rpc_getroute();
+	}
+	Ev::Io<void> local_route() {
+		return Ev::yield().then([this]() {
+			/* Drop alternatives that go through anything
+			 * excluded since we got them.  */
+			alternatives.erase(std::remove_if( alternatives.begin()
+							 , alternatives.end()
+							 , [this](Ln::RouteFinder::Route const& r) {
+				return is_excluded(r);
+			}), alternatives.end());
+			if (alternatives.empty()) {
+				auto q = Ln::RouteFinder::Query();
+				q.source = source;
+				q.destination = destination;
+				q.amount = dest_amount;
+				q.final_cltv = cltv_delta + 14;
+				q.max_fee = *fee_budget;
+				q.exclude_nodes = exclude_nodes;
+				q.exclude_channels = exclude_channels;
+				q.count = local_route_count;
+				alternatives = finder->find(q);
+			}
+			if (alternatives.empty()) {
+				if (found_local)
+					return give_up();
+				/* Our snapshot of the graph may be missing
+				 * channels that lightningd knows about.  */
+				finder = nullptr;
+				return rpc_getroute();
+			}
+			found_local = true;
+			route = make_local_route(alternatives.front());
+			alternatives.erase(alternatives.begin());
+			return compute_source_amount();
+		});
+	}
+	bool is_excluded(Ln::RouteFinder::Route const& r) const {
+		for (auto const& h : r.hops) {
+			auto it = std::find( exclude_nodes.begin()
+					   , exclude_nodes.end()
+					   , h.id
+					   );
+			if (it != exclude_nodes.end())
+				return true;
+			for (auto const& e : exclude_channels)
+				if (e.first == h.channel && e.second == h.direction)
+					return true;
+		}
+		return false;
+	}
+	/* Convert to the same format as the `getroute` result.  */
+	static
+	Jsmn::Object make_local_route(Ln::RouteFinder::Route const& r) {
+		auto js = Json::Out();
+		auto arr = js.start_array();
+		for (auto const& h : r.hops)
+			arr.start_object()
+				.field("id", std::string(h.id))
+				.field("channel", std::string(h.channel))
+				.field("direction", h.direction)
+				.field("amount_msat", h.amount.to_msat())
+				.field("delay", h.delay)
+				.field("style", "tlv")
+			.end_object();
+		arr.end_array();
+		return Jsmn::Object::parse_json(js.output().c_str());
+	}
+	Ev::Io<void> rpc_getroute() {
 		return Ev::yield().then([this]() {
 			auto parms = Json::Out()
 				.start_object()
@@ -152,40 +240,100 @@ private:
 	Json::Out make_excludes() {
 		auto rv = Json::Out();
 		auto arr = rv.start_array();
-		for (auto const& s : excludes)
-			arr.entry(s);
+		for (auto const& n : exclude_nodes)
+			arr.entry(std::string(n));
+		for (auto const& c : exclude_channels)
+			arr.entry( std::string(c.first) + "/"
+				 + Util::stringify(c.second)
+				 );
 		arr.end_array();
 		return rv;
 	}
 	Ev::Io<void> compute_source_amount() {
-		struct Fail { };
-		auto hop1_amount = std::make_shared<Ln::Amount>();
-		auto hop1_delay = std::make_shared<std::uint32_t>();
+		auto hop1 = Ln::Scid();
+		auto hop1_amount = Ln::Amount();
+		auto hop1_delay = std::uint32_t();
+		try {
+			auto hop1_data = route[0];
+			hop1 = Ln::Scid(std::string(
+				hop1_data["channel"]
+			));
+			hop1_amount = Ln::Amount::object(
+				hop1_data["amount_msat"]
+			);
+			hop1_delay = std::uint32_t(double(
+				hop1_data["delay"]
+			));
+		} catch (Jsmn::TypeError const& ) {
+			return Boss::log( bus, Error
+					, "FundsMover: Unexpected "
+					  "route from getroute: %s"
+					, Util::stringify(route)
+						.c_str()
+					).then([this]() {
+				return fee_failed();
+			});
+		}
 
-		return Ev::lift().then([this, hop1_amount, hop1_delay]() {
-			auto hop1 = Ln::Scid();
-			try {
-				auto hop1_data = route[0];
-				hop1 = Ln::Scid(std::string(
-					hop1_data["channel"]
-				));
-				*hop1_amount = Ln::Amount::object(
-					hop1_data["amount_msat"]
-				);
-				*hop1_delay = std::uint32_t(double(
-					hop1_data["delay"]
-				));
-			} catch (Jsmn::TypeError const& ) {
-				return Boss::log( bus, Error
-						, "FundsMover: Unexpected "
-						  "route from getroute: %s"
-						, Util::stringify(route)
-							.c_str()
-						).then([]() {
-					throw Fail();
-					return Ev::lift(Jsmn::Object());
-				});
+		return get_source_policy(hop1).then([ this
+						    , hop1_amount
+						    , hop1_delay
+						    ](std::shared_ptr<Policy> p) {
+			if (!p)
+				return Ev::lift(false);
+			source_amount = hop1_amount + p->base_fee
+				      + (hop1_amount * ( double(p->prop_fee)
+						       / 1000000
+						       ))
+				      + Ln::Amount::msat(1)
+				      ;
+			source_delay = hop1_delay + p->cltv_delta;
+			our_fee = source_amount - amount;
+
+			assert(amount <= *remaining_amount);
+
+			/* Make our fee budget proportional to how large we are.  */
+			auto prorata = amount / *remaining_amount;
+			auto prorated_fee_budget = *fee_budget * prorata;
+
+			if (our_fee > prorated_fee_budget)
+				return Ev::lift(false);
+			*fee_budget -= our_fee;
+			*remaining_amount -= amount;
+			return Ev::lift(true);
+		}).then([this](bool success) {
+			if (!success)
+				return fee_failed();
+			/* At this point we have deducted our fee from the
+			 * fee budget.
+			 */
+			return sendpay();
+		});
+	}
+	/* What the source charges to forward over the first
+	 * channel of the route.  */
+	struct Policy {
+		Ln::Amount base_fee;
+		std::uint32_t prop_fee;
+		std::uint32_t cltv_delta;
+	};
+	/* Return null if we could not get it.  */
+	Ev::Io<std::shared_ptr<Policy>> get_source_policy(Ln::Scid hop1) {
+		if (finder) {
+			auto const& graph = finder->graph();
+			for (auto c : graph.find(hop1)) {
+				auto const& ch = graph.channel(c);
+				if (graph.node(ch.source) != source)
+					continue;
+				return Ev::lift(std::make_shared<Policy>(Policy{
+					Ln::Amount::msat(ch.base_fee),
+					ch.proportional_fee,
+					ch.delay
+				}));
 			}
+		}
+
+		return Ev::lift().then([this, hop1]() {
 			auto parms = Json::Out()
 				.start_object()
 					.field( "short_channel_id"
@@ -194,10 +342,8 @@ private:
 				.end_object()
 				;
 			return rpc.command("listchannels", std::move(parms));
-		}).then([this, hop1_amount, hop1_delay](Jsmn::Object res) {
-			auto base_fee = Ln::Amount();
-			auto prop_fee = std::uint32_t();
-			auto cltv_delta = std::uint32_t();
+		}).then([this](Jsmn::Object res) {
+			auto rv = std::make_shared<Policy>();
 			try {
 				auto found = false;
 				auto cs = res["channels"];
@@ -208,13 +354,13 @@ private:
 					if (csrc != source)
 						continue;
 					found = true;
-					base_fee = Ln::Amount::msat(double(
+					rv->base_fee = Ln::Amount::msat(double(
 						c["base_fee_millisatoshi"]
 					));
-					prop_fee = std::uint32_t(double(
+					rv->prop_fee = std::uint32_t(double(
 						c["fee_per_millionth"]
 					));
-					cltv_delta = std::uint32_t(double(
+					rv->cltv_delta = std::uint32_t(double(
 						c["delay"]
 					));
 				}
@@ -228,40 +374,12 @@ private:
 						, Util::stringify(res)
 							.c_str()
 						).then([]() {
-					return Ev::lift(false);
+					return Ev::lift(std::shared_ptr<Policy>());
 				});
 			}
-			source_amount = *hop1_amount + base_fee
-				      + (*hop1_amount * ( double(prop_fee)
-							/ 1000000
-							))
-				      + Ln::Amount::msat(1)
-				      ;
-			source_delay = *hop1_delay + cltv_delta;
-			our_fee = source_amount - amount;
-
-			assert(amount <= *remaining_amount);
-
-			/* Make our fee budget proportional to how large we are.  */
-			auto prorata = amount / *remaining_amount;
-			auto prorated_fee_budget = *fee_budget * prorata;
-
-			if (our_fee > prorated_fee_budget)
-				return Ev::lift(false);
-			*fee_budget -= our_fee;
-			*remaining_amount -= amount;
-			return Ev::lift(true);
+			return Ev::lift(std::move(rv));
 		}).catching<RpcError>([](RpcError const&) {
-			return Ev::lift(false);
-		}).catching<Fail>([](Fail const&) {
-			return Ev::lift(false);
-		}).then([this](bool success) {
-			if (!success)
-				return fee_failed();
-			/* At this point we have deducted our fee from the
-			 * fee budget.
-			 */
-			return sendpay();
+			return Ev::lift(std::shared_ptr<Policy>());
 		});
 	}
 
@@ -419,13 +537,10 @@ private:
 					     ;
 				/* 0x2000 == NODE level error.  */
 				if ((fail & 0x2000))
-					excludes.push_back(std::string(
-						enode
-					));
+					exclude_nodes.push_back(enode);
 				else
-					excludes.push_back(
-						std::string(echan) + "/" +
-						Util::stringify(edir)
+					exclude_channels.emplace_back(
+						echan, edir
 					);
 			} else {
 				/* Unparsable onion, exclude any node.  */
@@ -433,9 +548,9 @@ private:
 					0, route.size() - 2
 				);
 				auto hop = route[dist(Boss::random_engine)];
-				excludes.push_back(std::string(
+				exclude_nodes.push_back(Ln::NodeId(std::string(
 					hop["id"]
-				));
+				)));
 			}
 
 			return std::move(act) + getroute();
@@ -530,12 +645,17 @@ private:
 	}
 
 	Ev::Io<void> fee_failed() {
-		if (fuzzpercent > 0) {
+		/* Local routes are tried cheapest first, so the
+		 * remaining alternatives cost even more.  */
+		if (!finder && fuzzpercent > 0) {
 			fuzzpercent -= step_fuzzpercent;
 			if (fuzzpercent < 0)
 				fuzzpercent = 0;
 			return getroute();
 		}
+		return give_up();
+	}
+	Ev::Io<void> give_up() {
 		return Boss::log( bus, Debug
 				, "FundsMover: Giving up attempt to move "
 				  "%s from %s to %s."
@@ -565,6 +685,7 @@ Attempter::run( S::Bus& bus
 	      , std::uint32_t cltv_delta
 	      /* The channel from us to source.  */
 	      , Ln::Scid first_scid
+	      , std::shared_ptr<Ln::RouteFinder> finder
 	      ) {
 	auto impl = std::make_shared<Impl>( bus
 					  , rpc
@@ -581,6 +702,7 @@ Attempter::run( S::Bus& bus
 					  , proportional_fee
 					  , cltv_delta
 					  , first_scid
+					  , std::move(finder)
 					  );
 	return impl->run();
 }
@@ -9,6 +9,7 @@ namespace Ev { template<typename a> class Io; }
 namespace Ln { class Amount; }
 namespace Ln { class NodeId; }
 namespace Ln { class Preimage; }
+namespace Ln { class RouteFinder; }
 namespace Ln { class Scid; }
 namespace S { class Bus; }
 
@@ -63,6 +64,11 @@ public:
 	   , std::uint32_t cltv_delta
 	   /* The channel from us to source.  */
 	   , Ln::Scid first_scid
+	   /* Finds routes from source to destination locally;
+	    * if null, or if it cannot find any route, routes
+	    * are requested from `lightningd` via `getroute`.
+	    */
+	   , std::shared_ptr<Ln::RouteFinder> finder
 	   );
 };
 
@@ -4,15 +4,20 @@
 #include"Boss/Mod/FundsMover/create_label.hpp"
 #include"Boss/Mod/Rpc.hpp"
 #include"Boss/ModG/RebalanceUnmanagerProxy.hpp"
+#include"Boss/ModG/ReqResp.hpp"
 #include"Boss/Msg/Init.hpp"
 #include"Boss/Msg/ProvideDeletablePaymentLabelFilter.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
 #include"Boss/Msg/RequestMoveFunds.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
 #include"Boss/Msg/SolicitDeletablePaymentLabelFilter.hpp"
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
 #include"Ev/Io.hpp"
 #include"Ev/yield.hpp"
+#include"Ln/GossipGraph.hpp"
 #include"Ln/NodeId.hpp"
+#include"Ln/RouteFinder.hpp"
 #include"S/Bus.hpp"
 #include"Util/make_unique.hpp"
 #include"Util/stringify.hpp"
@@ -31,6 +36,9 @@ private:
 	Ln::NodeId self_id;
 
 	Boss::ModG::RebalanceUnmanagerProxy unmanager;
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
 
 	void start() {
 		bus.subscribe<Msg::Init>([this](Msg::Init const& init) {
@@ -74,13 +82,23 @@ private:
 							  "Contact " PACKAGE_BUGREPORT
 							);
 				}
-				auto runner = Runner::create( bus
-							    , *rpc
-							    , self_id
-							    , claimer
-							    , *msg
-							    );
-				return Runner::start(runner);
+				return graph_rr.execute(Msg::RequestGossipGraph{
+					nullptr
+				}).then([this, msg](Msg::ResponseGossipGraph g) {
+					auto finder = std::shared_ptr<Ln::RouteFinder>();
+					if (g.graph->num_channels() != 0)
+						finder = std::make_shared<Ln::RouteFinder>(
+							std::move(g.graph)
+						);
+					auto runner = Runner::create( bus
+								    , *rpc
+								    , self_id
+								    , claimer
+								    , std::move(finder)
+								    , *msg
+								    );
+					return Runner::start(runner);
+				});
 			});
 		});
 		using Msg::ProvideDeletablePaymentLabelFilter;
@@ -111,6 +129,7 @@ public:
 			   , claimer(bus_)
 			   , rpc(nullptr)
 			   , unmanager(bus_)
+			   , graph_rr(bus_)
 			   { start(); }
 };
 
@@ -36,11 +36,13 @@ Runner::Runner( S::Bus& bus_
 	      , Boss::Mod::Rpc& rpc_
 	      , Ln::NodeId self_
 	      , Boss::Mod::FundsMover::Claimer& claimer_
+	      , std::shared_ptr<Ln::RouteFinder> finder_
 	      , Boss::Msg::RequestMoveFunds const& req
 	      ) : bus(bus_)
 		, rpc(rpc_)
 		, self(std::move(self_))
 		, claimer(claimer_)
+		, finder(std::move(finder_))
 		, requester(req.requester)
 		, source(req.source)
 		, destination(req.destination)
@@ -198,6 +200,7 @@ Ev::Io<void> Runner::attempt(Ln::Amount amount) {
 				     , proportional_fee
 				     , cltv_delta
 				     , first_scid
+				     , finder
 				     );
 	}).then([this, amount](bool result) {
 		--attempts;
@@ -12,6 +12,7 @@ namespace Boss { namespace Mod { namespace FundsMover { class Claimer; }}}
 namespace Boss { namespace Mod { class Rpc; }}
 namespace Boss { namespace Msg { struct RequestMoveFunds; }}
 namespace Ev { template<typename a> class Io; }
+namespace Ln { class RouteFinder; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod { namespace FundsMover {
@@ -26,6 +27,9 @@ private:
 	Boss::Mod::Rpc& rpc;
 	Ln::NodeId self;
 	Boss::Mod::FundsMover::Claimer& claimer;
+	/* Shared by all attempts of this run; null if we
+	 * have no graph to search.  */
+	std::shared_ptr<Ln::RouteFinder> finder;
 
 	/* Specs from the request.  */
 	void* requester;
@@ -49,6 +53,7 @@ private:
 	      , Boss::Mod::Rpc& rpc
 	      , Ln::NodeId self
 	      , Boss::Mod::FundsMover::Claimer& claimer
+	      , std::shared_ptr<Ln::RouteFinder> finder
 	      , Boss::Msg::RequestMoveFunds const& req
 	      );
 
@@ -83,6 +88,7 @@ public:
 	      , Boss::Mod::Rpc& rpc
 	      , Ln::NodeId self
 	      , Boss::Mod::FundsMover::Claimer& claimer
+	      , std::shared_ptr<Ln::RouteFinder> finder
 	      , Boss::Msg::RequestMoveFunds const& req
 	      ) {
 		/* Constructor is private, cannot use std::make_shared.  */
@@ -91,6 +97,7 @@ public:
 				  , rpc
 				  , std::move(self)
 				  , claimer
+				  , std::move(finder)
 				  , req
 				  )
 		);
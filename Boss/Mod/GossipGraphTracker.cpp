@@ -0,0 +1,485 @@
+#include"Boss/Mod/GossipGraphTracker.hpp"
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Msg/Block.hpp"
+#include"Boss/Msg/Init.hpp"
+#include"Boss/Msg/ListpeersAnalyzedResult.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
+#include"Boss/concurrent.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/foreach.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Jsmn/ParseError.hpp"
+#include"Json/Out.hpp"
+#include"Ln/GossipGraph.hpp"
+#include"S/Bus.hpp"
+#include"Util/make_unique.hpp"
+#include<map>
+#include<set>
+#include<vector>
+
+namespace {
+
+/* Number of entries to parse before yielding to other
+ * greenthreads.
+ */
+auto const parse_batch = std::size_t(1000);
+
+/* Number of nodes, other than our peers, whose outgoing
+ * channels are re-queried at each block.
+ * With about 15,000 nodes on the network, the whole
+ * graph is swept about once a day.
+ */
+auto const refresh_batch = std::size_t(100);
+
+}
+
+namespace Boss { namespace Mod {
+
+class GossipGraphTracker::Impl {
+private:
+	S::Bus& bus;
+	Boss::Mod::Rpc* rpc;
+
+	/* The graph we patch at each block; never handed
+	 * out.  */
+	std::unique_ptr<Ln::GossipGraph> graph;
+	/* Immutable copy of the graph handed out to
+	 * requesters, made when first requested after the
+	 * graph changed.  */
+	std::shared_ptr<Ln::GossipGraph const> snapshot;
+
+	/* Set while the initial fetch is ongoing.  */
+	bool fetching;
+	/* Requesters waiting for the initial fetch.  */
+	std::vector<void*> requesters;
+
+	/* Set while a per-block refresh is ongoing.  */
+	bool refreshing;
+	/* Next node to refresh in the rotation.  */
+	Ln::GossipGraph::Index next_refresh;
+	/* Our channeled peers, refreshed at every block.  */
+	std::set<Ln::NodeId> peers;
+
+	/* A directed channel as reported by `listchannels`.  */
+	struct Entry {
+		Ln::NodeId source;
+		Ln::NodeId destination;
+		Ln::GossipGraph::Channel channel;
+	};
+
+	/* State of an ongoing fetch.  */
+	struct Fetch {
+		Ln::GossipGraph::Builder builder;
+		/* Entries that were not streamed, if any.  */
+		Jsmn::Object items;
+		Jsmn::Object::iterator it;
+		std::size_t skipped;
+	};
+
+	/* State of an ongoing refresh.  */
+	struct Refresh {
+		std::vector<Ln::NodeId> sources;
+		std::vector<Ln::NodeId>::const_iterator it;
+		/* Current outgoing channels of each source
+		 * successfully queried.  */
+		std::map<Ln::NodeId, std::vector<Entry>> fetched;
+	};
+
+	void start() {
+		fetching = false;
+		refreshing = false;
+		next_refresh = 0;
+		bus.subscribe<Msg::Init
+			     >([this](Msg::Init const& init) {
+			rpc = &init.rpc;
+			/* Requests that came in before init.  */
+			if (requesters.empty() || fetching)
+				return Ev::lift();
+			fetching = true;
+			return Boss::concurrent(fetch());
+		});
+		bus.subscribe<Msg::RequestGossipGraph
+			     >([this](Msg::RequestGossipGraph const& m) {
+			if (graph)
+				return bus.raise(Msg::ResponseGossipGraph{
+					m.requester, publish()
+				});
+			requesters.push_back(m.requester);
+			if (fetching || !rpc)
+				return Ev::lift();
+			fetching = true;
+			return Boss::concurrent(fetch());
+		});
+		bus.subscribe<Msg::ListpeersAnalyzedResult
+			     >([this](Msg::ListpeersAnalyzedResult const& m) {
+			peers = m.connected_channeled;
+			peers.insert( m.disconnected_channeled.begin()
+				    , m.disconnected_channeled.end()
+				    );
+			return Ev::lift();
+		});
+		bus.subscribe<Msg::Block
+			     >([this](Msg::Block const&) {
+			/* Nobody asked for the graph yet, so nothing
+			 * to keep current.  */
+			if (!graph || fetching || refreshing)
+				return Ev::lift();
+			refreshing = true;
+			return Boss::concurrent(refresh());
+		});
+	}
+
+	Ev::Io<void> fetch() {
+		auto f = std::make_shared<Fetch>();
+		f->skipped = 0;
+		return Boss::log( bus, Debug
+				, "GossipGraphTracker: Fetching channel graph."
+				).then([this, f]() {
+			/* The whole network is the largest result we
+			 * get, so add each entry as it arrives rather
+			 * than holding all of them.  */
+			return rpc->command_streaming( "listchannels"
+						     , Json::Out::empty_object()
+						     , "channels"
+						     , [f](Jsmn::Object c) {
+				add_channel(*f, c);
+			});
+		}).then([this, f](Jsmn::Object res) {
+			f->items = res["channels"];
+			f->it = f->items.begin();
+			return channels_loop(f);
+		}).then([this, f]() {
+			return rpc->command_streaming( "listnodes"
+						     , Json::Out::empty_object()
+						     , "nodes"
+						     , [f](Jsmn::Object n) {
+				add_node(*f, n);
+			});
+		}).then([this, f](Jsmn::Object res) {
+			f->items = res["nodes"];
+			f->it = f->items.begin();
+			return nodes_loop(f);
+		}).then([this, f]() {
+			f->items = Jsmn::Object();
+			graph = Util::make_unique<Ln::GossipGraph>(
+				std::move(f->builder).build()
+			);
+			graph->set_generation(1);
+			snapshot = nullptr;
+			return Boss::log( bus, Debug
+					, "GossipGraphTracker: "
+					  "%zu nodes, %zu directed channels "
+					  "(%zu entries skipped)."
+					, graph->num_nodes()
+					, graph->num_channels()
+					, f->skipped
+					).then([this]() {
+				return respond(publish());
+			});
+		}).catching<RpcError>([this](RpcError const& e) {
+			return Boss::log( bus, Error
+					, "GossipGraphTracker: %s"
+					, e.what()
+					).then([this]() {
+				return respond(nullptr);
+			});
+		}).catching<Jsmn::TypeError>([this](Jsmn::TypeError const& e) {
+			return Boss::log( bus, Error
+					, "GossipGraphTracker: "
+					  "Unexpected result from lightningd."
+					).then([this]() {
+				return respond(nullptr);
+			});
+		}).catching<Jsmn::ParseError>([this](Jsmn::ParseError const& e) {
+			return Boss::log( bus, Error
+					, "GossipGraphTracker: %s"
+					, e.what()
+					).then([this]() {
+				return respond(nullptr);
+			});
+		});
+	}
+
+	Ev::Io<void> channels_loop(std::shared_ptr<Fetch> f) {
+		return Ev::yield().then([this, f]() {
+			for ( auto i = std::size_t(0)
+			    ; i < parse_batch && f->it != f->items.end()
+			    ; ++i, ++f->it
+			    )
+				add_channel(*f, *f->it);
+			if (f->it == f->items.end())
+				return Ev::lift();
+			return channels_loop(f);
+		});
+	}
+	Ev::Io<void> nodes_loop(std::shared_ptr<Fetch> f) {
+		return Ev::yield().then([this, f]() {
+			for ( auto i = std::size_t(0)
+			    ; i < parse_batch && f->it != f->items.end()
+			    ; ++i, ++f->it
+			    )
+				add_node(*f, *f->it);
+			if (f->it == f->items.end())
+				return Ev::lift();
+			return nodes_loop(f);
+		});
+	}
+
+	static
+	void add_channel(Fetch& f, Jsmn::Object const& c) {
+		auto e = Entry();
+		if (!parse_channel(e, c)) {
+			++f.skipped;
+			return;
+		}
+		f.builder.add_channel( std::move(e.source)
+				     , std::move(e.destination)
+				     , e.channel
+				     );
+	}
+	static
+	void add_node(Fetch& f, Jsmn::Object const& n) {
+		if (!n.is_object() || !n.has("nodeid"))
+			return;
+		auto id = n["nodeid"];
+		if ( !id.is_string()
+		  || !Ln::NodeId::valid_string(std::string(id))
+		   )
+			return;
+		f.builder.add_node(Ln::NodeId(std::string(id)));
+	}
+
+	/* Return false if the entry could not be parsed.  */
+	static
+	bool parse_channel(Entry& e, Jsmn::Object const& c) {
+		try {
+			auto source = std::string(c["source"]);
+			auto destination = std::string(c["destination"]);
+			auto scid = std::string(c["short_channel_id"]);
+			if ( !Ln::NodeId::valid_string(source)
+			  || !Ln::NodeId::valid_string(destination)
+			  || !Ln::Scid::valid_string(scid)
+			  || !Ln::Amount::valid_object(c["amount_msat"])
+			   )
+				return false;
+
+			e.source = Ln::NodeId(source);
+			e.destination = Ln::NodeId(destination);
+			auto& ch = e.channel;
+			ch.scid = Ln::Scid(scid);
+			ch.capacity = Ln::Amount::object(c["amount_msat"]);
+			ch.base_fee = std::uint32_t(double(
+				c["base_fee_millisatoshi"]
+			));
+			ch.proportional_fee = std::uint32_t(double(
+				c["fee_per_millionth"]
+			));
+			ch.delay = std::uint32_t(double(c["delay"]));
+			ch.active = bool(c["active"]);
+			return true;
+		} catch (Jsmn::TypeError const&) {
+			return false;
+		}
+	}
+
+	std::shared_ptr<Ln::GossipGraph const> publish() {
+		if (!snapshot)
+			snapshot = std::make_shared<Ln::GossipGraph const>(
+				*graph
+			);
+		return snapshot;
+	}
+
+	/* On failure, an empty graph is handed out, and the
+	 * next request will try again.  */
+	Ev::Io<void>
+	respond(std::shared_ptr<Ln::GossipGraph const> ng) {
+		if (!ng)
+			ng = std::make_shared<Ln::GossipGraph const>();
+		auto rs = std::move(requesters);
+		requesters.clear();
+		fetching = false;
+		auto f = [this, ng](void* requester) {
+			return bus.raise(Msg::ResponseGossipGraph{
+				requester, ng
+			});
+		};
+		return Ev::foreach(f, std::move(rs));
+	}
+
+	Ev::Io<void> refresh() {
+		auto r = std::make_shared<Refresh>();
+		r->sources.assign(peers.begin(), peers.end());
+		auto num_nodes = graph->num_nodes();
+		for ( auto i = std::size_t(0)
+		    ; i < refresh_batch && i < num_nodes
+		    ; ++i
+		    ) {
+			if (next_refresh >= num_nodes)
+				next_refresh = 0;
+			auto const& n = graph->node(next_refresh++);
+			if (peers.count(n) == 0)
+				r->sources.push_back(n);
+		}
+		r->it = r->sources.begin();
+		return refresh_loop(r).then([this, r]() {
+			return apply(*r);
+		}).catching<std::exception>([this](std::exception const& e) {
+			return Boss::log( bus, Error
+					, "GossipGraphTracker: "
+					  "Refresh failed: %s"
+					, e.what()
+					);
+		}).then([this]() {
+			refreshing = false;
+			return Ev::lift();
+		});
+	}
+	Ev::Io<void> refresh_loop(std::shared_ptr<Refresh> r) {
+		if (r->it == r->sources.end())
+			return Ev::lift();
+		auto const& source = *r->it;
+		++r->it;
+		return rpc->command( "listchannels"
+				   , Json::Out()
+					.start_object()
+						.field("source", std::string(source))
+					.end_object()
+				   ).then([r, source](Jsmn::Object res) {
+			auto& entries = r->fetched[source];
+			try {
+				for (auto c : res["channels"]) {
+					auto e = Entry();
+					if (!parse_channel(e, c))
+						continue;
+					if (e.source != source)
+						continue;
+					entries.emplace_back(std::move(e));
+				}
+			} catch (Jsmn::TypeError const&) {
+				/* Leave this source alone.  */
+				r->fetched.erase(source);
+			}
+			return Ev::lift();
+		}).catching<RpcError>([](RpcError const&) {
+			return Ev::lift();
+		}).then([this, r]() {
+			return refresh_loop(r);
+		});
+	}
+
+	/* Diff the fetched channels against the graph, then
+	 * patch or rebuild it.  */
+	Ev::Io<void> apply(Refresh const& r) {
+		auto patches = std::map< Ln::GossipGraph::Index
+				       , Ln::GossipGraph::Channel
+				       >();
+		/* Sources whose set of channels changed.  */
+		auto restructured = std::map< Ln::NodeId
+					    , std::vector<Entry> const*
+					    >();
+		for (auto const& f : r.fetched) {
+			auto const& source = f.first;
+			auto const& entries = f.second;
+			auto s = graph->lookup(source);
+			if (s == Ln::GossipGraph::none) {
+				if (!entries.empty())
+					restructured[source] = &entries;
+				continue;
+			}
+			auto outgoing = graph->outgoing(s);
+			/* A source has at most one direction of each
+			 * channel.  */
+			auto by_scid = std::map< Ln::Scid
+					       , Ln::GossipGraph::Channel const*
+					       >();
+			for (auto const& c : outgoing)
+				by_scid[c.scid] = &c;
+			auto matched = std::size_t(0);
+			auto structural = false;
+			for (auto const& e : entries) {
+				auto it = by_scid.find(e.channel.scid);
+				if ( it == by_scid.end()
+				  || graph->node(it->second->destination) != e.destination
+				   ) {
+					structural = true;
+					break;
+				}
+				auto const& c = *it->second;
+				++matched;
+				if (!Ln::GossipGraph::same_attributes(c, e.channel))
+					patches[graph->index_of(c)] = e.channel;
+			}
+			if (structural || matched != outgoing.size())
+				restructured[source] = &entries;
+		}
+
+		auto generation = graph->generation();
+		if (!restructured.empty()) {
+			/* Only endpoints of surviving channels are
+			 * kept, so nodes known only from `listnodes`
+			 * or whose channels all closed are dropped
+			 * here, and the graph does not grow without
+			 * bound.  */
+			auto builder = Ln::GossipGraph::Builder();
+			for ( auto c = Ln::GossipGraph::Index(0)
+			    ; c < graph->num_channels()
+			    ; ++c
+			    ) {
+				auto const& ch = graph->channel(c);
+				auto const& source = graph->node(ch.source);
+				if (restructured.count(source) != 0)
+					continue;
+				auto p = patches.find(c);
+				builder.add_channel( source
+						   , graph->node(ch.destination)
+						   , p != patches.end() ? p->second : ch
+						   );
+			}
+			for (auto const& rs : restructured)
+				for (auto const& e : *rs.second)
+					builder.add_channel( e.source
+							   , e.destination
+							   , e.channel
+							   );
+			*graph = std::move(builder).build();
+			graph->set_generation(generation + 1);
+		} else if (!patches.empty()) {
+			for (auto const& p : patches)
+				graph->update(p.first, p.second);
+			graph->set_generation(generation + 1);
+		} else
+			return Ev::lift();
+		snapshot = nullptr;
+
+		return Boss::log( bus, Debug
+				, "GossipGraphTracker: "
+				  "Refreshed %zu nodes: "
+				  "%zu channels updated, "
+				  "%zu nodes with new or closed channels; "
+				  "generation %llu."
+				, r.fetched.size()
+				, patches.size()
+				, restructured.size()
+				, (unsigned long long) graph->generation()
+				);
+	}
+
+public:
+	Impl() =delete;
+	Impl(Impl&&) =delete;
+
+	explicit
+	Impl(S::Bus& bus_) : bus(bus_), rpc(nullptr) { start(); }
+};
+
+GossipGraphTracker::GossipGraphTracker(GossipGraphTracker&&) =default;
+GossipGraphTracker::~GossipGraphTracker() =default;
+
+GossipGraphTracker::GossipGraphTracker(S::Bus& bus)
+	: pimpl(Util::make_unique<Impl>(bus)) { }
+
+}}
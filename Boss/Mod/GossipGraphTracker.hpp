@@ -0,0 +1,46 @@
+#ifndef BOSS_MOD_GOSSIPGRAPHTRACKER_HPP
+#define BOSS_MOD_GOSSIPGRAPHTRACKER_HPP
+
+#include<memory>
+
+namespace S { class Bus; }
+
+namespace Boss { namespace Mod {
+
+/** class Boss::Mod::GossipGraphTracker
+ *
+ * @brief keeps an in-memory snapshot of the public
+ * channel graph and hands it out in response to
+ * `Boss::Msg::RequestGossipGraph`.
+ *
+ * @desc the snapshot is built from a single bulk
+ * `listchannels` and `listnodes`, whose entries are
+ * added as they are streamed in, and is shared by
+ * all modules that need to walk the network, so
+ * that they do not need to query `lightningd` once
+ * per node.
+ *
+ * Afterwards, at each block, the channels of our
+ * peers and of a rotating slice of the network are
+ * re-queried and the differences patched into the
+ * snapshot, bumping its generation counter, so the
+ * snapshot stays current without a full refetch.
+ */
+class GossipGraphTracker {
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	GossipGraphTracker() =delete;
+
+	GossipGraphTracker(GossipGraphTracker&&);
+	~GossipGraphTracker();
+
+	explicit
+	GossipGraphTracker(S::Bus&);
+};
+
+}}
+
+#endif /* !defined(BOSS_MOD_GOSSIPGRAPHTRACKER_HPP) */
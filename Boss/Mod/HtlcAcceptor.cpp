@@ -63,9 +63,7 @@ private:
 
 	void start() {
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& req) {
-			if (req.command != "htlc_accepted")
-				return Ev::lift();
+			     >("htlc_accepted", [this](Msg::CommandRequest const& req) {
 			return parse_payload(req.id, req.params
 			).then([this
 			      ](std::shared_ptr<Ln::HtlcAccepted::Request
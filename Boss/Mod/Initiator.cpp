@@ -7,6 +7,7 @@
 #include"Boss/Msg/EndOfOptions.hpp"
 #include"Boss/Msg/Init.hpp"
 #include"Boss/Msg/ManifestOption.hpp"
+#include"Boss/Msg/Manifestation.hpp"
 #include"Boss/Msg/Option.hpp"
 #include"Boss/Msg/ProvideStatus.hpp"
 #include"Boss/Msg/SolicitStatus.hpp"
@@ -29,6 +30,7 @@
 #include"Util/make_unique.hpp"
 #include<algorithm>
 #include<assert.h>
+#include<ctype.h>
 #include<set>
 #include<sstream>
 #include<stdlib.h>
@@ -58,6 +60,7 @@ private:
 			     )> open_rpc_socket;
 
 	Sqlite3::Db db;
+	Sqlite3::Db::Config db_config;
 
 	Ln::NodeId self_id;
 
@@ -147,6 +150,66 @@ public:
 	      {
 		assert(open_rpc_socket);
 
+		/* WAL with synchronous=NORMAL cannot corrupt the
+		 * database on power loss, at worst it loses the
+		 * last few commits, and it needs far fewer
+		 * fsyncs.  */
+		db_config.wal = true;
+		db_config.synchronous = "NORMAL";
+
+		bus.subscribe< Msg::Manifestation
+			     >([this](Msg::Manifestation const&) {
+			return bus.raise(Msg::ManifestOption{
+				"clboss-db-wal", Msg::OptionType_Bool,
+				Json::Out::direct(db_config.wal),
+				"Whether to use a write-ahead log for the "
+				"CLBOSS database."
+			}) + bus.raise(Msg::ManifestOption{
+				"clboss-db-synchronous", Msg::OptionType_String,
+				Json::Out::direct(db_config.synchronous),
+				"Database fsync level: OFF, NORMAL, FULL, or "
+				"EXTRA."
+			}) + bus.raise(Msg::ManifestOption{
+				"clboss-db-cache-size", Msg::OptionType_Int,
+				Json::Out::direct(db_config.cache_size),
+				"Database page cache size, in pages if "
+				"positive, in KiB if negative, or 0 for "
+				"the SQLITE3 default."
+			}) + bus.raise(Msg::ManifestOption{
+				"clboss-db-mmap-size", Msg::OptionType_Int,
+				Json::Out::direct(db_config.mmap_size),
+				"Number of bytes of the database to "
+				"memory-map, or 0 to not memory-map."
+			});
+		});
+		bus.subscribe< Msg::Option
+			     >([this](Msg::Option const& o) {
+			if (o.name == "clboss-db-wal")
+				db_config.wal = bool(o.value);
+			else if (o.name == "clboss-db-synchronous") {
+				auto s = std::string(o.value);
+				std::transform( s.begin(), s.end(), s.begin()
+					      , [](char c) {
+					return (char) toupper(c);
+				});
+				if ( s != "OFF" && s != "NORMAL"
+				  && s != "FULL" && s != "EXTRA"
+				   )
+					return Boss::log( bus, Error
+							, "Initiator: "
+							  "Invalid "
+							  "clboss-db-synchronous: "
+							  "%s"
+							, s.c_str()
+							);
+				db_config.synchronous = std::move(s);
+			} else if (o.name == "clboss-db-cache-size")
+				db_config.cache_size = std::int64_t(double(o.value));
+			else if (o.name == "clboss-db-mmap-size")
+				db_config.mmap_size = std::int64_t(double(o.value));
+			return Ev::lift();
+		});
+
 		bus.subscribe< Msg::SolicitStatus
 			     >([this](Msg::SolicitStatus const&) {
 			auto info = Json::Out()
@@ -160,10 +223,7 @@ public:
 				"info", std::move(info)
 			});
 		});
-		bus.subscribe<Boss::Msg::CommandRequest>([this](Boss::Msg::CommandRequest const& c) {
-			if (c.command != "init")
-				return Ev::lift();
-
+		bus.subscribe<Boss::Msg::CommandRequest>("init", [this](Boss::Msg::CommandRequest const& c) {
 			init_id = c.id;
 			auto const& params = c.params;
 
@@ -257,14 +317,17 @@ public:
 						, "RPC socket opened."
 						);
 			}).then([this]() {
-				db = Sqlite3::Db("data.clboss");
+				db = Sqlite3::Db("data.clboss", db_config);
 				return db.transact();
 			}).then([this](Sqlite3::Tx tx) {
 				tx.query_execute("PRAGMA application_id = 0x424F5353;");
 				tx.query_execute("PRAGMA user_version = 0x2020434C;");
 				tx.commit();
 				return Boss::log( bus, Debug
-						, "Database file opened."
+						, "Database file opened "
+						  "(wal: %s, synchronous: %s)."
+						, db_config.wal ? "yes" : "no"
+						, db_config.synchronous.c_str()
 						);
 			}).then([this]() {
 				return bus.raise(Msg::DbResource{db});
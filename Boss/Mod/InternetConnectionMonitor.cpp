@@ -3,6 +3,7 @@
 #include"Boss/Mod/Waiter.hpp"
 #include"Boss/Msg/Init.hpp"
 #include"Boss/Msg/InternetOnline.hpp"
+#include"Boss/Msg/ListpeersAnalyzedChanged.hpp"
 #include"Boss/Msg/ListpeersAnalyzedResult.hpp"
 #include"Boss/Msg/NeedsConnect.hpp"
 #include"Boss/Msg/ProvideStatus.hpp"
@@ -118,6 +119,25 @@ private:
 			/* Copy connected nodes.  */
 			return periodic_check(l);
 		});
+		/* Losing a peer may mean we lost the Internet, so
+		 * check at once instead of at the next periodic
+		 * check.  */
+		bus.subscribe< Msg::ListpeersAnalyzedChanged
+			     >([this](Msg::ListpeersAnalyzedChanged const& m) {
+			if (!connector || checking_connectivity)
+				return Ev::lift();
+			auto const& l = m.analyzed;
+			auto lost = false;
+			for (auto const& n : m.changed)
+				if ( l.disconnected_channeled.count(n) != 0
+				  || l.disconnected_unchanneled.count(n) != 0
+				   )
+					lost = true;
+			if (!lost)
+				return Ev::lift();
+			checking_connectivity = true;
+			return periodic_check(l);
+		});
 		/* If the NeedsConnectSolicitor failed, it might be due to
 		 * Internet connection problems.  */
 		bus.subscribe< Msg::TaskCompletion
@@ -9,25 +9,47 @@ namespace Boss { namespace Mod {
 
 JsonOutputter::JsonOutputter( std::ostream& cout_
 			    , S::Bus& bus
-			    ) : cout(cout_) {
+			    ) : cout(cout_), running(false) {
 	bus.subscribe<Boss::Msg::JsonCout>([this](Boss::Msg::JsonCout const& j) {
-		auto& obj = j.obj;
-		auto start = outs.empty();
+		auto& q = j.notification ? notifications : responses;
+		q.push_back(j.obj.output());
 
-		outs.push(obj.output());
-
-		if (!start)
+		if (running)
 			return Ev::lift();
+		running = true;
 		return Boss::concurrent(loop());
 	});
 }
 
 Ev::Io<void> JsonOutputter::loop() {
+	/* Let everything raised in the same turn queue up
+	 * first.  */
 	return Ev::yield().then([this]() {
-		if (outs.empty())
+		if (responses.empty() && notifications.empty()) {
+			running = false;
 			return Ev::lift();
-		cout << outs.front() << std::endl;
-		outs.pop();
+		}
+
+		auto buf = std::string();
+		auto size = std::size_t(0);
+		for (auto const& s : responses)
+			size += s.size() + 1;
+		for (auto const& s : notifications)
+			size += s.size() + 1;
+		buf.reserve(size);
+		for (auto const& s : responses) {
+			buf += s;
+			buf += '\n';
+		}
+		for (auto const& s : notifications) {
+			buf += s;
+			buf += '\n';
+		}
+		responses.clear();
+		notifications.clear();
+
+		cout.write(buf.data(), buf.size());
+		cout.flush();
 		return loop();
 	});
 }
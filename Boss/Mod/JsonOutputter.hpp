@@ -3,7 +3,7 @@
 
 #include<ostream>
 #include<string>
-#include<queue>
+#include<vector>
 
 namespace Ev { template<typename a> class Io; }
 namespace S { class Bus; }
@@ -14,11 +14,17 @@ namespace Boss { namespace Mod {
  *
  * @brief module that outputs Boss::Msg::JsonCout
  * objects.
+ *
+ * @desc Everything queued by the time the output loop
+ * runs goes out in a single write and flush, with
+ * responses ahead of notifications.
  */
 class JsonOutputter {
 private:
 	std::ostream& cout;
-	std::queue<std::string> outs;
+	std::vector<std::string> responses;
+	std::vector<std::string> notifications;
+	bool running;
 
 	Ev::Io<void> loop();
 public:
@@ -1,5 +1,7 @@
 #include"Boss/Mod/ListpeersAnalyzer.hpp"
+#include"Boss/Msg/ListpeersAnalyzedChanged.hpp"
 #include"Boss/Msg/ListpeersAnalyzedResult.hpp"
+#include"Boss/Msg/ListpeersChanged.hpp"
 #include"Boss/Msg/ListpeersResult.hpp"
 #include"Ev/Io.hpp"
 #include"Jsmn/Object.hpp"
@@ -7,55 +9,70 @@
 #include"Ln/NodeId.hpp"
 #include"S/Bus.hpp"
 
-namespace Boss { namespace Mod {
+namespace {
 
-ListpeersAnalyzer::ListpeersAnalyzer(S::Bus& bus) {
-	bus.subscribe< Msg::ListpeersResult
-		     >([&bus](Msg::ListpeersResult const& l) {
-		auto ar = Msg::ListpeersAnalyzedResult();
-		ar.initial = l.initial;
-
-		for (auto peer : l.cpeers) {
-
-			auto id = peer.first;
-			auto connected = peer.second.connected;
-
-			auto has_chan = bool(false);
-			auto chans = peer.second.channels;
-			for (auto chan : chans) {
-				if (!chan.is_object() || !chan.has("state"))
-					continue;
-
-				auto state_j = chan["state"];
-				if (!state_j.is_string())
-					continue;
-				auto state = std::string(state_j);
-				auto prefix = std::string( state.begin()
-							 , state.begin() + 8
-							 );
-
-				if ( prefix == "OPENINGD"
-				  || prefix == "CHANNELD"
-				   ) {
-					has_chan = true;
-					break;
-				}
-			}
+Boss::Msg::ListpeersAnalyzedResult
+analyze(Boss::Mod::ConstructedListpeers const& cpeers, bool initial) {
+	auto ar = Boss::Msg::ListpeersAnalyzedResult();
+	ar.initial = initial;
+
+	for (auto peer : cpeers) {
 
-			if (connected) {
-				if (has_chan)
-					ar.connected_channeled.emplace(id);
-				else
-					ar.connected_unchanneled.emplace(id);
-			} else {
-				if (has_chan)
-					ar.disconnected_channeled.emplace(id);
-				else
-					ar.disconnected_unchanneled.emplace(id);
+		auto id = peer.first;
+		auto connected = peer.second.connected;
+
+		auto has_chan = bool(false);
+		auto chans = peer.second.channels;
+		for (auto chan : chans) {
+			if (!chan.is_object() || !chan.has("state"))
+				continue;
+
+			auto state_j = chan["state"];
+			if (!state_j.is_string())
+				continue;
+			auto state = std::string(state_j);
+			auto prefix = std::string( state.begin()
+						 , state.begin() + 8
+						 );
+
+			if ( prefix == "OPENINGD"
+			  || prefix == "CHANNELD"
+			   ) {
+				has_chan = true;
+				break;
 			}
 		}
 
-		return bus.raise(std::move(ar));
+		if (connected) {
+			if (has_chan)
+				ar.connected_channeled.emplace(id);
+			else
+				ar.connected_unchanneled.emplace(id);
+		} else {
+			if (has_chan)
+				ar.disconnected_channeled.emplace(id);
+			else
+				ar.disconnected_unchanneled.emplace(id);
+		}
+	}
+
+	return ar;
+}
+
+}
+
+namespace Boss { namespace Mod {
+
+ListpeersAnalyzer::ListpeersAnalyzer(S::Bus& bus) {
+	bus.subscribe< Msg::ListpeersResult
+		     >([&bus](Msg::ListpeersResult const& l) {
+		return bus.raise(analyze(l.cpeers, l.initial));
+	});
+	bus.subscribe< Msg::ListpeersChanged
+		     >([&bus](Msg::ListpeersChanged const& l) {
+		return bus.raise(Msg::ListpeersAnalyzedChanged{
+			l.changed, analyze(l.cpeers, false)
+		});
 	});
 }
 
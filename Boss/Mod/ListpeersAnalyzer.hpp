@@ -8,7 +8,9 @@ namespace Boss { namespace Mod {
 /** class Boss::Mod::ListpeersAnalyzer
  *
  * @brief converts `Boss::Msg::ListpeersResult` to
- * `Boss::Msg::ListpeersAnalyzedResult`.
+ * `Boss::Msg::ListpeersAnalyzedResult`, and
+ * `Boss::Msg::ListpeersChanged` to
+ * `Boss::Msg::ListpeersAnalyzedChanged`.
  */
 class ListpeersAnalyzer {
 public:
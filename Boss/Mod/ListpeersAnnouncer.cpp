@@ -1,18 +1,100 @@
 #include"Boss/Mod/ListpeersAnnouncer.hpp"
 #include"Boss/Mod/ConstructedListpeers.hpp"
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Mod/Waiter.hpp"
 #include"Boss/ModG/RpcProxy.hpp"
 #include"Boss/Msg/Init.hpp"
+#include"Boss/Msg/ListpeersChanged.hpp"
 #include"Boss/Msg/ListpeersResult.hpp"
+#include"Boss/Msg/ManifestNotification.hpp"
+#include"Boss/Msg/Manifestation.hpp"
+#include"Boss/Msg/Notification.hpp"
 #include"Boss/Msg/Timer10Minutes.hpp"
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
 #include"Ev/Io.hpp"
+#include"Ev/foreach.hpp"
+#include"Ev/now.hpp"
+#include"Ev/yield.hpp"
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"S/Bus.hpp"
 #include"Util/make_unique.hpp"
 #include<assert.h>
 #include<sstream>
+#include<vector>
+
+namespace {
+
+/* Notifications that tell us the connection or channels
+ * of a peer might have changed.  */
+char const* const tracked_notifications[] = {
+	"connect",
+	"disconnect",
+	"channel_opened",
+	"channel_state_changed",
+	"coin_movement",
+};
+
+/* Returns false if the result is not usable.  */
+bool construct( Boss::Mod::ConstructedListpeers& cpeers
+	      , Jsmn::Object const& result
+	      ) {
+	if (!result.is_object() || !result.has("channels"))
+		return false;
+	auto channels = result["channels"];
+	if (!channels.is_array())
+		return false;
+
+	for (auto c : channels) {
+		auto id = Ln::NodeId(std::string(c["peer_id"]));
+		auto connected = c["peer_connected"];
+		cpeers[id].connected = connected.is_boolean() && bool(connected);
+		cpeers[id].channels.push_back(c);
+	}
+	return true;
+}
+
+bool same_peer( Boss::Mod::ConstructedListpeer const& a
+	      , Boss::Mod::ConstructedListpeer const& b
+	      ) {
+	if (a.connected != b.connected)
+		return false;
+	if (a.channels.size() != b.channels.size())
+		return false;
+	for (auto i = std::size_t(0); i < a.channels.size(); ++i)
+		if (!(a.channels[i] == b.channels[i]))
+			return false;
+	return true;
+}
+
+/* Peers that are different, or only in one of them.  */
+std::set<Ln::NodeId>
+differences( Boss::Mod::ConstructedListpeers const& a
+	   , Boss::Mod::ConstructedListpeers const& b
+	   ) {
+	auto rv = std::set<Ln::NodeId>();
+	for (auto const& p : a) {
+		auto it = b.find(p.first);
+		if (it == b.end() || !same_peer(it->second, p.second))
+			rv.insert(p.first);
+	}
+	for (auto const& p : b)
+		if (a.find(p.first) == a.end())
+			rv.insert(p.first);
+	return rv;
+}
+
+/* Older `lightningd` puts the fields directly in the
+ * params, newer ones in an object named after the
+ * notification.  */
+Jsmn::Object payload_of(Boss::Msg::Notification const& n) {
+	if (n.params.is_object() && n.params.has(n.notification))
+		return n.params[n.notification];
+	return n.params;
+}
+
+}
 
 namespace Boss { namespace Mod {
 
@@ -24,55 +106,257 @@ namespace Boss { namespace Mod {
  */
 
 void ListpeersAnnouncer::start() {
-	auto invalid_listpeerchannels = [this](Jsmn::Object result) {
-		auto os = std::ostringstream();
-		os << result;
-		return Boss::log( bus, Error
-				, "ListpeersAnnouncer: invalid result from "
-				  "`listpeerchannels`."
-				);
-	};
-	auto do_listpeerchannels = [ this
-			    , invalid_listpeerchannels
-			    ](bool initial) {
-		return rpc->command("listpeerchannels"
-				   , Json::Out::empty_object()
-				   ).then([ this
-					  , initial
-					  , invalid_listpeerchannels
-					  ](Jsmn::Object result) {
-			if (!result.is_object() || !result.has("channels"))
-				return invalid_listpeerchannels(std::move(result));
-			auto channels = result["channels"];
-			if (!channels.is_array())
-				return invalid_listpeerchannels(std::move(result));
-
-			Boss::Mod::ConstructedListpeers cpeers;
-			for (auto c : channels) {
-				auto id = Ln::NodeId(std::string(c["peer_id"]));
-				auto connected = c["peer_connected"];
-				cpeers[id].connected = connected.is_boolean() && bool(connected);
-				cpeers[id].channels.push_back(c);
-			}
-
-			return bus.raise(Msg::ListpeersResult{
-				std::move(cpeers), initial
-			});
-		});
-	};
+	bus.subscribe<Msg::Manifestation
+		     >([this](Msg::Manifestation const&) {
+		auto act = Ev::lift();
+		for (auto n : tracked_notifications)
+			act += bus.raise(Msg::ManifestNotification{n});
+		return act;
+	});
 	bus.subscribe<Msg::Init
-		     >([do_listpeerchannels](Msg::Init const& init) {
-		return Boss::concurrent(do_listpeerchannels(true));
+		     >([this](Msg::Init const& init) {
+		return Boss::concurrent(reconcile(true));
 	});
 	bus.subscribe<Msg::Timer10Minutes
-		     >([do_listpeerchannels](Msg::Timer10Minutes const& _) {
-		return Boss::concurrent(do_listpeerchannels(false));
+		     >([this](Msg::Timer10Minutes const& _) {
+		return Boss::concurrent(reconcile(false));
 	});
+	bus.subscribe<Msg::Notification
+		     >([this](Msg::Notification const& n) {
+		return on_notification(n);
+	});
+}
+
+Ev::Io<void>
+ListpeersAnnouncer::invalid_listpeerchannels(Jsmn::Object result) {
+	return Boss::log( bus, Error
+			, "ListpeersAnnouncer: invalid result from "
+			  "`listpeerchannels`."
+			);
+}
+
+Ev::Io<void> ListpeersAnnouncer::reconcile(bool initial) {
+	return rpc->command("listpeerchannels"
+			   , Json::Out::empty_object()
+			   ).then([ this
+				  , initial
+				  ](Jsmn::Object result) {
+		auto fresh = ConstructedListpeers();
+		if (!construct(fresh, result))
+			return invalid_listpeerchannels(std::move(result));
+
+		/* Anything we missed from notifications, or
+		 * every peer on the first listing.  */
+		auto changed = differences(cpeers, fresh);
+		cpeers = fresh;
+		have_cpeers = true;
+		channel_peers.clear();
+		for (auto const& p : cpeers)
+			index_channels(p.first);
+		/* Balances are now current.  */
+		moved.clear();
+
+		auto act = bus.raise(Msg::ListpeersResult{
+			std::move(fresh), initial
+		});
+		if (changed.empty())
+			return act;
+		return std::move(act).then([this, changed]() {
+			return bus.raise(Msg::ListpeersChanged{
+				changed, cpeers
+			});
+		});
+	});
+}
+
+Ev::Io<void>
+ListpeersAnnouncer::on_notification(Msg::Notification const& n) {
+	auto tracked = false;
+	for (auto t : tracked_notifications)
+		if (n.notification == t)
+			tracked = true;
+	if (!tracked)
+		return Ev::lift();
+
+	auto payload = payload_of(n);
+	if (!payload.is_object())
+		return Ev::lift();
+
+	auto node = Ln::NodeId();
+	if (n.notification == "coin_movement") {
+		/* Channel movements name the channel, not
+		 * the peer.  */
+		if (!payload.has("account_id"))
+			return Ev::lift();
+		auto account = payload["account_id"];
+		if (!account.is_string())
+			return Ev::lift();
+		auto it = channel_peers.find(std::string(account));
+		if (it == channel_peers.end())
+			return Ev::lift();
+		node = it->second;
+
+		/* An HTLC only shifts the balance, and there is
+		 * one for each payment part we send or forward,
+		 * so get those peers only now and then.
+		 * Onchain movements, which open or close the
+		 * channel, are handled at once.  */
+		auto type = payload.has("type") ? payload["type"]
+						: Jsmn::Object()
+						;
+		if (type.is_string() && std::string(type) == "channel_mvt") {
+			moved.insert(node);
+			if (moved_flush_pending)
+				return Ev::lift();
+			auto wait = last_moved_refresh
+				  + moved_refresh_interval
+				  - Ev::now()
+				  ;
+			if (wait <= 0)
+				return flush_moved();
+			/* Both sides of a forward move in the same
+			 * turn, so whatever comes in the meantime
+			 * is gotten once the interval is up.  */
+			moved_flush_pending = true;
+			return Boss::concurrent(waiter.wait(wait).then([this]() {
+				moved_flush_pending = false;
+				return flush_moved();
+			}));
+		}
+	} else {
+		auto field = (n.notification == "channel_state_changed") ?
+			"peer_id" : "id";
+		if (!payload.has(field))
+			return Ev::lift();
+		auto id = payload[field];
+		if (!id.is_string())
+			return Ev::lift();
+		auto id_s = std::string(id);
+		if (!Ln::NodeId::valid_string(id_s))
+			return Ev::lift();
+		node = Ln::NodeId(id_s);
+	}
+	dirty.insert(node);
+	return start_refresh();
+}
+
+Ev::Io<void> ListpeersAnnouncer::flush_moved() {
+	last_moved_refresh = Ev::now();
+	dirty.insert(moved.begin(), moved.end());
+	moved.clear();
+	return start_refresh();
+}
+
+Ev::Io<void> ListpeersAnnouncer::start_refresh() {
+	if (dirty.empty())
+		return Ev::lift();
+	/* Before the first `listpeerchannels`, that will
+	 * get everything anyway.  */
+	if (!have_cpeers || refreshing)
+		return Ev::lift();
+	refreshing = true;
+	return Boss::concurrent(refresh_loop());
+}
+
+Ev::Io<void> ListpeersAnnouncer::refresh_loop() {
+	/* Let notifications that arrive together pile up.  */
+	return Ev::yield().then([this]() {
+		if (dirty.empty()) {
+			refreshing = false;
+			return Ev::lift();
+		}
+		auto nodes = std::vector<Ln::NodeId>( dirty.begin()
+						    , dirty.end()
+						    );
+		dirty.clear();
+
+		auto changed = std::make_shared<std::set<Ln::NodeId>>();
+		auto f = [this, changed](Ln::NodeId node) {
+			return refresh_peer(std::move(node), changed);
+		};
+		return Ev::foreach(f, std::move(nodes)
+				  ).then([this, changed]() {
+			if (changed->empty())
+				return Ev::lift();
+			return bus.raise(Msg::ListpeersChanged{
+				std::move(*changed), cpeers
+			});
+		}).then([this]() {
+			return refresh_loop();
+		});
+	});
+}
+
+Ev::Io<void>
+ListpeersAnnouncer::refresh_peer( Ln::NodeId node
+				, std::shared_ptr<std::set<Ln::NodeId>> changed
+				) {
+	auto parms = Json::Out()
+		.start_object()
+			.field("id", std::string(node))
+		.end_object()
+		;
+	return rpc->command("listpeerchannels", std::move(parms)
+			   ).then([this, node, changed](Jsmn::Object result) {
+		auto fresh = ConstructedListpeers();
+		if (!construct(fresh, result))
+			return invalid_listpeerchannels(std::move(result));
+
+		auto fit = fresh.find(node);
+		auto it = cpeers.find(node);
+		if (fit == fresh.end()) {
+			if (it == cpeers.end())
+				return Ev::lift();
+			unindex_channels(node);
+			cpeers.erase(it);
+		} else {
+			if (it != cpeers.end() && same_peer(it->second, fit->second))
+				return Ev::lift();
+			unindex_channels(node);
+			cpeers[node] = std::move(fit->second);
+			index_channels(node);
+		}
+		changed->insert(node);
+		return Ev::lift();
+	}).catching<RpcError>([this, node](RpcError const& e) {
+		return Boss::log( bus, Debug
+				, "ListpeersAnnouncer: listpeerchannels "
+				  "%s failed: %s"
+				, std::string(node).c_str()
+				, e.what()
+				);
+	});
+}
+
+void ListpeersAnnouncer::index_channels(Ln::NodeId const& node) {
+	auto it = cpeers.find(node);
+	if (it == cpeers.end())
+		return;
+	for (auto const& c : it->second.channels)
+		if (c.has("channel_id") && c["channel_id"].is_string())
+			channel_peers[std::string(c["channel_id"])] = node;
+}
+void ListpeersAnnouncer::unindex_channels(Ln::NodeId const& node) {
+	auto it = cpeers.find(node);
+	if (it == cpeers.end())
+		return;
+	for (auto const& c : it->second.channels)
+		if (c.has("channel_id") && c["channel_id"].is_string())
+			channel_peers.erase(std::string(c["channel_id"]));
 }
 
-ListpeersAnnouncer::ListpeersAnnouncer(S::Bus& bus_)
+ListpeersAnnouncer::ListpeersAnnouncer( S::Bus& bus_
+				      , Boss::Mod::Waiter& waiter_
+				      , double moved_refresh_interval_
+				      )
 	: bus(bus_)
+	, waiter(waiter_)
 	, rpc(Util::make_unique<ModG::RpcProxy>(bus))
+	, have_cpeers(false)
+	, refreshing(false)
+	, moved_refresh_interval(moved_refresh_interval_)
+	, last_moved_refresh(0)
+	, moved_flush_pending(false)
 	{ start(); }
 
 ListpeersAnnouncer::~ListpeersAnnouncer() =default;
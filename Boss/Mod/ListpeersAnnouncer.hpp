@@ -1,9 +1,18 @@
 #ifndef BOSS_MOD_LISTPEERSANNOUNCER_HPP
 #define BOSS_MOD_LISTPEERSANNOUNCER_HPP
 
+#include"Boss/Mod/ConstructedListpeers.hpp"
+#include"Ln/NodeId.hpp"
+#include<map>
 #include<memory>
+#include<set>
+#include<string>
 
+namespace Boss { namespace Mod { class Waiter; }}
 namespace Boss { namespace ModG { class RpcProxy; }}
+namespace Boss { namespace Msg { struct Notification; }}
+namespace Ev { template<typename a> class Io; }
+namespace Jsmn { class Object; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod {
@@ -13,6 +22,16 @@ namespace Boss { namespace Mod {
  * @brief announces `listpeers` at `init` and
  * every 10 minutes thereafter.
  *
+ * @desc In between, it keeps its own copy up to date
+ * from the `connect`, `disconnect`, `channel_opened`,
+ * `channel_state_changed`, and `coin_movement`
+ * notifications, getting only the affected peers,
+ * and announces `Boss::Msg::ListpeersChanged`.
+ * Coin movements that only shift channel balances,
+ * one per HTLC, are collected and their peers gotten
+ * again at most once every `moved_refresh_interval`
+ * seconds.
+ *
  * IMPORTANT - this msg is no longer directly obtained from
  * `listpeers` but rather is constructed by "convolving" the value
  * from `listpeerchannels`.  Specifically, the top level `peer`
@@ -21,15 +40,48 @@ namespace Boss { namespace Mod {
 class ListpeersAnnouncer {
 private:
 	S::Bus& bus;
+	Boss::Mod::Waiter& waiter;
 	std::unique_ptr<Boss::ModG::RpcProxy> rpc;
 
+	/* The state as of the last full or partial
+	 * `listpeerchannels`.  */
+	ConstructedListpeers cpeers;
+	bool have_cpeers;
+	/* Peer of each channel in `cpeers`, by
+	 * `channel_id`.  */
+	std::map<std::string, Ln::NodeId> channel_peers;
+	/* Peers to get again.  */
+	std::set<Ln::NodeId> dirty;
+	bool refreshing;
+	/* Peers whose balances moved, when we last got
+	 * peers for that reason, and whether we are waiting
+	 * to get them again.  */
+	std::set<Ln::NodeId> moved;
+	double moved_refresh_interval;
+	double last_moved_refresh;
+	bool moved_flush_pending;
+
 	void start();
+	Ev::Io<void> reconcile(bool initial);
+	Ev::Io<void> on_notification(Msg::Notification const& n);
+	Ev::Io<void> flush_moved();
+	Ev::Io<void> start_refresh();
+	Ev::Io<void> refresh_loop();
+	Ev::Io<void> refresh_peer( Ln::NodeId node
+				 , std::shared_ptr<std::set<Ln::NodeId>> changed
+				 );
+	Ev::Io<void> invalid_listpeerchannels(Jsmn::Object result);
+	void index_channels(Ln::NodeId const& node);
+	void unindex_channels(Ln::NodeId const& node);
 
 public:
 	ListpeersAnnouncer() =delete;
 	ListpeersAnnouncer(ListpeersAnnouncer const&) =delete;
 	~ListpeersAnnouncer();
-	ListpeersAnnouncer(S::Bus& bus);
+	ListpeersAnnouncer( S::Bus& bus
+			  , Boss::Mod::Waiter& waiter
+			  , double moved_refresh_interval = 60.0
+			  );
 };
 
 }}
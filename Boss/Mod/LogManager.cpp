@@ -0,0 +1,160 @@
+#include"Boss/Mod/LogManager.hpp"
+#include"Boss/Msg/CommandFail.hpp"
+#include"Boss/Msg/CommandRequest.hpp"
+#include"Boss/Msg/CommandResponse.hpp"
+#include"Boss/Msg/ManifestCommand.hpp"
+#include"Boss/Msg/ManifestOption.hpp"
+#include"Boss/Msg/Manifestation.hpp"
+#include"Boss/Msg/Option.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Jsmn/Object.hpp"
+#include"Json/Out.hpp"
+#include"S/Bus.hpp"
+#include"Util/make_unique.hpp"
+
+namespace Boss { namespace Mod {
+
+class LogManager::Impl {
+private:
+	S::Bus& bus;
+
+	void start() {
+		bus.subscribe<Msg::Manifestation
+			     >([this](Msg::Manifestation const&) {
+			return bus.raise(Msg::ManifestOption{
+				"clboss-log-level",
+				Msg::OptionType_String,
+				Json::Out::direct(std::string("debug")),
+				"Minimum level of log messages to emit: "
+				"debug, info, warn, or error."
+			}).then([this]() {
+				return bus.raise(Msg::ManifestOption{
+					"clboss-log-history",
+					Msg::OptionType_Int,
+					Json::Out::direct(0),
+					"Number of recent log messages to "
+					"keep for clboss-logs."
+				});
+			}).then([this]() {
+				return bus.raise(Msg::ManifestCommand{
+					"clboss-logs", "[level]",
+					"Show recent log messages at or "
+					"above {level} (default debug).",
+					false
+				});
+			});
+		});
+		bus.subscribe<Msg::Option
+			     >([this](Msg::Option const& o) {
+			if (o.name == "clboss-log-level") {
+				auto s = std::string(o.value);
+				auto l = Debug;
+				if (!log_level_from_string(l, s))
+					return Boss::log( bus, Error
+							, "LogManager: Unknown "
+							  "clboss-log-level %s, "
+							  "ignoring."
+							, s.c_str()
+							);
+				/* Log before we possibly filter it
+				 * out.  */
+				return Boss::log( bus, Info
+						, "LogManager: Log level: %s"
+						, log_level_string(l)
+						).then([l]() {
+					set_log_level(l);
+					return Ev::lift();
+				});
+			}
+			if (o.name == "clboss-log-history") {
+				auto n = double(o.value);
+				if (n < 1)
+					return Ev::lift();
+				auto num = std::size_t(n);
+				set_log_history(num);
+				return Boss::log( bus, Info
+						, "LogManager: Keeping last %zu "
+						  "log messages."
+						, num
+						);
+			}
+			return Ev::lift();
+		});
+
+		bus.subscribe<Msg::CommandRequest
+			     >("clboss-logs", [this](Msg::CommandRequest const& req) {
+			auto id = req.id;
+			auto paramfail = [this, id]() {
+				return bus.raise(Msg::CommandFail{
+					id, -32602,
+					"Parameter failure",
+					Json::Out::empty_object()
+				});
+			};
+			auto level_j = Jsmn::Object();
+			auto params = req.params;
+			if (params.is_object()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1) {
+					if (!params.has("level"))
+						return paramfail();
+					level_j = params["level"];
+				}
+			} else if (params.is_array()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1)
+					level_j = params[0];
+			}
+			auto level = Debug;
+			if (!level_j.is_null()) {
+				if (!level_j.is_string())
+					return paramfail();
+				if (!log_level_from_string(level, std::string(level_j)))
+					return paramfail();
+			}
+
+			auto result = Json::Out();
+			auto obj = result.start_object();
+			obj.field( "log_level"
+				 , std::string(log_level_string(get_log_level()))
+				 );
+			auto arr = obj.start_array("logs");
+			for (auto const& r : get_log_history()) {
+				if (r.level < level)
+					continue;
+				arr
+					.start_object()
+						.field("time", r.time)
+						.field( "level"
+						      , std::string(log_level_string(r.level))
+						      )
+						.field("message", r.message)
+					.end_object()
+					;
+			}
+			arr.end_array();
+			obj.end_object();
+			return bus.raise(Msg::CommandResponse{
+				id, std::move(result)
+			});
+		});
+	}
+
+public:
+	Impl() =delete;
+	Impl(Impl&&) =delete;
+
+	explicit
+	Impl(S::Bus& bus_) : bus(bus_) { start(); }
+};
+
+LogManager::LogManager(LogManager&&) =default;
+LogManager::~LogManager() =default;
+
+LogManager::LogManager(S::Bus& bus)
+	: pimpl(Util::make_unique<Impl>(bus)) { }
+
+}}
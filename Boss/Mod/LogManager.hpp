@@ -0,0 +1,33 @@
+#ifndef BOSS_MOD_LOGMANAGER_HPP
+#define BOSS_MOD_LOGMANAGER_HPP
+
+#include<memory>
+
+namespace S { class Bus; }
+
+namespace Boss { namespace Mod {
+
+/** class Boss::Mod::LogManager
+ *
+ * @brief Sets the minimum log level and the size of the
+ * in-memory log history from the `clboss-log-level` and
+ * `clboss-log-history` options, and provides the
+ * `clboss-logs` command to query the history.
+ */
+class LogManager {
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	LogManager() =delete;
+	LogManager(LogManager&&);
+	~LogManager();
+
+	explicit
+	LogManager(S::Bus&);
+};
+
+}}
+
+#endif /* !defined(BOSS_MOD_LOGMANAGER_HPP) */
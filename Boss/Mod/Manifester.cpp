@@ -27,10 +27,7 @@ std::string option_type_name(Boss::Msg::OptionType t) {
 namespace Boss { namespace Mod {
 
 void Manifester::start() {
-	bus.subscribe<Boss::Msg::CommandRequest>([this](Boss::Msg::CommandRequest const& req) {
-		if (req.command != "getmanifest")
-			return Ev::lift();
-
+	bus.subscribe<Boss::Msg::CommandRequest>("getmanifest", [this](Boss::Msg::CommandRequest const& req) {
 		auto id = req.id;
 		return Ev::lift().then([this]() {
 			return bus.raise(Boss::Msg::Manifestation());
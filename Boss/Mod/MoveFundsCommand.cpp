@@ -40,9 +40,7 @@ private:
 			});
 		});
 		bus.subscribe<Msg::CommandRequest
-			     >([this, &bus](Msg::CommandRequest const& r) {
-			if (r.command != "clboss-movefunds")
-				return Ev::lift();
+			     >("clboss-movefunds", [this, &bus](Msg::CommandRequest const& r) {
 			auto parms = std::make_shared<Jsmn::Object>(
 				r.params
 			);
@@ -146,10 +146,7 @@ private:
 
 		/* Command handler.  */
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& req) {
-			if (req.command != "clboss-feerates")
-				return Ev::lift();
-
+			     >("clboss-feerates", [this](Msg::CommandRequest const& req) {
 			auto id = req.id;
 			if (!db) {
 				auto result = Json::Out()
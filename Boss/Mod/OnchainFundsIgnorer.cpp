@@ -68,69 +68,62 @@ private:
 
 		/* Command handling.  */
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& req) {
+			     >("clboss-ignore-onchain", [this](Msg::CommandRequest const& req) {
 			auto id = req.id;
-			auto succeed = [this, id]() {
-				return bus.raise(Msg::CommandResponse{
-					id, Json::Out::empty_object()
+			auto paramfail = [this, id]() {
+				return bus.raise(Msg::CommandFail{
+					id, -32602,
+					"Parameter failure",
+					Json::Out::empty_object()
 				});
 			};
 
-			auto act = Ev::lift();
-			if (req.command == "clboss-ignore-onchain") {
-				auto paramfail = [this, id]() {
-					return bus.raise(Msg::CommandFail{
-						id, -32602,
-						"Parameter failure",
-						Json::Out::empty_object()
-					});
-				};
+			auto hours = double(24.0);
 
-				auto hours = double(24.0);
-
-				auto hours_j = Jsmn::Object();
-				auto params = req.params;
-				if (params.is_object()) {
-					if (params.size() > 1)
-						return paramfail();
-					if (params.size() == 1) {
-						if (!params.has("hours"))
-							return paramfail();
-						hours_j = params["hours"];
-					}
-				} else if (params.is_array()) {
-					if (params.size() > 1)
-						return paramfail();
-					if (params.size() == 1)
-						hours_j = params[0];
-				} else
+			auto hours_j = Jsmn::Object();
+			auto params = req.params;
+			if (params.is_object()) {
+				if (params.size() > 1)
 					return paramfail();
-				if (!hours_j.is_null()) {
-					if (!hours_j.is_number())
+				if (params.size() == 1) {
+					if (!params.has("hours"))
 						return paramfail();
-					hours = (double) hours_j;
+					hours_j = params["hours"];
 				}
-
-				act += set_disableuntil( Ev::now()
-						       + (hours * 3600)
-						       );
-				act += Boss::log( bus, Info
-						, "OnchainFundsIgnorer: "
-						  "Will ignore onchain funds "
-						  "for %f hours starting now."
-						, hours
-						);
-				act += succeed();
-
-			} else if (req.command == "clboss-notice-onchain") {
-				act += set_disableuntil(0);
-				act += Boss::log( bus, Info
-						, "OnchainFundsIgnorer: "
-						  "Will notice onchain funds."
-						);
-				act += succeed();
+			} else if (params.is_array()) {
+				if (params.size() > 1)
+					return paramfail();
+				if (params.size() == 1)
+					hours_j = params[0];
+			} else
+				return paramfail();
+			if (!hours_j.is_null()) {
+				if (!hours_j.is_number())
+					return paramfail();
+				hours = (double) hours_j;
 			}
-			return act;
+
+			return set_disableuntil( Ev::now()
+					       + (hours * 3600)
+					       )
+			     + Boss::log( bus, Info
+					, "OnchainFundsIgnorer: "
+					  "Will ignore onchain funds "
+					  "for %f hours starting now."
+					, hours
+					)
+			     + succeed(id)
+			     ;
+		});
+		bus.subscribe<Msg::CommandRequest
+			     >("clboss-notice-onchain", [this](Msg::CommandRequest const& req) {
+			return set_disableuntil(0)
+			     + Boss::log( bus, Info
+					, "OnchainFundsIgnorer: "
+					  "Will notice onchain funds."
+					)
+			     + succeed(req.id)
+			     ;
 		});
 
 		/* clboss-status */
@@ -225,6 +218,12 @@ private:
 			return Ev::lift(rv);
 		});
 	}
+	Ev::Io<void> succeed(Ln::CommandId id) {
+		return bus.raise(Msg::CommandResponse{
+			id, Json::Out::empty_object()
+		});
+	}
+
 	Ev::Io<void> set_disableuntil(double disableuntil) {
 		return db.transact().then([disableuntil](Sqlite3::Tx tx) {
 			tx.query(R"QRY(
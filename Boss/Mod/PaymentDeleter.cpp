@@ -7,12 +7,13 @@
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
 #include"Ev/Io.hpp"
-#include"Ev/yield.hpp"
+#include"Ev/foreach.hpp"
 #include"Jsmn/Object.hpp"
 #include"Json/Out.hpp"
 #include"S/Bus.hpp"
 #include"Util/make_unique.hpp"
 #include"Util/stringify.hpp"
+#include<utility>
 #include<vector>
 
 namespace Boss { namespace Mod {
@@ -26,8 +27,10 @@ private:
 	bool soliciting;
 	std::vector<std::function<bool(std::string const&)>> filters;
 
-	Jsmn::Object pays;
-	Jsmn::Object::const_iterator it;
+	/* Payment hash and status of payments to delete.  */
+	std::vector<std::pair<std::string, std::string>> to_delete;
+	/* Descriptions of entries we could not understand.  */
+	std::vector<std::string> bad_entries;
 
 	void start() {
 		rpc = nullptr;
@@ -98,93 +101,104 @@ private:
 
 	Ev::Io<void> core_perform() {
 		return Ev::lift().then([this]() {
+			to_delete.clear();
+			bad_entries.clear();
 			return Boss::log( bus, Debug
 					, "PaymentDeleter: Start."
 					);
 		}).then([this]() {
-
-			return rpc->command("listpays", Json::Out::empty_object());
+			/* Stream the payments, as there can be very
+			 * many of them.  */
+			return rpc->command_streaming( "listpays"
+						     , Json::Out::empty_object()
+						     , "pays"
+						     , [this](Jsmn::Object pay) {
+				consider(std::move(pay));
+			});
 		}).then([this](Jsmn::Object res) {
-			try {
-				pays = res["pays"];
-				it = pays.begin();
-			} catch (std::exception const& ex) {
+			if (!res.is_object() || !res.has("pays"))
 				return Boss::log( bus, Error
 						, "PaymentDeleter: Unexpected "
-						  "result from 'listpays': %s: %s"
+						  "result from 'listpays': %s"
 						, Util::stringify(res).c_str()
-						, ex.what()
 						);
-			}
-			return loop();
+			/* Anything not streamed is still here.  */
+			auto pays = res["pays"];
+			if (pays.is_array())
+				for (auto pay : pays)
+					consider(std::move(pay));
+			return Ev::lift();
 		}).then([this]() {
-			return Boss::log( bus, Debug
-					, "PaymentDeleter: End."
-					);
-		});
-	}
-	Ev::Io<void> loop() {
-		return Ev::yield().then([this]() {
-			if (it == pays.end())
-				return Ev::lift();
-
-			auto pay = *it;
-			++it;
-			try {
-				/* All our payments must be labelled.  */
-				if (!pay.has("label"))
-					return loop();
-				/* Is it one of ours?  */
-				auto label = std::string(pay["label"]);
-				if (!filter_label(label))
-					return loop();
-				/* If pending, skip.  */
-				auto status = std::string(pay["status"]);
-				if (status == "pending")
-					return loop();
-
-				auto payment_hash = std::string(
-					pay["payment_hash"]
-				);
+			return Ev::foreach([this](std::string bad) {
+				return Boss::log( bus, Error
+						, "PaymentDeleter: "
+						  "Unexpected 'pays' entry "
+						  "from 'listpays': %s"
+						, bad.c_str()
+						);
+			}, std::move(bad_entries));
+		}).then([this]() {
+			return Ev::foreach([this](std::pair<std::string, std::string> d) {
 				return Boss::log( bus, Debug
 						, "PaymentDeleter: "
 						  "Deleting %s payment with "
 						  "hash %s."
-						, status.c_str()
-						, payment_hash.c_str()
-						)
-				     + delpay(payment_hash, status)
-				     + loop()
-				     ;
-			} catch (std::exception const& ex) {
-				return Boss::log( bus, Error
-						, "PaymentDeleter: "
-						  "Unexpected 'pays' entry "
-						  "from 'listpays': %s: %s"
-						, Util::stringify(pay).c_str()
-						, ex.what()
+						, d.second.c_str()
+						, d.first.c_str()
 						);
-			}
+			}, to_delete);
+		}).then([this]() {
+			return delpays();
+		}).then([this]() {
+			return Boss::log( bus, Debug
+					, "PaymentDeleter: End."
+					);
 		});
 	}
+	/* Called for each entry of `listpays` as it is
+	 * received.  */
+	void consider(Jsmn::Object pay) {
+		try {
+			/* All our payments must be labelled.  */
+			if (!pay.has("label"))
+				return;
+			/* Is it one of ours?  */
+			auto label = std::string(pay["label"]);
+			if (!filter_label(label))
+				return;
+			/* If pending, skip.  */
+			auto status = std::string(pay["status"]);
+			if (status == "pending")
+				return;
+
+			auto payment_hash = std::string(
+				pay["payment_hash"]
+			);
+			to_delete.emplace_back(payment_hash, status);
+		} catch (std::exception const& ex) {
+			bad_entries.push_back( Util::stringify(pay)
+					     + ": " + ex.what()
+					     );
+		}
+	}
 
-	Ev::Io<void>
-	delpay( std::string const& payment_hash
-	      , std::string const& status
-	      ) {
-		auto parms = Json::Out()
-			.start_object()
-				.field("payment_hash", payment_hash)
-				.field("status", status)
-			.end_object()
-			;
-		return rpc->command( "delpay"
-				   , std::move(parms)
-				   ).then([](Jsmn::Object _) {
-			/* Ignore result.  */
-			return Ev::lift();
-		}).catching<RpcError>([](RpcError const& _) {
-			/* Ignore failure.  */
+	/* Send all the deletions as a single batch.  */
+	Ev::Io<void> delpays() {
+		auto commands = std::vector<std::pair<std::string, Json::Out>>();
+		commands.reserve(to_delete.size());
+		for (auto const& d : to_delete) {
+			auto parms = Json::Out()
+				.start_object()
+					.field("payment_hash", d.first)
+					.field("status", d.second)
+				.end_object()
+				;
+			commands.emplace_back("delpay", std::move(parms));
+		}
+		to_delete.clear();
+		return rpc->command_many(std::move(commands)
+					).then([](std::vector<Jsmn::Object> _) {
+			/* Ignore results, including failures.  */
 			return Ev::lift();
 		});
 	}
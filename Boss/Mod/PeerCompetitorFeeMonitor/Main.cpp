@@ -1,13 +1,16 @@
 #include"Boss/Mod/PeerCompetitorFeeMonitor/Main.hpp"
 #include"Boss/Mod/PeerCompetitorFeeMonitor/Surveyor.hpp"
-#include"Boss/Msg/AvailableRpcCommands.hpp"
+#include"Boss/ModG/ReqResp.hpp"
 #include"Boss/Msg/Init.hpp"
 #include"Boss/Msg/ListpeersAnalyzedResult.hpp"
 #include"Boss/Msg/PeerMedianChannelFee.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
 #include"Boss/Msg/TimerRandomHourly.hpp"
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
 #include"Ev/Io.hpp"
+#include"Ev/ThreadPool.hpp"
 #include"Ev/foreach.hpp"
 #include"Ev/map.hpp"
 #include"S/Bus.hpp"
@@ -21,10 +24,12 @@ namespace Boss { namespace Mod { namespace PeerCompetitorFeeMonitor {
 class Main::Impl {
 private:
 	S::Bus& bus;
+	Ev::ThreadPool& threadpool;
 	Boss::Mod::Rpc* rpc;
 
-	bool have_listchannels_destination;
-	bool got_available_commands;
+	Boss::ModG::ReqResp< Msg::RequestGossipGraph
+			   , Msg::ResponseGossipGraph
+			   > graph_rr;
 
 	Ln::NodeId self_id;
 
@@ -36,10 +41,12 @@ private:
 	bool fired_init;
 
 public:
-	Impl(S::Bus& bus_
+	Impl( S::Bus& bus_
+	    , Ev::ThreadPool& threadpool_
 	    ) : bus(bus_)
+	      , threadpool(threadpool_)
 	      , rpc(nullptr)
-	      , got_available_commands(false)
+	      , graph_rr(bus_)
 	      , have_channels(false)
 	      , fired_init(false)
 	      { start(); }
@@ -81,56 +88,35 @@ private:
 				return Ev::lift();
 			return on_periodic();
 		});
-		bus.subscribe<Msg::AvailableRpcCommands
-			     >([this](Msg::AvailableRpcCommands const& m) {
-			got_available_commands = true;
-			auto it = m.commands.find("listchannels");
-			if (it == m.commands.end()) {
-				/* No `listchannels` command...?  */
-				have_listchannels_destination = false;
-				return Ev::lift();
-			}
-			auto& desc = it->second;
-			auto& usage = desc.usage;
-
-			/* Look for [destination] in usage.  */
-			auto static const needle = std::string("[destination]");
-			auto result = std::search( usage.begin(), usage.end()
-						 , needle.begin(), needle.end()
-						 );
-			have_listchannels_destination = (result != usage.end());
-
-			return Boss::log( bus, Debug
-					, "PeerCompetitorFeeMonitor: "
-					  "have_listchannels_destination = %s"
-					, have_listchannels_destination ? "true" : "false"
-					);
-		});
-	}
-
-	Ev::Io<void> wait_available_commands() {
-		return Ev::lift().then([this]() {
-			if (got_available_commands)
-				return Ev::lift();
-			return Ev::yield() + wait_available_commands();
-		});
 	}
 
 	Ev::Io<void> on_periodic() {
-		return wait_available_commands().then([this]() {
-			auto f = [this](Ln::NodeId nid) {
-				auto surveyor = Surveyor::create
-						( bus
-						, *rpc
-						, self_id
-						, std::move(nid)
-						, have_listchannels_destination
-						);
-				return surveyor->run();
+		return graph_rr.execute(Msg::RequestGossipGraph{
+			nullptr
+		}).then([this](Msg::ResponseGossipGraph r) {
+			auto surveyor = std::make_shared<Surveyor>(
+				std::move(r.graph), self_id
+			);
+			/* Each peer is surveyed in its own background
+			 * thread.  */
+			auto f = [this, surveyor](Ln::NodeId nid) {
+				typedef std::unique_ptr<Surveyor::Result>
+					Result;
+				return threadpool.background<Result>([ surveyor
+								     , nid
+								     ]() {
+					return surveyor->survey(nid);
+				});
 			};
 			/* Do not std::move channels --- we need to retain
 			 * it.  */
-			return Ev::map(f, channels);
+			return Boss::log( bus, Debug
+					, "PeerCompetitorFeeMonitor: "
+					  "Surveying %zu peers."
+					, channels.size()
+					).then([this, f]() {
+				return Ev::map(f, channels);
+			});
 		}).then([this](std::vector<std::unique_ptr<Surveyor::Result>> results) {
 			/* Build report.  */
 			auto os = std::ostringstream();
@@ -174,6 +160,8 @@ Main::Main(Main&&) =default;
 Main& Main::operator=(Main&&) =default;
 Main::~Main() =default;
 
-Main::Main(S::Bus& bus) : pimpl(Util::make_unique<Impl>(bus)) { }
+Main::Main( S::Bus& bus
+	  , Ev::ThreadPool& threadpool
+	  ) : pimpl(Util::make_unique<Impl>(bus, threadpool)) { }
 
 }}}
@@ -3,6 +3,7 @@
 
 #include<memory>
 
+namespace Ev { class ThreadPool; }
 namespace S { class Bus; }
 
 namespace Boss { namespace Mod { namespace PeerCompetitorFeeMonitor {
@@ -24,8 +25,7 @@ public:
 	Main& operator=(Main&&);
 	~Main();
 
-	explicit
-	Main(S::Bus& bus);
+	Main(S::Bus& bus, Ev::ThreadPool& threadpool);
 };
 
 }}}
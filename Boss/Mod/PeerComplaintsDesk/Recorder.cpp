@@ -1,4 +1,5 @@
 #include"Boss/Mod/PeerComplaintsDesk/Recorder.hpp"
+#include"Boss/migrate_hex_to_blob.hpp"
 #include"Ev/now.hpp"
 #include"Ln/NodeId.hpp"
 #include"Sqlite3.hpp"
@@ -16,7 +17,7 @@ void Recorder::initialize(Sqlite3::Tx& tx) {
 	CREATE TABLE IF NOT EXISTS
 	       "PeerComplaintsDesk_peers"
 	     ( peerdbid INTEGER PRIMARY KEY
-	     , nodeid TEXT NOT NULL
+	     , nodeid BLOB NOT NULL
 	     );
 	CREATE UNIQUE INDEX IF NOT EXISTS
 	       "PeerComplaintsDesk_peers_id"
@@ -65,6 +66,10 @@ void Recorder::initialize(Sqlite3::Tx& tx) {
 	       ON DELETE CASCADE
 	     );
 	)QRY");
+	/* Older versions stored node IDs as hex text.  */
+	migrate_hex_to_blob(tx, "PeerComplaintsDesk_blob", {
+		{"PeerComplaintsDesk_peers", "nodeid"}
+	});
 }
 void Recorder::cleanup( Sqlite3::Tx& tx
 		      , double complaint_age
@@ -144,13 +149,12 @@ void Recorder::cleanup( Sqlite3::Tx& tx
 namespace {
 
 std::uint64_t get_peerdbid(Sqlite3::Tx& tx, Ln::NodeId const& nid) {
-	auto nid_s = std::string(nid);
 	auto fetch = tx.query(R"QRY(
 	SELECT peerdbid FROM "PeerComplaintsDesk_peers"
 	 WHERE nodeid = :nodeid
 	     ;
 	)QRY")
-		.bind(":nodeid", nid_s)
+		.bind(":nodeid", nid)
 		.execute()
 		;
 	for (auto& r : fetch)
@@ -161,7 +165,7 @@ std::uint64_t get_peerdbid(Sqlite3::Tx& tx, Ln::NodeId const& nid) {
 	      (nodeid)
 	VALUES(:nodeid);
 	)QRY")
-		.bind(":nodeid", nid_s)
+		.bind(":nodeid", nid)
 		.execute()
 		;
 
@@ -171,7 +175,7 @@ std::uint64_t get_peerdbid(Sqlite3::Tx& tx, Ln::NodeId const& nid) {
 	 WHERE nodeid = :nodeid
 	     ;
 	)QRY")
-		.bind(":nodeid", nid_s)
+		.bind(":nodeid", nid)
 		.execute()
 		;
 	for (auto& r : fetch2)
@@ -230,7 +234,7 @@ std::map< Ln::NodeId
 	 ORDER BY time;
 	)QRY").execute();
 	for (auto& r : fetch) {
-		auto peer = Ln::NodeId(r.get<std::string>(0));
+		auto peer = r.get<Ln::NodeId>(0);
 		auto time = r.get<double>(1);
 		auto complaint = r.get<std::string>(2);
 		auto ignored = r.get<int>(3) == 1 ? true : false;
@@ -260,7 +264,7 @@ std::map< Ln::NodeId
 	 WHERE ignored = 0;
 	)QRY").execute();
 	for (auto& r : fetch) {
-		auto peer = Ln::NodeId(r.get<std::string>(0));
+		auto peer = r.get<Ln::NodeId>(0);
 		auto it = rv.find(peer);
 		if (it == rv.end())
 			rv[peer] = 1;
@@ -324,7 +328,7 @@ std::map< Ln::NodeId
 	    ;
 	)QRY").execute();
 	for (auto& r : fetch)
-		rv[Ln::NodeId(r.get<std::string>(0))] = r.get<double>(1);
+		rv[r.get<Ln::NodeId>(0)] = r.get<double>(1);
 
 	return rv;
 }
@@ -340,7 +344,7 @@ std::unique_ptr<double> Recorder::get_close_pending( Sqlite3::Tx& tx
 	 WHERE nodeid = :nodeid
 	    ;
 	)QRY")
-		.bind(":nodeid", std::string(peer))
+		.bind(":nodeid", peer)
 		.execute();
 	for (auto& r : fetch)
 		rv = Util::make_unique<double>(r.get<double>(0));
@@ -357,7 +361,7 @@ void Recorder::clear_close_pending( Sqlite3::Tx& tx
 	                    WHERE nodeid = :nodeid)
 	     ;
 	)QRY")
-		.bind(":nodeid", std::string(peer))
+		.bind(":nodeid", peer)
 		.execute()
 		;
 }
@@ -374,7 +378,7 @@ std::map< Ln::NodeId
 	 ORDER BY time;
 	)QRY").execute();
 	for (auto& r : fetch) {
-		auto peer = Ln::NodeId(r.get<std::string>(0));
+		auto peer = r.get<Ln::NodeId>(0);
 		auto time = r.get<double>(1);
 		auto closedtime = r.get<double>(2);
 		auto complaint = r.get<std::string>(3);
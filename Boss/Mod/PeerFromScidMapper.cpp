@@ -1,4 +1,5 @@
 #include"Boss/Mod/PeerFromScidMapper.hpp"
+#include"Boss/Msg/ListpeersChanged.hpp"
 #include"Boss/Msg/ListpeersResult.hpp"
 #include"Boss/Msg/RequestPeerFromScid.hpp"
 #include"Boss/Msg/ResponsePeerFromScid.hpp"
@@ -26,28 +27,32 @@ private:
 		bus.subscribe<Msg::ListpeersResult
 			     >([this](Msg::ListpeersResult const& m) {
 			auto tmp = std::map<Ln::Scid, Ln::NodeId>();
-			for (auto p : m.cpeers) {
-				auto node = p.first;
-				auto cs = p.second.channels;
-				for (auto c : cs) {
-					if (!c.has("short_channel_id"))
-						continue;
-					auto scid_j = c["short_channel_id"];
-					if (!scid_j.is_string())
-						continue;
-					auto scid_s = std::string(scid_j);
-					if (!Ln::Scid::valid_string(scid_s))
-						continue;
-					auto scid = Ln::Scid(scid_s);
-					tmp[scid] = node;
-				}
-			}
+			for (auto p : m.cpeers)
+				add_channels(tmp, p.first, p.second.channels);
 			map = Util::make_unique<std::map< Ln::Scid
 							, Ln::NodeId
 							>>(std::move(tmp));
 			auto ppendings = std::make_shared<PendingQ>(std::move(pendings));
 			return resume_pendings(std::move(ppendings));
 		});
+		bus.subscribe<Msg::ListpeersChanged
+			     >([this](Msg::ListpeersChanged const& m) {
+			if (!map)
+				return Ev::lift();
+			for (auto it = map->begin(); it != map->end(); ) {
+				if (m.changed.count(it->second) != 0)
+					it = map->erase(it);
+				else
+					++it;
+			}
+			for (auto const& node : m.changed) {
+				auto it = m.cpeers.find(node);
+				if (it == m.cpeers.end())
+					continue;
+				add_channels(*map, node, it->second.channels);
+			}
+			return Ev::lift();
+		});
 
 		bus.subscribe<Msg::RequestPeerFromScid
 			     >([this](Msg::RequestPeerFromScid const& m) {
@@ -68,6 +73,25 @@ private:
 		});
 	}
 
+	static
+	void add_channels( std::map<Ln::Scid, Ln::NodeId>& tmp
+			 , Ln::NodeId const& node
+			 , std::vector<Jsmn::Object> const& cs
+			 ) {
+		for (auto c : cs) {
+			if (!c.has("short_channel_id"))
+				continue;
+			auto scid_j = c["short_channel_id"];
+			if (!scid_j.is_string())
+				continue;
+			auto scid_s = std::string(scid_j);
+			if (!Ln::Scid::valid_string(scid_s))
+				continue;
+			auto scid = Ln::Scid(scid_s);
+			tmp[scid] = node;
+		}
+	}
+
 	Ev::Io<void>
 	resume_pendings(std::shared_ptr<PendingQ> const& ppendings) {
 		return Ev::lift().then([this, ppendings]() {
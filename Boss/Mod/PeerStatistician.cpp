@@ -5,6 +5,7 @@
 #include"Boss/Msg/DbResource.hpp"
 #include"Boss/Msg/ForwardFee.hpp"
 #include"Boss/Msg/InternetOnline.hpp"
+#include"Boss/Msg/ListpeersAnalyzedChanged.hpp"
 #include"Boss/Msg/ListpeersAnalyzedResult.hpp"
 #include"Boss/Msg/ManifestCommand.hpp"
 #include"Boss/Msg/Manifestation.hpp"
@@ -14,6 +15,7 @@
 #include"Boss/Msg/TimerRandomDaily.hpp"
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
+#include"Boss/migrate_hex_to_blob.hpp"
 #include"Ev/Io.hpp"
 #include"Ev/now.hpp"
 #include"Ln/NodeId.hpp"
@@ -203,6 +205,36 @@ private:
 				return Ev::lift();
 			});
 		});
+		/* Connection samples are taken at the 10-minute
+		 * listing above, as uptime is the fraction of
+		 * samples where the peer was connected; but drop
+		 * peers as soon as their last channel goes.  */
+		bus.subscribe<Msg::ListpeersAnalyzedChanged
+			     >([this](Msg::ListpeersAnalyzedChanged const& m) {
+			if (!db)
+				return Ev::lift();
+			auto const& r = m.analyzed;
+			auto gone = std::vector<Ln::NodeId>();
+			for (auto const& n : m.changed)
+				if ( r.connected_channeled.count(n) == 0
+				  && r.disconnected_channeled.count(n) == 0
+				   )
+					gone.push_back(n);
+			if (gone.empty())
+				return Ev::lift();
+			return db.transact().then([gone](Sqlite3::Tx tx) {
+				for (auto const& n : gone)
+					tx.query(R"QRY(
+					DELETE FROM "PeerStatistician_peers"
+					 WHERE id = :id
+					     ;
+					)QRY")
+						.bind(":id", n)
+						.execute();
+				tx.commit();
+				return Ev::lift();
+			});
+		});
 		bus.subscribe<Msg::ForwardFee
 			     >([this](Msg::ForwardFee const& m) {
 			if (!db)
@@ -229,9 +261,7 @@ private:
 			});
 		});
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& c) {
-			if (c.command != "clboss-externpay")
-				return Ev::lift();
+			     >("clboss-externpay", [this](Msg::CommandRequest const& c) {
 			auto hash_j = Jsmn::Object();
 			if (c.params.is_array() && c.params.size() == 1)
 				hash_j = c.params[0];
@@ -258,9 +288,13 @@ private:
 		});
 	}
 
+	/* Also migrates hex node IDs and hashes of older
+	 * versions, which can be many rows, so do it in the
+	 * database thread.
+	 */
 	Ev::Io<void>
 	init_db() {
-		return db.transact().then([](Sqlite3::Tx tx) {
+		return db.transact_background([](Sqlite3::Tx& tx) {
 			tx.query_execute(R"QRY(
 			-- Table of when we first started recording
 			-- information about a peer.
@@ -270,7 +304,7 @@ private:
 			-- to the creation time of the peer.
 			CREATE TABLE IF NOT EXISTS
 			       "PeerStatistician_peers"
-			     ( id TEXT PRIMARY KEY
+			     ( id BLOB PRIMARY KEY
 			     -- time this entry was created.
 			     , creation REAL NOT NULL
 			     );
@@ -278,7 +312,7 @@ private:
 			CREATE TABLE IF NOT EXISTS
 			       "PeerStatistician_sendpayresults"
 			     -- peer
-			     ( id TEXT NOT NULL
+			     ( id BLOB NOT NULL
 			       REFERENCES "PeerStatistician_peers"(id)
 			       ON DELETE CASCADE
 			       ON UPDATE RESTRICT
@@ -307,7 +341,7 @@ private:
 
 			CREATE TABLE IF NOT EXISTS
 			       "PeerStatistician_connection"
-			     ( id TEXT NOT NULL
+			     ( id BLOB NOT NULL
 			       REFERENCES "PeerStatistician_peers"(id)
 			       ON DELETE CASCADE
 			       ON UPDATE RESTRICT
@@ -328,12 +362,12 @@ private:
 			CREATE TABLE IF NOT EXISTS
 			       "PeerStatistician_forwardfees"
 			     -- incoming peer.
-			     ( in_id TEXT NOT NULL
+			     ( in_id BLOB NOT NULL
 			       REFERENCES "PeerStatistician_peers"(id)
 			       ON DELETE CASCADE
 			       ON UPDATE RESTRICT
 			     -- outgoing peer.
-			     , out_id TEXT NOT NULL
+			     , out_id BLOB NOT NULL
 			       REFERENCES "PeerStatistician_peers"(id)
 			       ON DELETE CASCADE
 			       ON UPDATE RESTRICT
@@ -361,7 +395,7 @@ private:
 
 			CREATE TABLE IF NOT EXISTS
 			       "PeerStatistician_externpays"
-			     ( hash TEXT PRIMARY KEY
+			     ( hash BLOB PRIMARY KEY
 			     , creation REAL NOT NULL
 			     );
 			CREATE INDEX IF NOT EXISTS
@@ -417,49 +451,72 @@ private:
 			Good if this is high.
 			*/
 
+			auto migrated = migrate_hex_to_blob(
+				tx, "PeerStatistician_blob", {
+				{"PeerStatistician_sendpayresults", "id"},
+				{"PeerStatistician_connection", "id"},
+				{"PeerStatistician_forwardfees", "in_id"},
+				{"PeerStatistician_forwardfees", "out_id"},
+				{"PeerStatistician_peers", "id"},
+				{"PeerStatistician_externpays", "hash"}
+			});
+
 			tx.commit();
-			return Ev::lift();
+			return migrated;
+		}).then([this](std::size_t migrated) {
+			if (migrated == 0)
+				return Ev::lift();
+			return Boss::log( bus, Info
+					, "PeerStatistician: Migrated %zu "
+					  "node IDs and hashes to binary."
+					, migrated
+					);
 		});
 	}
 
-	/* Cleans up old entries.  */
+	/* Cleans up old entries.
+	 * This can delete many rows, so do it in the
+	 * database thread.
+	 */
 	Ev::Io<void> clean_entries() {
-		return db.transact().then([](Sqlite3::Tx tx) {
-			tx.query(R"QRY(
-			DELETE FROM "PeerStatistician_sendpayresults"
-			 WHERE creation + :max_age < :now
-			     ;
-			)QRY")
-				.bind(":max_age", max_entry_age)
-				.bind(":now", Ev::now())
-				.execute();
-			tx.query(R"QRY(
-			DELETE FROM "PeerStatistician_connection"
-			 WHERE creation + :max_age < :now
-			     ;
-			)QRY")
-				.bind(":max_age", max_entry_age)
-				.bind(":now", Ev::now())
-				.execute();
-			tx.query(R"QRY(
-			DELETE FROM "PeerStatistician_forwardfees"
-			 WHERE creation + :max_age < :now
-			     ;
-			)QRY")
-				.bind(":max_age", max_entry_age)
-				.bind(":now", Ev::now())
-				.execute();
-			tx.query(R"QRY(
-			DELETE FROM "PeerStatistician_externpays"
-			 WHERE creation + :max_age < :now
-			     ;
-			)QRY")
-				.bind(":max_age", max_entry_age)
-				.bind(":now", Ev::now())
-				.execute();
+		return Ev::lift().then([this]() {
+			auto now = Ev::now();
+			return db.transact_background([now](Sqlite3::Tx& tx) {
+				tx.query(R"QRY(
+				DELETE FROM "PeerStatistician_sendpayresults"
+				 WHERE creation + :max_age < :now
+				     ;
+				)QRY")
+					.bind(":max_age", max_entry_age)
+					.bind(":now", now)
+					.execute();
+				tx.query(R"QRY(
+				DELETE FROM "PeerStatistician_connection"
+				 WHERE creation + :max_age < :now
+				     ;
+				)QRY")
+					.bind(":max_age", max_entry_age)
+					.bind(":now", now)
+					.execute();
+				tx.query(R"QRY(
+				DELETE FROM "PeerStatistician_forwardfees"
+				 WHERE creation + :max_age < :now
+				     ;
+				)QRY")
+					.bind(":max_age", max_entry_age)
+					.bind(":now", now)
+					.execute();
+				tx.query(R"QRY(
+				DELETE FROM "PeerStatistician_externpays"
+				 WHERE creation + :max_age < :now
+				     ;
+				)QRY")
+					.bind(":max_age", max_entry_age)
+					.bind(":now", now)
+					.execute();
 
-			tx.commit();
-			return Ev::lift();
+				tx.commit();
+			});
 		});
 	}
 
@@ -472,7 +529,7 @@ private:
 		      , :now
 		      );
 		)QRY")
-			.bind(":id", std::string(id))
+			.bind(":id", id)
 			.bind(":now", Ev::now())
 			.execute();
 	}
@@ -496,7 +553,7 @@ private:
 			WHERE hash = :hash
 			    ;
 			)QRY")
-				.bind(":hash", std::string(payment_hash))
+				.bind(":hash", payment_hash)
 				.execute()
 				;
 			auto in_externpays = false;
@@ -522,7 +579,7 @@ private:
 			      , :destination_reached
 			      );
 			)QRY")
-				.bind(":id", std::string(id))
+				.bind(":id", id)
 				.bind(":creation", creation)
 				.bind(":lockrealtime", lockrealtime)
 				.bind( ":destination_reached"
@@ -547,7 +604,7 @@ private:
 		      , :connected
 		      );
 		)QRY")
-			.bind(":id", std::string(id))
+			.bind(":id", id)
 			.bind(":creation", Ev::now())
 			.bind(":connected", connected)
 			.execute();
@@ -562,7 +619,7 @@ private:
 		SELECT id FROM "PeerStatistician_peers";
 		)QRY").execute();
 		for (auto& r : fetch) {
-			auto peer = Ln::NodeId(r.get<std::string>(0));
+			auto peer = r.get<Ln::NodeId>(0);
 			auto it = channeled.find(peer);
 			if (it == channeled.end())
 				to_del.push_back(peer);
@@ -576,13 +633,14 @@ private:
 			 WHERE id = :id
 			     ;
 			)QRY")
-				.bind(":id", std::string(p))
+				.bind(":id", p)
 				.execute();
 		}
 	}
 
 	Ev::Io<void> add_forwardfee(Msg::ForwardFee const& m) {
-		return db.transact().then([this, m](Sqlite3::Tx tx) {
+		auto creation = Ev::now();
+		return db.write_behind([this, m, creation](Sqlite3::Tx& tx) {
 			make_entry(tx, m.in_id);
 			make_entry(tx, m.out_id);
 			tx.query(R"QRY(
@@ -594,15 +652,12 @@ private:
 			      , :resolution_time
 			      );
 			)QRY")
-				.bind(":in_id", std::string(m.in_id))
-				.bind(":out_id", std::string(m.out_id))
-				.bind(":creation", Ev::now())
+				.bind(":in_id", m.in_id)
+				.bind(":out_id", m.out_id)
+				.bind(":creation", creation)
 				.bind(":fee", m.fee.to_msat())
 				.bind(":resolution_time", m.resolution_time)
 				.execute();
-
-			tx.commit();
-			return Ev::lift();
 		});
 	}
 
@@ -634,7 +689,7 @@ private:
 				.execute()
 				;
 			for (auto& r : sendpays) {
-				auto node = Ln::NodeId(r.get<std::string>(0));
+				auto node = r.get<Ln::NodeId>(0);
 				auto& entry = get_entry( tx, data, node
 						       , start_time, end_time
 						       );
@@ -655,7 +710,7 @@ private:
 				.execute()
 				;
 			for (auto& r : connects) {
-				auto node = Ln::NodeId(r.get<std::string>(0));
+				auto node = r.get<Ln::NodeId>(0);
 				auto& entry = get_entry( tx, data, node
 						       , start_time, end_time
 						       );
@@ -675,14 +730,14 @@ private:
 				.execute()
 				;
 			for (auto& r : fees) {
-				auto in = Ln::NodeId(r.get<std::string>(0));
+				auto in = r.get<Ln::NodeId>(0);
 				auto& in_e = get_entry( tx, data, in
 						      , start_time, end_time
 						      );
 				in_e.in_fee += Ln::Amount::msat(
 					r.get<std::uint64_t>(2)
 				);
-				auto out = Ln::NodeId(r.get<std::string>(1));
+				auto out = r.get<Ln::NodeId>(1);
 				auto& out_e = get_entry( tx, data, out
 						       , start_time, end_time
 						       );
@@ -720,7 +775,7 @@ private:
 		 WHERE id = :id
 		     ;
 		)QRY")
-			.bind(":id", std::string(node))
+			.bind(":id", node)
 			.execute()
 			;
 		auto node_start = double();
@@ -753,7 +808,7 @@ private:
 			      , :creation
 			      );
 			)QRY")
-				.bind(":hash", std::string(hash))
+				.bind(":hash", hash)
 				.bind(":creation", Ev::now())
 				.execute()
 				;
@@ -1,11 +1,16 @@
 #include"Boss/Mod/Rpc.hpp"
+#include"Boss/Msg/ProvideStatus.hpp"
+#include"Boss/Msg/SolicitStatus.hpp"
 #include"Boss/Shutdown.hpp"
 #include"Boss/log.hpp"
 #include"Ev/Io.hpp"
 #include"Ev/Semaphore.hpp"
+#include"Ev/map.hpp"
+#include"Jsmn/ArrayStreamer.hpp"
 #include"Jsmn/ParserExposedBuffer.hpp"
 #include"Json/Out.hpp"
 #include"Net/Fd.hpp"
+#include"Net/WriteQueue.hpp"
 #include"S/Bus.hpp"
 #include"Util/make_unique.hpp"
 #include<algorithm>
@@ -27,6 +32,88 @@ namespace {
  * prevent hammering of the node.
  */
 auto constexpr max_concurrent_rpcs = 100;
+/* Maximum number of commands in a single write of
+ * `command_many`; larger batches are split and the
+ * parts run concurrently.
+ */
+auto constexpr max_batch_rpcs = std::size_t(25);
+
+/* Read-only commands whose results are cached, and for
+ * how many seconds.
+ * Several modules list peers and channels at around the
+ * same time, so even a short time saves a lot of
+ * round-trips.
+ */
+struct CachePolicy {
+	char const* command;
+	double ttl;
+};
+CachePolicy const cache_policies[] = {
+	{"listpeers", 10.0},
+	{"listpeerchannels", 10.0},
+	{"listchannels", 30.0},
+};
+CachePolicy const* find_cache_policy(std::string const& command) {
+	for (auto const& p : cache_policies)
+		if (command == p.command)
+			return &p;
+	return nullptr;
+}
+/* Commands that cannot change anything the cached
+ * commands would report.  Anything not listed here
+ * clears the cache.  */
+char const* const read_only_commands[] = {
+	"checkmessage",
+	"decode",
+	"decodepay",
+	"feerates",
+	"getinfo",
+	"getlog",
+	"getroute",
+	"help",
+	"listchannels",
+	"listconfigs",
+	"listforwards",
+	"listfunds",
+	"listinvoices",
+	"listnodes",
+	"listpays",
+	"listpeerchannels",
+	"listpeers",
+	"listsendpays",
+	"listtransactions",
+	"waitblockheight",
+};
+bool is_read_only(std::string const& command) {
+	for (auto c : read_only_commands)
+		if (command == c)
+			return true;
+	return false;
+}
+/* Whether the result of the command with the given
+ * parameters may be cached.  An unfiltered
+ * `listchannels` is the whole network, which is too
+ * large to keep around.  A `listpeerchannels` of a
+ * single peer is cheap, and is done to see its
+ * balances right after they move, which does not
+ * clear the cache.  */
+bool is_cacheable(std::string const& command, Json::Out const& params) {
+	if (command == "listpeerchannels") {
+		auto p = Jsmn::Object::parse_json(params.output().c_str());
+		if (p.is_array())
+			return p.size() == 0;
+		return !p.has("id");
+	}
+	if (command != "listchannels")
+		return true;
+	auto p = Jsmn::Object::parse_json(params.output().c_str());
+	if (p.is_array())
+		return p.size() != 0;
+	return p.has("short_channel_id")
+	    || p.has("source")
+	    || p.has("destination")
+	     ;
+}
 
 std::string limited_enstring(Jsmn::Object const& val) {
 	char const* t;
@@ -80,16 +167,47 @@ private:
 	/* Next id.  */
 	std::uint64_t next_id;
 
+	std::function<double()> get_now;
+
+	/* Cached results of read-only commands, keyed by
+	 * command and parameters.  */
+	struct CacheEntry {
+		double expiry;
+		Jsmn::Object result;
+	};
+	std::map<std::string, CacheEntry> cache;
+	/* Cached commands that are still running, and
+	 * everyone waiting on them.  */
+	struct InFlight {
+		std::vector<std::function<void(Jsmn::Object)>> passes;
+		std::vector<std::function<void(std::exception_ptr)>> fails;
+	};
+	std::map<std::string, std::shared_ptr<InFlight>> in_flight;
+	/* Incremented whenever the cache is invalidated, so
+	 * that commands started before do not fill it.  */
+	std::uint64_t cache_generation;
+	std::uint64_t cache_hits;
+	std::uint64_t cache_misses;
+	std::uint64_t cache_coalesced;
+	std::uint64_t cache_invalidations;
+
 	/* Pending commands.  */
 	struct Pending {
 		std::string command;
 		std::function<void(Jsmn::Object)> pass;
 		std::function<void(std::exception_ptr)> fail;
+		/* If set, pass the entire response, even on
+		 * error.  */
+		bool whole_response;
+		/* If set, the elements of this field of the
+		 * result are passed to the visitor instead.  */
+		std::string stream_field;
+		Jsmn::ArrayStreamer::Visitor visitor;
 	};
 	std::map<std::uint64_t, Pending> pendings;
 
 	/* Data to be written.  */
-	std::vector<char> to_write;
+	Net::WriteQueue to_write;
 
 	/* libev event on read end of RPC socket.  */
 	ev_io read_event;
@@ -98,8 +216,33 @@ private:
 	/* libev event on write end of RPC socket.  */
 	std::unique_ptr<ev_io> write_event;
 
-	/* Data we get on the read end of the RPC socket.  */
+	/* Data we get on the read end of the RPC socket,
+	 * after removing streamed elements.  */
 	std::string read_buffer;
+	Jsmn::ArrayStreamer streamer;
+
+	/* Select the visitor for an array in a response.  */
+	Jsmn::ArrayStreamer::Visitor select_stream( std::string const& id_s
+						  , std::string const& k1
+						  , std::string const& k2
+						  ) {
+		if (k1 != "result" || id_s.empty())
+			return nullptr;
+		auto it = pendings.find(string_to_u64(id_s));
+		if (it == pendings.end() || it->second.stream_field != k2)
+			return nullptr;
+		return it->second.visitor;
+	}
+	/* Fail the command whose streamed array had an
+	 * invalid element; its response is then ignored.  */
+	void fail_stream(std::string const& id_s, std::exception_ptr e) {
+		auto it = pendings.find(string_to_u64(id_s));
+		if (it == pendings.end())
+			return;
+		auto fail = std::move(it->second.fail);
+		pendings.erase(it);
+		fail(e);
+	}
 
 	/* Call at shutdown.  */
 	void shutdown() {
@@ -143,7 +286,13 @@ private:
 		if (it == pendings.end())
 			return;
 
-		if (resp.has("result")) {
+		if (it->second.whole_response) {
+			if (!resp.has("result") && !resp.has("error"))
+				return;
+			auto pass = std::move(it->second.pass);
+			pendings.erase(it);
+			pass(resp);
+		} else if (resp.has("result")) {
 			auto pass = std::move(it->second.pass);
 			pendings.erase(it);
 			pass(resp["result"]);
@@ -182,35 +331,41 @@ private:
 	/* Call when read end is ready.  */
 	void on_read() {
 		auto static constexpr chunk_size = std::size_t(4096);
-		auto eagain_flag = false;
-
-		while (!eagain_flag && is_ready(socket.get(), POLLIN)) {
-			parser.load_buffer( chunk_size
-					  , [ this
-					    , &eagain_flag
-					    ](char* ptr) {
-				auto res = ssize_t();
-				do {
-					res = read(socket.get(), ptr, chunk_size);
-				} while (res < 0 && errno == EINTR);
-				if (res < 0 && ( errno == EWOULDBLOCK
-					      || errno == EAGAIN
-					       )) {
-					eagain_flag = true;
-					return std::size_t(0);
-				}
-				if (res < 0)
-					throw Util::BacktraceException<std::runtime_error>(
-						std::string("Rpc: read: ") +
-						strerror(errno)
-					);
-				if (res == 0)
-					/* Unexpected end of file!  */
-					throw Util::BacktraceException<std::runtime_error>(
-						"Rpc: read: unexpected end-of-file "
-						"in RPC socket."
-					);
-				return std::size_t(res);
+		char chunk[chunk_size];
+
+		while (is_ready(socket.get(), POLLIN)) {
+			auto res = ssize_t();
+			do {
+				res = read(socket.get(), chunk, chunk_size);
+			} while (res < 0 && errno == EINTR);
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				break;
+			if (res < 0)
+				throw Util::BacktraceException<std::runtime_error>(
+					std::string("Rpc: read: ") +
+					strerror(errno)
+				);
+			if (res == 0)
+				/* Unexpected end of file!  */
+				throw Util::BacktraceException<std::runtime_error>(
+					"Rpc: read: unexpected end-of-file "
+					"in RPC socket."
+				);
+
+			/* Streamed elements are visited here, and
+			 * only the rest goes to the parser.  */
+			read_buffer.clear();
+			streamer.feed(chunk, std::size_t(res), read_buffer);
+			if (read_buffer.empty())
+				continue;
+			parser.load_buffer( read_buffer.size()
+					  , [this](char* ptr) {
+				std::copy( read_buffer.begin(), read_buffer.end()
+					 , ptr
+					 );
+				return read_buffer.size();
 			});
 		}
 	}
@@ -246,17 +401,12 @@ private:
 
 	/* Call when write end is ready.  */
 	void on_write() {
-		while ( is_ready(socket.get(), POLLOUT)
-		     && to_write.size() != 0
-		      ) {
+		/* The socket is non-blocking, so just write
+		 * until it refuses.  */
+		while (!to_write.empty()) {
 			auto res = ssize_t();
-			auto size = to_write.size();
-			if (size > 512)
-				size = 512;
 			do {
-				res = write( socket.get()
-					   , &to_write[0], size
-					   );
+				res = to_write.write_to(socket.get());
 			} while (res < 0 && errno == EINTR);
 			if (res < 0 && ( errno == EWOULDBLOCK
 				      || errno == EAGAIN
@@ -267,12 +417,8 @@ private:
 					std::string("Rpc: write: ") +
 					strerror(errno)
 				);
-
-			to_write.erase( to_write.begin()
-				      , to_write.begin() + res
-				      );
 		}
-		if (to_write.size() == 0) {
+		if (to_write.empty()) {
 			if (write_event) {
 				ev_io_stop(EV_DEFAULT_ write_event.get());
 				write_event = nullptr;
@@ -301,13 +447,30 @@ private:
 public:
 	Impl( S::Bus& bus_
 	    , Net::Fd socket_
+	    , std::function<double()> get_now_
 	    ) : bus(bus_)
 	      , socket(std::move(socket_))
 	      , is_shutting_down(false)
 	      , sem(max_concurrent_rpcs)
 	      , next_id(0)
+	      , get_now(std::move(get_now_))
+	      , cache_generation(0)
+	      , cache_hits(0)
+	      , cache_misses(0)
+	      , cache_coalesced(0)
+	      , cache_invalidations(0)
 	      , write_event(nullptr)
 	      , read_buffer("")
+	      , streamer([this]( std::string const& id_s
+			       , std::string const& k1
+			       , std::string const& k2
+			       ) {
+			return select_stream(id_s, k1, k2);
+		}, [this]( std::string const& id_s
+			 , std::exception_ptr e
+			 ) {
+			fail_stream(id_s, e);
+		})
 	      {
 
 		{
@@ -333,6 +496,21 @@ public:
 			shutdown();
 			return Ev::lift();
 		});
+
+		bus.subscribe<Msg::SolicitStatus
+			     >([this](Msg::SolicitStatus const&) {
+			return bus.raise(Msg::ProvideStatus{
+				"rpc_cache",
+				Json::Out()
+					.start_object()
+						.field("entries", std::uint64_t(cache.size()))
+						.field("hits", cache_hits)
+						.field("misses", cache_misses)
+						.field("coalesced", cache_coalesced)
+						.field("invalidations", cache_invalidations)
+					.end_object()
+			});
+		});
 	}
 
 	~Impl() {
@@ -344,8 +522,27 @@ public:
 			shutdown();
 	}
 
+	/* Append a request to to_write.  */
+	void write_request( std::uint64_t id
+			  , std::string const& command
+			  , Json::Out const& params
+			  ) {
+		auto js = Json::Out()
+			.start_object()
+				.field("jsonrpc", std::string("2.0"))
+				.field("id", id)
+				.field("method", command)
+				.field("params", params)
+			.end_object()
+			.output();
+		js += "\n\n";
+		to_write.push(std::move(js));
+	}
+
 	Ev::Io<Jsmn::Object> core_command( std::string const& command
 					 , Json::Out params
+					 , std::string const& stream_field = ""
+					 , Jsmn::ArrayStreamer::Visitor visitor = nullptr
 					 ) {
 		return Ev::Io<Jsmn::Object>([=, this]( std::function<void(Jsmn::Object)> pass
 						     , std::function<void(std::exception_ptr)> fail
@@ -360,22 +557,15 @@ public:
 			}
 
 			auto id = next_id++;
-			auto js = Json::Out()
-				.start_object()
-					.field("jsonrpc", std::string("2.0"))
-					.field("id", id)
-					.field("method", command)
-					.field("params", params)
-				.end_object()
-				.output() + "\n\n";
-			std::copy( js.begin(), js.end()
-				 , std::back_inserter(to_write)
-				 );
+			write_request(id, command, params);
 
 			/* Add to pending.  */
 			pendings[id] = Pending{ std::move(command)
 					      , std::move(pass)
 					      , std::move(fail)
+					      , false
+					      , std::move(stream_field)
+					      , std::move(visitor)
 					      };
 
 			/* Perform the write.  */
@@ -384,37 +574,53 @@ public:
 	}
 	Ev::Io<Jsmn::Object> logging_command( std::string const& command
 					    , Json::Out params
+					    , std::string const& stream_field = ""
+					    , Jsmn::ArrayStreamer::Visitor visitor = nullptr
 					    ) {
+		/* Skip stringifying the parameters and results
+		 * if nobody will see them.  */
+		if (!log_enabled(Debug))
+			return core_command( command, std::move(params)
+					   , stream_field, std::move(visitor)
+					   );
+
 		auto save = std::make_shared<Jsmn::Object>();
 		auto errsave = std::make_shared<RpcError>(
 			"", Jsmn::Object()
 		);
+		auto params_s = std::make_shared<std::string>(params.output());
 		return Boss::log( bus, Debug
 				, "Rpc out: %s %s"
 				, command.c_str()
-				, params.output().c_str()
-				).then([this, command, params]() {
-			return core_command(command, params);
-		}).then([this, command, params, save](Jsmn::Object result) {
+				, params_s->c_str()
+				).then([ this, command, params
+				       , stream_field, visitor
+				       ]() {
+			return core_command( command, params
+					   , stream_field, visitor
+					   );
+		}).then([this, command, params_s, save](Jsmn::Object result) {
 			*save = std::move(result);
+			if (!log_enabled(Debug))
+				return Ev::lift();
 			return Boss::log( bus, Debug
 					, "Rpc in: %s %s => %s"
 					, command.c_str()
-					, params.output().c_str()
+					, params_s->c_str()
 					, limited_enstring(*save).c_str()
 					);
 		}).then([save]() {
 			return Ev::lift(std::move(*save));
 		}).catching<RpcError>([ this
 				      , command
-				      , params
+				      , params_s
 				      , errsave
 				      ](RpcError const& e) {
 			*errsave = e;
 			return Boss::log( bus, Debug
 					, "Rpc in: %s %s => error %s"
 					, command.c_str()
-					, params.output().c_str()
+					, params_s->c_str()
 					, limited_enstring(errsave->error).c_str()
 					).then([errsave]() {
 				throw *errsave;
@@ -423,16 +629,264 @@ public:
 			});
 		});
 	}
+	void invalidate_cache() {
+		++cache_generation;
+		if (cache.empty() && in_flight.empty())
+			return;
+		++cache_invalidations;
+		cache.clear();
+		/* Those already waiting still get the result of
+		 * the running command, but later callers will
+		 * run it anew.  */
+		in_flight.clear();
+	}
+	/* Invalidate the cache when the given action, which
+	 * might change things, completes.  */
+	template<typename a>
+	Ev::Io<a> invalidating(Ev::Io<a> act) {
+		invalidate_cache();
+		return Ev::Io<a>([this, act
+				 ]( std::function<void(a)> pass
+				  , std::function<void(std::exception_ptr)> fail
+				  ) {
+			act.run([this, pass](a result) {
+				invalidate_cache();
+				pass(std::move(result));
+			}, [this, fail](std::exception_ptr e) {
+				invalidate_cache();
+				fail(e);
+			});
+		});
+	}
+
+	Ev::Io<Jsmn::Object> cached_command( std::string const& command
+					   , Json::Out params
+					   , double ttl
+					   ) {
+		return Ev::Io<Jsmn::Object>([ this, command, params, ttl
+					    ]( std::function<void(Jsmn::Object)> pass
+					     , std::function<void(std::exception_ptr)> fail
+					     ) {
+			auto key = command + " " + params.output();
+
+			auto it = cache.find(key);
+			if (it != cache.end()) {
+				if (it->second.expiry > get_now()) {
+					++cache_hits;
+					pass(it->second.result);
+					return;
+				}
+				cache.erase(it);
+			}
+
+			auto fit = in_flight.find(key);
+			if (fit != in_flight.end()) {
+				++cache_coalesced;
+				fit->second->passes.push_back(std::move(pass));
+				fit->second->fails.push_back(std::move(fail));
+				return;
+			}
+
+			++cache_misses;
+			auto flight = std::make_shared<InFlight>();
+			flight->passes.push_back(std::move(pass));
+			flight->fails.push_back(std::move(fail));
+			in_flight[key] = flight;
+
+			auto generation = cache_generation;
+			auto done = [this, key, flight]() {
+				auto fit = in_flight.find(key);
+				if (fit != in_flight.end() && fit->second == flight)
+					in_flight.erase(fit);
+			};
+			sem.run(logging_command(command, params)).run([ this
+								      , key, ttl
+								      , flight, done
+								      , generation
+								      ](Jsmn::Object result) {
+				done();
+				if (generation == cache_generation)
+					cache[key] = CacheEntry{
+						get_now() + ttl, result
+					};
+				for (auto& pass : flight->passes)
+					pass(result);
+			}, [flight, done](std::exception_ptr e) {
+				done();
+				for (auto& fail : flight->fails)
+					fail(e);
+			});
+		});
+	}
+
 	Ev::Io<Jsmn::Object> command( std::string const& command
 				    , Json::Out params
 				    ) {
-		return sem.run(logging_command(command, std::move(params)));
+		auto policy = find_cache_policy(command);
+		if (policy && is_cacheable(command, params))
+			return cached_command( command, std::move(params)
+					     , policy->ttl
+					     );
+		auto act = sem.run(logging_command(command, std::move(params)));
+		if (!is_read_only(command))
+			return invalidating(std::move(act));
+		return act;
+	}
+	Ev::Io<Jsmn::Object>
+	command_streaming( std::string const& command
+			 , Json::Out params
+			 , std::string const& field
+			 , std::function<void(Jsmn::Object)> visitor
+			 ) {
+		auto act = sem.run(logging_command( command, std::move(params)
+						  , field, std::move(visitor)
+						  ));
+		if (!is_read_only(command))
+			return invalidating(std::move(act));
+		return act;
+	}
+
+	typedef std::vector<std::pair<std::string, Json::Out>> Commands;
+
+	Ev::Io<std::vector<Jsmn::Object>>
+	core_command_many(std::shared_ptr<Commands> commands) {
+		return Ev::Io<std::vector<Jsmn::Object>>([this, commands
+							 ]( std::function<void(std::vector<Jsmn::Object>)> pass
+							  , std::function<void(std::exception_ptr)> fail
+							  ) {
+			if (is_shutting_down) {
+				try {
+					throw Boss::Shutdown();
+				} catch (...) {
+					fail(std::current_exception());
+				}
+				return;
+			}
+
+			struct Batch {
+				std::vector<Jsmn::Object> responses;
+				std::size_t remaining;
+				std::function<void(std::vector<Jsmn::Object>)> pass;
+				std::function<void(std::exception_ptr)> fail;
+			};
+			auto batch = std::make_shared<Batch>();
+			batch->responses.resize(commands->size());
+			batch->remaining = commands->size();
+			batch->pass = std::move(pass);
+			batch->fail = std::move(fail);
+
+			for (auto i = std::size_t(0); i < commands->size(); ++i) {
+				auto& c = (*commands)[i];
+				auto id = next_id++;
+				write_request(id, c.first, c.second);
+				auto pass_i = [batch, i](Jsmn::Object r) {
+					if (!batch->pass)
+						return;
+					batch->responses[i] = std::move(r);
+					if (--batch->remaining != 0)
+						return;
+					auto pass = std::move(batch->pass);
+					batch->pass = nullptr;
+					pass(std::move(batch->responses));
+				};
+				/* Only called at shutdown, which fails
+				 * the whole batch.  */
+				auto fail_i = [batch](std::exception_ptr e) {
+					if (!batch->pass)
+						return;
+					batch->pass = nullptr;
+					auto fail = std::move(batch->fail);
+					fail(e);
+				};
+				pendings[id] = Pending{ std::move(c.first)
+						      , std::move(pass_i)
+						      , std::move(fail_i)
+						      , true
+						      , ""
+						      , nullptr
+						      };
+			}
+
+			/* Perform the write.  */
+			on_write();
+		});
+	}
+	Ev::Io<std::vector<Jsmn::Object>>
+	logging_command_many(std::shared_ptr<Commands> commands) {
+		if (!log_enabled(Debug))
+			return core_command_many(std::move(commands));
+
+		auto os = std::ostringstream();
+		for (auto const& c : *commands)
+			os << " " << c.first << " " << c.second.output();
+		return Boss::log( bus, Debug
+				, "Rpc out: batch of %zu:%s"
+				, commands->size()
+				, os.str().c_str()
+				).then([this, commands]() {
+			return core_command_many(commands);
+		}).then([this](std::vector<Jsmn::Object> responses) {
+			auto errors = std::size_t(0);
+			for (auto const& r : responses)
+				if (r.has("error"))
+					++errors;
+			auto n = responses.size();
+			auto save = std::make_shared<std::vector<Jsmn::Object>>(
+				std::move(responses)
+			);
+			return Boss::log( bus, Debug
+					, "Rpc in: batch of %zu => %zu errors"
+					, n, errors
+					).then([save]() {
+				return Ev::lift(std::move(*save));
+			});
+		});
+	}
+	Ev::Io<std::vector<Jsmn::Object>>
+	command_many(Commands commands) {
+		if (commands.empty())
+			return Ev::lift(std::vector<Jsmn::Object>());
+
+		auto read_only = std::all_of( commands.begin(), commands.end()
+					    , [](std::pair<std::string, Json::Out> const& c) {
+			return is_read_only(c.first);
+		});
+
+		/* Split into parts, each a single write.  */
+		auto parts = std::vector<std::shared_ptr<Commands>>();
+		for (auto& c : commands) {
+			if ( parts.empty()
+			  || parts.back()->size() >= max_batch_rpcs
+			   )
+				parts.push_back(std::make_shared<Commands>());
+			parts.back()->push_back(std::move(c));
+		}
+
+		auto f = [this](std::shared_ptr<Commands> part) {
+			auto units = part->size();
+			return sem.run(units, logging_command_many(part));
+		};
+		auto act = Ev::map(f, std::move(parts)
+				  ).then([](std::vector<std::vector<Jsmn::Object>> rs) {
+			auto result = std::vector<Jsmn::Object>();
+			for (auto& r : rs)
+				std::move( r.begin(), r.end()
+					 , std::back_inserter(result)
+					 );
+			return Ev::lift(std::move(result));
+		});
+		if (!read_only)
+			return invalidating(std::move(act));
+		return act;
 	}
 };
 
 Rpc::Rpc( S::Bus& bus
 	, Net::Fd socket
-	) : pimpl(Util::make_unique<Impl>(bus, std::move(socket)))
+	, std::function<double()> get_now
+	) : pimpl(Util::make_unique<Impl>( bus, std::move(socket)
+					 , std::move(get_now)
+					 ))
 	  { }
 Rpc::Rpc(Rpc&& o) : pimpl(std::move(o.pimpl)) { }
 Rpc::~Rpc() { }
@@ -444,5 +898,38 @@ Ev::Io<Jsmn::Object> Rpc::command( std::string const& command
 	return pimpl->command(command, std::move(params));
 }
 
+Ev::Io<Jsmn::Object>
+Rpc::command_streaming( std::string const& command
+		      , Json::Out params
+		      , std::string const& field
+		      , std::function<void(Jsmn::Object)> visitor
+		      ) {
+	assert(pimpl);
+	return pimpl->command_streaming( command, std::move(params)
+				       , field, std::move(visitor)
+				       );
+}
+
+Ev::Io<std::vector<Jsmn::Object>>
+Rpc::command_many(std::vector<std::pair<std::string, Json::Out>> commands) {
+	assert(pimpl);
+	return pimpl->command_many(std::move(commands));
+}
+
+void Rpc::invalidate_cache() {
+	assert(pimpl);
+	pimpl->invalidate_cache();
+}
+
+Jsmn::Object Rpc::result_of( std::string const& command
+			   , Jsmn::Object const& response
+			   ) {
+	if (response.has("result"))
+		return response["result"];
+	if (response.has("error"))
+		throw RpcError(command, response["error"]);
+	throw RpcError(command, response);
+}
+
 }}
 
@@ -1,10 +1,14 @@
 #ifndef BOSS_MOD_RPC_HPP
 #define BOSS_MOD_RPC_HPP
 
+#include"Ev/now.hpp"
 #include"Jsmn/Object.hpp"
+#include<functional>
 #include<memory>
 #include<stdexcept>
 #include<string>
+#include<utility>
+#include<vector>
 
 namespace Ev { template<typename a> class Io; }
 namespace Json { class Out; }
@@ -36,6 +40,19 @@ public:
  * @desc Module that handles a JSON-RPC stream.
  * This module is constructed later, after the
  * `init` method.
+ *
+ * Results of `listpeers`, `listpeerchannels`, and
+ * `listchannels` via `command` are cached for a few
+ * seconds, and identical such commands that are
+ * running at the same time share one request.
+ * An unfiltered `listchannels`, or a `listpeerchannels`
+ * of a single peer, is not cached.
+ * The cache is cleared by `invalidate_cache`, which
+ * `Boss::Mod::RpcCacheInvalidator` calls when peers or
+ * channels change, and whenever a command not known
+ * to be read-only is sent.
+ * The cache hits and misses are reported in
+ * `clboss-status`.
  */
 class Rpc {
 private:
@@ -44,13 +61,87 @@ private:
 
 public:
 	explicit
-	Rpc(S::Bus& bus, Net::Fd socket);
+	Rpc( S::Bus& bus, Net::Fd socket
+	   , std::function<double()> get_now = &Ev::now
+	   );
 	Rpc(Rpc&&);
 	~Rpc();
 
 	Ev::Io<Jsmn::Object> command( std::string const& command
 				    , Json::Out params
 				    );
+
+	/** Boss::Mod::Rpc::command_streaming
+	 *
+	 * @brief like `command`, but the elements of
+	 * the array in the given field of the result
+	 * are passed to the visitor one at a time as
+	 * they arrive, and the returned result has
+	 * that field as an empty array.
+	 *
+	 * @desc use this for commands that can return
+	 * very large arrays, such as `listchannels`
+	 * or `listpays`, so that only one element is
+	 * held in memory at a time.
+	 *
+	 * The visitor is called directly from the
+	 * socket read handler, so it must return
+	 * quickly and must not throw.
+	 * It is called for all elements before the
+	 * returned action completes.
+	 *
+	 * Elements are only streamed if the response
+	 * has its `id` before its `result`, as
+	 * `lightningd` writes them; otherwise the
+	 * field is left as-is in the returned result,
+	 * so callers should also visit whatever
+	 * elements remain there.
+	 * If an element is not valid JSON, the
+	 * returned action fails with
+	 * `Jsmn::ParseError`.
+	 */
+	Ev::Io<Jsmn::Object>
+	command_streaming( std::string const& command
+			 , Json::Out params
+			 , std::string const& field
+			 , std::function<void(Jsmn::Object)> visitor
+			 );
+
+	/** Boss::Mod::Rpc::command_many
+	 *
+	 * @brief sends a batch of commands, given as
+	 * pairs of method name and parameters, in a
+	 * single write, and waits for all of them to
+	 * complete.
+	 *
+	 * @desc lightningd handles the commands
+	 * concurrently and responses are matched as
+	 * they arrive, in any order.
+	 * Each command in the batch counts against
+	 * the limit on concurrent RPC commands.
+	 *
+	 * The result has one entry per command, in
+	 * the same order, each being the entire
+	 * JSON-RPC response object: it has a `result`
+	 * field on success or an `error` field on
+	 * failure; use `Rpc::result_of` to extract
+	 * the former or throw `RpcError`.
+	 * A failing command does not fail the batch;
+	 * only shutting down does.
+	 */
+	Ev::Io<std::vector<Jsmn::Object>>
+	command_many(std::vector<std::pair<std::string, Json::Out>> commands);
+
+	/* Forget all cached results.  */
+	void invalidate_cache();
+
+	/* Extract the `result` from an entry returned by
+	 * `command_many`, or throw `RpcError` with the
+	 * given command name.  */
+	static
+	Jsmn::Object result_of( std::string const& command
+			      , Jsmn::Object const& response
+			      );
 };
 
 }}
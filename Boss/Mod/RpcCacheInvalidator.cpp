@@ -0,0 +1,75 @@
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Mod/RpcCacheInvalidator.hpp"
+#include"Boss/Msg/Init.hpp"
+#include"Boss/Msg/ManifestNotification.hpp"
+#include"Boss/Msg/Manifestation.hpp"
+#include"Boss/Msg/Notification.hpp"
+#include"Ev/Io.hpp"
+#include"S/Bus.hpp"
+#include"Util/make_unique.hpp"
+
+namespace {
+
+/* Notifications after which cached `listpeers`,
+ * `listpeerchannels`, or `listchannels` results would
+ * show the wrong connections or channel states.  */
+char const* const invalidating_notifications[] = {
+	"connect",
+	"disconnect",
+	"channel_opened",
+	"channel_state_changed",
+};
+
+}
+
+namespace Boss { namespace Mod {
+
+class RpcCacheInvalidator::Impl {
+private:
+	S::Bus& bus;
+	Boss::Mod::Rpc* rpc;
+
+	void start() {
+		rpc = nullptr;
+
+		bus.subscribe<Msg::Manifestation
+			     >([this](Msg::Manifestation const&) {
+			auto act = Ev::lift();
+			for (auto n : invalidating_notifications)
+				act += bus.raise(Msg::ManifestNotification{n});
+			return act;
+		});
+		bus.subscribe<Msg::Init
+			     >([this](Msg::Init const& init) {
+			rpc = &init.rpc;
+			return Ev::lift();
+		});
+		bus.subscribe<Msg::Notification
+			     >([this](Msg::Notification const& n) {
+			if (!rpc)
+				return Ev::lift();
+			for (auto name : invalidating_notifications) {
+				if (n.notification == name) {
+					rpc->invalidate_cache();
+					break;
+				}
+			}
+			return Ev::lift();
+		});
+	}
+
+public:
+	Impl() =delete;
+	Impl(Impl const&) =delete;
+
+	explicit
+	Impl(S::Bus& bus_) : bus(bus_) { start(); }
+};
+
+RpcCacheInvalidator::RpcCacheInvalidator(RpcCacheInvalidator&&) =default;
+RpcCacheInvalidator::~RpcCacheInvalidator() =default;
+
+RpcCacheInvalidator::RpcCacheInvalidator(S::Bus& bus)
+	: pimpl(Util::make_unique<Impl>(bus)) { }
+
+}}
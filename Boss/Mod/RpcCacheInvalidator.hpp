@@ -0,0 +1,41 @@
+#ifndef BOSS_MOD_RPCCACHEINVALIDATOR_HPP
+#define BOSS_MOD_RPCCACHEINVALIDATOR_HPP
+
+#include<memory>
+
+namespace S { class Bus; }
+
+namespace Boss { namespace Mod {
+
+/** class Boss::Mod::RpcCacheInvalidator
+ *
+ * @brief clears the result cache of `Boss::Mod::Rpc`
+ * when `lightningd` notifies us that peers or channels
+ * changed.
+ *
+ * @desc `Boss::Mod::Rpc` is only constructed after
+ * manifestation, so this module subscribes to the
+ * notifications for it.
+ * Notifications that only shift channel balances,
+ * such as payments and forwards, come at a high rate
+ * and do not clear the cache; the cache lifetime
+ * bounds how stale balances can get.
+ */
+class RpcCacheInvalidator {
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	RpcCacheInvalidator() =delete;
+	RpcCacheInvalidator(RpcCacheInvalidator const&) =delete;
+
+	RpcCacheInvalidator(RpcCacheInvalidator&&);
+	~RpcCacheInvalidator();
+	explicit
+	RpcCacheInvalidator(S::Bus& bus);
+};
+
+}}
+
+#endif /* BOSS_MOD_RPCCACHEINVALIDATOR_HPP */
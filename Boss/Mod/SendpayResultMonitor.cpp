@@ -8,6 +8,7 @@
 #include"Boss/Msg/Timer10Minutes.hpp"
 #include"Boss/concurrent.hpp"
 #include"Boss/log.hpp"
+#include"Boss/migrate_hex_to_blob.hpp"
 #include"Ev/Io.hpp"
 #include"Ev/now.hpp"
 #include"Jsmn/Object.hpp"
@@ -63,13 +64,13 @@ private:
 		bus.subscribe<Msg::DbResource
 			     >([this](Msg::DbResource const& m) {
 			db = m.db;
-			return db.transact().then([](Sqlite3::Tx tx) {
+			return db.transact().then([this](Sqlite3::Tx tx) {
 				tx.query_execute(R"QRY(
 				CREATE TABLE
 				       IF NOT EXISTS "SendpayResultMonitor"
-				     ( payment_hash TEXT NOT NULL
+				     ( payment_hash BLOB NOT NULL
 				     , partid INTEGER NOT NULL
-				     , first_hop TEXT NOT NULL
+				     , first_hop BLOB NOT NULL
 				     , creation REAL NOT NULL
 				     );
 				CREATE UNIQUE INDEX
@@ -79,7 +80,7 @@ private:
 
 				CREATE TABLE IF NOT EXISTS
 				       "SendpayResultMonitor_rl"
-				      ( payment_hash TEXT NOT NULL
+				      ( payment_hash BLOB NOT NULL
 				      , partid INTEGER NOT NULL
 				      , route_len INTEGER NOT NULL
 				      , FOREIGN KEY(payment_hash, partid)
@@ -92,8 +93,23 @@ private:
 				    ON "SendpayResultMonitor_rl"
 				       (payment_hash, partid);
 				)QRY");
+				/* Older versions stored hashes and node
+				 * IDs as hex text.  */
+				auto migrated = migrate_hex_to_blob(
+					tx, "SendpayResultMonitor_blob", {
+					{"SendpayResultMonitor_rl", "payment_hash"},
+					{"SendpayResultMonitor", "payment_hash"},
+					{"SendpayResultMonitor", "first_hop"}
+				});
 				tx.commit();
-				return Ev::lift();
+				if (migrated == 0)
+					return Ev::lift();
+				return Boss::log( bus, Info
+						, "SendpayResultMonitor: "
+						  "Migrated %zu hashes and "
+						  "node IDs to binary."
+						, migrated
+						);
 			});
 		});
 		/* Extract the first hop for the payment, from the
@@ -269,12 +285,15 @@ private:
 		auto route_len = std::shared_ptr<std::size_t>(
 			std::move(n_route_len)
 		);
-		return db.transact().then([ this
-					  , payment_hash
-					  , partid
-					  , first_hop
-					  , route_len
-					  ](Sqlite3::Tx tx) {
+		/* The result handlers go through `transact`, which
+		 * applies these first.  */
+		auto creation = Ev::now();
+		return db.write_behind([ payment_hash
+				       , partid
+				       , first_hop
+				       , route_len
+				       , creation
+				       ](Sqlite3::Tx& tx) {
 			tx.query(R"QRY(
 			INSERT OR REPLACE
 			  INTO "SendpayResultMonitor"
@@ -284,14 +303,10 @@ private:
 			      , :creation
 			      )
 			)QRY")
-				.bind( ":payment_hash"
-				     , std::string(payment_hash)
-				     )
+				.bind(":payment_hash", payment_hash)
 				.bind(":partid" , partid)
-				.bind( ":first_hop"
-				     , std::string(first_hop)
-				     )
-				.bind(":creation", Ev::now())
+				.bind(":first_hop", first_hop)
+				.bind(":creation", creation)
 				.execute()
 				;
 			if (route_len) {
@@ -303,15 +318,18 @@ private:
 				      , :route_len
 				      );
 				)QRY")
-					.bind( ":payment_hash"
-					     , std::string(payment_hash)
-					     )
+					.bind(":payment_hash", payment_hash)
 					.bind(":partid" , partid)
 					.bind(":route_len", *route_len)
 					.execute()
 					;
 			}
-			tx.commit();
+		}).then([ this
+			, payment_hash
+			, partid
+			, first_hop
+			, route_len
+			]() {
 			return Boss::log( bus, Debug
 					, "SendpayResultMonitor: "
 					  "Monitoring %s part %" PRIu64
@@ -430,9 +448,7 @@ private:
 			   AND partid = :partid
 			     ;
 			)QRY")
-				.bind( ":payment_hash"
-				     , std::string(payment_hash)
-				     )
+				.bind(":payment_hash", payment_hash)
 				.bind(":partid", partid)
 				.execute();
 			tx.commit();
@@ -483,17 +499,13 @@ private:
 		   AND partid = :partid
 		     ;
 		)QRY")
-			.bind( ":payment_hash"
-			     , std::string(payment_hash)
-			     )
+			.bind(":payment_hash", payment_hash)
 			.bind(":partid", partid)
 			.execute();
 
 		auto found = false;
 		for (auto& r : fetch) {
-			first_hop = Ln::NodeId(
-				r.get<std::string>(0)
-			);
+			first_hop = r.get<Ln::NodeId>(0);
 			creation = r.get<double>(1);
 			found = true;
 		}
@@ -508,9 +520,7 @@ private:
 		   AND partid = :partid
 		     ;
 		)QRY")
-			.bind( ":payment_hash"
-			     , std::string(payment_hash)
-			     )
+			.bind(":payment_hash", payment_hash)
 			.bind(":partid", partid)
 			.execute();
 		/* This could return empty, i.e. from old database.  */
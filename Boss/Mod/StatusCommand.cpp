@@ -20,6 +20,7 @@ void StatusCommand::start() {
 		std::bind(&This::on_manifest, this, _1)
 	);
 	bus.subscribe<Msg::CommandRequest>(
+		"clboss-status",
 		std::bind(&This::on_command, this, _1)
 	);
 	bus.subscribe<Msg::ProvideStatus>(
@@ -33,9 +34,6 @@ Ev::Io<void> StatusCommand::on_manifest(Boss::Msg::Manifestation const&) {
 	});
 }
 Ev::Io<void> StatusCommand::on_command(Boss::Msg::CommandRequest const& c) {
-	if (c.command != "clboss-status")
-		return Ev::lift();
-
 	/* Could happen as a race condition.
 	 * Just busy-spin.
 	 */
@@ -98,9 +98,7 @@ private:
 			});
 		});
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& r) {
-			if (r.command != "clboss-swaps")
-				return Ev::lift();
+			     >("clboss-swaps", [this](Msg::CommandRequest const& r) {
 			auto id = r.id;
 			if (!db)
 				return bus.raise(Msg::CommandResponse{
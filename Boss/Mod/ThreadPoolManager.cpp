@@ -0,0 +1,94 @@
+#include"Boss/Mod/ThreadPoolManager.hpp"
+#include"Boss/Msg/ManifestOption.hpp"
+#include"Boss/Msg/Manifestation.hpp"
+#include"Boss/Msg/Option.hpp"
+#include"Boss/Msg/ProvideStatus.hpp"
+#include"Boss/Msg/SolicitStatus.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/ThreadPool.hpp"
+#include"Jsmn/Object.hpp"
+#include"Json/Out.hpp"
+#include"S/Bus.hpp"
+#include"Util/make_unique.hpp"
+
+namespace Boss { namespace Mod {
+
+class ThreadPoolManager::Impl {
+private:
+	S::Bus& bus;
+	Ev::ThreadPool& threadpool;
+
+	void start() {
+		bus.subscribe<Msg::Manifestation
+			     >([this](Msg::Manifestation const&) {
+			return bus.raise(Msg::ManifestOption{
+				"clboss-threads",
+				Msg::OptionType_Int,
+				Json::Out::direct(0),
+				"Number of background threads for blocking "
+				"operations, including one reserved for "
+				"interactive work, so at least 2; 0 picks "
+				"one based on the number of cores."
+			});
+		});
+		bus.subscribe<Msg::Option
+			     >([this](Msg::Option const& o) {
+			if (o.name != "clboss-threads")
+				return Ev::lift();
+			auto n = double(o.value);
+			if (n < 1)
+				return Ev::lift();
+			threadpool.set_num_threads(std::size_t(n));
+			return Boss::log( bus, Info
+					, "ThreadPoolManager: Using %zu "
+					  "background threads."
+					, threadpool.get_stats().threads
+					);
+		});
+
+		bus.subscribe<Msg::SolicitStatus
+			     >([this](Msg::SolicitStatus const&) {
+			auto s = threadpool.get_stats();
+			auto out = Json::Out()
+				.start_object()
+					.field("threads", std::uint64_t(s.threads))
+					.field("busy", std::uint64_t(s.busy))
+					.field( "interactive_queued"
+					      , std::uint64_t(s.interactive_queued)
+					      )
+					.field( "bulk_queued"
+					      , std::uint64_t(s.bulk_queued)
+					      )
+					.field("completed", s.completed)
+					.field("mean_wait_seconds", s.mean_wait)
+					.field("max_wait_seconds", s.max_wait)
+					.field("mean_run_seconds", s.mean_run)
+					.field("max_run_seconds", s.max_run)
+				.end_object()
+				;
+			return bus.raise(Msg::ProvideStatus{
+				"threadpool", std::move(out)
+			});
+		});
+	}
+
+public:
+	Impl() =delete;
+	Impl(Impl&&) =delete;
+
+	Impl( S::Bus& bus_
+	    , Ev::ThreadPool& threadpool_
+	    ) : bus(bus_)
+	      , threadpool(threadpool_)
+	      { start(); }
+};
+
+ThreadPoolManager::ThreadPoolManager(ThreadPoolManager&&) =default;
+ThreadPoolManager::~ThreadPoolManager() =default;
+
+ThreadPoolManager::ThreadPoolManager( S::Bus& bus
+				    , Ev::ThreadPool& threadpool
+				    ) : pimpl(Util::make_unique<Impl>(bus, threadpool)) { }
+
+}}
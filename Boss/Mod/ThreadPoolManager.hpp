@@ -0,0 +1,32 @@
+#ifndef BOSS_MOD_THREADPOOLMANAGER_HPP
+#define BOSS_MOD_THREADPOOLMANAGER_HPP
+
+#include<memory>
+
+namespace Ev { class ThreadPool; }
+namespace S { class Bus; }
+
+namespace Boss { namespace Mod {
+
+/** class Boss::Mod::ThreadPoolManager
+ *
+ * @brief Sizes the background thread pool from the
+ * `clboss-threads` option, and reports its queue depths
+ * and task latencies on `clboss-status`.
+ */
+class ThreadPoolManager {
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	ThreadPoolManager() =delete;
+	ThreadPoolManager(ThreadPoolManager&&);
+	~ThreadPoolManager();
+
+	ThreadPoolManager(S::Bus&, Ev::ThreadPool&);
+};
+
+}}
+
+#endif /* !defined(BOSS_MOD_THREADPOOLMANAGER_HPP) */
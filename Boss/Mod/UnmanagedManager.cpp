@@ -97,9 +97,7 @@ private:
 			});
 		});
 		bus.subscribe<Msg::CommandRequest
-			     >([this](Msg::CommandRequest const& m) {
-			if (m.command != "clboss-unmanage")
-				return Ev::lift();
+			     >("clboss-unmanage", [this](Msg::CommandRequest const& m) {
 			return unmanage(m.id, m.params);
 		});
 
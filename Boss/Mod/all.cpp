@@ -23,6 +23,7 @@
 #include"Boss/Mod/ConnectFinderByHardcode.hpp"
 #include"Boss/Mod/Connector.hpp"
 #include"Boss/Mod/CommandReceiver.hpp"
+#include"Boss/Mod/DbMaintainer.hpp"
 #include"Boss/Mod/Dowser.hpp"
 #include"Boss/Mod/EarningsRebalancer.hpp"
 #include"Boss/Mod/EarningsTracker.hpp"
@@ -32,6 +33,7 @@
 #include"Boss/Mod/FeeModderBySize.hpp"
 #include"Boss/Mod/ForwardFeeMonitor.hpp"
 #include"Boss/Mod/FundsMover/Main.hpp"
+#include"Boss/Mod/GossipGraphTracker.hpp"
 #include"Boss/Mod/HtlcAcceptor.hpp"
 #include"Boss/Mod/InitialConnect.hpp"
 #include"Boss/Mod/InitialRebalancer.hpp"
@@ -45,6 +47,7 @@
 #include"Boss/Mod/ListpaysHandler.hpp"
 #include"Boss/Mod/ListpeersAnalyzer.hpp"
 #include"Boss/Mod/ListpeersAnnouncer.hpp"
+#include"Boss/Mod/LogManager.hpp"
 #include"Boss/Mod/Manifester.hpp"
 #include"Boss/Mod/MoveFundsCommand.hpp"
 #include"Boss/Mod/NeedsConnectSolicitor.hpp"
@@ -63,12 +66,14 @@
 #include"Boss/Mod/RebalanceUnmanager.hpp"
 #include"Boss/Mod/Reconnector.hpp"
 #include"Boss/Mod/RegularActiveProbe.hpp"
+#include"Boss/Mod/RpcCacheInvalidator.hpp"
 #include"Boss/Mod/RpcWrapper.hpp"
 #include"Boss/Mod/SelfUptimeMonitor.hpp"
 #include"Boss/Mod/SendpayResultMonitor.hpp"
 #include"Boss/Mod/StatusCommand.hpp"
 #include"Boss/Mod/SwapManager.hpp"
 #include"Boss/Mod/SwapReporter.hpp"
+#include"Boss/Mod/ThreadPoolManager.hpp"
 #include"Boss/Mod/TimerTwiceDailyAnnouncer.hpp"
 #include"Boss/Mod/Timers.hpp"
 #include"Boss/Mod/UnmanagedManager.hpp"
@@ -112,9 +117,12 @@ std::shared_ptr<void> all( std::ostream& cout
 							   , *waiter
 							   );
 	all->install<JsonOutputter>(cout, bus);
+	all->install<LogManager>(bus);
 	all->install<CommandReceiver>(bus);
 	all->install<RpcWrapper>(bus);
+	all->install<RpcCacheInvalidator>(bus);
 	all->install<AvailableRpcCommandsAnnouncer>(bus);
+	all->install<ThreadPoolManager>(bus, threadpool);
 
 	/* Startup.  */
 	all->install<Manifester>(bus);
@@ -139,7 +147,7 @@ std::shared_ptr<void> all( std::ostream& cout
 
 	/* Status monitors.  */
 	all->install<ChannelFundsComputer>(bus);
-	all->install<ListpeersAnnouncer>(bus);
+	all->install<ListpeersAnnouncer>(bus, *waiter);
 	all->install<ListpeersAnalyzer>(bus);
 	all->install<OnchainFeeMonitor>(bus, *waiter);
 	all->install<ListfundsAnnouncer>(bus);
@@ -148,12 +156,13 @@ std::shared_ptr<void> all( std::ostream& cout
 	all->install<OnchainFundsIgnorer>(bus);
 	all->install<ChannelCreateDestroyMonitor>(bus);
 	all->install<SelfUptimeMonitor>(bus);
+	all->install<GossipGraphTracker>(bus);
 
 	/* Channel creation wrangling.  */
-	all->install<ChannelFinderByDistance>(bus, *waiter);
+	all->install<ChannelFinderByDistance>(bus, *waiter, threadpool);
 	all->install<ChannelFinderByEarnedFee>(bus);
 	all->install<ChannelFinderByListpays>(bus);
-	all->install<ChannelFinderByPopularity>(bus, *waiter);
+	all->install<ChannelFinderByPopularity>(bus, *waiter, threadpool);
 	all->install<ChannelCandidatePreinvestigator>(bus);
 	auto investigator = all->install< ChannelCandidateInvestigator::Main
 					>(bus, *imon);
@@ -165,6 +174,9 @@ std::shared_ptr<void> all( std::ostream& cout
 	/* Status.  */
 	all->install<StatusCommand>(bus);
 
+	/* Database maintenance.  */
+	all->install<DbMaintainer>(bus, *waiter);
+
 	/* Offchain-to-onchain swap.  */
 	all->install<NewaddrHandler>(bus);
 	all->install<BoltzSwapper::Main>(bus, threadpool);
@@ -180,7 +192,7 @@ std::shared_ptr<void> all( std::ostream& cout
 
 	/* Channel fees.  */
 	all->install<FeeMonitor>(bus);
-	all->install<PeerCompetitorFeeMonitor::Main>(bus);
+	all->install<PeerCompetitorFeeMonitor::Main>(bus, threadpool);
 	all->install<ChannelFeeSetter>(bus);
 	all->install<ChannelFeeManager>(bus);
 	all->install<FeeModderBySize>(bus);
@@ -8,7 +8,8 @@ namespace Boss { namespace Msg {
 /** struct Boss::Msg::ChannelFunds
  *
  * @brief periodically emitted to inform all modules
- * of channel funds.
+ * of channel funds, and also soon after peers or
+ * channels change.
  */
 struct ChannelFunds {
 	/* Total on all channels.  */
@@ -3,6 +3,7 @@
 
 #include"Jsmn/Object.hpp"
 #include"Ln/CommandId.hpp"
+#include"S/Key.hpp"
 #include<cstdint>
 #include<string>
 
@@ -13,6 +14,11 @@ namespace Boss { namespace Msg {
  * @brief emitted whenever a command or hook is
  * received on stdin.
  * Respond by Boss::Msg::CommandResponse.
+ *
+ * @desc Handlers should subscribe with the command
+ * as key, i.e.
+ * `bus.subscribe<Msg::CommandRequest>("command", ...)`,
+ * so that each request goes only to its handler.
  */
 struct CommandRequest {
 	std::string command;
@@ -22,4 +28,11 @@ struct CommandRequest {
 
 }}
 
+template<>
+struct S::Key<Boss::Msg::CommandRequest> {
+	static std::string const& get(Boss::Msg::CommandRequest const& m) {
+		return m.command;
+	}
+};
+
 #endif /* !defined(BOSS_MSG_COMMANDREQUEST_HPP) */
@@ -5,8 +5,16 @@
 
 namespace Boss { namespace Msg {
 
+/** struct Boss::Msg::JsonCout
+ *
+ * @brief emit to send a JSON object to lightningd.
+ */
 struct JsonCout {
 	Json::Out obj;
+	/* Set for notifications such as log lines, which
+	 * nothing waits on; responses to commands and hooks
+	 * are sent before any queued notifications.  */
+	bool notification = false;
 };
 
 }}
@@ -0,0 +1,28 @@
+#ifndef BOSS_MSG_LISTPEERSANALYZEDCHANGED_HPP
+#define BOSS_MSG_LISTPEERSANALYZEDCHANGED_HPP
+
+#include"Boss/Msg/ListpeersAnalyzedResult.hpp"
+#include"Ln/NodeId.hpp"
+#include<set>
+
+namespace Boss { namespace Msg {
+
+/** struct Boss::Msg::ListpeersAnalyzedChanged
+ *
+ * @brief message derived from `Boss::Msg::ListpeersChanged`
+ * with the peers split up into the same bins as in
+ * `Boss::Msg::ListpeersAnalyzedResult`.
+ *
+ * @desc `analyzed` covers all peers, and its `initial`
+ * is always false; `changed` names the peers whose
+ * connection or channels changed, which may be in no
+ * bin if they no longer have any channels.
+ */
+struct ListpeersAnalyzedChanged {
+	std::set<Ln::NodeId> changed;
+	ListpeersAnalyzedResult analyzed;
+};
+
+}}
+
+#endif /* !defined(BOSS_MSG_LISTPEERSANALYZEDCHANGED_HPP) */
@@ -0,0 +1,33 @@
+#ifndef BOSS_MSG_LISTPEERSCHANGED_HPP
+#define BOSS_MSG_LISTPEERSCHANGED_HPP
+
+#include"Boss/Mod/ConstructedListpeers.hpp"
+#include"Ln/NodeId.hpp"
+#include<set>
+
+namespace Boss { namespace Msg {
+
+/** struct Boss::Msg::ListpeersChanged
+ *
+ * @brief announced soon after the connection or
+ * channels of some peers change, as told by
+ * notifications from `lightningd`, or when the
+ * 10-minute `Boss::Msg::ListpeersResult` finds
+ * changes that were missed.
+ * The first `Boss::Msg::ListpeersResult` is also
+ * announced as a change to all its peers.
+ *
+ * @desc `cpeers` is the entire current state, in the
+ * same form as in `Boss::Msg::ListpeersResult`, so
+ * that modules can update just the `changed` peers.
+ * A changed peer missing from `cpeers` no longer has
+ * any channels.
+ */
+struct ListpeersChanged {
+	std::set<Ln::NodeId> changed;
+	Boss::Mod::ConstructedListpeers cpeers;
+};
+
+}}
+
+#endif /* !defined(BOSS_MSG_LISTPEERSCHANGED_HPP) */
@@ -0,0 +1,22 @@
+#ifndef BOSS_MSG_REQUESTGOSSIPGRAPH_HPP
+#define BOSS_MSG_REQUESTGOSSIPGRAPH_HPP
+
+namespace Boss { namespace Msg {
+
+/** struct Boss::Msg::RequestGossipGraph
+ *
+ * @brief Requests a snapshot of the public channel
+ * graph.
+ *
+ * @desc Handled by `Boss::Mod::GossipGraphTracker`,
+ * which responds with `Boss::Msg::ResponseGossipGraph`.
+ * Modules should use this instead of walking the
+ * network with one `listchannels` per node.
+ */
+struct RequestGossipGraph {
+	void* requester;
+};
+
+}}
+
+#endif /* !defined(BOSS_MSG_REQUESTGOSSIPGRAPH_HPP) */
@@ -0,0 +1,31 @@
+#ifndef BOSS_MSG_RESPONSEGOSSIPGRAPH_HPP
+#define BOSS_MSG_RESPONSEGOSSIPGRAPH_HPP
+
+#include<memory>
+
+namespace Ln { class GossipGraph; }
+
+namespace Boss { namespace Msg {
+
+/** struct Boss::Msg::ResponseGossipGraph
+ *
+ * @brief Emitted in response to `Boss::Msg::RequestGossipGraph`.
+ *
+ * @desc The graph is shared by all requesters and is
+ * never modified; the tracker applies updates to its
+ * own copy and hands out a new snapshot afterwards.
+ * It is never null, but may be empty if `lightningd`
+ * could not be queried.
+ *
+ * Compare `graph->generation()` with that of an
+ * earlier response to tell if the network has changed
+ * since then.
+ */
+struct ResponseGossipGraph {
+	void* requester;
+	std::shared_ptr<Ln::GossipGraph const> graph;
+};
+
+}}
+
+#endif /* !defined(BOSS_MSG_RESPONSEGOSSIPGRAPH_HPP) */
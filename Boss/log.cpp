@@ -1,13 +1,62 @@
 #include"Boss/Msg/JsonCout.hpp"
 #include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/now.hpp"
 #include"Json/Out.hpp"
 #include"S/Bus.hpp"
 #include"Util/Str.hpp"
+#include<deque>
 #include<stdarg.h>
 
+namespace {
+
+auto history_size = std::size_t(0);
+auto history = std::deque<Boss::LogRecord>();
+
+}
+
 namespace Boss {
 
+namespace Detail { LogLevel log_level = Debug; }
+
+void set_log_level(LogLevel l) {
+	Detail::log_level = l;
+}
+
+void set_log_history(std::size_t size) {
+	history_size = size;
+	while (history.size() > history_size)
+		history.pop_front();
+}
+std::vector<LogRecord> get_log_history() {
+	return std::vector<LogRecord>(history.begin(), history.end());
+}
+
+char const* log_level_string(LogLevel l) {
+	switch (l) {
+	case Debug: return "debug";
+	case Info: return "info";
+	case Warn: return "warn";
+	case Error: return "error";
+	}
+	return "debug";
+}
+bool log_level_from_string(LogLevel& l, std::string const& s) {
+	for (auto c : {Debug, Info, Warn, Error}) {
+		if (s == log_level_string(c)) {
+			l = c;
+			return true;
+		}
+	}
+	return false;
+}
+
 Ev::Io<void> log(S::Bus& bus, LogLevel l, const char *fmt, ...) {
+	/* Messages below the log level are still kept in
+	 * the history, so `clboss-logs` can show them.  */
+	if (!log_enabled(l) && history_size == 0)
+		return Ev::lift();
+
 	va_list ap;
 
 	auto msg = std::string();
@@ -16,30 +65,29 @@ Ev::Io<void> log(S::Bus& bus, LogLevel l, const char *fmt, ...) {
 	msg = Util::Str::vfmt(fmt, ap);
 	va_end(ap);
 
-	auto level_string = std::string();
-	switch (l) {
-	case Debug: level_string = std::string("debug"); break;
-	case Info: level_string = std::string("info"); break;
-	case Warn: level_string = std::string("warn"); break;
-	case Error: level_string = std::string("error"); break;
+	if (history_size != 0) {
+		if (history.size() == history_size)
+			history.pop_front();
+		history.push_back(LogRecord{Ev::now(), l, msg});
 	}
+	if (!log_enabled(l))
+		return Ev::lift();
 
 	auto js = Json::Out()
 		.start_object()
 			.field("jsonrpc", std::string("2.0"))
 			.field("method", std::string("log"))
 			.start_object("params")
-				.field("level", level_string)
+				.field("level", std::string(log_level_string(l)))
 				.field("message", msg)
 			.end_object()
 		.end_object()
 		;
 
 	/* TODO: Instead of raising JsonCout directly, raise a
-	 * Log message and have a module translate that, as well as
-	 * possibly save the log for programmatic access.  */
+	 * Log message and have a module translate that.  */
 
-	return bus.raise(Boss::Msg::JsonCout{std::move(js)});
+	return bus.raise(Boss::Msg::JsonCout{std::move(js), true});
 }
 
 }
@@ -5,6 +5,10 @@
 # include"config.h"
 #endif
 
+#include<cstddef>
+#include<string>
+#include<vector>
+
 namespace Ev { template<typename a> class Io; }
 namespace S { class Bus; }
 
@@ -23,6 +27,75 @@ Ev::Io<void> log(S::Bus& bus, LogLevel l, const char *fmt, ...)
 #endif
 ;
 
+namespace Detail { extern LogLevel log_level; }
+
+/** Boss::log_enabled
+ *
+ * @brief determines if a message at the given level
+ * would be emitted by `Boss::log`.
+ *
+ * @desc Use this to skip building expensive arguments
+ * for messages that would just be dropped.
+ */
+inline
+bool log_enabled(LogLevel l) {
+	return l >= Detail::log_level;
+}
+
+/** Boss::set_log_level
+ *
+ * @brief sets the minimum level of messages that
+ * `Boss::log` emits.
+ * Messages below it are not emitted, and are
+ * dropped before being formatted unless a log
+ * history is kept.
+ * Defaults to `Debug`, i.e. everything is emitted.
+ */
+void set_log_level(LogLevel l);
+inline
+LogLevel get_log_level() {
+	return Detail::log_level;
+}
+
+/** Boss::LogRecord
+ *
+ * @brief a message kept in the log history.
+ */
+struct LogRecord {
+	double time;
+	LogLevel level;
+	std::string message;
+};
+
+/** Boss::set_log_history
+ *
+ * @brief keeps up to the given number of the most
+ * recent messages in memory, including those below
+ * the log level.
+ * 0, the default, keeps none.
+ */
+void set_log_history(std::size_t size);
+
+/** Boss::get_log_history
+ *
+ * @brief returns the messages kept in the log
+ * history, oldest first.
+ */
+std::vector<LogRecord> get_log_history();
+
+/** Boss::log_level_string
+ *
+ * @brief returns "debug", "info", "warn", or "error".
+ */
+char const* log_level_string(LogLevel l);
+
+/** Boss::log_level_from_string
+ *
+ * @brief parses the output of `log_level_string`.
+ * Returns false if the string is not a log level.
+ */
+bool log_level_from_string(LogLevel& l, std::string const& s);
+
 }
 
 #endif /* BOSS_LOG_HPP */
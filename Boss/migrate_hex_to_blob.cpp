@@ -0,0 +1,107 @@
+#include"Boss/migrate_hex_to_blob.hpp"
+#include"Sqlite3.hpp"
+#include"Util/Str.hpp"
+#include<cstdint>
+
+namespace {
+
+/* Rows changed by the last statement.  */
+std::int64_t changes(Sqlite3::Tx& tx) {
+	auto fetch = tx.query("SELECT changes();").execute();
+	for (auto& r : fetch)
+		return r.get<std::int64_t>(0);
+	return 0;
+}
+
+}
+
+namespace Boss {
+
+std::size_t
+migrate_hex_to_blob( Sqlite3::Tx& tx
+		   , std::string const& name
+		   , std::vector<std::pair<std::string, std::string>
+				> const& columns
+		   ) {
+	tx.query_execute(R"QRY(
+	CREATE TABLE IF NOT EXISTS "Boss_migrations"
+	     ( name TEXT PRIMARY KEY
+	     );
+	)QRY");
+	auto fetch = tx.query(R"QRY(
+	SELECT 1 FROM "Boss_migrations" WHERE name = :name;
+	)QRY")
+		.bind(":name", name)
+		.execute()
+		;
+	if (fetch.begin() != fetch.end())
+		return 0;
+
+	/* Referencing columns are converted before the keys
+	 * they reference, so they briefly refer to keys not
+	 * yet converted.  */
+	tx.query_execute("PRAGMA defer_foreign_keys = ON;");
+
+	auto count = std::size_t(0);
+	for (auto const& c : columns) {
+		auto const& table = c.first;
+		auto const& column = c.second;
+
+		/* Gather first, as updating rows while stepping
+		 * over the same table may revisit them.  */
+		auto rows = std::vector<std::pair< std::int64_t
+						 , std::string
+						 >>();
+		auto const select = std::string()
+			+ "SELECT rowid, \"" + column + "\""
+			+ "  FROM \"" + table + "\""
+			+ " WHERE typeof(\"" + column + "\") = 'text';"
+			;
+		auto res = tx.query(select.c_str()).execute();
+		for (auto& r : res)
+			rows.emplace_back( r.get<std::int64_t>(0)
+					 , r.get<std::string>(1)
+					 );
+
+		auto const update = std::string()
+			+ "UPDATE OR IGNORE \"" + table + "\""
+			+ "   SET \"" + column + "\" = :value"
+			+ " WHERE rowid = :rowid;"
+			;
+		auto const remove = std::string()
+			+ "DELETE FROM \"" + table + "\""
+			+ " WHERE rowid = :rowid;"
+			;
+		for (auto const& r : rows) {
+			if (!Util::Str::ishex(r.second))
+				continue;
+			tx.query(update.c_str())
+				.bind(":value", Util::Str::hexread(r.second))
+				.bind(":rowid", r.first)
+				.execute()
+				;
+			if (changes(tx) != 0) {
+				++count;
+				continue;
+			}
+			/* A row with the BLOB form of a unique key was
+			 * already written; keep that one and drop the
+			 * old row.  */
+			tx.query(remove.c_str())
+				.bind(":rowid", r.first)
+				.execute()
+				;
+		}
+	}
+
+	tx.query(R"QRY(
+	INSERT INTO "Boss_migrations" VALUES(:name);
+	)QRY")
+		.bind(":name", name)
+		.execute()
+		;
+
+	return count;
+}
+
+}
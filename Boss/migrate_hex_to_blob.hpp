@@ -0,0 +1,46 @@
+#ifndef BOSS_MIGRATE_HEX_TO_BLOB_HPP
+#define BOSS_MIGRATE_HEX_TO_BLOB_HPP
+
+#include<cstddef>
+#include<string>
+#include<utility>
+#include<vector>
+
+namespace Sqlite3 { class Tx; }
+
+namespace Boss {
+
+/** Boss::migrate_hex_to_blob()
+ *
+ * @brief converts node IDs and hashes that older
+ * versions stored as hex TEXT into BLOBs, in place,
+ * and returns the number of values converted.
+ *
+ * @desc `columns` is a list of table and column
+ * names.
+ * Columns that reference other columns in the list
+ * must come before the columns they reference.
+ *
+ * The migration is recorded under the given `name`
+ * in the `"Boss_migrations"` table, and is skipped
+ * once recorded.
+ * It is done in the given transaction, so an
+ * interrupted migration is simply redone on the next
+ * start.
+ * Each module migrates its own tables, so modules
+ * that already did so are not migrated again.
+ *
+ * If a row with the BLOB form of a unique key already
+ * exists, the old row is deleted instead, and is not
+ * counted as converted.
+ */
+std::size_t
+migrate_hex_to_blob( Sqlite3::Tx& tx
+		   , std::string const& name
+		   , std::vector<std::pair<std::string, std::string>
+				> const& columns
+		   );
+
+}
+
+#endif /* !defined(BOSS_MIGRATE_HEX_TO_BLOB_HPP) */
@@ -0,0 +1,107 @@
+#include<Ev/Detail/RunQueue.hpp>
+#include<ev.h>
+
+namespace {
+
+struct Node {
+	std::function<void()> f;
+	Node* next;
+};
+
+/* Intrusive FIFO of ready functions.  */
+Node* head = nullptr;
+Node* tail = nullptr;
+std::size_t queued = 0;
+
+/* Free list of nodes.  */
+Node* free_nodes = nullptr;
+std::size_t num_free = 0;
+auto constexpr max_free = std::size_t(1024);
+
+std::size_t budget = 0;
+
+ev_idle idler;
+bool idler_initted = false;
+
+void run_handler(EV_P_ ev_idle*, int);
+
+void start_idler() {
+	if (!idler_initted) {
+		ev_idle_init(&idler, &run_handler);
+		idler_initted = true;
+	}
+	if (!ev_is_active(&idler))
+		ev_idle_start(EV_DEFAULT_ &idler);
+}
+
+Node* pop() {
+	auto n = head;
+	head = n->next;
+	if (!head)
+		tail = nullptr;
+	--queued;
+	return n;
+}
+
+void release(Node* n) {
+	if (num_free >= max_free) {
+		delete n;
+		return;
+	}
+	n->next = free_nodes;
+	free_nodes = n;
+	++num_free;
+}
+
+void run_handler(EV_P_ ev_idle*, int) {
+	/* Functions queued while we run wait for the next
+	 * turn, so that I/O gets a chance in between.  */
+	auto count = queued;
+	if (budget != 0 && budget < count)
+		count = budget;
+
+	for (auto i = std::size_t(0); i < count; ++i) {
+		auto n = pop();
+		auto f = std::move(n->f);
+		n->f = nullptr;
+		release(n);
+		f();
+	}
+
+	if (!head)
+		ev_idle_stop(EV_A_ &idler);
+}
+
+}
+
+namespace Ev { namespace Detail {
+
+void run_later(std::function<void()> f) {
+	auto n = free_nodes;
+	if (n) {
+		free_nodes = n->next;
+		--num_free;
+	} else
+		n = new Node();
+	n->f = std::move(f);
+	n->next = nullptr;
+
+	if (tail)
+		tail->next = n;
+	else
+		head = n;
+	tail = n;
+	++queued;
+
+	start_idler();
+}
+
+}}
+
+namespace Ev {
+
+void set_yield_budget(std::size_t budget_) {
+	budget = budget_;
+}
+
+}
@@ -0,0 +1,22 @@
+#ifndef EV_DETAIL_RUNQUEUE_HPP
+#define EV_DETAIL_RUNQUEUE_HPP
+
+#include<functional>
+
+namespace Ev { namespace Detail {
+
+/* Queues a function to be called from the main loop, at
+ * the same point ev_idle watchers would be.
+ * Functions are called in the order they were queued.
+ *
+ * All queued functions share a single persistent ev_idle
+ * watcher and pooled queue entries, so queueing does not
+ * allocate in steady state.
+ *
+ * Must only be called from the main loop thread.
+ */
+void run_later(std::function<void()> f);
+
+}}
+
+#endif /* !defined(EV_DETAIL_RUNQUEUE_HPP) */
@@ -31,6 +31,29 @@ struct PassFunc<void> {
 	using type = std::function<void()>;
 };
 
+/* Makes a pass function that calls the pass function
+ * in a shared structure.  */
+template<typename a>
+struct ForwardPass {
+	template<typename Conts>
+	static
+	typename PassFunc<a>::type make(std::shared_ptr<Conts> pconts) {
+		return [pconts](a value) {
+			pconts->pass(std::move(value));
+		};
+	}
+};
+template<>
+struct ForwardPass<void> {
+	template<typename Conts>
+	static
+	PassFunc<void>::type make(std::shared_ptr<Conts> pconts) {
+		return [pconts]() {
+			pconts->pass();
+		};
+	}
+};
+
 /* Base for Io<a>.  */
 template<typename a>
 class IoBase {
@@ -53,29 +76,45 @@ public:
 
 	template<typename e>
 	Io<a> catching(std::function<Io<a>(e const&)> handler)&& {
-		auto pcore = std::make_shared<CoreFunc>(std::move(core));
-		auto phandler = std::make_shared<std::function<Io<a>(e const&)>>(std::move(handler));
-		return Io<a>([ pcore
-			     , phandler
+		struct Link {
+			CoreFunc core;
+			std::function<Io<a>(e const&)> handler;
+		};
+		/* Both the action and the handler may continue
+		 * into pass and fail, so share them instead of
+		 * copying them.  */
+		struct Conts {
+			typename Detail::PassFunc<a>::type pass;
+			std::function<void (std::exception_ptr)> fail;
+		};
+		auto plink = std::make_shared<Link>(Link{
+			std::move(core), std::move(handler)
+		});
+		return Io<a>([plink
 			     ]( typename Detail::PassFunc<a>::type pass
 			      , std::function<void (std::exception_ptr)> fail
 			      ) {
-			auto sub_fail = [ pass, fail
-					, phandler
+			auto pconts = std::make_shared<Conts>(Conts{
+				std::move(pass), std::move(fail)
+			});
+			auto sub_fail = [ pconts
+					, plink
 					](std::exception_ptr err) {
 				try {
 					std::rethrow_exception(err);
 				} catch (e const& err) {
 					try {
-						(*phandler)(err).core(pass, fail);
+						plink->handler(err).core( pconts->pass
+									, pconts->fail
+									);
 					} catch (...) {
-						fail(std::current_exception());
+						pconts->fail(std::current_exception());
 					}
 				} catch (...) {
-					fail(std::current_exception());
+					pconts->fail(std::current_exception());
 				}
 			};
-			(*pcore)(pass, sub_fail);
+			plink->core(Detail::ForwardPass<a>::make(pconts), sub_fail);
 		});
 	}
 };
@@ -94,19 +133,35 @@ public:
 	Io<typename Detail::IoInner<std::invoke_result_t<f, a>>::type>
 	then(f func)&& {
 		using b = typename Detail::IoInner<std::invoke_result_t<f, a>>::type;
-		auto pcore = std::make_shared<CoreFunc>(std::move(this->core));
-		auto pfunc = std::make_shared<f>(std::move(func));
+		struct Link {
+			CoreFunc core;
+			f func;
+		};
+		auto plink = std::make_shared<Link>(Link{
+			std::move(this->core), std::move(func)
+		});
 		/* Continuation Monad.  */
-		return Io<b>([ pcore
-			     , pfunc
+		return Io<b>([plink
 			     ]( typename Detail::PassFunc<b>::type pass
 			      , std::function<void (std::exception_ptr)> fail
 			      ) {
 			try {
-				auto sub_pass = [pfunc, pass, fail](a value) {
-					(*pfunc)(std::move(value)).core(pass, fail);
+				/* The continuation runs at most once, so
+				 * it can hand over pass and fail instead
+				 * of copying them.  */
+				auto sub_pass = [ plink
+						, pass = std::move(pass)
+						, fail
+						, done = false
+						](a value) mutable {
+					if (done)
+						return;
+					done = true;
+					plink->func(std::move(value)).core(
+						std::move(pass), std::move(fail)
+					);
 				};
-				(*pcore)(sub_pass, fail);
+				plink->core(std::move(sub_pass), fail);
 			} catch (...) {
 				fail(std::current_exception());
 			}
@@ -153,23 +208,37 @@ public:
 	Io<typename Detail::IoInner<std::invoke_result_t<f>>::type>
 	then(f func)&& {
 		using b = typename Detail::IoInner<std::invoke_result_t<f>>::type;
-		auto pcore = std::make_shared<CoreFunc>(std::move(this->core));
-		auto pfunc = std::make_shared<f>(std::move(func));
+		struct Link {
+			CoreFunc core;
+			f func;
+		};
+		auto plink = std::make_shared<Link>(Link{
+			std::move(this->core), std::move(func)
+		});
 		/* Continuation Monad.  */
-		return Io<b>([ pcore
-			     , pfunc
+		return Io<b>([plink
 			     ]( typename Detail::PassFunc<b>::type pass
 			      , std::function<void (std::exception_ptr)> fail
 			      ) {
 			try {
-				auto sub_pass = [pfunc, pass, fail]() {
+				/* As in Io<a>::then.  */
+				auto sub_pass = [ plink
+						, pass = std::move(pass)
+						, fail
+						, done = false
+						]() mutable {
+					if (done)
+						return;
+					done = true;
 					try {
-						(*pfunc)().core(pass, fail);
+						plink->func().core(
+							std::move(pass), fail
+						);
 					} catch (...) {
 						fail(std::current_exception());
 					}
 				};
-				(*pcore)(sub_pass, fail);
+				plink->core(std::move(sub_pass), fail);
 			} catch (...) {
 				fail(std::current_exception());
 			}
@@ -205,12 +274,22 @@ public:
 
 template<typename a>
 Io<a> lift(a val) {
-	auto container = std::make_shared<a>(std::move(val));
-	return Io<a>([container]( std::function<void(a)> pass
-				, std::function<void(std::exception_ptr)> fail
-				) {
-		pass(std::move(*container));
-	});
+	if constexpr (std::is_copy_constructible_v<a>) {
+		return Io<a>([val = std::move(val)
+			     ]( std::function<void(a)> pass
+			      , std::function<void(std::exception_ptr)> fail
+			      ) mutable {
+			pass(std::move(val));
+		});
+	} else {
+		/* std::function needs something copyable.  */
+		auto container = std::make_shared<a>(std::move(val));
+		return Io<a>([container]( std::function<void(a)> pass
+					, std::function<void(std::exception_ptr)> fail
+					) {
+			pass(std::move(*container));
+		});
+	}
 }
 inline
 Io<void> lift(void) {
@@ -225,9 +304,8 @@ Io<void> lift(void) {
 
 inline
 Ev::Io<void>& operator+=(Ev::Io<void>& a, Ev::Io<void> b) {
-	auto container = std::make_shared<Ev::Io<void>>(std::move(b));
-	a = std::move(a).then([container]() {
-		return std::move(*container);
+	a = std::move(a).then([b = std::move(b)]() mutable {
+		return std::move(b);
 	});
 	return a;
 }
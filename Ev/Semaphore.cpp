@@ -11,74 +11,89 @@ namespace Ev {
 
 class Semaphore::Impl {
 private:
+	std::size_t max;
 	std::size_t remaining;
 	/* A currently-pending process.  */
 	struct Process {
+		std::size_t units;
 		Ev::Io<void> action;
 		std::function<void()> pass;
 		std::function<void(std::exception_ptr)> fail;
-		Process( Ev::Io<void> action_
+		Process( std::size_t units_
+		       , Ev::Io<void> action_
 		       , std::function<void()> pass_
 		       , std::function<void(std::exception_ptr)> fail_
-		       ) : action(std::move(action_))
+		       ) : units(units_)
+			 , action(std::move(action_))
 			 , pass(std::move(pass_))
 			 , fail(std::move(fail_))
 			 { }
 	};
 	std::queue<Process> blocked;
 
-	void unblock() {
-		if (!blocked.empty()) {
-			assert(remaining == 0);
+	void unblock(std::size_t units) {
+		remaining += units;
+		/* Strictly first-come first-served, so that a
+		 * process needing many units is not starved
+		 * by later ones needing fewer.  */
+		while ( !blocked.empty()
+		     && blocked.front().units <= remaining
+		      ) {
 			auto& next = blocked.front();
+			auto next_units = next.units;
 			auto action = std::move(next.action);
 			auto pass = std::move(next.pass);
 			auto fail = std::move(next.fail);
 			blocked.pop();
-			handle( std::move(action)
+			remaining -= next_units;
+			handle( next_units
+			      , std::move(action)
 			      , std::move(pass)
 			      , std::move(fail)
 			      );
-		} else {
-			++remaining;
 		}
 	}
-	void handle( Ev::Io<void> action
+	void handle( std::size_t units
+		   , Ev::Io<void> action
 		   , std::function<void()> pass
 		   , std::function<void(std::exception_ptr)> fail
 		   ) {
 		/* Avoid copying functions, just move them.  */
 		auto ppass = std::make_shared<std::function<void()>>(std::move(pass));
 		auto pfail = std::make_shared<std::function<void(std::exception_ptr)>>(std::move(fail));
-		action.run([ppass, this]() {
-			unblock();
+		action.run([ppass, units, this]() {
+			unblock(units);
 			std::move(*ppass)();
-		}, [pfail, this](std::exception_ptr e) {
-			unblock();
+		}, [pfail, units, this](std::exception_ptr e) {
+			unblock(units);
 			std::move(*pfail)(e);
 		});
 	}
 
 public:
-	Impl(std::size_t max) : remaining(max), blocked() { }
+	Impl(std::size_t max_) : max(max_), remaining(max_), blocked() { }
 	Impl() =delete;
 	Impl(Impl const&) =delete;
 	Impl(Impl&&) =delete;
 
-	Ev::Io<void> run(Ev::Io<void> action_) {
+	Ev::Io<void> run(std::size_t units, Ev::Io<void> action_) {
+		if (units > max)
+			units = max;
 		auto action = std::make_shared<Ev::Io<void>>(std::move(action_));
-		return Ev::Io<void>([ this, action
+		return Ev::Io<void>([ this, units, action
 				    ]( std::function<void()> pass
 				     , std::function<void(std::exception_ptr)> fail
 				     ) {
-			if (remaining > 0) {
-				--remaining;
-				handle( std::move(*action)
+			if (blocked.empty() && remaining >= units) {
+				remaining -= units;
+				handle( units
+				      , std::move(*action)
 				      , std::move(pass)
 				      , std::move(fail)
 				      );
 			} else {
-				blocked.emplace( std::move(*action)
+				blocked.emplace( units
+					       , std::move(*action)
 					       , std::move(pass)
 					       , std::move(fail)
 					       );
@@ -94,8 +109,8 @@ Semaphore::~Semaphore() =default;
 Semaphore::Semaphore(std::size_t max)
 	: pimpl(Util::make_unique<Impl>(max)) { }
 
-Ev::Io<void> Semaphore::core_run(Ev::Io<void> action) {
-	return pimpl->run(Ev::yield() + std::move(action));
+Ev::Io<void> Semaphore::core_run(std::size_t units, Ev::Io<void> action) {
+	return pimpl->run(units, Ev::yield() + std::move(action));
 }
 
 }
@@ -55,7 +55,7 @@ private:
 	class Impl;
 	std::unique_ptr<Impl> pimpl;
 
-	Ev::Io<void> core_run(Ev::Io<void> action);
+	Ev::Io<void> core_run(std::size_t units, Ev::Io<void> action);
 
 public:
 	Semaphore() =delete;
@@ -82,8 +82,23 @@ public:
 	 */
 	template<typename a>
 	Ev::Io<a> run(Ev::Io<a> action) {
-		return Detail::SemaphoreRunHelper<a>::run(std::move(action), [this](Ev::Io<void> action) {
-			return core_run(std::move(action));
+		return run(1, std::move(action));
+	}
+	/*~
+	 * Execute the given action, counting it as
+	 * the given number of simultaneous runs,
+	 * e.g. for an action that is a batch of
+	 * smaller operations.
+	 *
+	 * The units are capped to the preconfigured
+	 * max number.
+	 * Blocked actions are resumed strictly in the
+	 * order they were started.
+	 */
+	template<typename a>
+	Ev::Io<a> run(std::size_t units, Ev::Io<a> action) {
+		return Detail::SemaphoreRunHelper<a>::run(std::move(action), [this, units](Ev::Io<void> action) {
+			return core_run(units, std::move(action));
 		});
 	}
 };
@@ -1,4 +1,6 @@
+#include<algorithm>
 #include<assert.h>
+#include<chrono>
 #include<condition_variable>
 #include<errno.h>
 #include<ev.h>
@@ -15,6 +17,14 @@
 #include"Util/BacktraceException.hpp"
 #include"Util/make_unique.hpp"
 
+#if HAVE_CONFIG_H
+#include"config.h"
+#endif
+
+#if HAVE_EVENTFD
+#include<sys/eventfd.h>
+#endif
+
 namespace {
 
 /* RAII class to block all signals while still alive.  */
@@ -41,122 +51,226 @@ namespace Ev {
 
 class ThreadPool::Impl {
 private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Work {
+		std::function<std::function<void()>()> func;
+		Clock::time_point added;
+	};
+
 	/*-------------------------------------------------------*/
 	/* These objects are handled only by the
 	 * main thread.
 	 */
-	/* Background threads.  */
+	/* Background threads, including any that
+	 * exited after set_num_threads but are not
+	 * joined yet.  */
 	std::vector<std::thread> threads;
+	/* Whether one thread is reserved for
+	 * interactive work.  */
+	bool has_interactive_thread;
+	/* Number of threads that take any work.  */
+	std::size_t num_general;
 
 	/* Number of pending added tasks.  */
 	std::size_t num_tasks;
 
 	/* An ev_io watcher that is waiting for
-	 * the read pipe.
+	 * the wakeup fd.
 	 */
 	std::unique_ptr<ev_io> io_waiter;
 
 	/*-------------------------------------------------------*/
-	/* This is only set during initialization.  */
-	int pipe_write;
-	int pipe_read;
+	/* This is only set during initialization.
+	 * With eventfd, both are the same fd.
+	 */
+	int wake_write;
+	int wake_read;
 
 	/*-------------------------------------------------------*/
 	/* These objects are shared across threads.
 	 * Hold the mutex while using these!
 	 */
-	std::mutex mtx;
+	mutable std::mutex mtx;
 
 	/* Used to wake up a background thread if
-	 * there is work to be done.
+	 * there is work to be done; the interactive
+	 * thread waits on its own.
 	 */
 	std::condition_variable cnd;
+	std::condition_variable cnd_interactive;
 
 	/* Set to true if this is being destructed.  */
 	bool shutdown;
+	/* Number of general threads that should exit.  */
+	std::size_t retire;
+	/* Threads that exited because of `retire`, to be
+	 * joined by the main thread.  */
+	std::vector<std::thread::id> exited;
 
-	/* Queue of commands to execute in the
+	/* Queues of commands to execute in the
 	 * background thread.
 	 */
-	std::queue<std::function<std::function<void()>()>>
-		work_queue;
+	std::queue<Work> interactive_queue;
+	std::queue<Work> bulk_queue;
 
 	/* Queue of results to execute in the
 	 * main thread.
 	 */
 	std::queue<std::function<void()>> result_queue;
 
+	/* Statistics.  */
+	std::size_t busy;
+	std::uint64_t completed;
+	double total_wait;
+	double max_wait;
+	double total_run;
+	double max_run;
+
 private:
-	/* Gets from the work queue.
+	static
+	double seconds(Clock::duration d) {
+		return std::chrono::duration<double>(d).count();
+	}
+
+	/* Gets from the work queues, or returns a null
+	 * work if the thread should exit.
 	 * Precondition: the mutex must be locked.
 	 */
-	std::function<std::function<void()>()>
-	get_work(std::unique_lock<std::mutex>& locker) {
-		while (work_queue.empty() && !shutdown)
-			cnd.wait(locker);
-		if (shutdown)
-			return nullptr;
-		auto ret = std::move(work_queue.front());
-		work_queue.pop();
-		return ret;
+	Work
+	get_work( std::unique_lock<std::mutex>& locker
+		, bool interactive_only
+		) {
+		for (;;) {
+			if (shutdown)
+				return Work{nullptr, Clock::time_point()};
+			auto q = (std::queue<Work>*) nullptr;
+			if (!interactive_queue.empty())
+				q = &interactive_queue;
+			else if (!interactive_only) {
+				if (retire != 0) {
+					--retire;
+					exited.push_back(std::this_thread::get_id());
+					return Work{nullptr, Clock::time_point()};
+				}
+				if (!bulk_queue.empty())
+					q = &bulk_queue;
+			}
+			if (q) {
+				auto ret = std::move(q->front());
+				q->pop();
+				return ret;
+			}
+			if (interactive_only)
+				cnd_interactive.wait(locker);
+			else
+				cnd.wait(locker);
+		}
 	}
 
 	/* Puts to the result queue.
 	 * Precondition: the mutex must be locked.
 	 */
 	void put_result(std::function<void()> result) {
+		auto was_empty = result_queue.empty();
 		result_queue.emplace(std::move(result));
-		/* Wake up main thread.  */
+		/* Wake up main thread, unless an earlier result
+		 * already did and it has not gotten to them
+		 * yet.  */
+		if (!was_empty)
+			return;
+#if HAVE_EVENTFD
+		auto c = std::uint64_t(1);
+		auto res = ssize_t();
+		do {
+			res = write(wake_write, &c, sizeof(c));
+		} while (res < 0 && errno == EINTR);
+#else
 		auto c = char(1);
 		auto res = ssize_t();
 		do {
-			res = write(pipe_write, &c, 1);
+			res = write(wake_write, &c, 1);
 		} while (res < 0 && errno == EINTR);
+#endif
 	}
 
 	/* Run at each backgrond thread.  */
-	void background() {
+	void background(bool interactive_only) {
 		auto locker = std::unique_lock<std::mutex>(mtx);
 		for (;;) {
-			auto work = get_work(locker);
-			locker.unlock();
-
-			if (!work)
+			auto work = get_work(locker, interactive_only);
+			if (!work.func)
 				return;
+			++busy;
+			locker.unlock();
 
-			auto result = work();
-			work = nullptr;
+			auto start = Clock::now();
+			auto result = work.func();
+			work.func = nullptr;
+			auto end = Clock::now();
 
 			locker.lock();
+			--busy;
+			++completed;
+			auto wait = seconds(start - work.added);
+			auto run = seconds(end - start);
+			total_wait += wait;
+			total_run += run;
+			max_wait = std::max(max_wait, wait);
+			max_run = std::max(max_run, run);
 			put_result(std::move(result));
 		}
 	}
 
-	/* Run to handle an ev_io event.  */
-	void io_handler(EV_P) {
-		/* Remove one notification from the pipe.
-		 * FIXME
-		 * It would theoretically be better to just
-		 * read as much as is available until EAGAIN
-		 * or EWOULDBLOCK, and then pull that many
-		 * from the queue, but that optimization can
-		 * be done later.
-		 */
-		auto c = char();
+	/* Removes all pending wakeups.  */
+	void drain_wakeups() {
+#if HAVE_EVENTFD
+		auto c = std::uint64_t();
 		auto res = ssize_t();
 		do {
-			res = read(pipe_read, &c, 1);
+			res = read(wake_read, &c, sizeof(c));
 		} while (res < 0 && errno == EINTR);
+#else
+		char buf[64];
+		auto res = ssize_t();
+		do {
+			res = read(wake_read, buf, sizeof(buf));
+		} while (res > 0 || (res < 0 && errno == EINTR));
+#endif
+	}
 
-		/* Grab one.  */
-		auto result = ([this](){
+	/* Joins and forgets threads that exited after
+	 * set_num_threads.  */
+	void reap() {
+		auto ids = std::vector<std::thread::id>();
+		{
 			auto locker = std::unique_lock<std::mutex>(mtx);
-			auto ret = std::move(result_queue.front());
-			result_queue.pop();
-			return ret;
-		})();
+			ids.swap(exited);
+		}
+		for (auto const& id : ids) {
+			auto it = std::find_if( threads.begin(), threads.end()
+					      , [&id](std::thread const& t) {
+				return t.get_id() == id;
+			});
+			assert(it != threads.end());
+			it->join();
+			threads.erase(it);
+		}
+	}
+
+	/* Run to handle an ev_io event.  */
+	void io_handler(EV_P) {
+		drain_wakeups();
+		reap();
 
-		--num_tasks;
+		/* Grab all the results that are ready.  */
+		auto results = std::queue<std::function<void()>>();
+		{
+			auto locker = std::unique_lock<std::mutex>(mtx);
+			results.swap(result_queue);
+		}
+
+		num_tasks -= results.size();
 		if (num_tasks == 0) {
 			/* No more tasks, so we can stop the watcher.
 			 * This is important as we have the rule that
@@ -166,7 +280,13 @@ private:
 			io_waiter = nullptr;
 		}
 
-		result();
+		/* A result may destroy this object, so do not
+		 * touch it from here on.  */
+		while (!results.empty()) {
+			auto result = std::move(results.front());
+			results.pop();
+			result();
+		}
 	}
 
 	static
@@ -175,11 +295,41 @@ private:
 		return self->io_handler(EV_A);
 	}
 
+	void launch(bool interactive_only) {
+		/* Launch threads with all signals blocked.
+		 * On exit from this function, the current
+		 * thread has its signal mask restored.
+		 */
+		SigBlocker blocker;
+		threads.emplace_back([this, interactive_only]() {
+			background(interactive_only);
+		});
+	}
+
 public:
-	Impl() {
+	explicit
+	Impl(std::size_t num_threads) {
+		assert(num_threads != 0);
 		num_tasks = 0;
 		shutdown = false;
-
+		retire = 0;
+		busy = 0;
+		completed = 0;
+		total_wait = 0;
+		max_wait = 0;
+		total_run = 0;
+		max_run = 0;
+
+#if HAVE_EVENTFD
+		auto fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (fd < 0) {
+			throw Util::BacktraceException<std::runtime_error>(std::string("Ev::ThreadPool: eventfd:")
+						+ strerror(errno)
+						);
+		}
+		wake_read = fd;
+		wake_write = fd;
+#else
 		int pipes[2];
 		auto pipe_res = pipe(pipes);
 		if (pipe_res < 0) {
@@ -188,30 +338,76 @@ public:
 						);
 		}
 
-		pipe_read = pipes[0];
-		pipe_write = pipes[1];
+		wake_read = pipes[0];
+		wake_write = pipes[1];
 		{
 			/* Make read end non-blocking.  */
-			auto flags = fcntl(pipe_read, F_GETFL);
+			auto flags = fcntl(wake_read, F_GETFL);
 			flags |= O_NONBLOCK;
-			fcntl(pipe_read, F_SETFL, flags);
+			fcntl(wake_read, F_SETFL, flags);
 		}
+#endif
+
+		/* With a single thread, it has to do everything,
+		 * in order.  */
+		has_interactive_thread = num_threads >= 2;
+		num_general = 0;
+		if (has_interactive_thread)
+			launch(true);
+		set_num_threads(num_threads);
+	}
 
-		/* Launch threads with all signals blocked.
-		 * On exit from this function, the current
-		 * thread has its signal mask restored.
-		 */
-		SigBlocker blocker;
-		for (auto i = 0; i < 16; ++i)
-			threads.emplace_back([this]() { background(); });
+	void set_num_threads(std::size_t num_threads) {
+		reap();
+		auto target = num_threads;
+		if (has_interactive_thread)
+			target = std::max(num_threads, std::size_t(2)) - 1;
+		else
+			target = std::max(num_threads, std::size_t(1));
+
+		if (target < num_general) {
+			{
+				auto locker = std::unique_lock<std::mutex>(mtx);
+				retire += num_general - target;
+			}
+			cnd.notify_all();
+		}
+		while (num_general < target) {
+			launch(false);
+			++num_general;
+		}
+		num_general = target;
 	}
 
-	void add(std::function<std::function<void()>()> work) {
+	Stats get_stats() const {
+		auto locker = std::unique_lock<std::mutex>(mtx);
+		auto rv = Stats();
+		rv.threads = num_general + (has_interactive_thread ? 1 : 0);
+		rv.busy = busy;
+		rv.interactive_queued = interactive_queue.size();
+		rv.bulk_queued = bulk_queue.size();
+		rv.completed = completed;
+		rv.mean_wait = completed == 0 ? 0 : total_wait / completed;
+		rv.max_wait = max_wait;
+		rv.mean_run = completed == 0 ? 0 : total_run / completed;
+		rv.max_run = max_run;
+		return rv;
+	}
+
+	void add( std::function<std::function<void()>()> work
+		, Lane lane
+		) {
 		assert(work);
+		reap();
 		{
 			auto locker = std::unique_lock<std::mutex>(mtx);
-			work_queue.emplace(std::move(work));
+			auto& q = (lane == Interactive) ? interactive_queue
+							: bulk_queue
+							;
+			q.emplace(Work{std::move(work), Clock::now()});
 		}
+		if (lane == Interactive)
+			cnd_interactive.notify_one();
 		cnd.notify_one();
 		++num_tasks;
 
@@ -219,7 +415,7 @@ public:
 			io_waiter = Util::make_unique<ev_io>();
 			ev_io_init( io_waiter.get()
 				  , &io_handler_static
-				  , pipe_read
+				  , wake_read
 				  , EV_READ
 				  );
 			io_waiter->data = this;
@@ -237,20 +433,45 @@ public:
 			shutdown = true;
 		}
 		cnd.notify_all();
+		cnd_interactive.notify_all();
 		/* Wait for all threads to finish.  */
 		for (auto& t : threads)
 			t.join();
+
+		close(wake_read);
+		if (wake_write != wake_read)
+			close(wake_write);
 	}
 };
 
+std::size_t ThreadPool::default_num_threads() {
+	/* The work is mostly waiting on disk or network,
+	 * not computing, so use more threads than cores,
+	 * but not so many that small machines waste
+	 * memory on idle thread stacks.  */
+	auto cores = std::size_t(std::thread::hardware_concurrency());
+	if (cores == 0)
+		cores = 2;
+	return std::min(std::max(2 * cores, std::size_t(4)), std::size_t(16));
+}
+
 ThreadPool::ThreadPool()
-	: pimpl(Util::make_unique<Impl>()) { }
+	: pimpl(Util::make_unique<Impl>(default_num_threads())) { }
+ThreadPool::ThreadPool(std::size_t num_threads)
+	: pimpl(Util::make_unique<Impl>(num_threads)) { }
 ThreadPool::~ThreadPool() { }
 
 void
-ThreadPool::add(std::function<std::function<void()>()> work) {
-	return pimpl->add(std::move(work));
+ThreadPool::add( std::function<std::function<void()>()> work
+	       , Lane lane
+	       ) {
+	return pimpl->add(std::move(work), lane);
 }
-
+void ThreadPool::set_num_threads(std::size_t num_threads) {
+	pimpl->set_num_threads(num_threads);
+}
+ThreadPool::Stats ThreadPool::get_stats() const {
+	return pimpl->get_stats();
 }
 
+}
@@ -1,6 +1,8 @@
 #ifndef EV_THREADPOOL_HPP
 #define EV_THREADPOOL_HPP
 
+#include<cstddef>
+#include<cstdint>
 #include<functional>
 #include<memory>
 #include"Ev/Io.hpp"
@@ -20,6 +22,42 @@ namespace Ev {
  * up.
  */
 class ThreadPool {
+public:
+	/* Interactive work is taken before bulk work, and
+	 * one thread only ever does interactive work, so
+	 * a flood of slow bulk operations (DNS lookups,
+	 * HTTP requests, connection probes) cannot delay
+	 * it.  */
+	enum Lane
+	{ Interactive
+	, Bulk
+	};
+
+	struct Stats {
+		/* Background threads, including the one for
+		 * interactive work only.  */
+		std::size_t threads;
+		/* Threads currently running work.  */
+		std::size_t busy;
+		/* Work not yet started, per lane.  */
+		std::size_t interactive_queued;
+		std::size_t bulk_queued;
+		/* Work completed since construction.  */
+		std::uint64_t completed;
+		/* Seconds from adding work until a thread
+		 * started it, and from then until it was
+		 * done.  */
+		double mean_wait;
+		double max_wait;
+		double mean_run;
+		double max_run;
+	};
+
+	/* The number of threads used by the default
+	 * constructor, based on the hardware
+	 * concurrency.  */
+	static std::size_t default_num_threads();
+
 private:
 	class Impl;
 	std::unique_ptr<Impl> pimpl;
@@ -31,19 +69,35 @@ private:
 	 * The second stage is executed in
 	 * the main thread.
 	 */
-	void add(std::function<std::function<void()>()>);
+	void add(std::function<std::function<void()>()>, Lane);
 
 public:
 	ThreadPool();
+	/* Use exactly the given number of background
+	 * threads; with 1, work is done in the order it
+	 * is added.  */
+	explicit
+	ThreadPool(std::size_t num_threads);
 	~ThreadPool();
 	ThreadPool(ThreadPool const&) =delete;
 	ThreadPool(ThreadPool&&) =delete;
 
+	/* Changes the number of background threads,
+	 * counting the interactive thread if there is
+	 * one; such a pool keeps at least 2 threads.
+	 * Extra threads exit once they finish their
+	 * current work.  */
+	void set_num_threads(std::size_t num_threads);
+	Stats get_stats() const;
+
 	template<typename a>
-	Ev::Io<a> background(std::function<a()> func) {
+	Ev::Io<a> background( std::function<a()> func
+			    , Lane lane = Bulk
+			    ) {
 		auto funptr = std::make_shared<std::function<a()>>
 			( std::move(func) );
 		return Ev::Io<a>([ funptr
+				 , lane
 				 , this
 				 ]( std::function<void(a)> pass
 				  , std::function<void(std::exception_ptr)> fail
@@ -65,7 +119,7 @@ public:
 				}
 				return stage2;
 			};
-			add(stage1);
+			add(stage1, lane);
 		});
 	}
 };
@@ -31,6 +31,18 @@ Ev::Io<void> yield();
 
 Ev::Io<void> yield(std::size_t num_yields);
 
+/** Ev::set_yield_budget
+ *
+ * @brief sets how many greenthreads waiting in
+ * Ev::yield or Ev::concurrent get resumed in a single
+ * turn of the main loop, before I/O and timers are
+ * checked again.
+ *
+ * @desc The default of 0 resumes every greenthread that
+ * was already waiting at the start of the turn.
+ */
+void set_yield_budget(std::size_t budget);
+
 }
 
 #endif /* !defined(EV_YIELD_HPP) */
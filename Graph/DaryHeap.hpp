@@ -0,0 +1,167 @@
+#ifndef GRAPH_DARYHEAP_HPP
+#define GRAPH_DARYHEAP_HPP
+
+#include<cassert>
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+#include<utility>
+#include<vector>
+
+namespace Graph {
+
+/** class Graph::DaryHeap<Cost, D, CmpC>
+ *
+ * @brief an indexed d-ary min-heap of dense
+ * `std::uint32_t` keys, each with a cost.
+ *
+ * @desc unlike `std::priority_queue`, each key
+ * is in the heap at most once, and the cost of a
+ * key already in the heap can be lowered in place
+ * with `decrease`, so there are never stale
+ * entries to skip.
+ *
+ * Keys should be small integers, as the heap keeps
+ * a position table as large as the largest key
+ * pushed.
+ */
+template< typename Cost
+	, std::size_t D = 4
+	, typename CmpC = std::less<Cost>
+	>
+class DaryHeap {
+	static_assert(D >= 2, "DaryHeap needs at least 2 children per node");
+
+public:
+	typedef std::uint32_t Key;
+
+private:
+	struct Entry {
+		Cost cost;
+		Key key;
+	};
+
+	/* Position of keys not in the heap.  */
+	static constexpr std::uint32_t npos = ~std::uint32_t(0);
+
+	CmpC cmp;
+	std::vector<Entry> heap;
+	/* Position of each key within heap, or npos.  */
+	std::vector<std::uint32_t> pos;
+
+public:
+	DaryHeap(DaryHeap&&) =default;
+	DaryHeap(DaryHeap const&) =default;
+	DaryHeap& operator=(DaryHeap&&) =default;
+	DaryHeap& operator=(DaryHeap const&) =default;
+
+	explicit
+	DaryHeap(CmpC cmp_ = CmpC()) : cmp(std::move(cmp_)) { }
+
+	/* Preallocate for keys below `num_keys`.  */
+	void reserve(std::size_t num_keys) {
+		heap.reserve(num_keys);
+		if (pos.size() < num_keys)
+			pos.resize(num_keys, npos);
+	}
+
+	bool empty() const { return heap.empty(); }
+	std::size_t size() const { return heap.size(); }
+
+	bool contains(Key k) const {
+		return k < pos.size() && pos[k] != npos;
+	}
+
+	/* The key with the lowest cost.  */
+	Key top() const {
+		assert(!heap.empty());
+		return heap[0].key;
+	}
+	Cost const& top_cost() const {
+		assert(!heap.empty());
+		return heap[0].cost;
+	}
+
+	/* The key must not be in the heap.  */
+	void push(Key k, Cost c) {
+		assert(!contains(k));
+		if (pos.size() <= k)
+			pos.resize(std::size_t(k) + 1, npos);
+		heap.push_back(Entry{std::move(c), k});
+		sift_up(heap.size() - 1);
+	}
+	/* The key must be in the heap, and the new cost
+	 * must not be higher than its current cost.  */
+	void decrease(Key k, Cost c) {
+		assert(contains(k));
+		auto i = std::size_t(pos[k]);
+		assert(!cmp(heap[i].cost, c));
+		heap[i].cost = std::move(c);
+		sift_up(i);
+	}
+
+	/* Remove and return the key with the lowest
+	 * cost.  */
+	Key pop() {
+		assert(!heap.empty());
+		auto k = heap[0].key;
+		pos[k] = npos;
+		if (heap.size() > 1) {
+			heap[0] = std::move(heap.back());
+			heap.pop_back();
+			pos[heap[0].key] = 0;
+			sift_down(0);
+		} else
+			heap.pop_back();
+		return k;
+	}
+
+	void clear() {
+		for (auto const& e : heap)
+			pos[e.key] = npos;
+		heap.clear();
+	}
+
+private:
+	void sift_up(std::size_t i) {
+		auto e = std::move(heap[i]);
+		while (i > 0) {
+			auto parent = (i - 1) / D;
+			if (!cmp(e.cost, heap[parent].cost))
+				break;
+			heap[i] = std::move(heap[parent]);
+			pos[heap[i].key] = std::uint32_t(i);
+			i = parent;
+		}
+		pos[e.key] = std::uint32_t(i);
+		heap[i] = std::move(e);
+	}
+	void sift_down(std::size_t i) {
+		auto n = heap.size();
+		auto e = std::move(heap[i]);
+		for (;;) {
+			auto first = i * D + 1;
+			if (first >= n)
+				break;
+			auto last = first + D;
+			if (last > n)
+				last = n;
+			/* Find the lowest child.  */
+			auto best = first;
+			for (auto c = first + 1; c < last; ++c)
+				if (cmp(heap[c].cost, heap[best].cost))
+					best = c;
+			if (!cmp(heap[best].cost, e.cost))
+				break;
+			heap[i] = std::move(heap[best]);
+			pos[heap[i].key] = std::uint32_t(i);
+			i = best;
+		}
+		pos[e.key] = std::uint32_t(i);
+		heap[i] = std::move(e);
+	}
+};
+
+}
+
+#endif /* !defined(GRAPH_DARYHEAP_HPP) */
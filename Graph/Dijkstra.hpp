@@ -1,14 +1,13 @@
 #ifndef GRAPH_DIJKSTRA_HPP
 #define GRAPH_DIJKSTRA_HPP
 
+#include"Graph/IndexedDijkstra.hpp"
 #include"Graph/TreeNode.hpp"
 #include"Util/make_unique.hpp"
-#include<algorithm>
 #include<functional>
 #include<map>
 #include<memory>
-#include<queue>
-#include<set>
+#include<vector>
 
 namespace Graph {
 
@@ -25,6 +24,12 @@ namespace Graph {
  * This allows clients with non-standard
  * execution policies and incremental map
  * loading to use this class.
+ *
+ * This is an adapter that assigns each `Node`
+ * a dense index and runs
+ * `Graph::IndexedDijkstra`; clients that already
+ * have dense node indices should use that
+ * directly.
  */
 template< typename Node
 	, typename Cost = double
@@ -44,14 +49,13 @@ public:
 	Dijkstra() =delete;
 	Dijkstra(Dijkstra&&) =default;
 	Dijkstra( Dijkstra const& o
-		) : cmp_c(o.cmp_c)
-		  , add_c(o.add_c)
-		  , q(o.q)
-		  , treenodes()
-		  , closed(o.closed)
+		) : indices(o.indices)
+		  , nodes(o.nodes.size())
+		  , engine(o.engine)
 		  {
-		/* treenodes have to be copied.  */
-		copy_treenodes(o.treenodes);
+		/* nodes has to point into our own indices.  */
+		for (auto const& e : indices)
+			nodes[e.second] = &e.first;
 	}
 
 	explicit
@@ -60,14 +64,15 @@ public:
 		, CmpN cmp_n_ = CmpN()
 		, CmpC cmp_c_ = CmpC()
 		, AddC add_c_ = AddC()
-		) : cmp_c(cmp_c_)
-		  , add_c(std::move(add_c_))
-		  , q(WrappedCmpC(cmp_c_))
-		  , treenodes(cmp_n_)
-		  , closed()
-		  {
-		initialize(std::move(root), std::move(root_cost));
-	}
+		) : indices(cmp_n_)
+		  , nodes()
+		  , engine( index_of(std::move(root))
+			  , std::move(root_cost)
+			  , 0
+			  , cmp_c_
+			  , std::move(add_c_)
+			  )
+		  { }
 
 	/** Graph::Dijkstra<Node, Cost>::current
 	 *
@@ -89,9 +94,10 @@ public:
 	 * function.
 	 */
 	Node const* current() const {
-		if (q.empty())
+		auto u = engine.current();
+		if (u == Engine::none)
 			return nullptr;
-		return q.top().first->data.first;
+		return nodes[u];
 	}
 	/** Graph::Dijsktra<Node, Cost>::neighbor
 	 *
@@ -105,26 +111,7 @@ public:
 	 * returns.
 	 */
 	void neighbor(Node n, Cost c) {
-		/* for each neighbor v of u: */ /* v = n, u = current() */
-		auto& u = *q.top().first;
-		auto& u_cost = u.data.second;
-		auto alt = add_c(u_cost, c);
-
-		auto it = treenodes.find(n);
-		if (it == treenodes.end()) {
-			/* No TreeNode yet, initialize it to alt.  */
-			auto& v = create_treenode(n);
-			v.data.second = alt;
-			reparent(v, u);
-			q.push(std::make_pair(&v, alt));
-		} else {
-			auto& v = *it->second;
-			if (cmp_c(alt, v.data.second)) {
-				v.data.second = alt;
-				reparent(v, u);
-				q.push(std::make_pair(&v, alt));
-			}
-		}
+		engine.neighbor(index_of(std::move(n)), std::move(c));
 	}
 	/** Graph::Dijkstra<Node, Cost>::end_neighbors
 	 *
@@ -136,14 +123,7 @@ public:
 	 * After this call, `current()` will change.
 	 */
 	void end_neighbors() {
-		auto u = q.top().first;
-		closed.insert(u);
-		q.pop();
-		/* Filter out those already in the closed set.  */
-		while ( !q.empty()
-		     && closed.find(q.top().first) != closed.end()
-		      )
-			q.pop();
+		engine.end_neighbors();
 	}
 
 	/** Graph::Dijkstra<Node::Cost>::finalize
@@ -156,86 +136,55 @@ public:
 	 */
 	Result
 	finalize()&& {
-		return std::move(treenodes);
+		auto result = Result(indices.key_comp());
+		/* Create the reached nodes.  */
+		auto treenodes = std::vector<TreeNode*>(nodes.size(), nullptr);
+		for (auto& e : indices) {
+			auto i = e.second;
+			if (!engine.reached(i))
+				continue;
+			auto tn = Util::make_unique<TreeNode>();
+			tn->data.second = engine.cost(i);
+			tn->parent = nullptr;
+			treenodes[i] = tn.get();
+			auto it = result.emplace_hint( result.end()
+						     , std::move(e.first)
+						     , std::move(tn)
+						     );
+			it->second->data.first = &it->first;
+		}
+		/* Link them up.  */
+		for (auto i = Index(0); i < treenodes.size(); ++i) {
+			auto tn = treenodes[i];
+			if (!tn)
+				continue;
+			auto p = engine.parent(i);
+			if (p == Engine::none)
+				continue;
+			tn->parent = treenodes[p];
+			treenodes[p]->children.push_back(tn);
+		}
+		return result;
 	}
 
 private:
-	class WrappedCmpC {
-	private:
-		CmpC cmp_c;
-	public:
-		explicit
-		WrappedCmpC(CmpC cmp_c_) : cmp_c(cmp_c_) { }
-		bool operator()( std::pair<TreeNode*, Cost> const& a
-			       , std::pair<TreeNode*, Cost> const& b
-			       ) const {
-			/* We want the priority queue to return
-			 * the *lowest* cost, but std::priority_queue
-			 * is designed to return the *highest* score
-			 * when given std::less.
-			 * So flip the args here.
-			 */
-			return cmp_c(b.second, a.second);
-		}
-	};
+	typedef IndexedDijkstra<Cost, CmpC, AddC> Engine;
+	typedef typename Engine::Index Index;
 
-	CmpC cmp_c;
-	AddC add_c;
-	std::priority_queue< std::pair<TreeNode*, Cost>
-			   , std::vector<std::pair<TreeNode*, Cost>>
-			   , WrappedCmpC
-			   > q;
-	Result treenodes;
-	std::set<TreeNode*> closed;
+	/* Dense index of each node seen.  */
+	std::map<Node, Index, CmpN> indices;
+	/* Reverse of the above.  */
+	std::vector<Node const*> nodes;
+	Engine engine;
 
-	void initialize(Node root, Cost root_cost) {
-		auto& tn = get_treenode(root);
-		tn.data.second = root_cost;
-		q.push(std::make_pair(&tn, root_cost));
-	}
-	TreeNode& get_treenode(Node n) {
-		auto it = treenodes.find(n);
-		if (it == treenodes.end())
-			return create_treenode(std::move(n));
-		return *it->second;
-	}
-	TreeNode& create_treenode(Node n) {
-		auto tn = Util::make_unique<TreeNode>();
-		auto itb = treenodes.insert(std::make_pair(
-			std::move(n), std::move(tn)
-		));
-		auto it = itb.first;
-		it->second->data.first = &it->first;
-		return *it->second;
-	}
-	void reparent(TreeNode& node, TreeNode& parent) {
-		if (node.parent) {
-			/* Remove it from the existing parent children.  */
-			auto& curparent = const_cast<TreeNode&>(*node.parent);
-			auto& children = curparent.children;
-			children.erase( std::remove( children.begin()
-						   , children.end()
-						   , &node
-						   )
-				      , children.end()
-				      );
-		}
-		node.parent = &parent;
-		parent.children.push_back(&node);
-	}
-
-	void copy_treenodes(Result const& src) {
-		for (auto const& e : src) {
-			auto const& n = e.first;
-			auto const& tn = *e.second;
-			auto& my_tn = get_treenode(n);
-			if (tn.parent) {
-				auto const& parent_n = *tn.parent->data.first;
-				auto& my_parent_tn = get_treenode(parent_n);
-				reparent(my_tn, my_parent_tn);
-			}
-			my_tn.data.second = tn.data.second;
-		}
+	Index index_of(Node n) {
+		auto it = indices.lower_bound(n);
+		if (it != indices.end() && !indices.key_comp()(n, it->first))
+			return it->second;
+		auto i = Index(nodes.size());
+		it = indices.emplace_hint(it, std::move(n), i);
+		nodes.push_back(&it->first);
+		return i;
 	}
 };
 
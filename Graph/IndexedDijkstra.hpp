@@ -0,0 +1,169 @@
+#ifndef GRAPH_INDEXEDDIJKSTRA_HPP
+#define GRAPH_INDEXEDDIJKSTRA_HPP
+
+#include"Graph/DaryHeap.hpp"
+#include<cassert>
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+#include<utility>
+#include<vector>
+
+namespace Graph {
+
+/** class Graph::IndexedDijkstra<Cost>
+ *
+ * @brief an implementation of the Dijkstra
+ * shortest-path algorithm over dense
+ * `std::uint32_t` node indices.
+ *
+ * @desc this has the same data interface as
+ * `Graph::Dijkstra`, i.e. the client feeds in
+ * the neighbors of the `current()` node, but
+ * keeps its state in flat arrays indexed by node,
+ * with an indexed d-ary heap for the frontier, so
+ * there is no per-node allocation and no
+ * comparison of node identifiers.
+ *
+ * Arrays grow as larger indices are seen; give
+ * the number of nodes in the constructor to
+ * preallocate them.
+ */
+template< typename Cost = double
+	, typename CmpC = std::less<Cost>
+	, typename AddC = std::plus<Cost>
+	>
+class IndexedDijkstra {
+public:
+	typedef std::uint32_t Index;
+	/* Returned by `current` at the end of the run,
+	 * and by `parent` for the root and unreached
+	 * nodes.  */
+	static constexpr Index none = ~Index(0);
+
+private:
+	enum State : unsigned char { Unreached, Open, Closed };
+
+	CmpC cmp_c;
+	AddC add_c;
+	DaryHeap<Cost, 4, CmpC> q;
+	std::vector<Cost> costs;
+	std::vector<Index> parents;
+	std::vector<State> states;
+	std::size_t num_reached;
+
+	void ensure(Index n) {
+		if (n < states.size())
+			return;
+		auto size = std::size_t(n) + 1;
+		costs.resize(size);
+		parents.resize(size, none);
+		states.resize(size, Unreached);
+	}
+
+public:
+	IndexedDijkstra() =delete;
+	IndexedDijkstra(IndexedDijkstra&&) =default;
+	IndexedDijkstra(IndexedDijkstra const&) =default;
+
+	explicit
+	IndexedDijkstra( Index root
+		       , Cost root_cost = Cost()
+		       , std::size_t num_nodes = 0
+		       , CmpC cmp_c_ = CmpC()
+		       , AddC add_c_ = AddC()
+		       ) : cmp_c(cmp_c_)
+			 , add_c(std::move(add_c_))
+			 , q(cmp_c_)
+			 , num_reached(1)
+			 {
+		costs.resize(num_nodes);
+		parents.resize(num_nodes, none);
+		states.resize(num_nodes, Unreached);
+		q.reserve(num_nodes);
+		ensure(root);
+		costs[root] = root_cost;
+		states[root] = Open;
+		q.push(root, std::move(root_cost));
+	}
+
+	/** Graph::IndexedDijkstra<Cost>::current
+	 *
+	 * @brief return the current node being
+	 * considered by the algorithm, or `none` if
+	 * there are no more nodes reachable from the
+	 * root.
+	 */
+	Index current() const {
+		if (q.empty())
+			return none;
+		return q.top();
+	}
+	/** Graph::IndexedDijkstra<Cost>::neighbor
+	 *
+	 * @brief inform the algorithm that the
+	 * `current()` node has a directly-reachable
+	 * neighbor, that has a cost `c` to go to.
+	 *
+	 * @desc do not call this if `current()` returns
+	 * `none`.
+	 */
+	void neighbor(Index v, Cost c) {
+		auto u = q.top();
+		ensure(v);
+		auto state = states[v];
+		if (state == Closed)
+			return;
+		auto alt = add_c(costs[u], c);
+		if (state == Unreached) {
+			states[v] = Open;
+			++num_reached;
+			costs[v] = alt;
+			parents[v] = u;
+			q.push(v, std::move(alt));
+		} else if (cmp_c(alt, costs[v])) {
+			costs[v] = alt;
+			parents[v] = u;
+			q.decrease(v, std::move(alt));
+		}
+	}
+	/** Graph::IndexedDijkstra<Cost>::end_neighbors
+	 *
+	 * @brief inform the algorithm that the
+	 * `current()` node has no more neighbors.
+	 *
+	 * @desc after this call, `current()` will
+	 * change.
+	 */
+	void end_neighbors() {
+		states[q.pop()] = Closed;
+	}
+
+	/* Results so far; final once `current()`
+	 * returns `none`.  */
+
+	/* One more than the highest node index seen.  */
+	std::size_t size() const { return states.size(); }
+	/* Number of nodes with a known path from the
+	 * root.  */
+	std::size_t reached_count() const { return num_reached; }
+	bool reached(Index n) const {
+		return n < states.size() && states[n] != Unreached;
+	}
+	/* Only valid if `reached(n)`.  */
+	Cost const& cost(Index n) const {
+		assert(reached(n));
+		return costs[n];
+	}
+	/* Previous node on the shortest path from the
+	 * root.  */
+	Index parent(Index n) const {
+		if (n >= parents.size())
+			return none;
+		return parents[n];
+	}
+};
+
+}
+
+#endif /* !defined(GRAPH_INDEXEDDIJKSTRA_HPP) */
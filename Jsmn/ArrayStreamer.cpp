@@ -0,0 +1,171 @@
+#include"Jsmn/ArrayStreamer.hpp"
+#include"Jsmn/ParseError.hpp"
+#include"Util/make_unique.hpp"
+
+namespace {
+
+bool is_space(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string trim(std::string const& s) {
+	auto b = std::size_t(0);
+	auto e = s.size();
+	while (b < e && is_space(s[b]))
+		++b;
+	while (e > b && is_space(s[e - 1]))
+		--e;
+	return s.substr(b, e - b);
+}
+
+}
+
+namespace Jsmn {
+
+std::exception_ptr ArrayStreamer::flush_element() {
+	auto text = trim(element);
+	element.clear();
+	if (skipping || text.empty())
+		return nullptr;
+
+	/* Whitespace ends a top-level number.  */
+	text.push_back('\n');
+	auto parsed = std::vector<Jsmn::Object>();
+	try {
+		parsed = element_parser->feed(text);
+		if (parsed.size() != 1)
+			throw ParseError(text, 0);
+	} catch (ParseError const&) {
+		/* Drop any partial datum, and the rest of
+		 * the array.  */
+		element_parser = Util::make_unique<Jsmn::Parser>();
+		skipping = true;
+		auto e = std::current_exception();
+		if (!failer)
+			return e;
+		failer(trim(id), e);
+		return nullptr;
+	}
+	visitor(std::move(parsed[0]));
+	return nullptr;
+}
+
+void ArrayStreamer::feed(char const* text, std::size_t len, std::string& out) {
+	auto error = std::exception_ptr();
+	for (auto p = text; p != text + len; ++p) {
+		auto c = *p;
+		auto depth = stack.size();
+		/* Inside an element of the streamed array?  */
+		auto in_element = bool(visitor) && depth >= 3;
+
+		if (in_string) {
+			auto closing = false;
+			if (in_string_backslash)
+				in_string_backslash = false;
+			else if (c == '\\')
+				in_string_backslash = true;
+			else if (c == '"') {
+				in_string = false;
+				closing = true;
+			}
+			if (in_key) {
+				if (closing)
+					in_key = false;
+				else
+					keys[depth - 1].push_back(c);
+			}
+			if (in_id)
+				id.push_back(c);
+			if (in_element)
+				element.push_back(c);
+			else
+				out.push_back(c);
+			continue;
+		}
+
+		if (in_element && depth == 3 && (c == ',' || c == ']')) {
+			auto e = flush_element();
+			if (e && !error)
+				error = e;
+			if (c == ']') {
+				stack.pop_back();
+				visitor = nullptr;
+				skipping = false;
+				expect_key = false;
+				out.push_back(c);
+			}
+			continue;
+		}
+
+		if (in_id && depth == 1 && (c == ',' || c == '}'))
+			in_id = false;
+
+		switch (c) {
+		case '"':
+			in_string = true;
+			if ( depth != 0 && depth <= 2
+			  && stack.back() == '{' && expect_key
+			   ) {
+				in_key = true;
+				keys[depth - 1].clear();
+			}
+			break;
+		case ':':
+			expect_key = false;
+			if (depth == 1 && keys[0] == "id" && id.empty()) {
+				in_id = true;
+				/* Do not record the colon.  */
+				out.push_back(c);
+				continue;
+			}
+			break;
+		case ',':
+			expect_key = depth != 0 && stack.back() == '{';
+			break;
+		case '{':
+			stack.push_back(c);
+			expect_key = true;
+			break;
+		case '[':
+			stack.push_back(c);
+			expect_key = false;
+			if ( !visitor && depth == 2
+			  && stack[0] == '{' && stack[1] == '{'
+			   ) {
+				visitor = selector(trim(id), keys[0], keys[1]);
+				if (visitor) {
+					element.clear();
+					skipping = false;
+					out.push_back(c);
+					continue;
+				}
+			}
+			break;
+		case '}':
+		case ']':
+			if (!stack.empty())
+				stack.pop_back();
+			expect_key = false;
+			if (stack.empty()) {
+				/* End of datum.  */
+				id.clear();
+				in_id = false;
+				keys[0].clear();
+				keys[1].clear();
+			}
+			break;
+		}
+
+		if (in_id)
+			id.push_back(c);
+		if (in_element)
+			element.push_back(c);
+		else
+			out.push_back(c);
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+}
@@ -0,0 +1,124 @@
+#ifndef JSMN_ARRAYSTREAMER_HPP
+#define JSMN_ARRAYSTREAMER_HPP
+
+#include"Jsmn/Object.hpp"
+#include"Jsmn/Parser.hpp"
+#include"Util/make_unique.hpp"
+#include<cstddef>
+#include<exception>
+#include<functional>
+#include<memory>
+#include<string>
+#include<vector>
+
+namespace Jsmn {
+
+/** class Jsmn::ArrayStreamer
+ *
+ * @brief filters a stream of JSON text, removing
+ * the elements of selected arrays and passing
+ * each of them, parsed, to a visitor as soon as
+ * it is complete.
+ *
+ * @desc only arrays at the second level of a
+ * top-level object can be selected, i.e. the
+ * `[...]` in `{"k1": {"k2": [...]}}`, which is
+ * where JSON-RPC responses put the bulk of their
+ * result.
+ * When such an array starts, the selector is
+ * called with the raw text of the top-level `id`
+ * field, if it came before (or an empty string if
+ * not), and the two keys.
+ * If it returns a visitor, the elements are
+ * passed to it and the array is left empty in the
+ * filtered text.
+ *
+ * Thus only one element at a time is held in
+ * memory, rather than the entire array.
+ *
+ * If an element is not valid JSON, the rest of
+ * that array is dropped, and the failer, if any,
+ * is called with the same `id` text and a
+ * `Jsmn::ParseError`.
+ */
+class ArrayStreamer {
+public:
+	typedef std::function<void(Jsmn::Object)> Visitor;
+	typedef std::function<Visitor( std::string const& id
+				     , std::string const& k1
+				     , std::string const& k2
+				     )> Selector;
+	typedef std::function<void( std::string const& id
+				  , std::exception_ptr
+				  )> Failer;
+
+private:
+	Selector selector;
+	Failer failer;
+
+	/* Open containers, '{' or '['.  */
+	std::vector<char> stack;
+	bool in_string;
+	bool in_string_backslash;
+	/* Whether the next string in an object is a key.  */
+	bool expect_key;
+
+	/* Keys at the first and second levels.  */
+	std::string keys[2];
+	/* Whether we are within a key at the first or
+	 * second level.  */
+	bool in_key;
+	/* Raw text of the top-level id.  */
+	std::string id;
+	bool in_id;
+
+	/* The visitor of the array being streamed, or
+	 * nullptr if none.  */
+	Visitor visitor;
+	/* Set if an element of the array being streamed
+	 * was invalid.  */
+	bool skipping;
+	std::string element;
+	std::unique_ptr<Jsmn::Parser> element_parser;
+
+	/* Returns the parse error if there is no
+	 * failer.  */
+	std::exception_ptr flush_element();
+
+public:
+	ArrayStreamer() =delete;
+	ArrayStreamer(ArrayStreamer const&) =delete;
+	ArrayStreamer(ArrayStreamer&&) =delete;
+
+	explicit
+	ArrayStreamer( Selector selector_
+		     , Failer failer_ = nullptr
+		     ) : selector(std::move(selector_))
+		       , failer(std::move(failer_))
+		, in_string(false)
+		, in_string_backslash(false)
+		, expect_key(false)
+		, in_key(false)
+		, in_id(false)
+		, skipping(false)
+		, element_parser(Util::make_unique<Jsmn::Parser>())
+		{ }
+
+	/** Jsmn::ArrayStreamer::feed
+	 *
+	 * @brief processes the given text, appending
+	 * whatever is not streamed to `out`.
+	 *
+	 * @desc visitors and the failer are called from
+	 * within this function.
+	 * If there is no failer, throws `Jsmn::ParseError`
+	 * if an element is not valid JSON, after all of
+	 * the text has been processed, so that the
+	 * streamer can still be used.
+	 */
+	void feed(char const* text, std::size_t len, std::string& out);
+};
+
+}
+
+#endif /* !defined(JSMN_ARRAYSTREAMER_HPP) */
@@ -1,15 +1,42 @@
 #ifndef JSMN_DETAIL_PARSERESULT_HPP
 #define JSMN_DETAIL_PARSERESULT_HPP
 
+#include<mutex>
 #include<string>
+#include<string_view>
+#include<unordered_map>
 #include<vector>
 #include"Jsmn/Detail/Token.hpp"
 
 namespace Jsmn { namespace Detail {
 
+/* Maps the raw text of each key of an object to the
+ * token index of its value.  */
+struct KeyIndex {
+	/* False if some key has escapes, in which case
+	 * the object has to be scanned.  */
+	bool usable;
+	std::unordered_map<std::string_view, unsigned int> values;
+};
+
 struct ParseResult {
 	std::string orig_string;
 	std::vector<Token> tokens;
+
+	/* Key indices of large objects, keyed by token
+	 * index of the object, built on first lookup.
+	 * Parse results may be shared across threads,
+	 * so guarded by a mutex.
+	 */
+	std::mutex key_indices_mutex;
+	std::unordered_map<unsigned int, KeyIndex> key_indices;
+
+	/* Token index just past the last element of large
+	 * arrays, keyed by token index of the array, found
+	 * on first use so that loops comparing against
+	 * `end()` at each step stay linear.  */
+	std::mutex array_ends_mutex;
+	std::unordered_map<unsigned int, unsigned int> array_ends;
 };
 
 }}
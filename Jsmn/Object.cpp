@@ -1,5 +1,6 @@
 #include<assert.h>
 #include<sstream>
+#include<string.h>
 #include"Jsmn/Detail/ParseResult.hpp"
 #include"Jsmn/Detail/Str.hpp"
 #include"Jsmn/Detail/Token.hpp"
@@ -8,17 +9,28 @@
 #include"Jsmn/Parser.hpp"
 #include"Util/Str.hpp"
 
+namespace {
+
+/* Objects with at least this many keys get a key index
+ * on first lookup; smaller ones are scanned.  */
+auto constexpr min_indexed_keys = 32;
+/* Arrays with at least this many elements have their
+ * end cached on first use; smaller ones are walked.  */
+auto constexpr min_cached_end = 32;
+
+}
+
 namespace Jsmn {
 
+/* Operations on a token of a parse result.  Constructed
+ * on the stack by each Object operation; holds no
+ * reference count.
+ */
 class Object::Impl {
 private:
-	std::shared_ptr<Detail::ParseResult> parse_result;
+	Detail::ParseResult* parse_result;
 	unsigned int i;
-	unsigned int i_end;
 
-	Detail::Token& token() {
-		return parse_result->tokens[i];
-	}
 	Detail::Token const& token() const {
 		return parse_result->tokens[i];
 	}
@@ -30,21 +42,80 @@ private:
 		return std::string(sb + b, sb + e);
 	}
 
+	/* Whether the given key token is the key s.  */
+	bool key_equals( Detail::Token const& key
+		       , std::string const& s
+		       ) const {
+		auto raw = &at(key.start);
+		auto len = std::size_t(key.end - key.start);
+		if (!memchr(raw, '\\', len))
+			return len == s.size()
+			    && memcmp(raw, s.data(), len) == 0
+			     ;
+		return Detail::Str::from_escaped(at(key.start, key.end)) == s;
+	}
+
+	Detail::KeyIndex const& key_index() const {
+		auto& tok = token();
+		auto& pr = *parse_result;
+		/* Entries are never removed, so the reference
+		 * remains valid after unlocking.  */
+		auto lock = std::lock_guard<std::mutex>(pr.key_indices_mutex);
+		auto it = pr.key_indices.find(i);
+		if (it != pr.key_indices.end())
+			return it->second;
+
+		auto& index = pr.key_indices[i];
+		index.usable = true;
+		index.values.reserve(tok.size);
+		auto tokptr = &tok + 1;
+		for (auto k = 0; k < tok.size; ++k, ++tokptr, Detail::Token::next(tokptr)) {
+			auto raw = &at(tokptr->start);
+			auto len = std::size_t(tokptr->end - tokptr->start);
+			if (memchr(raw, '\\', len)) {
+				index.usable = false;
+				index.values.clear();
+				break;
+			}
+			auto value = unsigned(tokptr + 1 - &pr.tokens[0]);
+			/* Like the scan, the first of duplicate
+			 * keys wins.  */
+			index.values.emplace(std::string_view(raw, len), value);
+		}
+		return index;
+	}
+
+	/* Return the token index of the value of key s,
+	 * or 0 if not found.  */
+	unsigned int find_key(std::string const& s) const {
+		auto& tok = token();
+		if (tok.type != Detail::Object)
+			throw TypeError();
+
+		if (tok.size >= min_indexed_keys) {
+			auto const& index = key_index();
+			if (index.usable) {
+				auto it = index.values.find(std::string_view(s));
+				if (it == index.values.end())
+					return 0;
+				return it->second;
+			}
+		}
+
+		auto tokptr = &tok + 1;
+		for (auto k = 0; k < tok.size; ++k, ++tokptr, Detail::Token::next(tokptr)) {
+			if (key_equals(*tokptr, s))
+				return tokptr + 1 - &parse_result->tokens[0];
+		}
+		return 0;
+	}
+
 public:
-	Impl( std::shared_ptr<Detail::ParseResult> parse_result_
+	Impl( Detail::ParseResult& parse_result_
 	    , unsigned int i_
-	    ) : parse_result(std::move(parse_result_))
+	    ) : parse_result(&parse_result_)
 	      , i(i_)
-	      , i_end(i_ + 1)
-	      {
-		if (type() == Detail::Array) {
-			auto& tok = token();
-			Detail::Token const* tokptr = &tok + 1;
-			for (auto step = 0; step < tok.size; ++step)
-				Detail::Token::next(tokptr);
-			i_end = tokptr - &parse_result->tokens[0];
-		}
-	}
+	      { }
 
 	Detail::Type type() const {
 		return token().type;
@@ -129,177 +200,186 @@ public:
 		return ret;
 	}
 	bool has(std::string const& s) const {
-		auto& tok = token();
-		if (tok.type != Detail::Object)
-			throw TypeError();
-
-		auto tokptr = &tok + 1;
-		for (auto i = 0; i < tok.size; ++i, ++tokptr, Detail::Token::next(tokptr)) {
-			auto ekey = at(tokptr->start, tokptr->end);
-			auto key = Detail::Str::from_escaped(ekey);
-			if (key == s)
-				return true;
-		}
-		return false;
+		return find_key(s) != 0;
 	}
-	std::shared_ptr<Impl> operator[](std::string const& s) const {
-		auto& tok = token();
-		if (tok.type != Detail::Object)
-			throw TypeError();
-
-		auto tokptr = &tok + 1;
-		for (auto i = int(0); i < tok.size; ++i, ++tokptr, Detail::Token::next(tokptr)) {
-			auto ekey = at(tokptr->start, tokptr->end);
-			auto key = Detail::Str::from_escaped(ekey);
-			if (key == s) {
-				++tokptr;
-				return std::make_shared<Impl>( parse_result
-							     , tokptr - &parse_result->tokens[0]
-							     );
-			}
-		}
-		return nullptr;
+	/* Return the token index of the value, or 0 if
+	 * not found.  */
+	unsigned int operator[](std::string const& s) const {
+		return find_key(s);
 	}
 
 	/* Array.  */
-	std::shared_ptr<Impl> operator[](std::size_t i) const {
+	/* Return the token index of the element, or 0 if
+	 * out of range.  */
+	unsigned int operator[](std::size_t i) const {
 		auto& tok = token();
 		if (tok.type != Detail::Array)
 			throw TypeError();
 
 		if (int(i) >= tok.size)
-			return nullptr;
+			return 0;
 
 		auto tokptr = &tok + 1;
 		for (auto step = 0; step < int(i); ++step)
 			Detail::Token::next(tokptr);
 
-		return std::make_shared<Impl>( parse_result
-					     , tokptr - &parse_result->tokens[0]
-					     );
+		return tokptr - &parse_result->tokens[0];
 	}
 
-	Detail::Iterator begin() const {
-		return Detail::Iterator(parse_result, i + 1);
+	/* Token index of the first element.  */
+	unsigned int begin() const {
+		return i + 1;
+	}
+	/* Token index just past the last element; non-arrays
+	 * are empty ranges.  */
+	unsigned int end() const {
+		auto& tok = token();
+		if (tok.type != Detail::Array)
+			return i + 1;
+		if (tok.size < min_cached_end)
+			return walk_end();
+
+		auto& pr = *parse_result;
+		auto lock = std::lock_guard<std::mutex>(pr.array_ends_mutex);
+		auto it = pr.array_ends.find(i);
+		if (it != pr.array_ends.end())
+			return it->second;
+		auto e = walk_end();
+		pr.array_ends.emplace(i, e);
+		return e;
 	}
-	Detail::Iterator end() const {
-		return Detail::Iterator(parse_result, i_end);
+
+private:
+	unsigned int walk_end() const {
+		auto& tok = token();
+		Detail::Token const* tokptr = &tok + 1;
+		for (auto step = 0; step < tok.size; ++step)
+			Detail::Token::next(tokptr);
+		return tokptr - &parse_result->tokens[0];
 	}
 };
 
-Object::Object() : pimpl(nullptr) { }
+Object::Object() : parse_result(nullptr), i(0) { }
+
+Object::Object( std::shared_ptr<Detail::ParseResult> parse_result_
+	      , unsigned int i_
+	      ) : parse_result(std::move(parse_result_))
+		, i(i_)
+		{ }
 
-Object::Object( std::shared_ptr<Detail::ParseResult> parse_result
-	      , unsigned int i
-	      ) : pimpl(std::make_shared<Impl>(std::move(parse_result), i)) {}
+Object::Impl Object::impl() const {
+	return Impl(*parse_result, i);
+}
 
 bool Object::is_null() const {
-	if (!pimpl)
+	if (!parse_result)
 		return true;
-	return pimpl->type() == Detail::Primitive && pimpl->first_char() == 'n';
+	return impl().type() == Detail::Primitive && impl().first_char() == 'n';
 }
 bool Object::is_boolean() const {
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	auto c = pimpl->first_char();
-	return pimpl->type() == Detail::Primitive && ((c == 'f') || (c == 't'));
+	auto c = impl().first_char();
+	return impl().type() == Detail::Primitive && ((c == 'f') || (c == 't'));
 }
 bool Object::is_string() const {
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	return pimpl->type() == Detail::String;
+	return impl().type() == Detail::String;
 }
 bool Object::is_object() const {
 	/* null is not considered an object, unlike JavaScript.  */
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	return pimpl->type() == Detail::Object;
+	return impl().type() == Detail::Object;
 }
 bool Object::is_array() const {
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	return pimpl->type() == Detail::Array;
+	return impl().type() == Detail::Array;
 }
 bool Object::is_number() const {
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	auto c = pimpl->first_char();
-	return pimpl->type() == Detail::Primitive
+	auto c = impl().first_char();
+	return impl().type() == Detail::Primitive
 	    && ((c != 't') && (c != 'f') && (c != 'n'))
 	     ;
 }
 
 Object::operator bool() const {
-	if (!pimpl)
+	if (!parse_result)
 		return false;
-	return (bool) (*pimpl);
+	return (bool) impl();
 }
 Object::operator std::string() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return (std::string) (*pimpl);
+	return (std::string) impl();
 }
 Object::operator double() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return (double) (*pimpl);
+	return (double) impl();
 }
 
 std::size_t Object::size() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return pimpl->size();
+	return impl().size();
 }
 std::vector<std::string> Object::keys() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return pimpl->keys();
+	return impl().keys();
 }
 bool Object::has(std::string const& s) const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return pimpl->has(s);
+	return impl().has(s);
 }
 Object Object::operator[](std::string const& s) const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	auto ret = Object();
-	ret.pimpl = (*pimpl)[s];
-	return ret;
+	auto value = impl()[s];
+	if (value == 0)
+		return Object();
+	return Object(parse_result, value);
 }
 
-Object Object::operator[](std::size_t i) const {
-	if (!pimpl)
+Object Object::operator[](std::size_t n) const {
+	if (!parse_result)
 		throw TypeError();
-	auto ret = Object();
-	ret.pimpl = (*pimpl)[i];
-	return ret;
+	auto element = impl()[n];
+	if (element == 0)
+		return Object();
+	return Object(parse_result, element);
 }
 
 std::string Object::direct_text() const {
-	if (!pimpl)
+	if (!parse_result)
 		return "null";
-	return pimpl->direct_text();
+	return impl().direct_text();
 }
 void Object::direct_text(char const*& t, std::size_t& len) const {
-	if (!pimpl) {
+	if (!parse_result) {
 		auto static const text = "null";
 		t = text;
 		len = 4;
 		return;
 	}
-	return pimpl->direct_text(t, len);
+	return impl().direct_text(t, len);
 }
 
 Detail::Iterator Object::begin() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return pimpl->begin();
+	return Detail::Iterator(parse_result, impl().begin());
 }
 Detail::Iterator Object::end() const {
-	if (!pimpl)
+	if (!parse_result)
 		throw TypeError();
-	return pimpl->end();
+	return Detail::Iterator(parse_result, impl().end());
 }
 
 Object Object::parse_json(char const* txt) {
@@ -22,11 +22,21 @@ public:
 	TypeError() : Util::BacktraceException<std::invalid_argument>("Incorrect type.") { }
 };
 
-/* Represents an object that has been parsed from a JSON string.  */
+/* Represents an object that has been parsed from a JSON string.
+ *
+ * This is a handle to a token of a shared parse result, so
+ * it is cheap to copy, and accessing fields and elements does
+ * not allocate.
+ */
 class Object {
 private:
 	class Impl;
-	std::shared_ptr<Impl> pimpl;
+	/* Null for a null object.  */
+	std::shared_ptr<Detail::ParseResult> parse_result;
+	/* Index of our token in the parse result.  */
+	unsigned int i;
+
+	Impl impl() const;
 
 	/* Used by class ParserExposedBuffer to construct.  */
 	Object( std::shared_ptr<Detail::ParseResult>
@@ -114,7 +114,8 @@ private:
 					     );
 			if (res > 0) {
 				assert(base.pos + start_idx <= end_idx);
-				auto pr = Detail::ParseResult();
+				auto ppr = std::make_shared<Detail::ParseResult>();
+				auto& pr = *ppr;
 				auto text = std::string( buffer.begin() + start_idx
 						       , buffer.begin() + start_idx + base.pos
 						       );
@@ -126,7 +127,6 @@ private:
 				start_idx += base.pos;
 				jsmn_init(&base);
 
-				auto ppr = std::make_shared<Detail::ParseResult>(std::move(pr));
 				auto o = Object(std::move(ppr), 0);
 				return Util::make_unique<Object>(std::move(o));
 			}
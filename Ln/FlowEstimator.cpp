@@ -0,0 +1,222 @@
+#include"Ln/FlowEstimator.hpp"
+#include"Ln/GossipGraph.hpp"
+#include"Util/make_unique.hpp"
+#include<algorithm>
+#include<cstdint>
+
+namespace {
+
+typedef Ln::GossipGraph::Index Index;
+
+}
+
+namespace Ln {
+
+class FlowEstimator::Impl {
+private:
+	std::shared_ptr<Ln::GossipGraph const> graph;
+
+	/* Amount already taken out of each directed
+	 * channel.  */
+	std::vector<std::uint64_t> used;
+	std::vector<Index> used_touched;
+
+	std::vector<unsigned char> excluded;
+	std::vector<Index> excluded_touched;
+
+	/* Layer k holds, for each node, the widest path
+	 * from the source with exactly k hops.  */
+	struct Layer {
+		std::vector<std::uint64_t> width;
+		/* The last channel of that path.  */
+		std::vector<Index> parent;
+		/* Nodes with non-zero width.  */
+		std::vector<Index> touched;
+	};
+	std::vector<Layer> layers;
+
+public:
+	explicit
+	Impl(std::shared_ptr<Ln::GossipGraph const> graph_
+	    ) : graph(std::move(graph_))
+	      , used(graph->num_channels(), 0)
+	      , excluded(graph->num_nodes(), 0)
+	      { }
+
+	Ln::GossipGraph const& get_graph() const { return *graph; }
+
+	FlowEstimator::Result estimate( Ln::NodeId const& from
+				      , Ln::NodeId const& to
+				      , std::vector<Ln::NodeId> const& exclude
+				      , std::size_t max_hops
+				      , std::size_t max_paths
+				      ) {
+		auto rv = FlowEstimator::Result{
+			Ln::Amount::msat(0), Ln::Amount::msat(0), 0
+		};
+
+		auto f = graph->lookup(from);
+		auto t = graph->lookup(to);
+		if ( f == Ln::GossipGraph::none
+		  || t == Ln::GossipGraph::none
+		  || f == t
+		  || max_hops == 0
+		   )
+			return rv;
+
+		for (auto const& n : exclude) {
+			auto i = graph->lookup(n);
+			if (i == Ln::GossipGraph::none || i == f || i == t)
+				continue;
+			if (excluded[i])
+				continue;
+			excluded[i] = 1;
+			excluded_touched.push_back(i);
+		}
+		while (layers.size() < max_hops + 1) {
+			layers.emplace_back();
+			auto& l = layers.back();
+			l.width.resize(graph->num_nodes(), 0);
+			l.parent.resize(graph->num_nodes(), Ln::GossipGraph::none);
+		}
+
+		while (rv.paths < max_paths) {
+			widen(f, t, max_hops);
+
+			/* Fewer hops win ties.  */
+			auto best_k = std::size_t(0);
+			auto best_plausible = double(0);
+			for (auto k = std::size_t(1); k <= max_hops; ++k) {
+				auto w = layers[k].width[t];
+				if (w == 0)
+					continue;
+				auto plausible = double(w) / double(k + 1);
+				if (plausible > best_plausible) {
+					best_k = k;
+					best_plausible = plausible;
+				}
+			}
+			if (best_k == 0) {
+				clear_layers(max_hops);
+				break;
+			}
+
+			auto width = layers[best_k].width[t];
+			auto path = std::vector<Index>();
+			auto n = t;
+			for (auto k = best_k; k > 0; --k) {
+				auto c = layers[k].parent[n];
+				path.push_back(c);
+				n = graph->channel(c).source;
+			}
+			clear_layers(max_hops);
+
+			rv.flow += Ln::Amount::msat(width);
+			rv.plausible += Ln::Amount::msat(width / (best_k + 1));
+			++rv.paths;
+
+			for (auto c : path)
+				for (auto d : graph->find(graph->channel(c).scid))
+					take(d, width);
+		}
+
+		for (auto c : used_touched)
+			used[c] = 0;
+		used_touched.clear();
+		for (auto n : excluded_touched)
+			excluded[n] = 0;
+		excluded_touched.clear();
+
+		return rv;
+	}
+
+private:
+	std::uint64_t residual(Index c) const {
+		auto cap = graph->channel(c).capacity.to_msat();
+		if (cap <= used[c])
+			return 0;
+		return cap - used[c];
+	}
+	void take(Index c, std::uint64_t amount) {
+		if (used[c] == 0)
+			used_touched.push_back(c);
+		used[c] += amount;
+	}
+
+	/* Fill in the layers with the widest paths from f
+	 * of each length.  */
+	void widen(Index f, Index t, std::size_t max_hops) {
+		layers[0].width[f] = ~std::uint64_t(0);
+		layers[0].touched.push_back(f);
+
+		for (auto k = std::size_t(1); k <= max_hops; ++k) {
+			auto const& prev = layers[k - 1];
+			auto& cur = layers[k];
+			if (k == max_hops) {
+				/* Only paths ending at t matter now.  */
+				for (auto c : graph->incoming(t)) {
+					auto u = graph->channel(c).source;
+					if (prev.width[u] != 0)
+						relax(cur, c, prev.width[u]);
+				}
+				break;
+			}
+			for (auto u : prev.touched) {
+				/* Paths end at t.  */
+				if (u == t)
+					continue;
+				for (auto const& ch : graph->outgoing(u)) {
+					auto v = ch.destination;
+					if (v == f || excluded[v])
+						continue;
+					relax( cur, graph->index_of(ch)
+					     , prev.width[u]
+					     );
+				}
+			}
+		}
+	}
+	void relax(Layer& cur, Index c, std::uint64_t prev_width) {
+		auto const& ch = graph->channel(c);
+		if (!ch.active)
+			return;
+		auto w = std::min(prev_width, residual(c));
+		auto v = ch.destination;
+		if (w <= cur.width[v])
+			return;
+		if (cur.width[v] == 0)
+			cur.touched.push_back(v);
+		cur.width[v] = w;
+		cur.parent[v] = c;
+	}
+	void clear_layers(std::size_t max_hops) {
+		for (auto k = std::size_t(0); k <= max_hops; ++k) {
+			auto& l = layers[k];
+			for (auto n : l.touched)
+				l.width[n] = 0;
+			l.touched.clear();
+		}
+	}
+};
+
+FlowEstimator::FlowEstimator(FlowEstimator&&) =default;
+FlowEstimator::~FlowEstimator() =default;
+
+FlowEstimator::FlowEstimator(std::shared_ptr<Ln::GossipGraph const> graph)
+	: pimpl(Util::make_unique<Impl>(std::move(graph))) { }
+
+Ln::GossipGraph const& FlowEstimator::graph() const {
+	return pimpl->get_graph();
+}
+
+FlowEstimator::Result
+FlowEstimator::estimate( Ln::NodeId const& from
+		       , Ln::NodeId const& to
+		       , std::vector<Ln::NodeId> const& exclude
+		       , std::size_t max_hops
+		       , std::size_t max_paths
+		       ) {
+	return pimpl->estimate(from, to, exclude, max_hops, max_paths);
+}
+
+}
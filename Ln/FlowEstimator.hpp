@@ -0,0 +1,79 @@
+#ifndef LN_FLOWESTIMATOR_HPP
+#define LN_FLOWESTIMATOR_HPP
+
+#include"Ln/Amount.hpp"
+#include"Ln/NodeId.hpp"
+#include<cstddef>
+#include<memory>
+#include<vector>
+
+namespace Ln { class GossipGraph; }
+
+namespace Ln {
+
+/** class Ln::FlowEstimator
+ *
+ * @brief estimates how much can plausibly be sent
+ * between two nodes, over a `Ln::GossipGraph`
+ * snapshot.
+ *
+ * @desc this is a greedy bounded-hop max-flow.
+ * Each round picks the path of at most `max_hops`
+ * hops with the best plausible capacity, i.e. its
+ * narrowest channel divided by the number of hops
+ * plus one, then takes the narrowest capacity out
+ * of each of its channels, in both directions since
+ * the two directions of a channel share its funds.
+ * This repeats until there are no more paths or
+ * `max_paths` paths have been taken.
+ *
+ * The flow is bounded by the minimum cut between
+ * the two nodes.
+ * The plausible capacity is lower, as channel
+ * balances are unknown and longer paths are less
+ * likely to succeed.
+ *
+ * The object keeps scratch arrays sized to the
+ * graph, so reuse one object for many estimates
+ * on the same graph.
+ */
+class FlowEstimator {
+public:
+	struct Result {
+		/* Sum of the narrowest capacity of each
+		 * path.  */
+		Ln::Amount flow;
+		/* Sum of the narrowest capacity of each
+		 * path, divided by its hops plus one.  */
+		Ln::Amount plausible;
+		std::size_t paths;
+	};
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	FlowEstimator() =delete;
+	FlowEstimator(FlowEstimator const&) =delete;
+	FlowEstimator(FlowEstimator&&);
+	~FlowEstimator();
+
+	explicit
+	FlowEstimator(std::shared_ptr<Ln::GossipGraph const> graph);
+
+	Ln::GossipGraph const& graph() const;
+
+	/* Paths do not pass through the `exclude` nodes.
+	 * Unknown nodes result in zero flow.  */
+	Result estimate( Ln::NodeId const& from
+		       , Ln::NodeId const& to
+		       , std::vector<Ln::NodeId> const& exclude
+		       , std::size_t max_hops
+		       , std::size_t max_paths
+		       );
+};
+
+}
+
+#endif /* !defined(LN_FLOWESTIMATOR_HPP) */
@@ -0,0 +1,123 @@
+#include"Ln/GossipGraph.hpp"
+#include<algorithm>
+#include<iterator>
+
+namespace Ln {
+
+GossipGraph::Index
+GossipGraph::lookup(Ln::NodeId const& n) const {
+	auto it = std::lower_bound(nodes.begin(), nodes.end(), n);
+	if (it == nodes.end() || *it != n)
+		return none;
+	return Index(it - nodes.begin());
+}
+
+GossipGraph::Range<GossipGraph::Index>
+GossipGraph::find(Ln::Scid const& scid) const {
+	auto b = std::lower_bound( by_scid.begin(), by_scid.end()
+				 , scid
+				 , [this](Index c, Ln::Scid const& s) {
+		return channels[c].scid < s;
+	});
+	auto e = std::upper_bound( b, by_scid.end()
+				 , scid
+				 , [this](Ln::Scid const& s, Index c) {
+		return s < channels[c].scid;
+	});
+	auto base = by_scid.data();
+	return Range<Index>( base + (b - by_scid.begin())
+			   , base + (e - by_scid.begin())
+			   );
+}
+
+void GossipGraph::update(Index c, Channel const& attrs) {
+	auto& ch = channels[c];
+	ch.capacity = attrs.capacity;
+	ch.base_fee = attrs.base_fee;
+	ch.proportional_fee = attrs.proportional_fee;
+	ch.delay = attrs.delay;
+	ch.active = attrs.active;
+}
+bool GossipGraph::same_attributes(Channel const& a, Channel const& b) {
+	return a.capacity == b.capacity
+	    && a.base_fee == b.base_fee
+	    && a.proportional_fee == b.proportional_fee
+	    && a.delay == b.delay
+	    && a.active == b.active
+	     ;
+}
+
+void GossipGraph::Builder::add_node(Ln::NodeId n) {
+	nodes.emplace_back(std::move(n));
+}
+void GossipGraph::Builder::add_channel( Ln::NodeId source
+				      , Ln::NodeId destination
+				      , Channel channel
+				      ) {
+	entries.emplace_back(Entry{
+		std::move(source), std::move(destination), channel
+	});
+}
+
+GossipGraph GossipGraph::Builder::build()&& {
+	auto ret = GossipGraph();
+
+	/* Collect and index the nodes.  */
+	for (auto const& e : entries) {
+		nodes.push_back(e.source);
+		nodes.push_back(e.destination);
+	}
+	std::sort(nodes.begin(), nodes.end());
+	nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+	ret.nodes = std::move(nodes);
+	auto num_nodes = ret.nodes.size();
+
+	/* Resolve endpoints and count degrees.  */
+	ret.out_offsets.assign(num_nodes + 1, 0);
+	ret.in_offsets.assign(num_nodes + 1, 0);
+	for (auto& e : entries) {
+		e.channel.source = ret.lookup(e.source);
+		e.channel.destination = ret.lookup(e.destination);
+		++ret.out_offsets[e.channel.source + 1];
+		++ret.in_offsets[e.channel.destination + 1];
+	}
+	for (auto n = std::size_t(0); n < num_nodes; ++n) {
+		ret.out_offsets[n + 1] += ret.out_offsets[n];
+		ret.in_offsets[n + 1] += ret.in_offsets[n];
+	}
+
+	/* Counting-sort the channels by source.  */
+	ret.channels.resize(entries.size());
+	{
+		auto fill = std::vector<Index>( ret.out_offsets.begin()
+					      , ret.out_offsets.end() - 1
+					      );
+		for (auto const& e : entries)
+			ret.channels[fill[e.channel.source]++] = e.channel;
+	}
+	entries.clear();
+	entries.shrink_to_fit();
+
+	/* Incoming index, also by counting sort.  */
+	ret.in_channels.resize(ret.channels.size());
+	{
+		auto fill = std::vector<Index>( ret.in_offsets.begin()
+					      , ret.in_offsets.end() - 1
+					      );
+		for (auto c = Index(0); c < ret.channels.size(); ++c)
+			ret.in_channels[fill[ret.channels[c].destination]++] = c;
+	}
+
+	/* Scid index.  */
+	ret.by_scid.resize(ret.channels.size());
+	for (auto c = Index(0); c < ret.channels.size(); ++c)
+		ret.by_scid[c] = c;
+	std::sort( ret.by_scid.begin(), ret.by_scid.end()
+		 , [&ret](Index a, Index b) {
+		return ret.channels[a].scid < ret.channels[b].scid;
+	});
+
+	return ret;
+}
+
+}
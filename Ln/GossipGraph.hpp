@@ -0,0 +1,174 @@
+#ifndef LN_GOSSIPGRAPH_HPP
+#define LN_GOSSIPGRAPH_HPP
+
+#include"Ln/Amount.hpp"
+#include"Ln/NodeId.hpp"
+#include"Ln/Scid.hpp"
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+
+namespace Ln {
+
+/** class Ln::GossipGraph
+ *
+ * @brief a compact in-memory snapshot of the public
+ * channel graph, i.e. what `listchannels` and
+ * `listnodes` report.
+ *
+ * @desc nodes are assigned dense indices in
+ * `Ln::NodeId` order.
+ * Each public channel appears once per direction,
+ * and the directed channels are stored sorted by
+ * their source node (compressed sparse row), so the
+ * outgoing channels of a node are one contiguous
+ * range.
+ * Secondary indices give the incoming channels of
+ * each node and the directed channels for a
+ * particular short channel ID.
+ *
+ * The attributes of existing channels (fees,
+ * capacity, delay, active) can be patched in place
+ * with `update`, but adding or removing channels
+ * requires building a fresh graph.
+ * The `generation` is a counter maintained by the
+ * owner of the graph, so that users can tell if
+ * results derived from an earlier graph are stale.
+ *
+ * Construct using `Ln::GossipGraph::Builder`.
+ */
+class GossipGraph {
+public:
+	typedef std::uint32_t Index;
+	/* Returned by `lookup` for unknown nodes.  */
+	static constexpr Index none = ~Index(0);
+
+	/* One direction of a public channel.  */
+	struct Channel {
+		Ln::Scid scid;
+		Index source;
+		Index destination;
+		Ln::Amount capacity;
+		/* In millisatoshi.  */
+		std::uint32_t base_fee;
+		/* In parts per million.  */
+		std::uint32_t proportional_fee;
+		/* In blocks.  */
+		std::uint32_t delay;
+		bool active;
+	};
+
+	/* Read-only view of a contiguous run of items.  */
+	template<typename a>
+	class Range {
+	private:
+		a const* b;
+		a const* e;
+	public:
+		Range(a const* b_, a const* e_) : b(b_), e(e_) { }
+		a const* begin() const { return b; }
+		a const* end() const { return e; }
+		std::size_t size() const { return e - b; }
+		bool empty() const { return b == e; }
+	};
+
+	class Builder;
+
+	GossipGraph() : generation_(0), out_offsets(1, 0), in_offsets(1, 0) { }
+	GossipGraph(GossipGraph&&) =default;
+	GossipGraph(GossipGraph const&) =default;
+	GossipGraph& operator=(GossipGraph&&) =default;
+	GossipGraph& operator=(GossipGraph const&) =default;
+
+	std::uint64_t generation() const { return generation_; }
+	void set_generation(std::uint64_t g) { generation_ = g; }
+
+	std::size_t num_nodes() const { return nodes.size(); }
+	std::size_t num_channels() const { return channels.size(); }
+
+	Ln::NodeId const& node(Index n) const { return nodes[n]; }
+	/* Return `none` if the node is not in the graph.  */
+	Index lookup(Ln::NodeId const&) const;
+
+	Channel const& channel(Index c) const { return channels[c]; }
+	/* Index of the given channel within `channels`.  */
+	Index index_of(Channel const& c) const {
+		return Index(&c - channels.data());
+	}
+
+	/* Directed channels whose source is the given node.  */
+	Range<Channel> outgoing(Index n) const {
+		auto base = channels.data();
+		return Range<Channel>( base + out_offsets[n]
+				     , base + out_offsets[n + 1]
+				     );
+	}
+	/* Indices of directed channels whose destination
+	 * is the given node.  */
+	Range<Index> incoming(Index n) const {
+		auto base = in_channels.data();
+		return Range<Index>( base + in_offsets[n]
+				   , base + in_offsets[n + 1]
+				   );
+	}
+	/* Indices of directed channels with the given
+	 * short channel ID; at most one per direction.  */
+	Range<Index> find(Ln::Scid const&) const;
+
+	/* Overwrite the attributes of the given channel;
+	 * its `scid`, `source` and `destination` are kept.  */
+	void update(Index c, Channel const& attrs);
+	/* Whether the attributes of the two channels are
+	 * the same, ignoring `scid`, `source` and
+	 * `destination`.  */
+	static bool same_attributes(Channel const& a, Channel const& b);
+
+private:
+	std::uint64_t generation_;
+	/* Sorted.  */
+	std::vector<Ln::NodeId> nodes;
+	/* Sorted by source.  */
+	std::vector<Channel> channels;
+	/* num_nodes() + 1 entries; outgoing channels of
+	 * node n are [out_offsets[n], out_offsets[n + 1]).  */
+	std::vector<Index> out_offsets;
+	/* Same, but for in_channels.  */
+	std::vector<Index> in_offsets;
+	std::vector<Index> in_channels;
+	/* Channel indices sorted by scid.  */
+	std::vector<Index> by_scid;
+};
+
+/** class Ln::GossipGraph::Builder
+ *
+ * @brief accumulates nodes and directed channels in
+ * any order, then packs them into a `GossipGraph`.
+ */
+class GossipGraph::Builder {
+private:
+	struct Entry {
+		Ln::NodeId source;
+		Ln::NodeId destination;
+		Channel channel;
+	};
+	std::vector<Ln::NodeId> nodes;
+	std::vector<Entry> entries;
+
+public:
+	/* Nodes that are endpoints of channels are added
+	 * automatically; this is only needed for nodes
+	 * without any channels.  */
+	void add_node(Ln::NodeId n);
+	/* The `source` and `destination` fields of the
+	 * given channel are ignored.  */
+	void add_channel( Ln::NodeId source
+			, Ln::NodeId destination
+			, Channel channel
+			);
+
+	GossipGraph build()&&;
+};
+
+}
+
+#endif /* !defined(LN_GOSSIPGRAPH_HPP) */
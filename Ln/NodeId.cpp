@@ -55,6 +55,30 @@ NodeId::operator std::string() const {
 	return Util::Str::hexdump(pimpl->raw, sizeof(pimpl->raw));
 }
 
+void NodeId::to_buffer(std::uint8_t d[33]) const {
+	if (!pimpl)
+		std::fill(d, d + 33, std::uint8_t(0));
+	else
+		std::copy(pimpl->raw, pimpl->raw + 33, d);
+}
+void NodeId::from_buffer(std::uint8_t const d[33]) {
+	if (std::all_of( d, d + 33
+		       , [](std::uint8_t b) { return b == 0; }
+		       )) {
+		pimpl = nullptr;
+		return;
+	}
+	if (d[0] != 0x02 && d[0] != 0x03)
+		throw Util::BacktraceException<std::range_error>(
+			std::string("Ln::NodeId: not node ID: ") +
+			Util::Str::hexdump(d, 33)
+		);
+
+	auto tmp = std::make_shared<Impl>();
+	std::copy(d, d + 33, tmp->raw);
+	pimpl = std::move(tmp);
+}
+
 bool NodeId::equality_check(NodeId const& o) const {
 	if (!o.pimpl && pimpl)
 		return false;
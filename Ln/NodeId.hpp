@@ -40,6 +40,12 @@ public:
 	explicit
 	operator std::string() const;
 
+	/* Raw 33-byte compressed public key.  The null node ID
+	 * is all zeros.  */
+	void to_buffer(std::uint8_t d[33]) const;
+	/* Throws std::range_error if not a valid node ID.  */
+	void from_buffer(std::uint8_t const d[33]);
+
 	explicit
 	operator bool() const { return !!pimpl; }
 	bool operator!() const { return !bool(*this); }
@@ -0,0 +1,427 @@
+#include"Graph/DaryHeap.hpp"
+#include"Ln/GossipGraph.hpp"
+#include"Ln/RouteFinder.hpp"
+#include"Util/make_unique.hpp"
+#include<algorithm>
+
+namespace {
+
+typedef Ln::GossipGraph::Index Index;
+
+/* What a node would receive in order to forward the
+ * payment the rest of the way to the destination.  */
+struct Label {
+	std::uint64_t amount;
+	std::uint32_t delay;
+	std::uint32_t hops;
+
+	bool operator<(Label const& o) const {
+		if (amount != o.amount)
+			return amount < o.amount;
+		if (delay != o.delay)
+			return delay < o.delay;
+		return hops < o.hops;
+	}
+};
+
+std::uint64_t fee_msat( std::uint32_t base_fee
+		      , std::uint32_t proportional_fee
+		      , std::uint64_t amount
+		      ) {
+	/* Split the amount so that the multiplication cannot
+	 * overflow; this is still exactly the rounded-down
+	 * amount * proportional_fee / 1000000.  */
+	return std::uint64_t(base_fee)
+	     + (amount / 1000000) * proportional_fee
+	     + (amount % 1000000) * proportional_fee / 1000000
+	     ;
+}
+
+}
+
+namespace Ln {
+
+class RouteFinder::Impl {
+private:
+	enum State : unsigned char { Unreached, Open, Closed };
+
+	std::shared_ptr<Ln::GossipGraph const> graph;
+
+	/* Scratch space for the search, indexed by a node
+	 * and its number of hops to the destination, as
+	 * `hops * num_nodes + node`, so that a cheaper path
+	 * with too many hops does not hide a costlier one
+	 * within the hop limit.  Grown to the largest hop
+	 * limit searched so far.  */
+	Graph::DaryHeap<Label> queue;
+	std::vector<Label> labels;
+	/* The channel from the node towards the destination.  */
+	std::vector<Index> next;
+	std::vector<State> states;
+	/* States that have to be reset.  */
+	std::vector<Index> touched;
+	/* Per node, the first of its states to be closed,
+	 * i.e. the one with the lowest amount.  */
+	std::vector<Index> first_closed;
+	/* Nodes whose first closed state has to be reset.  */
+	std::vector<Index> closed_nodes;
+
+	/* Excluded nodes and channels.  */
+	std::vector<unsigned char> banned_nodes;
+	std::vector<unsigned char> banned_channels;
+	/* What to unban at the end of a query or spur.  */
+	std::vector<Index> query_banned_nodes;
+	std::vector<Index> query_banned_channels;
+
+	/* The current query.  */
+	Index source;
+	Index destination;
+	std::uint64_t dest_amount;
+	std::uint64_t max_amount;
+	std::uint32_t final_cltv;
+	std::uint32_t max_delay;
+	std::size_t max_hops;
+
+	typedef std::vector<Index> Path;
+	struct Found {
+		Path path;
+		RouteFinder::Route route;
+	};
+
+public:
+	explicit
+	Impl(std::shared_ptr<Ln::GossipGraph const> graph_
+	    ) : graph(std::move(graph_))
+	      , first_closed(graph->num_nodes(), Ln::GossipGraph::none)
+	      , banned_nodes(graph->num_nodes(), 0)
+	      , banned_channels(graph->num_channels(), 0)
+	      { }
+
+	Ln::GossipGraph const& get_graph() const { return *graph; }
+
+	std::vector<RouteFinder::Route> find(RouteFinder::Query const& q) {
+		auto rv = std::vector<RouteFinder::Route>();
+
+		source = graph->lookup(q.source);
+		destination = graph->lookup(q.destination);
+		if ( source == Ln::GossipGraph::none
+		  || destination == Ln::GossipGraph::none
+		  || source == destination
+		  || q.count == 0
+		  || q.max_hops == 0
+		   )
+			return rv;
+		dest_amount = q.amount.to_msat();
+		max_amount = dest_amount + q.max_fee.to_msat();
+		if (max_amount < dest_amount)
+			/* Overflowed.  */
+			max_amount = ~std::uint64_t(0);
+		final_cltv = q.final_cltv;
+		max_delay = q.max_delay;
+		max_hops = q.max_hops;
+
+		ban_query(q);
+
+		auto accepted = std::vector<Found>();
+		auto candidates = std::vector<Found>();
+
+		auto first = search(source, max_hops);
+		if (!first.empty())
+			add_candidate(candidates, accepted, std::move(first));
+
+		while (!candidates.empty()) {
+			/* Move the best candidate to the accepted
+			 * routes.  */
+			auto best = std::min_element( candidates.begin()
+						    , candidates.end()
+						    , &better
+						    );
+			accepted.push_back(std::move(*best));
+			candidates.erase(best);
+			if (accepted.size() >= q.count)
+				break;
+
+			/* Yen's algorithm: deviate from the last
+			 * accepted path at each of its nodes.  */
+			auto const last = accepted.back().path;
+			for (auto i = std::size_t(0); i < last.size(); ++i) {
+				auto spur = node_at(last, i);
+				auto spur_banned_nodes = std::vector<Index>();
+				auto spur_banned_channels = std::vector<Index>();
+				/* The root path cannot be revisited.  */
+				for (auto j = std::size_t(0); j < i; ++j)
+					ban(banned_nodes, spur_banned_nodes
+					   , node_at(last, j)
+					   );
+				/* Accepted paths with the same root cannot
+				 * be repeated.  */
+				for (auto const& a : accepted) {
+					if (a.path.size() <= i)
+						continue;
+					if (!std::equal( last.begin()
+						       , last.begin() + i
+						       , a.path.begin()
+						       ))
+						continue;
+					ban( banned_channels
+					   , spur_banned_channels
+					   , a.path[i]
+					   );
+				}
+
+				auto spur_path = search(spur, max_hops - i);
+
+				unban(banned_nodes, spur_banned_nodes);
+				unban(banned_channels, spur_banned_channels);
+
+				if (spur_path.empty())
+					continue;
+				auto path = Path(last.begin(), last.begin() + i);
+				path.insert( path.end()
+					   , spur_path.begin(), spur_path.end()
+					   );
+				add_candidate(candidates, accepted, std::move(path));
+			}
+		}
+
+		unban(banned_nodes, query_banned_nodes);
+		unban(banned_channels, query_banned_channels);
+
+		for (auto& a : accepted)
+			rv.emplace_back(std::move(a.route));
+		return rv;
+	}
+
+private:
+	void ban_query(RouteFinder::Query const& q) {
+		for (auto const& n : q.exclude_nodes) {
+			auto i = graph->lookup(n);
+			if ( i == Ln::GossipGraph::none
+			  || i == source || i == destination
+			   )
+				continue;
+			ban(banned_nodes, query_banned_nodes, i);
+		}
+		for (auto const& e : q.exclude_channels)
+			for (auto c : graph->find(e.first))
+				if (direction(graph->channel(c)) == e.second)
+					ban(banned_channels, query_banned_channels, c);
+	}
+	static
+	void ban( std::vector<unsigned char>& flags
+		, std::vector<Index>& undo
+		, Index i
+		) {
+		if (flags[i])
+			return;
+		flags[i] = 1;
+		undo.push_back(i);
+	}
+	static
+	void unban( std::vector<unsigned char>& flags
+		  , std::vector<Index>& undo
+		  ) {
+		for (auto i : undo)
+			flags[i] = 0;
+		undo.clear();
+	}
+
+	int direction(Ln::GossipGraph::Channel const& ch) const {
+		return graph->node(ch.source) > graph->node(ch.destination) ?
+			1 : 0;
+	}
+	/* The node at which the given hop of the path
+	 * starts.  */
+	Index node_at(Path const& path, std::size_t i) const {
+		if (i == 0)
+			return source;
+		return graph->channel(path[i - 1]).destination;
+	}
+
+	/* Search backwards from the destination for the
+	 * cheapest path from the target, with at most
+	 * `hop_limit` hops, and return its channels in
+	 * order from the target, or an empty path if
+	 * there is none.  */
+	Path search(Index target, std::size_t hop_limit) {
+		auto rv = Path();
+		auto const num_nodes = std::size_t(graph->num_nodes());
+
+		/* The best path never visits a node twice.  */
+		if (hop_limit > num_nodes - 1)
+			hop_limit = num_nodes - 1;
+		auto const num_states = num_nodes * (hop_limit + 1);
+		if (states.size() < num_states) {
+			labels.resize(num_states);
+			next.resize(num_states, Ln::GossipGraph::none);
+			states.resize(num_states, Unreached);
+			queue.reserve(num_states);
+		}
+
+		auto found = Ln::GossipGraph::none;
+		reach(destination, Label{dest_amount, final_cltv, 0});
+		queue.push(destination, labels[destination]);
+		while (!queue.empty()) {
+			auto s = queue.pop();
+			states[s] = Closed;
+			auto v = Index(s % num_nodes);
+			if (v == target) {
+				found = s;
+				break;
+			}
+			auto const lv = labels[s];
+			/* States are closed in order of amount, so if
+			 * an earlier one of this node has no more hops
+			 * and no more delay, anything reached from this
+			 * one is reached more cheaply from that.  */
+			if (first_closed[v] == Ln::GossipGraph::none) {
+				first_closed[v] = s;
+				closed_nodes.push_back(v);
+			} else {
+				auto const& lf = labels[first_closed[v]];
+				if (lf.hops <= lv.hops && lf.delay <= lv.delay)
+					continue;
+			}
+			if (lv.hops >= hop_limit)
+				continue;
+			for (auto c : graph->incoming(v)) {
+				auto const& ch = graph->channel(c);
+				auto u = ch.source;
+				if (banned_nodes[u] || banned_channels[c])
+					continue;
+				if (!ch.active)
+					continue;
+				if (ch.capacity.to_msat() < lv.amount)
+					continue;
+				auto l = lv;
+				/* The source is the sender, and does not
+				 * charge itself.  */
+				if (u != source) {
+					l.amount += fee_msat( ch.base_fee
+							    , ch.proportional_fee
+							    , lv.amount
+							    );
+					l.delay += ch.delay;
+				}
+				++l.hops;
+				if (l.amount > max_amount || l.delay > max_delay)
+					continue;
+
+				auto su = Index(l.hops * num_nodes + u);
+				if (states[su] == Closed)
+					continue;
+				if (states[su] == Unreached) {
+					reach(su, l);
+					next[su] = c;
+					queue.push(su, l);
+				} else if (l < labels[su]) {
+					labels[su] = l;
+					next[su] = c;
+					queue.decrease(su, l);
+				}
+			}
+		}
+
+		if (found != Ln::GossipGraph::none)
+			for (auto s = found; labels[s].hops != 0; ) {
+				auto c = next[s];
+				rv.push_back(c);
+				s = Index( (labels[s].hops - 1) * num_nodes
+					 + graph->channel(c).destination
+					 );
+			}
+
+		queue.clear();
+		for (auto s : touched)
+			states[s] = Unreached;
+		touched.clear();
+		for (auto n : closed_nodes)
+			first_closed[n] = Ln::GossipGraph::none;
+		closed_nodes.clear();
+
+		return rv;
+	}
+	void reach(Index s, Label const& l) {
+		states[s] = Open;
+		labels[s] = l;
+		touched.push_back(s);
+	}
+
+	/* Evaluate the path exactly and add it to the
+	 * candidates if it is new and within the limits.  */
+	void add_candidate( std::vector<Found>& candidates
+			  , std::vector<Found> const& accepted
+			  , Path path
+			  ) {
+		auto same = [&path](Found const& f) {
+			return f.path == path;
+		};
+		if (std::any_of(accepted.begin(), accepted.end(), same))
+			return;
+		if (std::any_of(candidates.begin(), candidates.end(), same))
+			return;
+
+		auto route = RouteFinder::Route();
+		route.hops.resize(path.size());
+		auto amount = dest_amount;
+		auto delay = final_cltv;
+		for (auto i = path.size(); i-- > 0; ) {
+			auto const& ch = graph->channel(path[i]);
+			if (ch.capacity.to_msat() < amount)
+				return;
+			auto& hop = route.hops[i];
+			hop.id = graph->node(ch.destination);
+			hop.channel = ch.scid;
+			hop.direction = direction(ch);
+			hop.amount = Ln::Amount::msat(amount);
+			hop.delay = delay;
+			if (i == 0)
+				break;
+			amount += fee_msat( ch.base_fee, ch.proportional_fee
+					  , amount
+					  );
+			delay += ch.delay;
+		}
+		if (amount > max_amount || delay > max_delay)
+			return;
+		route.fee = Ln::Amount::msat(amount - dest_amount);
+
+		candidates.emplace_back(Found{std::move(path), std::move(route)});
+	}
+	static
+	bool better(Found const& a, Found const& b) {
+		auto const& ra = a.route;
+		auto const& rb = b.route;
+		if (ra.fee != rb.fee)
+			return ra.fee < rb.fee;
+		if (ra.hops[0].delay != rb.hops[0].delay)
+			return ra.hops[0].delay < rb.hops[0].delay;
+		return ra.hops.size() < rb.hops.size();
+	}
+};
+
+RouteFinder::RouteFinder(RouteFinder&&) =default;
+RouteFinder::~RouteFinder() =default;
+
+RouteFinder::RouteFinder(std::shared_ptr<Ln::GossipGraph const> graph)
+	: pimpl(Util::make_unique<Impl>(std::move(graph))) { }
+
+Ln::GossipGraph const& RouteFinder::graph() const {
+	return pimpl->get_graph();
+}
+
+std::vector<RouteFinder::Route>
+RouteFinder::find(Query const& q) {
+	return pimpl->find(q);
+}
+
+Ln::Amount RouteFinder::fee( std::uint32_t base_fee
+			   , std::uint32_t proportional_fee
+			   , Ln::Amount amount
+			   ) {
+	return Ln::Amount::msat(fee_msat( base_fee, proportional_fee
+					, amount.to_msat()
+					));
+}
+
+}
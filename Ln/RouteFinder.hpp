@@ -0,0 +1,128 @@
+#ifndef LN_ROUTEFINDER_HPP
+#define LN_ROUTEFINDER_HPP
+
+#include"Ln/Amount.hpp"
+#include"Ln/NodeId.hpp"
+#include"Ln/Scid.hpp"
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<utility>
+#include<vector>
+
+namespace Ln { class GossipGraph; }
+
+namespace Ln {
+
+/** class Ln::RouteFinder
+ *
+ * @brief finds payment routes over a
+ * `Ln::GossipGraph` snapshot, without asking
+ * `lightningd` via `getroute`.
+ *
+ * @desc routes are searched backwards from the
+ * destination, so that the amount each hop must
+ * forward, including the fees of later hops, is
+ * known exactly when a channel is considered.
+ * Routes with the lowest fee are preferred, then
+ * those with the lowest total delay, then those
+ * with fewer hops.  The search keeps a separate
+ * label for each number of hops a node is from the
+ * destination, so the hop limit never hides a
+ * route within it behind a cheaper, longer one.
+ *
+ * As with `getroute` with a `fromid`, the source
+ * is treated as the sender: it does not charge a
+ * fee for the first hop, and the route does not
+ * include any hop into the source.
+ *
+ * Several alternative routes can be requested in
+ * one query, which are found with Yen's
+ * k-shortest-paths algorithm.
+ *
+ * The object keeps scratch arrays sized to the
+ * graph times the hop limit, so reuse one object
+ * for many queries on the same graph.
+ */
+class RouteFinder {
+public:
+	/* One hop of a route, in the same format as an
+	 * entry of the `getroute` result.  */
+	struct Hop {
+		/* The node this hop reaches.  */
+		Ln::NodeId id;
+		Ln::Scid channel;
+		int direction;
+		/* Amount the node receives.  */
+		Ln::Amount amount;
+		/* CLTV delay at the node.  */
+		std::uint32_t delay;
+	};
+	struct Route {
+		std::vector<Hop> hops;
+		/* Total fees charged by the intermediate
+		 * nodes, i.e. the amount of the first hop
+		 * minus the amount of the last hop.  */
+		Ln::Amount fee;
+	};
+
+	struct Query {
+		Ln::NodeId source;
+		Ln::NodeId destination;
+		/* Amount to deliver to the destination.  */
+		Ln::Amount amount;
+		/* CLTV delay at the destination.  */
+		std::uint32_t final_cltv;
+		/* Limits; routes exceeding them are not
+		 * returned.  */
+		Ln::Amount max_fee;
+		std::uint32_t max_delay;
+		std::size_t max_hops;
+		/* Neither the source nor the destination
+		 * can be excluded.  */
+		std::vector<Ln::NodeId> exclude_nodes;
+		/* Short channel ID and direction.  */
+		std::vector<std::pair<Ln::Scid, int>> exclude_channels;
+		/* Maximum number of routes to return.  */
+		std::size_t count;
+
+		Query() : final_cltv(9)
+			, max_fee(Ln::Amount::btc(21000000))
+			, max_delay(2016)
+			, max_hops(20)
+			, count(1)
+			{ }
+	};
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> pimpl;
+
+public:
+	RouteFinder() =delete;
+	RouteFinder(RouteFinder const&) =delete;
+	RouteFinder(RouteFinder&&);
+	~RouteFinder();
+
+	explicit
+	RouteFinder(std::shared_ptr<Ln::GossipGraph const> graph);
+
+	Ln::GossipGraph const& graph() const;
+
+	/* Return up to `q.count` routes, best first, or
+	 * an empty vector if there is no route within
+	 * the limits.  */
+	std::vector<Route> find(Query const& q);
+
+	/* The fee a channel with the given fees charges
+	 * to forward the given amount.  */
+	static
+	Ln::Amount fee( std::uint32_t base_fee
+		      , std::uint32_t proportional_fee
+		      , Ln::Amount amount
+		      );
+};
+
+}
+
+#endif /* !defined(LN_ROUTEFINDER_HPP) */
@@ -0,0 +1,55 @@
+#include"Net/WriteQueue.hpp"
+#include<algorithm>
+#include<assert.h>
+#include<limits.h>
+#include<sys/uio.h>
+
+namespace {
+
+/* Chunks to pass to a single writev.  */
+#ifdef IOV_MAX
+auto constexpr max_iov = std::size_t(IOV_MAX < 64 ? IOV_MAX : 64);
+#else
+auto constexpr max_iov = std::size_t(16);
+#endif
+
+}
+
+namespace Net {
+
+ssize_t WriteQueue::write_to(int fd) {
+	if (total == 0)
+		return 0;
+
+	struct iovec iov[max_iov];
+	auto n = std::min(max_iov, chunks.size());
+	for (auto i = std::size_t(0); i < n; ++i) {
+		auto& c = chunks[i];
+		auto skip = (i == 0) ? offset : 0;
+		iov[i].iov_base = &c[skip];
+		iov[i].iov_len = c.size() - skip;
+	}
+
+	auto res = writev(fd, iov, int(n));
+	if (res <= 0)
+		return res;
+
+	/* Drop written data.  */
+	auto written = std::size_t(res);
+	total -= written;
+	while (written != 0) {
+		assert(!chunks.empty());
+		auto left = chunks.front().size() - offset;
+		if (written < left) {
+			offset += written;
+			break;
+		}
+		written -= left;
+		offset = 0;
+		chunks.pop_front();
+	}
+
+	return res;
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef NET_WRITEQUEUE_HPP
+#define NET_WRITEQUEUE_HPP
+
+#include<cstddef>
+#include<deque>
+#include<string>
+#include<sys/types.h>
+
+namespace Net {
+
+/** class Net::WriteQueue
+ *
+ * @brief queue of data waiting to be written to
+ * a file descriptor.
+ *
+ * @desc data is queued as whole chunks, which
+ * are moved in and never copied, and written
+ * with `writev`, several chunks per call.
+ * Written data is dropped by advancing an offset
+ * into the first chunk, so partial writes do not
+ * move the rest of the data.
+ */
+class WriteQueue {
+private:
+	std::deque<std::string> chunks;
+	/* Bytes of the first chunk already written.  */
+	std::size_t offset;
+	/* Bytes not yet written.  */
+	std::size_t total;
+
+public:
+	WriteQueue() : offset(0), total(0) { }
+	WriteQueue(WriteQueue&&) =default;
+	WriteQueue& operator=(WriteQueue&&) =default;
+
+	void push(std::string chunk) {
+		if (chunk.empty())
+			return;
+		total += chunk.size();
+		chunks.push_back(std::move(chunk));
+	}
+
+	bool empty() const { return total == 0; }
+	std::size_t size() const { return total; }
+
+	/** Net::WriteQueue::write_to
+	 *
+	 * @brief performs a single `writev` of the
+	 * queued data to the given file descriptor,
+	 * and drops whatever was written from the
+	 * queue.
+	 *
+	 * @desc returns the result of `writev`, i.e.
+	 * the number of bytes written, or -1 with
+	 * `errno` set.
+	 */
+	ssize_t write_to(int fd);
+};
+
+}
+
+#endif /* !defined(NET_WRITEQUEUE_HPP) */
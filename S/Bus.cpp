@@ -1,10 +1,24 @@
 #include<S/Bus.hpp>
 #include<Util/make_unique.hpp>
 #include<assert.h>
+#include<iostream>
 #include<unordered_map>
 
 namespace S {
 
+void Detail::SignalBase::report(std::exception_ptr e) {
+	std::cerr << "Unhandled exception in bus handler!"
+		  << std::endl
+		  ;
+	try {
+		std::rethrow_exception(e);
+	} catch (std::exception const& e) {
+		std::cerr << e.what() << std::endl;
+	} catch (...) {
+		std::cerr << "Unknown type!" << std::endl;
+	}
+}
+
 class Bus::Impl {
 private:
 	std::unordered_map< std::type_index
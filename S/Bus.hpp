@@ -2,6 +2,7 @@
 #define S_BUS_HPP
 
 #include<S/Detail/Signal.hpp>
+#include<S/Key.hpp>
 #include<typeindex>
 #include<typeinfo>
 
@@ -48,10 +49,31 @@ public:
 	void subscribe(std::function<Ev::Io<void>(a const&)> cb) {
 		get_signal_ex<a>().subscribe(std::move(cb));
 	}
+	/* Subscribes only to messages whose S::Key<a> is the
+	 * given key.
+	 * Raising such a message then skips the handlers for
+	 * other keys entirely.
+	 */
+	template<typename a>
+	void subscribe( std::string const& key
+		      , std::function<Ev::Io<void>(a const&)> cb
+		      ) {
+		get_signal_ex<a>().subscribe( key, std::move(cb)
+					    , &S::Key<a>::get
+					    );
+	}
 	template<typename a>
 	Ev::Io<void> raise(a value) {
 		return get_signal_ex<a>().raise(std::move(value));
 	}
+	/* Runs the handlers immediately instead of from the
+	 * main loop; see S::Detail::Signal::raise_sync.
+	 * Only for messages whose handlers never block.
+	 */
+	template<typename a>
+	void raise_sync(a value) {
+		get_signal_ex<a>().raise_sync(std::move(value));
+	}
 };
 
 }
@@ -2,17 +2,21 @@
 #define S_DETAIL_SIGNAL_HPP
 
 #include<Ev/Io.hpp>
-#include<Ev/concurrent.hpp>
 #include<Ev/yield.hpp>
 #include<S/Detail/SignalBase.hpp>
 #include<Util/make_unique.hpp>
 #include<functional>
 #include<memory>
+#include<optional>
+#include<string>
+#include<unordered_map>
+#include<vector>
 
 namespace S { namespace Detail {
 
 /* Registers callbacks for a particular type a, and
- * broadcasts to all callbacks.  */
+ * broadcasts to all callbacks, or to the callbacks
+ * registered for the key of the value.  */
 template<typename a>
 class Signal : public SignalBase {
 private:
@@ -21,29 +25,53 @@ private:
 		std::function<Ev::Io<void>(a const&)> callback;
 		std::shared_ptr<Node> next;
 	};
-	std::shared_ptr<Node> first;
-	Node* last;
+	struct List {
+		std::shared_ptr<Node> first;
+		Node* last;
+
+		List() : first(), last(nullptr) { }
+
+		void add(std::function<Ev::Io<void>(a const&)> callback) {
+			auto nnode = std::make_shared<Node>();
+			nnode->callback = std::move(callback);
+			if (last) {
+				last->next = std::move(nnode);
+				last = last->next.get();
+			} else {
+				first = std::move(nnode);
+				last = first.get();
+			}
+		}
+	};
+	/* Callbacks for all values.  */
+	List all;
+	/* Callbacks for values with a particular key, and the
+	 * function to get the key of a value, if there are
+	 * any.  */
+	std::unordered_map<std::string, List> keyed;
+	std::string const& (*get_key)(a const&);
 
 public:
-	Signal() : first(), last(nullptr) { }
+	Signal() : get_key(nullptr) { }
 
 private:
+	/* State of one raise, shared by the handlers it
+	 * started.
+	 * These are pooled, and reference-counted by Ref,
+	 * so that a raise does not need to allocate them
+	 * or a copy of the value.
+	 */
 	struct RaiseData {
-		std::unique_ptr<a> value;
+		std::optional<a> value;
 		std::function<void()> pass;
 		std::function<void(std::exception_ptr)> fail;
 		std::exception_ptr exc;
 		bool starting;
 		std::size_t running;
-		explicit
-		RaiseData(a value_
-			 ) : value(Util::make_unique<a>(std::move(value_)))
-			   , pass(nullptr)
-			   , fail(nullptr)
-			   , exc(nullptr)
-			   , starting(true)
-			   , running(0)
-			   { }
+		std::size_t refs;
+
+		RaiseData() : starting(true), running(0), refs(0) { }
+
 		void finish_startup() {
 			starting = false;
 			if (running == 0)
@@ -55,81 +83,179 @@ private:
 				trigger();
 		}
 		void trigger() {
-			value = nullptr;
-			if (exc) {
-				pass = nullptr;
-				fail(exc);
-			} else {
-				fail = nullptr;
-				pass();
-			}
+			value.reset();
+			auto e = std::move(exc);
+			auto p = std::move(pass);
+			auto f = std::move(fail);
+			exc = nullptr;
+			pass = nullptr;
+			fail = nullptr;
+			if (e)
+				f(std::move(e));
+			else
+				p();
 		}
 	};
+	/* Free RaiseData, shared by all Signal<a>.  */
+	static
+	std::vector<std::unique_ptr<RaiseData>>& pool() {
+		static std::vector<std::unique_ptr<RaiseData>> rv;
+		return rv;
+	}
+	static constexpr std::size_t max_pool = 64;
+
+	class Ref {
+	private:
+		RaiseData* p;
+	public:
+		explicit Ref(RaiseData* p_) : p(p_) { ++p->refs; }
+		Ref(Ref const& o) : p(o.p) { if (p) ++p->refs; }
+		Ref(Ref&& o) noexcept : p(o.p) { o.p = nullptr; }
+		Ref& operator=(Ref const&) =delete;
+		~Ref() {
+			if (!p || --p->refs != 0)
+				return;
+			p->value.reset();
+			p->pass = nullptr;
+			p->fail = nullptr;
+			p->exc = nullptr;
+			auto& free = pool();
+			if (free.size() < max_pool)
+				free.emplace_back(p);
+			else
+				delete p;
+		}
+		RaiseData* operator->() const { return p; }
+	};
 
 	static
-	Ev::Io<void> raise_loop( std::shared_ptr<RaiseData> pdata
-			       , std::shared_ptr<Node> it
-			       ) {
-		if (!it)
-			return Ev::lift().then([pdata]() {
-				return Ev::Io<void>([ pdata
-						    ]( std::function<void()> pass
-						     , std::function<void(std::exception_ptr)> fail
-						     ) {
-					pdata->pass = std::move(pass);
-					pdata->fail = std::move(fail);
-					pdata->finish_startup();
-				});
-			}).then([]() {
-				return Ev::yield();
-			});
+	Ref acquire(a value) {
+		auto& free = pool();
+		auto p = std::unique_ptr<RaiseData>();
+		if (free.empty()) {
+			p = Util::make_unique<RaiseData>();
+		} else {
+			p = std::move(free.back());
+			free.pop_back();
+		}
+		p->value.emplace(std::move(value));
+		p->starting = true;
+		p->running = 0;
+		return Ref(p.release());
+	}
 
-		return Ev::yield().then([pdata, it]() {
-			++pdata->running;
-			auto action = Ev::Io<void>([ pdata, it
-						   ]( std::function<void()> pass
-						    , std::function<void(std::exception_ptr)> _
-						    ) {
-				it->callback(*pdata->value).run([ pdata
-								, pass
-								]() {
-					pass();
-					pdata->finish_raise();
-				}, [pdata, pass](std::exception_ptr e) {
-					pass();
-					pdata->exc = e;
-					pdata->finish_raise();
+	/* Starts all the callbacks from `it`, then all the
+	 * ones from `rest`, in this same turn of the main
+	 * loop, then arranges for pass or fail to be called
+	 * once they have all finished.
+	 */
+	static
+	void start( Ref const& d
+		  , std::shared_ptr<Node> it
+		  , std::shared_ptr<Node> rest
+		  ) {
+		for (;;) {
+			if (!it) {
+				if (!rest)
+					break;
+				it = std::move(rest);
+				rest = nullptr;
+			}
+			++d->running;
+			try {
+				it->callback(*d->value).run([d]() {
+					d->finish_raise();
+				}, [d](std::exception_ptr e) {
+					d->exc = std::move(e);
+					d->finish_raise();
 				});
-			});
-			return Ev::concurrent(action);
-		}).then([pdata, it]() {
-			return raise_loop(pdata, it->next);
-		});
+			} catch (...) {
+				d->exc = std::current_exception();
+				d->finish_raise();
+			}
+			it = it->next;
+		}
+		d->finish_startup();
 	}
+
+	/* Callbacks for all values, plus those for the key
+	 * of the value, if any.  */
+	std::shared_ptr<Node> keyed_first(a const& value) const {
+		if (!get_key)
+			return nullptr;
+		auto it = keyed.find(get_key(value));
+		if (it == keyed.end())
+			return nullptr;
+		return it->second.first;
+	}
+
 public:
 	/* `a` must be at least movable.
 	 * The general expected use-case is that `a` is a
 	 * very dumb data-only structure.
+	 *
+	 * All the callbacks are started in a single turn of
+	 * the main loop, and run concurrently from there.
 	 */
 	Ev::Io<void> raise(a value) {
-		/* Move it to something we can share easily.  */
-		auto pdata = std::make_shared<RaiseData>(std::move(value));
-
-		return raise_loop(std::move(pdata), first);
+		auto first = all.first;
+		auto rest = keyed_first(value);
+		auto d = acquire(std::move(value));
+		return Ev::yield().then([d, first, rest]() {
+			return Ev::Io<void>([ d, first, rest
+					    ]( std::function<void()> pass
+					     , std::function<void(std::exception_ptr)> fail
+					     ) {
+				d->pass = std::move(pass);
+				d->fail = std::move(fail);
+				start(d, first, rest);
+			});
+		});
+	}
+	/* Runs the callbacks right now, on the caller's
+	 * stack, without waiting for the main loop.
+	 * Only for values whose callbacks never block;
+	 * a callback that does block keeps running on its
+	 * own, and its errors are only reported, as with
+	 * Ev::concurrent.
+	 * If all callbacks finish, the error of a failing
+	 * one is rethrown.
+	 */
+	void raise_sync(a value) {
+		auto first = all.first;
+		auto rest = keyed_first(value);
+		auto d = acquire(std::move(value));
+		auto done = false;
+		auto exc = std::exception_ptr();
+		d->pass = [&done]() { done = true; };
+		d->fail = [&done, &exc](std::exception_ptr e) {
+			done = true;
+			exc = std::move(e);
+		};
+		start(d, std::move(first), std::move(rest));
+		if (!done) {
+			/* Detach from this stack frame.  */
+			d->pass = []() { };
+			d->fail = &SignalBase::report;
+			return;
+		}
+		if (exc)
+			std::rethrow_exception(exc);
 	}
 
 	void subscribe(std::function<Ev::Io<void>(a const&)> callback) {
 		if (!callback)
 			return;
-		auto nnode = std::make_shared<Node>();
-		nnode->callback = std::move(callback);
-		if (last) {
-			last->next = std::move(nnode);
-			last = last->next.get();
-		} else {
-			first = std::move(nnode);
-			last = first.get();
-		}
+		all.add(std::move(callback));
+	}
+	void subscribe( std::string const& key
+		      , std::function<Ev::Io<void>(a const&)> callback
+		      , std::string const& (*get_key_)(a const&)
+		      ) {
+		if (!callback)
+			return;
+		get_key = get_key_;
+		keyed[key].add(std::move(callback));
 	}
 };
 
@@ -1,11 +1,17 @@
 #ifndef S_DETAIL_SIGNALBASE_HPP
 #define S_DETAIL_SIGNALBASE_HPP
 
+#include<exception>
+
 namespace S { namespace Detail {
 
 /* Common base class for all S::Detail::Signal<>.  */
 struct SignalBase {
 	virtual ~SignalBase() { }
+
+	/* Reports an error from a callback that nobody is
+	 * waiting on.  */
+	static void report(std::exception_ptr);
 };
 
 }}
@@ -0,0 +1,21 @@
+#ifndef S_KEY_HPP
+#define S_KEY_HPP
+
+namespace S {
+
+/** struct S::Key
+ *
+ * @brief specialize this for a message type in order to
+ * let handlers subscribe to only the messages with a
+ * particular key, via the two-argument form of
+ * S::Bus::subscribe.
+ *
+ * @desc The specialization should have a function
+ * `static std::string const& get(a const&)`.
+ */
+template<typename a>
+struct Key;
+
+}
+
+#endif /* !defined(S_KEY_HPP) */
@@ -1,11 +1,18 @@
 #include"Ev/Io.hpp"
+#include"Ev/ThreadPool.hpp"
 #include"Ev/yield.hpp"
 #include"Util/BacktraceException.hpp"
 #include"Sqlite3/Db.hpp"
 #include"Sqlite3/Tx.hpp"
+#include"Util/make_unique.hpp"
+#include<chrono>
+#include<list>
 #include<stdexcept>
 #include<queue>
 #include<sqlite3.h>
+#include<string>
+#include<unordered_map>
+#include<vector>
 
 namespace Sqlite3 {
 
@@ -15,11 +22,169 @@ private:
 
 	bool in_transaction;
 	/* Queue of greenthreads blocked on transact().  */
-	std::queue<std::function<void(Sqlite3::Tx)>> blocked;
+	std::queue<std::function<void()>> blocked;
+
+	/* Set while the transaction is owned by the database
+	 * thread.  The transaction then ends in the database
+	 * thread, but the next one is only let in from the
+	 * main thread.  */
+	bool in_background;
+	/* The database thread, created on first use.  */
+	std::unique_ptr<Ev::ThreadPool> worker;
+
+	/* Prepared statements not in use, keyed by SQL text,
+	 * most recently used first.  */
+	typedef std::pair<std::string, sqlite3_stmt*> CacheEntry;
+	std::list<CacheEntry> cache;
+	std::unordered_map< std::string
+			  , std::list<CacheEntry>::iterator
+			  > cache_index;
+	std::size_t cache_capacity;
+	/* Statements handed out by prepare(), and their SQL
+	 * text.  */
+	std::unordered_map<sqlite3_stmt*, std::string> in_use;
+	std::uint64_t cache_hits;
+	std::uint64_t cache_misses;
+
+	/* Mutations queued by write_behind(), done before the
+	 * next transaction.  */
+	std::vector<std::function<void(Sqlite3::Tx&)>> pending;
+	std::size_t write_behind_rows;
+	/* Whether write_behind() has already started a flush
+	 * for the current batch.  */
+	bool flush_started;
+	/* Whether the lock is held across the transaction of
+	 * apply_pending().  */
+	bool in_flush;
+	/* Errors of queued mutations that were dropped, not
+	 * yet taken.  */
+	std::vector<std::string> write_behind_failures;
+	/* Greenthreads blocked on wait_write_behind().  */
+	std::vector<std::function<void()>> write_behind_waiters;
+
+	/* Must be called with the lock held.  Does the queued
+	 * mutations in a transaction of their own, so that a
+	 * caller that does not commit does not lose them.
+	 * Each mutation is done in a savepoint, so one that
+	 * throws is rolled back and dropped alone; failures
+	 * are kept for take_write_behind_failures() rather
+	 * than thrown at the caller, who is likely not the
+	 * module that queued them.  */
+	void apply_pending(Db const& db) {
+		if (pending.empty())
+			return;
+		auto mutations = std::move(pending);
+		pending.clear();
+		flush_started = false;
+		in_flush = true;
+		auto failed = false;
+		try {
+			auto tx = Sqlite3::Tx(db);
+			for (auto& m : mutations) {
+				tx.query_execute("SAVEPOINT write_behind;");
+				try {
+					m(tx);
+				} catch (std::exception const& e) {
+					failed = true;
+					write_behind_failures.push_back(e.what());
+					tx.query_execute("ROLLBACK TO write_behind;");
+				} catch (...) {
+					failed = true;
+					write_behind_failures.push_back(
+						"unknown exception"
+					);
+					tx.query_execute("ROLLBACK TO write_behind;");
+				}
+				tx.query_execute("RELEASE write_behind;");
+			}
+			tx.commit();
+		} catch (std::exception const& e) {
+			/* The whole batch is lost.  */
+			failed = true;
+			write_behind_failures.push_back(
+				std::to_string(mutations.size()) +
+				" mutations dropped: " + e.what()
+			);
+		}
+		in_flush = false;
+		if (failed)
+			wake_write_behind_waiters();
+	}
+	void wake_write_behind_waiters() {
+		auto waiters = std::move(write_behind_waiters);
+		write_behind_waiters.clear();
+		for (auto& pass : waiters)
+			pass();
+	}
+
+	void fail_open(std::string const& src) {
+		auto msg = std::string(sqlite3_errmsg(connection));
+		sqlite3_close_v2(connection);
+		connection = nullptr;
+		throw Util::BacktraceException<std::runtime_error>(
+			std::string("Sqlite3::Db: ") + src + ": " +
+			msg
+		);
+	}
+	void pragma(std::string const& p) {
+		auto res = sqlite3_exec( connection, p.c_str()
+				       , NULL, NULL, NULL
+				       );
+		if (res != SQLITE_OK)
+			fail_open(p);
+	}
+
+	Ev::ThreadPool& get_worker() {
+		if (!worker)
+			worker = Util::make_unique<Ev::ThreadPool>(1);
+		return *worker;
+	}
+
+	/* Waits until no transaction is in-flight, then
+	 * blocks other transactions until unlock().  */
+	Ev::Io<void> lock() {
+		return Ev::Io<void>([this]( std::function<void()> pass
+					  , std::function<void(std::exception_ptr)> _
+					  ) {
+			if (in_transaction)
+				blocked.emplace(std::move(pass));
+			else {
+				in_transaction = true;
+				pass();
+			}
+		});
+	}
+	void unlock() {
+		if (!blocked.empty()) {
+			auto pass = std::move(blocked.front());
+			blocked.pop();
+			pass();
+		} else
+			in_transaction = false;
+	}
+
+	static
+	Ev::Io<void> rethrow(std::exception_ptr e) {
+		return Ev::Io<void>([e]( std::function<void()> pass
+				       , std::function<void(std::exception_ptr)> fail
+				       ) {
+			if (e)
+				fail(e);
+			else
+				pass();
+		});
+	}
 
 public:
-	Impl(std::string const& filename) {
+	Impl(std::string const& filename, Config const& config) {
 		in_transaction = false;
+		in_background = false;
+		cache_capacity = config.statement_cache_size;
+		cache_hits = 0;
+		cache_misses = 0;
+		write_behind_rows = config.write_behind_rows;
+		flush_started = false;
+		in_flush = false;
 		auto res = sqlite3_open(filename.c_str(), &connection);
 		if (res != SQLITE_OK) {
 			auto msg = std::string();
@@ -35,77 +200,267 @@ public:
 			);
 		}
 		res = sqlite3_extended_result_codes(connection, 1);
-		if (res != SQLITE_OK) {
-			auto msg = std::string(sqlite3_errmsg(connection));
-			sqlite3_close_v2(connection);
-			connection = nullptr;
-			throw Util::BacktraceException<std::runtime_error>(
-				std::string("Sqlite3::Db: sqlite3_extended_result_codes: ") +
-				msg
-			);
-		}
-		res = sqlite3_exec( connection, "PRAGMA foreign_keys = ON;"
-				  , NULL, NULL, NULL
-				  );
-		if (res != SQLITE_OK) {
-			auto msg = std::string(sqlite3_errmsg(connection));
-			sqlite3_close_v2(connection);
-			connection = nullptr;
-			throw Util::BacktraceException<std::runtime_error>(
-				std::string("Sqlite3::Db: "
-					    "PRAGMA foreign_keys = ON: "
-					   ) +
-				msg
-			);
-		}
+		if (res != SQLITE_OK)
+			fail_open("sqlite3_extended_result_codes");
+		pragma("PRAGMA foreign_keys = ON;");
+
+		if (config.wal)
+			pragma("PRAGMA journal_mode = WAL;");
+		if (config.synchronous != "")
+			pragma( "PRAGMA synchronous = "
+			      + config.synchronous + ";"
+			      );
+		if (config.cache_size != 0)
+			pragma( "PRAGMA cache_size = "
+			      + std::to_string(config.cache_size) + ";"
+			      );
+		if (config.mmap_size != 0)
+			pragma( "PRAGMA mmap_size = "
+			      + std::to_string(config.mmap_size) + ";"
+			      );
 	}
 	~Impl() {
+		for (auto& e : cache)
+			sqlite3_finalize(e.second);
 		if (connection)
 			sqlite3_close_v2(connection);
 	}
 
+	void* prepare(char const* sql) {
+		auto key = std::string(sql);
+		auto stmt = (sqlite3_stmt*) nullptr;
+		auto it = cache_index.find(key);
+		if (it != cache_index.end()) {
+			++cache_hits;
+			stmt = it->second->second;
+			cache.erase(it->second);
+			cache_index.erase(it);
+		} else {
+			++cache_misses;
+			auto res = sqlite3_prepare_v2( connection, sql, -1
+						     , &stmt, nullptr
+						     );
+			if (res != SQLITE_OK)
+				return nullptr;
+		}
+		in_use.emplace(stmt, std::move(key));
+		return stmt;
+	}
+	void release(sqlite3_stmt* stmt) {
+		auto it = in_use.find(stmt);
+		auto key = std::move(it->second);
+		in_use.erase(it);
+
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+		/* Already have one for this SQL text?  */
+		if (cache_capacity == 0 || cache_index.count(key) != 0) {
+			sqlite3_finalize(stmt);
+			return;
+		}
+		if (cache.size() >= cache_capacity) {
+			cache_index.erase(cache.back().first);
+			sqlite3_finalize(cache.back().second);
+			cache.pop_back();
+		}
+		cache.emplace_front(key, stmt);
+		cache_index.emplace(std::move(key), cache.begin());
+	}
+	StatementCacheStats statement_cache_stats() const {
+		auto rv = StatementCacheStats();
+		rv.hits = cache_hits;
+		rv.misses = cache_misses;
+		rv.size = cache.size();
+		return rv;
+	}
+
 	Ev::Io<Sqlite3::Tx> transact(Db const& db) {
 		auto ptx = std::make_shared<Sqlite3::Tx>();
-		return Ev::Io< Sqlite3::Tx
-			     >([ this, db
-			       ]( std::function<void(Sqlite3::Tx)> pass
-				, std::function<void(std::exception_ptr)> _
-				) {
-			if (in_transaction)
-				blocked.emplace(std::move(pass));
-			else {
-				in_transaction = true;
-				pass(Sqlite3::Tx(db));
-			}
-		}).then([ptx](Sqlite3::Tx tx) {
-			*ptx = std::move(tx);
+		return lock().then([this, ptx, db]() {
+			apply_pending(db);
+			*ptx = Sqlite3::Tx(db);
 			return Ev::yield();
 		}).then([ptx]() {
 			return Ev::lift(std::move(*ptx));
 		});
 	}
 	void* get_connection() const { return connection; }
-	void transaction_finish(Db const& db) {
-		if (!blocked.empty()) {
-			auto pass = std::move(blocked.front());
-			blocked.pop();
-			pass(Sqlite3::Tx(db));
-		} else
-			in_transaction = false;
+
+	Ev::Io<void>
+	write_behind( Db const& db
+		    , std::function<void(Sqlite3::Tx&)> mutation
+		    ) {
+		return Ev::lift().then([this, db, mutation]() {
+			pending.emplace_back(std::move(mutation));
+			if (pending.size() == 1)
+				wake_write_behind_waiters();
+			if (flush_started || pending.size() < write_behind_rows)
+				return Ev::lift();
+			flush_started = true;
+			return flush(db);
+		});
+	}
+	Ev::Io<void> flush(Db const& db) {
+		return lock().then([this, db]() {
+			apply_pending(db);
+			unlock();
+			return Ev::lift();
+		});
+	}
+	std::size_t write_behind_pending() const {
+		return pending.size();
+	}
+	Ev::Io<void> wait_write_behind() {
+		return Ev::Io<void>([this]( std::function<void()> pass
+					  , std::function<void(std::exception_ptr)> _
+					  ) {
+			if (!pending.empty() || !write_behind_failures.empty())
+				pass();
+			else
+				write_behind_waiters.emplace_back(std::move(pass));
+		}).then([]() {
+			/* Do not continue inside whoever woke us.  */
+			return Ev::yield();
+		});
+	}
+	std::vector<std::string> take_write_behind_failures() {
+		auto rv = std::move(write_behind_failures);
+		write_behind_failures.clear();
+		return rv;
+	}
+
+	Ev::Io<void>
+	transact_background( Db const& db
+			   , std::function<void(Sqlite3::Tx&)> func
+			   ) {
+		return transact(db).then([this, db, func](Sqlite3::Tx tx) {
+			auto ptx = std::make_shared<Sqlite3::Tx>(std::move(tx));
+			in_background = true;
+			return get_worker().background<std::exception_ptr>([ptx, func]() {
+				auto e = std::exception_ptr();
+				try {
+					func(*ptx);
+				} catch (...) {
+					e = std::current_exception();
+				}
+				/* Commit if committed by func, else roll
+				 * back, here in the database thread.  */
+				*ptx = Sqlite3::Tx();
+				return e;
+			}).then([this, db](std::exception_ptr e) {
+				/* Keeps us alive until back in the main
+				 * thread.  */
+				(void) db;
+				in_background = false;
+				unlock();
+				return rethrow(e);
+			});
+		});
+	}
+	void transaction_finish() {
+		if (in_background || in_flush)
+			return;
+		unlock();
+	}
+
+	Ev::Io<Checkpoint> checkpoint(Db const& db) {
+		auto res = std::make_shared<Checkpoint>();
+		return lock().then([this, res]() {
+			auto connection = this->connection;
+			return get_worker().background<std::exception_ptr>([connection, res]() {
+				auto start = std::chrono::steady_clock::now();
+				/* A truncating checkpoint reports 0 frames,
+				 * so do the work in a passive one first.  */
+				auto rc = sqlite3_wal_checkpoint_v2(
+					connection, nullptr,
+					SQLITE_CHECKPOINT_PASSIVE,
+					&res->wal_frames,
+					&res->checkpointed_frames
+				);
+				if (rc == SQLITE_OK && res->wal_frames > 0)
+					rc = sqlite3_wal_checkpoint_v2(
+						connection, nullptr,
+						SQLITE_CHECKPOINT_TRUNCATE,
+						nullptr, nullptr
+					);
+				auto end = std::chrono::steady_clock::now();
+				res->seconds = std::chrono::duration<double>(
+					end - start
+				).count();
+				if (rc == SQLITE_OK)
+					return std::exception_ptr();
+				return std::make_exception_ptr(Util::BacktraceException<std::runtime_error>(
+					std::string("Sqlite3::Db: checkpoint: ") +
+					sqlite3_errmsg(connection)
+				));
+			});
+		}).then([this, db, res](std::exception_ptr e) {
+			(void) db;
+			unlock();
+			return rethrow(e).then([res]() {
+				return Ev::lift(*res);
+			});
+		});
+	}
+
+	std::string filename() const {
+		auto f = sqlite3_db_filename(connection, "main");
+		if (!f)
+			return "";
+		return f;
 	}
 };
 
 void* Db::get_connection() const {
 	return pimpl->get_connection();
 }
+Ev::Io<void>
+Db::write_behind(std::function<void(Sqlite3::Tx&)> mutation) {
+	return pimpl->write_behind(*this, std::move(mutation));
+}
+Ev::Io<void> Db::flush() {
+	return pimpl->flush(*this);
+}
+std::size_t Db::write_behind_pending() const {
+	return pimpl->write_behind_pending();
+}
+Ev::Io<void> Db::wait_write_behind() {
+	return pimpl->wait_write_behind();
+}
+std::vector<std::string> Db::take_write_behind_failures() {
+	return pimpl->take_write_behind_failures();
+}
+void* Db::prepare(char const* sql) {
+	return pimpl->prepare(sql);
+}
+void Db::release(void* stmt) {
+	pimpl->release((sqlite3_stmt*) stmt);
+}
+Db::StatementCacheStats Db::statement_cache_stats() const {
+	return pimpl->statement_cache_stats();
+}
 void Db::transaction_finish() {
-	return pimpl->transaction_finish(*this);
+	return pimpl->transaction_finish();
 }
 Ev::Io<Sqlite3::Tx> Db::transact() {
 	return pimpl->transact(*this);
 }
+Ev::Io<void>
+Db::core_transact_background(std::function<void(Sqlite3::Tx&)> func) {
+	return pimpl->transact_background(*this, std::move(func));
+}
 
+Ev::Io<Db::Checkpoint> Db::checkpoint() {
+	return pimpl->checkpoint(*this);
+}
+std::string Db::filename() const {
+	return pimpl->filename();
+}
+
+Db::Db( std::string const& filename
+      ) : pimpl(std::make_shared<Impl>(filename, Config())) { }
 Db::Db( std::string const& filename
-      ) : pimpl(std::make_shared<Impl>(filename)) { }
+      , Config const& config
+      ) : pimpl(std::make_shared<Impl>(filename, config)) { }
 
 }
@@ -1,10 +1,17 @@
 #ifndef SQLITE3_DB_HPP
 #define SQLITE3_DB_HPP
 
+#include"Ev/Io.hpp"
+#include"Util/make_unique.hpp"
+#include<cstddef>
+#include<cstdint>
+#include<functional>
 #include<memory>
 #include<string>
+#include<type_traits>
+#include<vector>
 
-namespace Ev { template<typename a> class Io; }
+namespace Sqlite3 { class Query; }
 namespace Sqlite3 { class Result; }
 namespace Sqlite3 { class Tx; }
 
@@ -23,13 +30,51 @@ private:
 	class Impl;
 	std::shared_ptr<Impl> pimpl;
 
+	friend class Sqlite3::Query;
 	friend class Sqlite3::Result;
 	friend class Sqlite3::Tx;
 
 	void* get_connection() const;
 	void transaction_finish();
 
+	/* Gets a prepared statement for the SQL text from the
+	 * statement cache, or prepares a new one.
+	 * Returns nullptr if the SQL text is invalid.  */
+	void* prepare(char const* sql);
+	/* Returns a statement from `prepare` into the cache.  */
+	void release(void* stmt);
+
+	Ev::Io<void>
+	core_transact_background(std::function<void(Sqlite3::Tx&)> func);
+
 public:
+	/** struct Sqlite3::Db::Config
+	 *
+	 * @brief settings applied to the connection when the
+	 * database is opened.
+	 * The defaults leave SQLITE3 defaults alone.
+	 */
+	struct Config {
+		/* Number of prepared statements to keep for
+		 * reuse.  */
+		std::size_t statement_cache_size = 64;
+		/* Number of queued `write_behind` mutations that
+		 * triggers a flush.  */
+		std::size_t write_behind_rows = 64;
+		/* Use a write-ahead log instead of a rollback
+		 * journal.  */
+		bool wal = false;
+		/* One of "OFF", "NORMAL", "FULL", "EXTRA", or
+		 * empty to keep the default.  */
+		std::string synchronous;
+		/* As `PRAGMA cache_size`: positive is in pages,
+		 * negative is in kibibytes, 0 keeps the default.  */
+		std::int64_t cache_size = 0;
+		/* Number of bytes of the file to memory-map, 0
+		 * keeps the default.  */
+		std::int64_t mmap_size = 0;
+	};
+
 	/* Opens a database, creating it
 	 * if absent.
 	 * As typical for SQLITE3, ":memory:" creates an in-memory
@@ -37,6 +82,7 @@ public:
 	 */
 	explicit
 	Db(std::string const& filename);
+	Db(std::string const& filename, Config const& config);
 
 	/* Creates an empty/invalid db object.  */
 	Db() =default;
@@ -57,6 +103,133 @@ public:
 	 * is still in-flight.
 	 */
 	Ev::Io<Sqlite3::Tx> transact();
+
+	/** Sqlite3::Db::transact_background
+	 *
+	 * @brief Runs the given function on a transaction
+	 * in the database thread, so that slow queries and
+	 * commits do not block the main loop, then returns
+	 * the result of the function in the main thread.
+	 *
+	 * @desc Like `transact`, this blocks until no other
+	 * `Sqlite3::Tx` is in-flight, and blocks other
+	 * transactions until the function is done.
+	 *
+	 * The function is given a `Sqlite3::Tx&`, and must
+	 * call `commit()` on it to keep its changes;
+	 * the transaction is rolled back if the function
+	 * returns without committing, or throws.
+	 * The function runs in another thread, so it must
+	 * not touch anything else shared with the main
+	 * thread, including the bus, `Ev::now()`, and
+	 * `Sqlite3::Db` objects.
+	 */
+	template<typename F>
+	Ev::Io<std::invoke_result_t<F, Sqlite3::Tx&>>
+	transact_background(F func) {
+		typedef std::invoke_result_t<F, Sqlite3::Tx&> a;
+		if constexpr (std::is_void_v<a>) {
+			return core_transact_background(std::move(func));
+		} else {
+			auto res = std::make_shared<std::unique_ptr<a>>();
+			return core_transact_background([func, res](Sqlite3::Tx& tx) {
+				*res = Util::make_unique<a>(func(tx));
+			}).then([res]() {
+				return Ev::lift(std::move(**res));
+			});
+		}
+	}
+
+	/** Sqlite3::Db::write_behind
+	 *
+	 * @brief Queues a mutation of the database, to be
+	 * done together with other queued mutations in a
+	 * single transaction, saving a commit for each.
+	 *
+	 * @desc This is meant for records of events that can
+	 * arrive at a high rate, such as forwards and payment
+	 * attempts, where a commit per event would dominate
+	 * the cost of the write.
+	 *
+	 * Queued mutations are done, in order, in a
+	 * transaction of their own just before the next
+	 * transaction from `transact` or
+	 * `transact_background` begins, or on `flush`, so
+	 * every transaction sees all writes queued before
+	 * it.
+	 * Once `Config::write_behind_rows` mutations are
+	 * queued, the returned action flushes them.
+	 *
+	 * The mutation must not commit or roll back the
+	 * transaction, and should not throw; if it does,
+	 * only its own changes are rolled back, and it is
+	 * dropped while the rest of the batch is still
+	 * done.  The error is not thrown at whoever started
+	 * the transaction, but kept for
+	 * `take_write_behind_failures`; so is the error if
+	 * the batch cannot be committed at all.
+	 * Queued mutations not yet flushed are lost when
+	 * the last `Sqlite3::Db` referring to the database
+	 * is destroyed.
+	 */
+	Ev::Io<void> write_behind(std::function<void(Sqlite3::Tx&)> mutation);
+	/* Does all queued mutations in one transaction and
+	 * commits it.  */
+	Ev::Io<void> flush();
+	/* Number of queued mutations not yet done.  */
+	std::size_t write_behind_pending() const;
+	/* Waits until a mutation is queued, or one has
+	 * failed and is not yet taken; returns at once if
+	 * that is already the case.  For the one module
+	 * that flushes queued mutations.  */
+	Ev::Io<void> wait_write_behind();
+	/* Takes the errors of queued mutations dropped
+	 * since the last call.  */
+	std::vector<std::string> take_write_behind_failures();
+
+	/** struct Sqlite3::Db::Checkpoint
+	 *
+	 * @brief the result of `Sqlite3::Db::checkpoint`.
+	 */
+	struct Checkpoint {
+		/* Number of frames in the write-ahead log before
+		 * the checkpoint, or -1 if not in WAL mode.  */
+		int wal_frames;
+		/* Number of frames written back to the database.  */
+		int checkpointed_frames;
+		/* How long the checkpoint took.  */
+		double seconds;
+	};
+	/** Sqlite3::Db::checkpoint
+	 *
+	 * @brief Writes back the write-ahead log into the
+	 * database file and truncates the log, in the
+	 * database thread.
+	 *
+	 * @desc This waits for and blocks transactions like
+	 * `transact` does.
+	 * If the database is not in WAL mode, this does
+	 * nothing and reports -1 frames.
+	 */
+	Ev::Io<Checkpoint> checkpoint();
+
+	/* The filename of the database, or empty if it is
+	 * in-memory or temporary.  */
+	std::string filename() const;
+
+	/** struct Sqlite3::Db::StatementCacheStats
+	 *
+	 * @brief counters of the prepared statement cache.
+	 * A hit reuses a prepared statement, a miss has to
+	 * prepare one from the SQL text.
+	 */
+	struct StatementCacheStats {
+		std::uint64_t hits;
+		std::uint64_t misses;
+		std::size_t size;
+	};
+	/* Only consistent while holding a transaction.  */
+	StatementCacheStats statement_cache_stats() const;
 };
 
 }
@@ -1,3 +1,5 @@
+#include"Ln/NodeId.hpp"
+#include"Sha256/Hash.hpp"
 #include"Util/BacktraceException.hpp"
 #include"Sqlite3/Detail/binds.hpp"
 #include<sqlite3.h>
@@ -32,5 +34,23 @@ void bind_null(void* stmt, int l) {
 	if (res != SQLITE_OK)
 		throw Util::BacktraceException<std::runtime_error>("Sqlite3: bind error.");
 }
+void bind_b(void* stmt, int l, std::uint8_t const* p, std::size_t n) {
+	auto res = sqlite3_bind_blob( (sqlite3_stmt*) stmt
+				    , l, p, n
+				    , SQLITE_TRANSIENT
+				    );
+	if (res != SQLITE_OK)
+		throw Util::BacktraceException<std::runtime_error>("Sqlite3: bind error.");
+}
+void bind_node_id(void* stmt, int l, Ln::NodeId const& v) {
+	std::uint8_t buf[33];
+	v.to_buffer(buf);
+	bind_b(stmt, l, buf, sizeof(buf));
+}
+void bind_hash(void* stmt, int l, Sha256::Hash const& v) {
+	std::uint8_t buf[32];
+	v.to_buffer(buf);
+	bind_b(stmt, l, buf, sizeof(buf));
+}
 
 }}
@@ -4,6 +4,10 @@
 #include<cstddef>
 #include<cstdint>
 #include<string>
+#include<vector>
+
+namespace Ln { class NodeId; }
+namespace Sha256 { class Hash; }
 
 namespace Sqlite3 { namespace Detail {
 
@@ -11,6 +15,9 @@ void bind_d(void* stmt, int l, double);
 void bind_i(void* stmt, int l, std::int64_t);
 void bind_s(void* stmt, int l, std::string);
 void bind_null(void *stmt, int l);
+void bind_b(void* stmt, int l, std::uint8_t const* p, std::size_t n);
+void bind_node_id(void* stmt, int l, Ln::NodeId const&);
+void bind_hash(void* stmt, int l, Sha256::Hash const&);
 
 template<typename a>
 struct Bind;
@@ -108,6 +115,26 @@ struct Bind<std::string> {
 	}
 };
 
+/* Bound as BLOBs.  */
+template<>
+struct Bind<std::vector<std::uint8_t>> {
+	static void bind(void *stmt, int l, std::vector<std::uint8_t> v) {
+		bind_b(stmt, l, v.data(), v.size());
+	}
+};
+template<>
+struct Bind<Ln::NodeId> {
+	static void bind(void *stmt, int l, Ln::NodeId const& v) {
+		bind_node_id(stmt, l, v);
+	}
+};
+template<>
+struct Bind<Sha256::Hash> {
+	static void bind(void *stmt, int l, Sha256::Hash const& v) {
+		bind_hash(stmt, l, v);
+	}
+};
+
 template<>
 struct Bind<std::nullptr_t> {
 	static void bind(void *stmt, int l, std::nullptr_t) {
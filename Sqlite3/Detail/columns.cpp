@@ -1,6 +1,10 @@
+#include"Ln/NodeId.hpp"
+#include"Sha256/Hash.hpp"
 #include"Sqlite3/Detail/columns.hpp"
+#include"Util/BacktraceException.hpp"
 #include<algorithm>
 #include<sqlite3.h>
+#include<stdexcept>
 
 namespace Sqlite3 { namespace Detail {
 
@@ -21,5 +25,39 @@ std::string column_s(void* vstmt, int c) {
 
 	return s;
 }
+std::vector<std::uint8_t> column_b(void* vstmt, int c) {
+	auto stmt = (sqlite3_stmt*) vstmt;
+	auto dat = (std::uint8_t const*) sqlite3_column_blob(stmt, c);
+	auto len = sqlite3_column_bytes(stmt, c);
+
+	return std::vector<std::uint8_t>(dat, dat + len);
+}
+
+Ln::NodeId Column<Ln::NodeId>::column(void* vstmt, int c) {
+	auto stmt = (sqlite3_stmt*) vstmt;
+	if (sqlite3_column_type(stmt, c) != SQLITE_BLOB)
+		return Ln::NodeId(column_s(stmt, c));
+	auto dat = (std::uint8_t const*) sqlite3_column_blob(stmt, c);
+	if (sqlite3_column_bytes(stmt, c) != 33)
+		throw Util::BacktraceException<std::runtime_error>(
+			"Sqlite3: node ID column not 33 bytes."
+		);
+	auto rv = Ln::NodeId();
+	rv.from_buffer(dat);
+	return rv;
+}
+Sha256::Hash Column<Sha256::Hash>::column(void* vstmt, int c) {
+	auto stmt = (sqlite3_stmt*) vstmt;
+	if (sqlite3_column_type(stmt, c) != SQLITE_BLOB)
+		return Sha256::Hash(column_s(stmt, c));
+	auto dat = (std::uint8_t const*) sqlite3_column_blob(stmt, c);
+	if (sqlite3_column_bytes(stmt, c) != 32)
+		throw Util::BacktraceException<std::runtime_error>(
+			"Sqlite3: hash column not 32 bytes."
+		);
+	auto rv = Sha256::Hash();
+	rv.from_buffer(dat);
+	return rv;
+}
 
 }}
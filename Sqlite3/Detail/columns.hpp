@@ -3,12 +3,17 @@
 
 #include<cstdint>
 #include<string>
+#include<vector>
+
+namespace Ln { class NodeId; }
+namespace Sha256 { class Hash; }
 
 namespace Sqlite3 { namespace Detail {
 
 double column_d(void* stmt, int c);
 std::int64_t column_i(void* stmt, int c);
 std::string column_s(void* stmt, int c);
+std::vector<std::uint8_t> column_b(void* stmt, int c);
 
 template<typename a>
 struct Column;
@@ -114,6 +119,27 @@ struct Column<std::string> {
 	}
 };
 
+template<>
+struct Column<std::vector<std::uint8_t>> {
+	static
+	std::vector<std::uint8_t> column(void* stmt, int c) {
+		return column_b(stmt, c);
+	}
+};
+
+/* Read from BLOBs, or from hex TEXT as written by older
+ * versions.  */
+template<>
+struct Column<Ln::NodeId> {
+	static
+	Ln::NodeId column(void* stmt, int c);
+};
+template<>
+struct Column<Sha256::Hash> {
+	static
+	Sha256::Hash column(void* stmt, int c);
+};
+
 }}
 
 #endif /* !defined(SQLITE3_DETAIL_COLUMNS_HPP) */
@@ -21,7 +21,7 @@ public:
 	      { }
 	~Impl() {
 		if (stmt)
-			(void) sqlite3_finalize(stmt);
+			db.release(stmt);
 	}
 
 	void* get_stmt() const { return stmt; }
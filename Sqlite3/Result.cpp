@@ -16,14 +16,14 @@ Result::Result(Result&& o) {
 }
 Result::~Result() {
 	if (stmt)
-		sqlite3_finalize((sqlite3_stmt*) stmt);
+		db.release(stmt);
 }
 
 bool Result::advance() {
 	auto ss = (sqlite3_stmt*) stmt;
 	auto res = sqlite3_step(ss);
 	if (res == SQLITE_DONE) {
-		sqlite3_finalize((sqlite3_stmt*) stmt);
+		db.release(stmt);
 		stmt = nullptr;
 		return false;
 	} else if (res == SQLITE_ROW)
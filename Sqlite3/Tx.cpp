@@ -52,12 +52,8 @@ public:
 	}
 
 	Query query(char const* sql) {
-		auto connection = (sqlite3*) db.get_connection();
-		auto stmt = (sqlite3_stmt*) nullptr;
-		auto res = sqlite3_prepare_v2( connection, sql, -1
-					     , &stmt, nullptr
-					     );
-		if (res != SQLITE_OK)
+		auto stmt = db.prepare(sql);
+		if (!stmt)
 			throw_sqlite3(sql);
 
 		return Query(db, stmt);
@@ -0,0 +1,383 @@
+#undef NDEBUG
+#include"Boss/Mod/GossipGraphTracker.hpp"
+#include"Boss/ModG/ReqResp.hpp"
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Msg/Block.hpp"
+#include"Boss/Msg/Init.hpp"
+#include"Boss/Msg/RequestGossipGraph.hpp"
+#include"Boss/Msg/ResponseGossipGraph.hpp"
+#include"Boss/Shutdown.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Jsmn/Parser.hpp"
+#include"Ln/GossipGraph.hpp"
+#include"Net/Connector.hpp"
+#include"Net/Fd.hpp"
+#include"Net/SocketFd.hpp"
+#include"S/Bus.hpp"
+#include"Secp256k1/PrivKey.hpp"
+#include"Secp256k1/PubKey.hpp"
+#include"Secp256k1/Signature.hpp"
+#include"Secp256k1/SignerIF.hpp"
+#include"Sha256/Hash.hpp"
+#include"Sqlite3/Db.hpp"
+#include<assert.h>
+#include<deque>
+#include<errno.h>
+#include<fcntl.h>
+#include<map>
+#include<sstream>
+#include<string>
+#include<sys/socket.h>
+#include<sys/types.h>
+#include<unistd.h>
+
+namespace {
+
+auto const A = std::string("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = std::string("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = std::string("020000000000000000000000000000000000000000000000000000000000000003");
+auto const D = std::string("020000000000000000000000000000000000000000000000000000000000000004");
+
+std::string channel( std::string const& source
+		   , std::string const& destination
+		   , char const* scid
+		   , int base
+		   ) {
+	auto os = std::ostringstream();
+	os << "{ \"source\": \"" << source << "\""
+	   << ", \"destination\": \"" << destination << "\""
+	   << ", \"short_channel_id\": \"" << scid << "\""
+	   << ", \"amount_msat\": \"1000000000msat\""
+	   << ", \"base_fee_millisatoshi\": " << base
+	   << ", \"fee_per_millionth\": 10"
+	   << ", \"delay\": 14"
+	   << ", \"active\": true"
+	   << "}"
+	    ;
+	return os.str();
+}
+
+/* Channels currently on the mocked network, keyed by
+ * source.  */
+auto network = std::map<std::string, std::vector<std::string>>();
+
+std::string listchannels(std::string const* source) {
+	auto os = std::ostringstream();
+	os << "{ \"channels\": [";
+	auto first = true;
+	for (auto const& n : network) {
+		if (source && n.first != *source)
+			continue;
+		for (auto const& c : n.second) {
+			if (!first)
+				os << ", ";
+			first = false;
+			os << c;
+		}
+	}
+	os << "] }";
+	return os.str();
+}
+
+class DummyConnector : public Net::Connector {
+public:
+	Net::SocketFd
+	connect(std::string const& host, int port) override {
+		(void) host;
+		(void) port;
+		return Net::SocketFd();
+	}
+};
+
+class DummySigner : public Secp256k1::SignerIF {
+public:
+	Secp256k1::PubKey
+	get_pubkey_tweak(Secp256k1::PrivKey const&) override {
+		return Secp256k1::PubKey();
+	}
+	Secp256k1::Signature
+	get_signature_tweak( Secp256k1::PrivKey const&
+			   , Sha256::Hash const&
+			   ) override {
+		return Secp256k1::Signature();
+	}
+	Sha256::Hash
+	get_privkey_salted_hash(std::uint8_t salt[32]) override {
+		return Sha256::Hash();
+	}
+};
+
+/* Plays lightningd at the other end of the RPC socket.  */
+class DummyLightningd {
+private:
+	Net::Fd socket;
+	Jsmn::Parser parser;
+	std::deque<Jsmn::Object> requests;
+	bool stopped;
+
+	Ev::Io<Jsmn::Object> read_request() {
+		return Ev::yield().then([this]() {
+			if (stopped)
+				return Ev::lift(Jsmn::Object());
+			char buf[512];
+			for (;;) {
+				auto res = read(socket.get(), buf, sizeof(buf));
+				if (res < 0 && ( errno == EWOULDBLOCK
+					      || errno == EAGAIN
+					       ))
+					break;
+				assert(res > 0);
+				for (auto& r : parser.feed(std::string(buf, res)))
+					requests.push_back(std::move(r));
+			}
+			if (requests.empty())
+				return read_request();
+			auto req = std::move(requests.front());
+			requests.pop_front();
+			return Ev::lift(std::move(req));
+		});
+	}
+	Ev::Io<void> write_all(std::string data) {
+		return Ev::yield().then([this, data]() {
+			auto res = write(socket.get(), data.c_str(), data.size());
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				return write_all(data);
+			assert(res > 0);
+			if (std::size_t(res) < data.size())
+				return write_all(data.substr(res));
+			return Ev::lift();
+		});
+	}
+
+	/* lightningd puts the id first, but the result
+	 * can also come first, in which case nothing is
+	 * streamed.  */
+	Ev::Io<void> respond( Jsmn::Object const& req
+			    , std::string const& result
+			    , bool result_first = false
+			    ) {
+		auto id = req["id"].direct_text();
+		auto os = std::ostringstream();
+		if (result_first)
+			os << "{\"result\": " << result
+			   << ", \"id\": " << id
+			   << ", \"jsonrpc\": \"2.0\"}\n\n";
+		else
+			os << "{\"jsonrpc\": \"2.0\", \"id\": " << id
+			   << ", \"result\": " << result << "}\n\n";
+		return write_all(os.str());
+	}
+
+public:
+	std::size_t listchannels_count;
+
+	explicit
+	DummyLightningd(Net::Fd socket_) : socket(std::move(socket_))
+					 , stopped(false)
+					 , listchannels_count(0) {
+		auto flags = fcntl(socket.get(), F_GETFL);
+		flags |= O_NONBLOCK;
+		fcntl(socket.get(), F_SETFL, flags);
+	}
+
+	void stop() { stopped = true; }
+
+	Ev::Io<void> serve() {
+		return read_request().then([this](Jsmn::Object req) {
+			if (stopped)
+				return Ev::lift();
+			auto method = std::string(req["method"]);
+			auto params = req["params"];
+			auto act = Ev::lift();
+			if (method == "listchannels") {
+				++listchannels_count;
+				if (!params.has("source"))
+					act = respond(req, listchannels(nullptr));
+				else {
+					auto source = std::string(params["source"]);
+					act = respond(req, listchannels(&source));
+				}
+			} else if (method == "listnodes") {
+				act = respond(req, R"JSON(
+{ "nodes": [ {"nodeid": "020000000000000000000000000000000000000000000000000000000000000001"}
+           , {"nodeid": "020000000000000000000000000000000000000000000000000000000000000002"}
+           , {"nodeid": "020000000000000000000000000000000000000000000000000000000000000003"}
+           ]
+}
+)JSON", true);
+			} else
+				assert(0);
+			return std::move(act).then([this]() {
+				return serve();
+			});
+		});
+	}
+};
+
+Ev::Io<void> settle(std::size_t n) {
+	if (n == 0)
+		return Ev::lift();
+	return Ev::yield().then([n]() {
+		return settle(n - 1);
+	});
+}
+
+}
+
+int main() {
+	auto bus = S::Bus();
+
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto lightningd = DummyLightningd(Net::Fd(sockets[0]));
+	auto& rpc = lightningd;
+	/* Blocks are ten minutes apart, so that results of
+	 * the previous block are no longer cached.  */
+	auto now = double(0);
+	auto client = Boss::Mod::Rpc( bus, Net::Fd(sockets[1])
+				    , [&now]() { return now; }
+				    );
+	auto connector = DummyConnector();
+	auto signer = DummySigner();
+	auto db = Sqlite3::Db(":memory:");
+
+	auto tracker = Boss::Mod::GossipGraphTracker(bus);
+	auto rr = Boss::ModG::ReqResp< Boss::Msg::RequestGossipGraph
+				     , Boss::Msg::ResponseGossipGraph
+				     >(bus);
+
+	network[A] = { channel(A, B, "1x1x0", 1) };
+	network[B] = { channel(B, A, "1x1x0", 2)
+		     , channel(B, C, "2x1x0", 3)
+		     };
+	network[C] = { channel(C, B, "2x1x0", 4) };
+
+	auto g1 = std::shared_ptr<Ln::GossipGraph const>();
+	auto g2 = std::shared_ptr<Ln::GossipGraph const>();
+
+	auto code = Ev::lift().then([&]() {
+		return Ev::concurrent(lightningd.serve());
+	}).then([&]() {
+		return bus.raise(Boss::Msg::Init{
+			Boss::Msg::Network_Regtest,
+			client,
+			Ln::NodeId(A),
+			db,
+			connector,
+			signer,
+			std::string(),
+			false
+		});
+	}).then([&]() {
+		/* Block before anyone asked is ignored.  */
+		now += 600;
+		return bus.raise(Boss::Msg::Block{100});
+	}).then([&]() {
+		return settle(100);
+	}).then([&]() {
+		assert(rpc.listchannels_count == 0);
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		g1 = r.graph;
+		assert(g1->generation() == 1);
+		assert(g1->num_nodes() == 3);
+		assert(g1->num_channels() == 4);
+		assert(rpc.listchannels_count == 1);
+
+		/* Served from the snapshot.  */
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		assert(r.graph == g1);
+		assert(rpc.listchannels_count == 1);
+
+		/* Nothing changed.  */
+		now += 600;
+		return bus.raise(Boss::Msg::Block{101});
+	}).then([&]() {
+		return settle(100);
+	}).then([&]() {
+		/* One query per node.  */
+		assert(rpc.listchannels_count == 4);
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		assert(r.graph == g1);
+		assert(r.graph->generation() == 1);
+
+		/* Fee change.  */
+		network[A] = { channel(A, B, "1x1x0", 100) };
+		now += 600;
+		return bus.raise(Boss::Msg::Block{102});
+	}).then([&]() {
+		return settle(100);
+	}).then([&]() {
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		g2 = r.graph;
+		assert(g2->generation() == 2);
+		/* We held g1, so it was copied, not modified.  */
+		assert(g2 != g1);
+		auto a1 = g1->lookup(Ln::NodeId(A));
+		assert(g1->outgoing(a1).begin()->base_fee == 1);
+		auto a2 = g2->lookup(Ln::NodeId(A));
+		assert(g2->outgoing(a2).begin()->base_fee == 100);
+		assert(g2->num_channels() == 4);
+
+		/* New node and channel, and a closed channel.  */
+		network[B] = { channel(B, A, "1x1x0", 2) };
+		network[C] = { channel(C, D, "3x1x0", 5) };
+		network[D] = { channel(D, C, "3x1x0", 6) };
+		now += 600;
+		return bus.raise(Boss::Msg::Block{103});
+	}).then([&]() {
+		return settle(100);
+	}).then([&]() {
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		auto g3 = r.graph;
+		assert(g3->generation() == 3);
+		auto b = g3->lookup(Ln::NodeId(B));
+		auto c = g3->lookup(Ln::NodeId(C));
+		/* D was only seen as a destination of C so far.  */
+		auto d = g3->lookup(Ln::NodeId(D));
+		assert(d != Ln::GossipGraph::none);
+		assert(g3->outgoing(b).size() == 1);
+		assert(g3->outgoing(c).size() == 1);
+		assert(g3->outgoing(c).begin()->destination == d);
+		assert(g3->find(Ln::Scid("2x1x0")).empty());
+		assert(g3->find(Ln::Scid("3x1x0")).size() == 1);
+		/* Earlier patch retained.  */
+		auto a = g3->lookup(Ln::NodeId(A));
+		assert(g3->outgoing(a).begin()->base_fee == 100);
+
+		/* Nodes whose channels all closed are dropped.  */
+		network[C] = { };
+		network[D] = { };
+		now += 600;
+		return bus.raise(Boss::Msg::Block{104});
+	}).then([&]() {
+		return settle(100);
+	}).then([&]() {
+		return rr.execute(Boss::Msg::RequestGossipGraph{nullptr});
+	}).then([&](Boss::Msg::ResponseGossipGraph r) {
+		auto g4 = r.graph;
+		assert(g4->generation() == 4);
+		assert(g4->num_nodes() == 2);
+		assert(g4->lookup(Ln::NodeId(C)) == Ln::GossipGraph::none);
+		assert(g4->lookup(Ln::NodeId(D)) == Ln::GossipGraph::none);
+		assert(g4->find(Ln::Scid("3x1x0")).empty());
+
+		lightningd.stop();
+		return bus.raise(Boss::Shutdown());
+	}).then([]() {
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
@@ -67,6 +67,8 @@ public:
 		assert(res == 0);
 
 		unlink((temp_dir + "/data.clboss").c_str());
+		unlink((temp_dir + "/data.clboss-wal").c_str());
+		unlink((temp_dir + "/data.clboss-shm").c_str());
 		unlink((temp_dir + "/keys.clboss").c_str());
 		rmdir(temp_dir.c_str());
 	}
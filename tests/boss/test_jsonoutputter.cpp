@@ -0,0 +1,95 @@
+#undef NDEBUG
+#include"Boss/Mod/JsonOutputter.hpp"
+#include"Boss/Msg/JsonCout.hpp"
+#include"Boss/concurrent.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Json/Out.hpp"
+#include"S/Bus.hpp"
+#include<assert.h>
+#include<sstream>
+#include<string>
+#include<vector>
+
+namespace {
+
+/* Counts how often the output is flushed.  */
+class CountingBuf : public std::stringbuf {
+public:
+	std::size_t syncs = 0;
+protected:
+	int sync() override {
+		++syncs;
+		return std::stringbuf::sync();
+	}
+};
+
+Json::Out response(int id) {
+	return Json::Out()
+		.start_object()
+			.field("jsonrpc", std::string("2.0"))
+			.field("id", double(id))
+			.start_object("result")
+			.end_object()
+		.end_object()
+		;
+}
+
+std::vector<std::string> lines(std::string const& s) {
+	auto rv = std::vector<std::string>();
+	auto is = std::istringstream(s);
+	auto line = std::string();
+	while (std::getline(is, line))
+		rv.push_back(line);
+	return rv;
+}
+
+}
+
+int main() {
+	auto buf = CountingBuf();
+	auto os = std::ostream(&buf);
+	auto bus = S::Bus();
+	auto outputter = Boss::Mod::JsonOutputter(os, bus);
+
+	auto code = Ev::lift().then([&]() {
+		/* A burst of logs, then a response.  */
+		auto act = Ev::lift();
+		for (auto i = 0; i < 100; ++i)
+			act += Boss::concurrent(Boss::log( bus, Boss::Debug
+							 , "line %d", i
+							 ));
+		act += Boss::concurrent(bus.raise(Boss::Msg::JsonCout{
+			response(1)
+		}));
+		return act;
+	}).then([&]() {
+		return Ev::yield(10);
+	}).then([&]() {
+		auto out = lines(buf.str());
+		assert(out.size() == 101);
+		/* The response goes first.  */
+		assert(out[0].find("\"id\"") != std::string::npos);
+		/* The logs keep their order.  */
+		for (auto i = 0; i < 100; ++i) {
+			auto expected = "line " + std::to_string(i) + "\"";
+			assert(out[i + 1].find(expected) != std::string::npos);
+		}
+		/* All in a single flush.  */
+		assert(buf.syncs == 1);
+
+		/* Later output is still written.  */
+		return bus.raise(Boss::Msg::JsonCout{response(2)});
+	}).then([&]() {
+		return Ev::yield(10);
+	}).then([&]() {
+		auto out = lines(buf.str());
+		assert(out.size() == 102);
+		assert(buf.syncs == 2);
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
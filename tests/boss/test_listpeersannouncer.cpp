@@ -0,0 +1,260 @@
+#undef NDEBUG
+#include"Boss/Mod/ListpeersAnnouncer.hpp"
+#include"Boss/Mod/Waiter.hpp"
+#include"Boss/Msg/ListpeersChanged.hpp"
+#include"Boss/Msg/ListpeersResult.hpp"
+#include"Boss/Msg/Notification.hpp"
+#include"Boss/Msg/RequestRpcCommand.hpp"
+#include"Boss/Msg/ResponseRpcCommand.hpp"
+#include"Boss/Msg/Timer10Minutes.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Ln/NodeId.hpp"
+#include"S/Bus.hpp"
+#include<assert.h>
+#include<map>
+#include<string>
+#include<vector>
+
+namespace {
+
+auto const A = std::string("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = std::string("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = std::string("020000000000000000000000000000000000000000000000000000000000000003");
+
+struct Channel {
+	bool connected;
+	std::string channel_id;
+	std::string state;
+	std::uint64_t to_us;
+};
+
+/* What `listpeerchannels` would show.  */
+std::map<std::string, Channel> channels;
+
+std::string listpeerchannels(std::string const& id) {
+	auto rv = std::string("{\"channels\": [");
+	auto first = true;
+	for (auto const& p : channels) {
+		if (!id.empty() && p.first != id)
+			continue;
+		if (!first)
+			rv += ", ";
+		first = false;
+		auto const& c = p.second;
+		rv += "{\"peer_id\": \"" + p.first + "\""
+		      ", \"peer_connected\": "
+		    + (c.connected ? "true" : "false")
+		    + ", \"channel_id\": \"" + c.channel_id + "\""
+		      ", \"state\": \"" + c.state + "\""
+		      ", \"to_us_msat\": " + std::to_string(c.to_us)
+		    + "}";
+	}
+	rv += "]}";
+	return rv;
+}
+
+Jsmn::Object parse(std::string const& s) {
+	return Jsmn::Object::parse_json(s.c_str());
+}
+
+}
+
+int main() {
+	auto bus = S::Bus();
+	Boss::Mod::Waiter waiter(bus);
+	/* Get peers whose balances moved at most every
+	 * 0.2 seconds.  */
+	auto mut = Boss::Mod::ListpeersAnnouncer(bus, waiter, 0.2);
+
+	auto requests = std::vector<std::string>();
+	bus.subscribe<Boss::Msg::RequestRpcCommand
+		     >([&](Boss::Msg::RequestRpcCommand const& m) {
+		assert(m.command == "listpeerchannels");
+		auto params = parse(m.params.output());
+		auto id = std::string();
+		if (params.has("id"))
+			id = std::string(params["id"]);
+		requests.push_back(id);
+
+		auto response = Boss::Msg::ResponseRpcCommand();
+		response.requester = m.requester;
+		response.succeeded = true;
+		response.result = parse(listpeerchannels(id));
+		return bus.raise(std::move(response));
+	});
+
+	auto results = std::size_t(0);
+	auto last_result = Boss::Mod::ConstructedListpeers();
+	bus.subscribe<Boss::Msg::ListpeersResult
+		     >([&](Boss::Msg::ListpeersResult const& m) {
+		++results;
+		last_result = m.cpeers;
+		return Ev::lift();
+	});
+	auto changes = std::vector<Boss::Msg::ListpeersChanged>();
+	bus.subscribe<Boss::Msg::ListpeersChanged
+		     >([&](Boss::Msg::ListpeersChanged const& m) {
+		changes.push_back(m);
+		return Ev::lift();
+	});
+
+	auto notify = [&](char const* name, std::string const& params) {
+		return bus.raise(Boss::Msg::Notification{
+			name, parse(params)
+		});
+	};
+	auto state_of = [](Boss::Mod::ConstructedListpeers const& cpeers, std::string const& id) {
+		auto it = cpeers.find(Ln::NodeId(id));
+		assert(it != cpeers.end());
+		return std::string(it->second.channels[0]["state"]);
+	};
+
+	channels[A] = Channel{true, "aa", "CHANNELD_NORMAL", 1000};
+	channels[B] = Channel{true, "bb", "CHANNELD_NORMAL", 2000};
+
+	auto code = Ev::lift().then([&]() {
+		/* Notifications before the first listing are
+		 * covered by it.  */
+		return notify("connect", "{\"id\": \"" + A + "\"}");
+	}).then([&]() {
+		return bus.raise(Boss::Msg::Timer10Minutes{});
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(results == 1);
+		assert(last_result.size() == 2);
+		/* Everything is new.  */
+		assert(changes.size() == 1);
+		assert(changes[0].changed.size() == 2);
+		changes.clear();
+		assert((requests == std::vector<std::string>{""}));
+		requests.clear();
+
+		/* A channel changes state.  */
+		channels[A].state = "CHANNELD_SHUTTING_DOWN";
+		return notify( "channel_state_changed"
+			     , "{\"channel_state_changed\": {\"peer_id\": \"" + A + "\""
+			       ", \"new_state\": \"CHANNELD_SHUTTING_DOWN\"}}"
+			     );
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		/* Only that peer was listed.  */
+		assert((requests == std::vector<std::string>{A}));
+		requests.clear();
+		assert(changes.size() == 1);
+		assert(changes[0].changed.size() == 1);
+		assert(changes[0].changed.count(Ln::NodeId(A)) == 1);
+		assert(state_of(changes[0].cpeers, A) == "CHANNELD_SHUTTING_DOWN");
+		assert(changes[0].cpeers.size() == 2);
+		changes.clear();
+
+		/* Several at once, one of which does not change
+		 * anything.  */
+		channels[B].connected = false;
+		channels[C] = Channel{true, "cc", "CHANNELD_AWAITING_LOCKIN", 0};
+		return Ev::concurrent(notify( "disconnect"
+					    , "{\"disconnect\": {\"id\": \"" + B + "\"}}"
+					    ))
+		     + Ev::concurrent(notify( "channel_opened"
+					    , "{\"channel_opened\": {\"id\": \"" + C + "\"}}"
+					    ))
+		     + Ev::concurrent(notify( "coin_movement"
+					    , "{\"coin_movement\": {\"account_id\": \"aa\"}}"
+					    ))
+		     ;
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(requests.size() == 3);
+		requests.clear();
+		assert(changes.size() == 1);
+		assert(changes[0].changed.size() == 2);
+		assert(changes[0].changed.count(Ln::NodeId(B)) == 1);
+		assert(changes[0].changed.count(Ln::NodeId(C)) == 1);
+		assert(changes[0].cpeers.size() == 3);
+		assert(!changes[0].cpeers[Ln::NodeId(B)].connected);
+		changes.clear();
+
+		/* A peer whose channel is forgotten.  */
+		channels.erase(C);
+		return notify( "channel_state_changed"
+			     , "{\"channel_state_changed\": {\"peer_id\": \"" + C + "\""
+			       ", \"new_state\": \"CLOSED\"}}"
+			     );
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(changes.size() == 1);
+		assert(changes[0].changed.count(Ln::NodeId(C)) == 1);
+		assert(changes[0].cpeers.size() == 2);
+		changes.clear();
+		requests.clear();
+
+		/* A balance moves.  */
+		channels[A].to_us = 900;
+		return notify( "coin_movement"
+			     , "{\"coin_movement\": {\"account_id\": \"aa\""
+			       ", \"type\": \"channel_mvt\"}}"
+			     );
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert((requests == std::vector<std::string>{A}));
+		requests.clear();
+		assert(changes.size() == 1);
+		assert(changes[0].changed.count(Ln::NodeId(A)) == 1);
+		changes.clear();
+
+		/* Another soon after waits until the interval
+		 * is up.  */
+		channels[B].to_us = 2100;
+		return notify( "coin_movement"
+			     , "{\"coin_movement\": {\"account_id\": \"bb\""
+			       ", \"type\": \"channel_mvt\"}}"
+			     );
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(requests.empty());
+		assert(changes.empty());
+		return waiter.wait(0.3);
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert((requests == std::vector<std::string>{B}));
+		requests.clear();
+		assert(changes.size() == 1);
+		assert(changes[0].changed.size() == 1);
+		assert(changes[0].changed.count(Ln::NodeId(B)) == 1);
+		changes.clear();
+
+		/* Changes without notifications are found
+		 * by the periodic listing.  */
+		channels[A].to_us = 500;
+		return bus.raise(Boss::Msg::Timer10Minutes{});
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(results == 2);
+		assert(changes.size() == 1);
+		assert(changes[0].changed.size() == 1);
+		assert(changes[0].changed.count(Ln::NodeId(A)) == 1);
+		changes.clear();
+
+		/* Nothing changed, nothing announced.  */
+		return bus.raise(Boss::Msg::Timer10Minutes{});
+	}).then([&]() {
+		return Ev::yield(100);
+	}).then([&]() {
+		assert(results == 3);
+		assert(changes.empty());
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
@@ -0,0 +1,132 @@
+#undef NDEBUG
+#include"Boss/Mod/LogManager.hpp"
+#include"Boss/Msg/CommandFail.hpp"
+#include"Boss/Msg/CommandRequest.hpp"
+#include"Boss/Msg/CommandResponse.hpp"
+#include"Boss/Msg/JsonCout.hpp"
+#include"Boss/Msg/Option.hpp"
+#include"Boss/log.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/start.hpp"
+#include"Jsmn/Object.hpp"
+#include"Json/Out.hpp"
+#include"S/Bus.hpp"
+#include<assert.h>
+#include<string>
+
+namespace {
+
+/* Counts how often an argument is evaluated.  */
+int evaluations = 0;
+char const* arg() {
+	++evaluations;
+	return "arg";
+}
+
+}
+
+int main() {
+	auto bus = S::Bus();
+	auto mut = Boss::Mod::LogManager(bus);
+
+	auto emitted = std::size_t(0);
+	bus.subscribe<Boss::Msg::JsonCout>([&](Boss::Msg::JsonCout const&) {
+		++emitted;
+		return Ev::lift();
+	});
+	auto rsp = Jsmn::Object();
+	auto failed = false;
+	bus.subscribe<Boss::Msg::CommandResponse>([&](Boss::Msg::CommandResponse const& m) {
+		rsp = Jsmn::Object::parse_json(m.response.output().c_str());
+		return Ev::lift();
+	});
+	bus.subscribe<Boss::Msg::CommandFail>([&](Boss::Msg::CommandFail const&) {
+		failed = true;
+		return Ev::lift();
+	});
+	auto option = [&](char const* name, char const* json) {
+		auto wrapped = std::string("{\"v\": ") + json + "}";
+		return bus.raise(Boss::Msg::Option{
+			name, Jsmn::Object::parse_json(wrapped.c_str())["v"]
+		});
+	};
+	auto logs = [&](char const* params) {
+		return bus.raise(Boss::Msg::CommandRequest{
+			"clboss-logs",
+			Jsmn::Object::parse_json(params),
+			Ln::CommandId::left(1)
+		});
+	};
+
+	auto code = Ev::lift().then([&]() {
+		/* Everything is emitted by default.  */
+		assert(Boss::log_enabled(Boss::Debug));
+		return Boss::log(bus, Boss::Debug, "debug %d", 1);
+	}).then([&]() {
+		assert(emitted == 1);
+		return option("clboss-log-history", "3");
+	}).then([&]() {
+		return option("clboss-log-level", "\"info\"");
+	}).then([&]() {
+		assert(Boss::get_log_level() == Boss::Info);
+		assert(!Boss::log_enabled(Boss::Debug));
+		assert(Boss::log_enabled(Boss::Warn));
+		emitted = 0;
+		evaluations = 0;
+		return Boss::log(bus, Boss::Debug, "debug %s", arg());
+	}).then([&]() {
+		/* Not emitted, but still kept in the history.
+		 * The argument is still evaluated, which is
+		 * what log_enabled is for.  */
+		assert(emitted == 0);
+		assert(evaluations == 1);
+		auto h = Boss::get_log_history();
+		assert(!h.empty());
+		assert(h.back().level == Boss::Debug);
+		assert(h.back().message == "debug arg");
+		if (Boss::log_enabled(Boss::Debug))
+			return Boss::log(bus, Boss::Debug, "debug %s", arg());
+		return Ev::lift();
+	}).then([&]() {
+		assert(evaluations == 1);
+		return Boss::log(bus, Boss::Info, "info %d", 1);
+	}).then([&]() {
+		return Boss::log(bus, Boss::Warn, "warn %d", 1);
+	}).then([&]() {
+		return Boss::log(bus, Boss::Error, "error %d", 1);
+	}).then([&]() {
+		return Boss::log(bus, Boss::Info, "info %d", 2);
+	}).then([&]() {
+		assert(emitted == 4);
+		return logs("[]");
+	}).then([&]() {
+		/* Only the last 3 are kept, oldest first.  */
+		assert(std::string(rsp["log_level"]) == "info");
+		auto arr = rsp["logs"];
+		assert(arr.size() == 3);
+		assert(std::string(arr[0]["level"]) == "warn");
+		assert(std::string(arr[0]["message"]) == "warn 1");
+		assert(std::string(arr[1]["message"]) == "error 1");
+		assert(std::string(arr[2]["message"]) == "info 2");
+		return logs("{\"level\": \"warn\"}");
+	}).then([&]() {
+		auto arr = rsp["logs"];
+		assert(arr.size() == 2);
+		assert(std::string(arr[0]["message"]) == "warn 1");
+		assert(std::string(arr[1]["message"]) == "error 1");
+		return logs("[\"loud\"]");
+	}).then([&]() {
+		assert(failed);
+
+		/* Unknown levels are ignored.  */
+		return option("clboss-log-level", "\"verbose\"");
+	}).then([&]() {
+		assert(Boss::get_log_level() == Boss::Info);
+
+		Boss::set_log_level(Boss::Debug);
+		Boss::set_log_history(0);
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
@@ -0,0 +1,297 @@
+#undef NDEBUG
+#include"Boss/migrate_hex_to_blob.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/start.hpp"
+#include"Ln/NodeId.hpp"
+#include"Sha256/Hash.hpp"
+#include"Sqlite3.hpp"
+#include<assert.h>
+#include<chrono>
+#include<cstdio>
+#include<iostream>
+#include<vector>
+
+namespace {
+
+auto const a = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000001");
+auto const b = Ln::NodeId("030000000000000000000000000000000000000000000000000000000000000002");
+auto const c = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000004");
+auto const h = Sha256::Hash("0000000000000000000000000000000000000000000000000000000000000003");
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+std::int64_t db_size(Sqlite3::Tx& tx) {
+	auto rv = std::int64_t(1);
+	for (auto p : {"page_count", "page_size"}) {
+		auto sql = std::string("PRAGMA ") + p + ";";
+		auto fetch = tx.query(sql.c_str()).execute();
+		for (auto& r : fetch)
+			rv *= r.get<std::int64_t>(0);
+	}
+	return rv;
+}
+
+/* A synthetic year of forwarding history, in a table
+ * like "PeerStatistician_forwardfees".  */
+auto const num_peers = 50;
+auto const days = 365;
+auto const forwards_per_day = 200;
+
+struct Result {
+	std::int64_t size;
+	double insert_seconds;
+	double query_seconds;
+};
+
+/* Binds as hex text, as older versions did, or as BLOB.  */
+void bind_id( Sqlite3::Query& q, char const* field
+	    , Ln::NodeId const& n, bool text
+	    ) {
+	if (text)
+		q.bind(field, std::string(n));
+	else
+		q.bind(field, n);
+}
+
+Result run(std::vector<Ln::NodeId> const& peers, bool text) {
+	auto db = Sqlite3::Db(":memory:");
+	auto rv = Result();
+	auto code = db.transact().then([&](Sqlite3::Tx tx) {
+		tx.query_execute(R"QRY(
+		CREATE TABLE "forwardfees"
+		     ( in_id NOT NULL
+		     , out_id NOT NULL
+		     , creation REAL NOT NULL
+		     , fee INTEGER NOT NULL
+		     );
+		CREATE INDEX "forwardfees_timeidx"
+		    ON "forwardfees"(creation);
+		CREATE INDEX "forwardfees_inididx"
+		    ON "forwardfees"(in_id);
+		CREATE INDEX "forwardfees_outididx"
+		    ON "forwardfees"(out_id);
+		)QRY");
+
+		auto start = std::chrono::steady_clock::now();
+		auto n = std::size_t(0);
+		for (auto d = 0; d < days; ++d) {
+			for (auto i = 0; i < forwards_per_day; ++i, ++n) {
+				auto const& in = peers[n % peers.size()];
+				auto const& out = peers[(n * 7 + 1) % peers.size()];
+				auto q = tx.query(R"QRY(
+				INSERT INTO "forwardfees"
+				VALUES(:in_id, :out_id, :creation, :fee);
+				)QRY");
+				bind_id(q, ":in_id", in, text);
+				bind_id(q, ":out_id", out, text);
+				q.bind(":creation", d * 86400.0 + i)
+				 .bind(":fee", 1000 + i)
+				 .execute()
+				 ;
+			}
+		}
+		rv.insert_seconds = seconds_since(start);
+
+		start = std::chrono::steady_clock::now();
+		auto total = std::uint64_t(0);
+		for (auto const& p : peers) {
+			auto q = tx.query(R"QRY(
+			SELECT in_id, fee FROM "forwardfees"
+			 WHERE in_id = :id;
+			)QRY");
+			bind_id(q, ":id", p, text);
+			auto fetch = q.execute();
+			for (auto& r : fetch) {
+				assert(r.get<Ln::NodeId>(0) == p);
+				total += r.get<std::uint64_t>(1);
+			}
+		}
+		assert(total != 0);
+		rv.query_seconds = seconds_since(start);
+
+		rv.size = db_size(tx);
+		tx.commit();
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	return rv;
+}
+
+}
+
+int main() {
+	auto db = Sqlite3::Db(":memory:");
+
+	auto code = db.transact().then([&](Sqlite3::Tx tx) {
+		/* Tables as written by older versions.  */
+		tx.query_execute(R"QRY(
+		CREATE TABLE "peers"
+		     ( id TEXT PRIMARY KEY
+		     );
+		CREATE TABLE "fees"
+		     ( in_id TEXT NOT NULL
+		       REFERENCES "peers"(id)
+		       ON DELETE CASCADE
+		       ON UPDATE RESTRICT
+		     , out_id TEXT NOT NULL
+		       REFERENCES "peers"(id)
+		       ON DELETE CASCADE
+		       ON UPDATE RESTRICT
+		     );
+		CREATE TABLE "hashes"
+		     ( hash TEXT PRIMARY KEY
+		     );
+		)QRY");
+		for (auto const& n : {a, b})
+			tx.query("INSERT INTO \"peers\" VALUES(:id);")
+				.bind(":id", std::string(n))
+				.execute()
+				;
+		tx.query("INSERT INTO \"fees\" VALUES(:in_id, :out_id);")
+			.bind(":in_id", std::string(a))
+			.bind(":out_id", std::string(b))
+			.execute()
+			;
+		tx.query("INSERT INTO \"hashes\" VALUES(:hash);")
+			.bind(":hash", std::string(h))
+			.execute()
+			;
+		tx.commit();
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		/* Old text values can still be read.  */
+		auto fetch = tx.query("SELECT hash FROM \"hashes\";").execute();
+		for (auto& r : fetch)
+			assert(r.get<Sha256::Hash>(0) == h);
+
+		auto migrated = Boss::migrate_hex_to_blob(tx, "test", {
+			{"fees", "in_id"},
+			{"fees", "out_id"},
+			{"peers", "id"},
+			{"hashes", "hash"}
+		});
+		assert(migrated == 5);
+		tx.commit();
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		auto fetch = tx.query(R"QRY(
+		SELECT typeof(in_id), typeof(out_id) FROM "fees";
+		)QRY").execute();
+		for (auto& r : fetch) {
+			assert(r.get<std::string>(0) == "blob");
+			assert(r.get<std::string>(1) == "blob");
+		}
+		auto check = tx.query("PRAGMA foreign_key_check;").execute();
+		assert(check.begin() == check.end());
+
+		/* Binary keys match.  */
+		auto count = 0;
+		auto fetch2 = tx.query(R"QRY(
+		SELECT out_id FROM "fees" WHERE in_id = :id;
+		)QRY")
+			.bind(":id", a)
+			.execute()
+			;
+		for (auto& r : fetch2) {
+			assert(r.get<Ln::NodeId>(0) == b);
+			++count;
+		}
+		assert(count == 1);
+		count = 0;
+		auto fetch3 = tx.query(R"QRY(
+		SELECT hash FROM "hashes" WHERE hash = :hash;
+		)QRY")
+			.bind(":hash", h)
+			.execute()
+			;
+		for (auto& r : fetch3) {
+			assert(r.get<Sha256::Hash>(0) == h);
+			++count;
+		}
+		assert(count == 1);
+
+		/* Recorded, so not done again.  */
+		tx.query("INSERT INTO \"peers\" VALUES(:id);")
+			.bind(":id", std::string(c))
+			.execute()
+			;
+		auto migrated = Boss::migrate_hex_to_blob(tx, "test", {
+			{"peers", "id"}
+		});
+		assert(migrated == 0);
+
+		tx.commit();
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+
+	/* A key already written in BLOB form by a newer
+	 * version, as well as in hex TEXT form.  */
+	auto db2 = Sqlite3::Db(":memory:");
+	code = db2.transact().then([&](Sqlite3::Tx tx) {
+		tx.query_execute(R"QRY(
+		CREATE TABLE "peers"
+		     ( id TEXT PRIMARY KEY
+		     );
+		)QRY");
+		tx.query("INSERT INTO \"peers\" VALUES(:id);")
+			.bind(":id", std::string(a))
+			.execute()
+			;
+		tx.query("INSERT INTO \"peers\" VALUES(:id);")
+			.bind(":id", a)
+			.execute()
+			;
+		tx.query("INSERT INTO \"peers\" VALUES(:id);")
+			.bind(":id", std::string(b))
+			.execute()
+			;
+		auto migrated = Boss::migrate_hex_to_blob(tx, "test", {
+			{"peers", "id"}
+		});
+		/* Only b was converted.  */
+		assert(migrated == 1);
+
+		auto count = 0;
+		auto fetch = tx.query(R"QRY(
+		SELECT id, typeof(id) FROM "peers";
+		)QRY").execute();
+		for (auto& r : fetch) {
+			assert(r.get<std::string>(1) == "blob");
+			auto id = r.get<Ln::NodeId>(0);
+			assert(id == a || id == b);
+			++count;
+		}
+		assert(count == 2);
+
+		tx.commit();
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+
+	/* Size and speed comparison.  */
+	auto peers = std::vector<Ln::NodeId>();
+	for (auto i = 0; i < num_peers; ++i) {
+		char buf[67];
+		std::snprintf( buf, sizeof(buf)
+			     , "02%064x", i + 1
+			     );
+		peers.emplace_back(buf);
+	}
+	auto text = run(peers, true);
+	auto blob = run(peers, false);
+	std::cout << days * forwards_per_day << " forwards: "
+		  << "hex text " << text.size << " bytes, "
+		  << text.insert_seconds << "s inserts, "
+		  << text.query_seconds << "s lookups; "
+		  << "binary " << blob.size << " bytes, "
+		  << blob.insert_seconds << "s inserts, "
+		  << blob.query_seconds << "s lookups"
+		  << std::endl;
+	assert(blob.size < text.size);
+
+	return 0;
+}
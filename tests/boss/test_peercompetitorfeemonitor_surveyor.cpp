@@ -0,0 +1,63 @@
+#undef NDEBUG
+#include"Boss/Mod/PeerCompetitorFeeMonitor/Surveyor.hpp"
+#include"Ln/GossipGraph.hpp"
+#include<assert.h>
+
+namespace {
+
+auto const A = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000003");
+auto const D = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000004");
+auto const E = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000005");
+
+void add( Ln::GossipGraph::Builder& builder
+	, Ln::NodeId const& x, Ln::NodeId const& y
+	, char const* scid
+	, std::uint32_t base, std::uint32_t ppm
+	, std::uint64_t capacity
+	) {
+	auto ch = Ln::GossipGraph::Channel();
+	ch.scid = Ln::Scid(scid);
+	ch.capacity = Ln::Amount::sat(capacity);
+	ch.base_fee = base;
+	ch.proportional_fee = ppm;
+	ch.delay = 14;
+	ch.active = true;
+	builder.add_channel(x, y, ch);
+}
+
+}
+
+int main() {
+	using Boss::Mod::PeerCompetitorFeeMonitor::Surveyor;
+
+	/* We are A.  */
+	auto builder = Ln::GossipGraph::Builder();
+	/* Our own fees into B are ignored.  */
+	add(builder, A, B, "1x1x0", 0, 0, 9000000);
+	add(builder, B, A, "1x1x0", 0, 0, 9000000);
+	/* Competitors into B; C has the most capacity.  */
+	add(builder, C, B, "2x1x0", 1000, 100, 3000000);
+	add(builder, D, B, "3x1x0", 2000, 500, 1000000);
+	add(builder, E, B, "4x1x0", 3000, 900, 1000000);
+	/* Only our channel goes into E.  */
+	add(builder, A, E, "5x1x0", 1, 1, 1000000);
+	auto graph = std::make_shared<Ln::GossipGraph>(
+		std::move(builder).build()
+	);
+	auto surveyor = Surveyor(graph, A);
+
+	auto r = surveyor.survey(B);
+	assert(r);
+	assert(r->peer_id == B);
+	assert(r->median_base == 1000);
+	assert(r->median_proportional == 100);
+
+	/* No samples.  */
+	assert(!surveyor.survey(E));
+	/* Unknown.  */
+	assert(!surveyor.survey(Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000006")));
+
+	return 0;
+}
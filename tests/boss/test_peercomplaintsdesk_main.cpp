@@ -263,7 +263,7 @@ int main() {
 			 WHERE nodeid = :nodeid
 			     ;
 			)QRY")
-				.bind(":nodeid", std::string(peer))
+				.bind(":nodeid", peer)
 				.execute();
 			for (auto& r : fetch)
 				n = r.get<std::size_t>(0);
@@ -283,7 +283,7 @@ int main() {
 			     ;
 			)QRY")
 				.bind(":secs", secs)
-				.bind(":nodeid", std::string(peer))
+				.bind(":nodeid", peer)
 				.execute();
 			tx.commit();
 			return Ev::lift();
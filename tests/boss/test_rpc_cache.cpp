@@ -0,0 +1,377 @@
+#undef NDEBUG
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Mod/RpcCacheInvalidator.hpp"
+#include"Boss/Msg/Init.hpp"
+#include"Boss/Msg/Notification.hpp"
+#include"Boss/Msg/ProvideStatus.hpp"
+#include"Boss/Msg/SolicitStatus.hpp"
+#include"Boss/Shutdown.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/map.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Json/Out.hpp"
+#include"Net/Connector.hpp"
+#include"Net/Fd.hpp"
+#include"Net/SocketFd.hpp"
+#include"S/Bus.hpp"
+#include"Secp256k1/PrivKey.hpp"
+#include"Secp256k1/PubKey.hpp"
+#include"Secp256k1/Signature.hpp"
+#include"Secp256k1/SignerIF.hpp"
+#include"Sha256/Hash.hpp"
+#include"Sqlite3/Db.hpp"
+#include<assert.h>
+#include<cstdint>
+#include<errno.h>
+#include<fcntl.h>
+#include<string>
+#include<sys/types.h>
+#include<sys/socket.h>
+#include<unistd.h>
+#include<vector>
+
+namespace {
+
+/* Server that responds to each request with the number
+ * of requests it has received so far.  */
+class CountingServer {
+private:
+	Net::Fd socket;
+	std::string buffer;
+	std::vector<Jsmn::Object> requests;
+
+	Ev::Io<void> writeloop(std::string to_write) {
+		return Ev::yield().then([this, to_write]() {
+			auto res = write( socket.get()
+					, to_write.c_str(), to_write.size()
+					);
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				return writeloop(to_write);
+			assert(res > 0);
+			if (size_t(res) < to_write.size())
+				return writeloop(to_write.substr(res));
+			return Ev::yield();
+		});
+	}
+
+	void slurp() {
+		char buf[256];
+		for (;;) {
+			auto res = read( socket.get()
+				       , buf, sizeof(buf)
+				       );
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				break;
+			assert(res > 0);
+			buffer.append(buf, res);
+		}
+		for (;;) {
+			auto pos = buffer.find("\n\n");
+			if (pos == std::string::npos)
+				break;
+			auto js = buffer.substr(0, pos);
+			buffer.erase(0, pos + 2);
+			requests.push_back(Jsmn::Object::parse_json(
+				js.c_str()
+			));
+		}
+	}
+
+	Ev::Io<void> read_requests(std::size_t n) {
+		return Ev::yield().then([this, n]() {
+			slurp();
+			if (requests.size() < n)
+				return read_requests(n);
+			return Ev::lift();
+		});
+	}
+
+public:
+	std::size_t count = 0;
+
+	explicit
+	CountingServer(Net::Fd socket_) : socket(std::move(socket_)) {
+		auto flags = fcntl(socket.get(), F_GETFL);
+		flags |= O_NONBLOCK;
+		fcntl(socket.get(), F_SETFL, flags);
+	}
+
+	/* Wait for n requests and respond to them.  */
+	Ev::Io<void> serve(std::size_t n) {
+		return read_requests(n).then([this]() {
+			auto js = std::string();
+			for (auto const& req : requests) {
+				++count;
+				auto resp = Json::Out()
+					.start_object()
+						.field("jsonrpc", std::string("2.0"))
+						.field("id", double(req["id"]))
+						.start_object("result")
+							.field("count", double(count))
+						.end_object()
+					.end_object()
+					;
+				js += resp.output();
+			}
+			requests.clear();
+			return writeloop(js);
+		});
+	}
+	/* Check that nothing else was sent.  */
+	Ev::Io<void> check_idle() {
+		return Ev::yield(10).then([this]() {
+			slurp();
+			assert(requests.empty());
+			return Ev::lift();
+		});
+	}
+};
+
+class DummyConnector : public Net::Connector {
+public:
+	Net::SocketFd
+	connect(std::string const& host, int port) override {
+		(void) host;
+		(void) port;
+		return Net::SocketFd();
+	}
+};
+
+class DummySigner : public Secp256k1::SignerIF {
+public:
+	Secp256k1::PubKey
+	get_pubkey_tweak(Secp256k1::PrivKey const&) override {
+		return Secp256k1::PubKey();
+	}
+	Secp256k1::Signature
+	get_signature_tweak( Secp256k1::PrivKey const&
+			   , Sha256::Hash const&
+			   ) override {
+		return Secp256k1::Signature();
+	}
+	Sha256::Hash
+	get_privkey_salted_hash(std::uint8_t salt[32]) override {
+		return Sha256::Hash();
+	}
+};
+
+double mock_now = 1000.0;
+double mock_get_now() {
+	return mock_now;
+}
+
+Json::Out peer_02() {
+	return Json::Out()
+		.start_object()
+			.field("id", std::string("02"))
+		.end_object()
+		;
+}
+
+Json::Out source_02() {
+	return Json::Out()
+		.start_object()
+			.field("source", std::string("02"))
+		.end_object()
+		;
+}
+
+int count_of(Jsmn::Object const& r) {
+	return int(double(r["count"]));
+}
+
+}
+
+int main() {
+	auto bus = S::Bus();
+
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto server = CountingServer(Net::Fd(sockets[0]));
+	auto client = Boss::Mod::Rpc( bus, Net::Fd(sockets[1])
+				    , &mock_get_now
+				    );
+	auto invalidator = Boss::Mod::RpcCacheInvalidator(bus);
+	auto connector = DummyConnector();
+	auto signer = DummySigner();
+	auto db = Sqlite3::Db(":memory:");
+
+	auto status = Jsmn::Object();
+	bus.subscribe<Boss::Msg::ProvideStatus
+		     >([&](Boss::Msg::ProvideStatus const& m) {
+		if (m.key == "rpc_cache")
+			status = Jsmn::Object::parse_json(m.value.output().c_str());
+		return Ev::lift();
+	});
+
+	auto listpeers = [&]() {
+		return client.command("listpeers", Json::Out::empty_object());
+	};
+
+	auto code = Ev::lift().then([&]() {
+		return bus.raise(Boss::Msg::Init{
+			Boss::Msg::Network_Regtest,
+			client,
+			Ln::NodeId(),
+			db,
+			connector,
+			signer,
+			std::string(),
+			false
+		});
+	}).then([&]() {
+		/* Identical commands at the same time share a
+		 * single request.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		auto f = [&](int) { return listpeers(); };
+		return Ev::map(f, std::vector<int>{1, 2, 3});
+	}).then([&](std::vector<Jsmn::Object> rs) {
+		assert(rs.size() == 3);
+		for (auto const& r : rs)
+			assert(count_of(r) == 1);
+		return server.check_idle();
+	}).then([&]() {
+		/* Cached.  */
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 1);
+		return server.check_idle();
+	}).then([&]() {
+		/* Different parameters are cached separately.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		auto parms = Json::Out()
+			.start_object()
+				.field("id", std::string("02"))
+			.end_object()
+			;
+		return client.command("listpeers", std::move(parms));
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 2);
+
+		/* Expired.  */
+		mock_now += 11.0;
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 3);
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 3);
+
+		/* Cleared by a notification.  */
+		return bus.raise(Boss::Msg::Notification{
+			"connect", Jsmn::Object()
+		});
+	}).then([&]() {
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 4);
+
+		/* Cleared by a command that changes things,
+		 * but not by one that does not.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("getinfo", Json::Out::empty_object());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 5);
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 4);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("connect", Json::Out::empty_object());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 6);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 7);
+		return server.check_idle();
+	}).then([&]() {
+		/* Not every `wait` command is read-only.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("waitsendpay", Json::Out::empty_object());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 8);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 9);
+
+		/* Payments only shift balances, so they do not
+		 * clear the cache.  */
+		return bus.raise(Boss::Msg::Notification{
+			"invoice_payment", Jsmn::Object()
+		});
+	}).then([&]() {
+		return listpeers();
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 9);
+		return server.check_idle();
+	}).then([&]() {
+		/* The unfiltered `listchannels` is not cached.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("listchannels", Json::Out::empty_object());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 10);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("listchannels", Json::Out::empty_object());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 11);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("listchannels", source_02());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 12);
+		return client.command("listchannels", source_02());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 12);
+		return server.check_idle();
+	}).then([&]() {
+		/* Nor is `listpeerchannels` of a single peer,
+		 * which is how balances are checked after they
+		 * move.  */
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("listpeerchannels", peer_02());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 13);
+		return Ev::concurrent(server.serve(1));
+	}).then([&]() {
+		return client.command("listpeerchannels", peer_02());
+	}).then([&](Jsmn::Object r) {
+		assert(count_of(r) == 14);
+		return server.check_idle();
+	}).then([&]() {
+		return bus.raise(Boss::Msg::SolicitStatus{});
+	}).then([&]() {
+		assert(double(status["hits"]) == 5);
+		assert(double(status["misses"]) == 7);
+		assert(double(status["coalesced"]) == 2);
+		assert(double(status["invalidations"]) == 3);
+		assert(double(status["entries"]) == 2);
+		return bus.raise(Boss::Shutdown());
+	}).then([&]() {
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
@@ -0,0 +1,223 @@
+#undef NDEBUG
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Shutdown.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Json/Out.hpp"
+#include"Net/Fd.hpp"
+#include"S/Bus.hpp"
+#include<assert.h>
+#include<cstdint>
+#include<errno.h>
+#include<fcntl.h>
+#include<string>
+#include<sys/types.h>
+#include<sys/socket.h>
+#include<unistd.h>
+#include<vector>
+
+namespace {
+
+/* Server that waits for a number of requests, then
+ * responds to all of them in reverse order.  */
+class ReversingServer {
+private:
+	Net::Fd socket;
+	std::string buffer;
+	std::vector<Jsmn::Object> requests;
+
+	Ev::Io<void> writeloop(std::string to_write) {
+		return Ev::yield().then([this, to_write]() {
+			auto res = write( socket.get()
+					, to_write.c_str(), to_write.size()
+					);
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				return writeloop(to_write);
+			assert(res > 0);
+			if (size_t(res) < to_write.size())
+				return writeloop(to_write.substr(res));
+			return Ev::yield();
+		});
+	}
+
+	/* Read until we have n requests.  */
+	Ev::Io<void> read_requests(std::size_t n) {
+		return Ev::yield().then([this, n]() {
+			char buf[256];
+			for (;;) {
+				auto res = read( socket.get()
+					       , buf, sizeof(buf)
+					       );
+				if (res < 0 && ( errno == EWOULDBLOCK
+					      || errno == EAGAIN
+					       ))
+					break;
+				assert(res > 0);
+				buffer.append(buf, res);
+			}
+			for (;;) {
+				auto pos = buffer.find("\n\n");
+				if (pos == std::string::npos)
+					break;
+				auto js = buffer.substr(0, pos);
+				buffer.erase(0, pos + 2);
+				requests.push_back(Jsmn::Object::parse_json(
+					js.c_str()
+				));
+			}
+			if (requests.size() < n)
+				return read_requests(n);
+			return Ev::lift();
+		});
+	}
+
+public:
+	explicit
+	ReversingServer(Net::Fd socket_) : socket(std::move(socket_)) {
+		auto flags = fcntl(socket.get(), F_GETFL);
+		flags |= O_NONBLOCK;
+		fcntl(socket.get(), F_SETFL, flags);
+	}
+
+	Ev::Io<void> serve(std::size_t n) {
+		return read_requests(n).then([this]() {
+			auto js = std::string();
+			for ( auto it = requests.rbegin()
+			    ; it != requests.rend()
+			    ; ++it
+			    ) {
+				auto const& req = *it;
+				auto id = double(req["id"]);
+				auto method = std::string(req["method"]);
+				auto resp = Json::Out();
+				auto obj = resp.start_object();
+				obj.field("jsonrpc", std::string("2.0"));
+				obj.field("id", id);
+				if (method == "fail") {
+					obj.start_object("error")
+						.field("code", double(-1))
+						.field("message", std::string("failed"))
+					.end_object();
+				} else {
+					obj.start_object("result")
+						.field("x", double(req["params"]["x"]))
+					.end_object();
+				}
+				obj.end_object();
+				js += resp.output();
+			}
+			requests.clear();
+			return writeloop(js);
+		});
+	}
+	/* Wait for n requests, then ignore them.  */
+	Ev::Io<void> swallow(std::size_t n) {
+		return read_requests(n).then([this]() {
+			requests.clear();
+			return Ev::lift();
+		});
+	}
+};
+
+Json::Out params(std::size_t x) {
+	return Json::Out()
+		.start_object()
+			.field("x", double(x))
+		.end_object()
+		;
+}
+
+}
+
+int main() {
+	auto bus = S::Bus();
+
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto server = ReversingServer(Net::Fd(sockets[0]));
+	auto client = Boss::Mod::Rpc(bus, Net::Fd(sockets[1]));
+
+	/* More than fit in a single write.  */
+	auto constexpr num_commands = std::size_t(60);
+
+	auto batch_done = false;
+	auto shutdown_flag = false;
+
+	auto server_code = Ev::lift().then([&]() {
+		/* All commands must be in flight before
+		 * any response is sent.  */
+		return server.serve(num_commands);
+	}).then([&]() {
+		return server.swallow(3);
+	}).then([&]() {
+		return bus.raise(Boss::Shutdown());
+	});
+
+	auto client_code = Ev::lift().then([&]() {
+		/* Empty batch.  */
+		return client.command_many({});
+	}).then([&](std::vector<Jsmn::Object> rs) {
+		assert(rs.empty());
+
+		auto commands = std::vector<std::pair<std::string, Json::Out>>();
+		for (auto i = std::size_t(0); i < num_commands; ++i) {
+			if (i % 7 == 3)
+				commands.emplace_back("fail", params(i));
+			else
+				commands.emplace_back("echo", params(i));
+		}
+		return client.command_many(std::move(commands));
+	}).then([&](std::vector<Jsmn::Object> rs) {
+		/* Results are in order of the commands, even
+		 * though the server responded in reverse.  */
+		assert(rs.size() == num_commands);
+		for (auto i = std::size_t(0); i < num_commands; ++i) {
+			if (i % 7 == 3) {
+				assert(rs[i].has("error"));
+				auto failed = false;
+				try {
+					Boss::Mod::Rpc::result_of("fail", rs[i]);
+				} catch (Boss::Mod::RpcError const& e) {
+					failed = true;
+					assert(e.command == "fail");
+				}
+				assert(failed);
+			} else {
+				auto r = Boss::Mod::Rpc::result_of("echo", rs[i]);
+				assert(std::size_t(double(r["x"])) == i);
+			}
+		}
+		batch_done = true;
+
+		/* Unanswered batch is failed at shutdown.  */
+		auto commands = std::vector<std::pair<std::string, Json::Out>>();
+		for (auto i = std::size_t(0); i < 3; ++i)
+			commands.emplace_back("echo", params(i));
+		return client.command_many(std::move(commands))
+				.catching<Boss::Shutdown>([&](Boss::Shutdown const& e) {
+			shutdown_flag = true;
+			return Ev::lift(std::vector<Jsmn::Object>());
+		});
+	}).then([](std::vector<Jsmn::Object> ignored) {
+		return Ev::lift(0);
+	});
+
+	auto code = Ev::lift().then([&]() {
+		return Ev::concurrent(server_code);
+	}).then([&]() {
+		return client_code;
+	});
+
+	auto ec = Ev::start(code);
+
+	assert(batch_done);
+	assert(shutdown_flag);
+
+	return ec;
+}
@@ -0,0 +1,188 @@
+#undef NDEBUG
+#include"Boss/Mod/Rpc.hpp"
+#include"Boss/Shutdown.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include"Jsmn/Object.hpp"
+#include"Jsmn/ParseError.hpp"
+#include"Json/Out.hpp"
+#include"Net/Fd.hpp"
+#include"S/Bus.hpp"
+#include<assert.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<sstream>
+#include<string>
+#include<sys/socket.h>
+#include<sys/types.h>
+#include<unistd.h>
+
+namespace {
+
+auto constexpr num_pays = std::size_t(20000);
+
+/* Server that responds to each request with a large
+ * array of pays.  */
+class PaysServer {
+private:
+	Net::Fd socket;
+	std::string buffer;
+
+	Ev::Io<void> writeloop(std::string to_write) {
+		return Ev::yield().then([this, to_write]() {
+			auto res = write( socket.get()
+					, to_write.c_str(), to_write.size()
+					);
+			if (res < 0 && ( errno == EWOULDBLOCK
+				      || errno == EAGAIN
+				       ))
+				return writeloop(to_write);
+			assert(res > 0);
+			if (size_t(res) < to_write.size())
+				return writeloop(to_write.substr(res));
+			return Ev::lift();
+		});
+	}
+
+	Ev::Io<Jsmn::Object> read_request() {
+		return Ev::yield().then([this]() {
+			char buf[256];
+			for (;;) {
+				auto res = read(socket.get(), buf, sizeof(buf));
+				if (res < 0 && ( errno == EWOULDBLOCK
+					      || errno == EAGAIN
+					       ))
+					break;
+				assert(res > 0);
+				buffer.append(buf, res);
+			}
+			auto pos = buffer.find("\n\n");
+			if (pos == std::string::npos)
+				return read_request();
+			auto js = buffer.substr(0, pos);
+			buffer.erase(0, pos + 2);
+			return Ev::lift(Jsmn::Object::parse_json(js.c_str()));
+		});
+	}
+
+public:
+	explicit
+	PaysServer(Net::Fd socket_) : socket(std::move(socket_)) {
+		auto flags = fcntl(socket.get(), F_GETFL);
+		flags |= O_NONBLOCK;
+		fcntl(socket.get(), F_SETFL, flags);
+	}
+
+	/* If broken, one of the pays is not valid JSON.  */
+	Ev::Io<void> serve(bool broken = false) {
+		return read_request().then([this, broken](Jsmn::Object req) {
+			auto os = std::ostringstream();
+			os << "{\"jsonrpc\": \"2.0\", \"id\": "
+			   << req["id"].direct_text()
+			   << ", \"result\": {\"pays\": [";
+			for (auto i = std::size_t(0); i < num_pays; ++i) {
+				if (i != 0)
+					os << ",\n";
+				os << "{\"label\": \"l" << i << "\""
+				   << ", \"status\": \"complete\"}";
+			}
+			if (broken)
+				os << ", {]";
+			os << "], \"extra\": 1}}";
+			return writeloop(os.str());
+		});
+	}
+};
+
+}
+
+int main() {
+	auto bus = S::Bus();
+
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto server = PaysServer(Net::Fd(sockets[0]));
+	auto client = Boss::Mod::Rpc(bus, Net::Fd(sockets[1]));
+
+	auto count = std::size_t(0);
+	auto in_order = true;
+	auto done = false;
+
+	auto server_code = Ev::lift().then([&]() {
+		return server.serve();
+	}).then([&]() {
+		return server.serve();
+	}).then([&]() {
+		return server.serve(true);
+	}).then([&]() {
+		return server.serve();
+	});
+
+	auto client_code = Ev::lift().then([&]() {
+		return client.command_streaming( "listpays"
+					       , Json::Out::empty_object()
+					       , "pays"
+					       , [&](Jsmn::Object pay) {
+			auto label = std::string(pay["label"]);
+			if (label != "l" + std::to_string(count))
+				in_order = false;
+			++count;
+		});
+	}).then([&](Jsmn::Object result) {
+		assert(count == num_pays);
+		assert(in_order);
+		assert(result["pays"].is_array());
+		assert(result["pays"].size() == 0);
+		assert(double(result["extra"]) == 1);
+
+		/* Without streaming, all are in the result.  */
+		return client.command("listpays", Json::Out::empty_object());
+	}).then([&](Jsmn::Object result) {
+		assert(count == num_pays);
+		assert(result["pays"].size() == num_pays);
+
+		/* An invalid element fails the command.  */
+		count = 0;
+		return client.command_streaming( "listpays"
+					       , Json::Out::empty_object()
+					       , "pays"
+					       , [&](Jsmn::Object) { ++count; }
+					       ).then([](Jsmn::Object) {
+			assert(0); /* Should not happen.  */
+			return Ev::lift(false);
+		}).catching<Jsmn::ParseError>([](Jsmn::ParseError const&) {
+			return Ev::lift(true);
+		});
+	}).then([&](bool failed) {
+		assert(failed);
+		assert(count == num_pays);
+
+		/* Later commands still work.  */
+		count = 0;
+		return client.command_streaming( "listpays"
+					       , Json::Out::empty_object()
+					       , "pays"
+					       , [&](Jsmn::Object) { ++count; }
+					       );
+	}).then([&](Jsmn::Object result) {
+		assert(count == num_pays);
+		assert(result["pays"].size() == 0);
+		done = true;
+		return bus.raise(Boss::Shutdown());
+	}).then([]() {
+		return Ev::lift(0);
+	});
+
+	auto code = Ev::lift().then([&]() {
+		return Ev::concurrent(server_code);
+	}).then([&]() {
+		return client_code;
+	});
+
+	auto ec = Ev::start(code);
+	assert(done);
+	return ec;
+}
@@ -0,0 +1,201 @@
+#undef NDEBUG
+#include"Json/Out.hpp"
+#include"Net/Fd.hpp"
+#include"Net/WriteQueue.hpp"
+#include<assert.h>
+#include<chrono>
+#include<errno.h>
+#include<fcntl.h>
+#include<iostream>
+#include<string>
+#include<sys/socket.h>
+#include<sys/types.h>
+#include<unistd.h>
+#include<vector>
+
+namespace {
+
+#if USE_VALGRIND
+auto const num_requests = std::size_t(200);
+#else
+auto const num_requests = std::size_t(5000);
+#endif
+
+/* Requests like those `Boss::Mod::Rpc` queues up.  */
+std::vector<std::string> make_requests() {
+	auto rv = std::vector<std::string>();
+	for (auto i = std::size_t(0); i < num_requests; ++i) {
+		auto params = Json::Out();
+		if (i % 2 == 0) {
+			auto obj = params.start_object();
+			auto route = obj.start_array("route");
+			for (auto hop = 0; hop < 5; ++hop)
+				route.start_object()
+					.field("id", std::string("02000000000000000000000000000000000000000000000000000000000000000") + char('0' + hop))
+					.field("channel", std::string("700000x1000x") + std::to_string(hop))
+					.field("amount_msat", double(1000000 + hop))
+					.field("delay", double(144 - hop))
+				.end_object();
+			route.end_array();
+			obj.field("payment_hash", std::string(64, 'a'));
+			obj.end_object();
+		} else {
+			params.start_object()
+				.field("source", std::string(66, '2'))
+			.end_object();
+		}
+		auto js = Json::Out()
+			.start_object()
+				.field("jsonrpc", std::string("2.0"))
+				.field("id", double(i))
+				.field("method", std::string(i % 2 == 0 ? "sendpay" : "listchannels"))
+				.field("params", params)
+			.end_object()
+			.output();
+		js += "\n\n";
+		rv.push_back(std::move(js));
+	}
+	return rv;
+}
+
+void set_nonblocking(int fd) {
+	auto flags = fcntl(fd, F_GETFL);
+	flags |= O_NONBLOCK;
+	fcntl(fd, F_SETFL, flags);
+}
+
+/* Read everything available from the other end.  */
+void drain(int fd, std::string& received) {
+	char buf[65536];
+	for (;;) {
+		auto res = read(fd, buf, sizeof(buf));
+		if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+		assert(res > 0);
+		received.append(buf, res);
+	}
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+/* The old scheme: a flat byte buffer, written at most 512
+ * bytes per call, erasing from the front.  */
+std::string flush_flat(std::vector<std::string> const& reqs) {
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto writer = Net::Fd(sockets[0]);
+	auto reader = Net::Fd(sockets[1]);
+	set_nonblocking(writer.get());
+	set_nonblocking(reader.get());
+
+	auto to_write = std::vector<char>();
+	for (auto const& r : reqs)
+		std::copy(r.begin(), r.end(), std::back_inserter(to_write));
+
+	auto received = std::string();
+	while (!to_write.empty()) {
+		auto size = to_write.size();
+		if (size > 512)
+			size = 512;
+		auto res = write(writer.get(), &to_write[0], size);
+		if (res < 0) {
+			assert(errno == EAGAIN || errno == EWOULDBLOCK);
+			drain(reader.get(), received);
+			continue;
+		}
+		to_write.erase(to_write.begin(), to_write.begin() + res);
+	}
+	drain(reader.get(), received);
+	return received;
+}
+
+std::string flush_queue(std::vector<std::string> reqs) {
+	int sockets[2];
+	auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+	assert(res >= 0);
+	auto writer = Net::Fd(sockets[0]);
+	auto reader = Net::Fd(sockets[1]);
+	set_nonblocking(writer.get());
+	set_nonblocking(reader.get());
+
+	auto to_write = Net::WriteQueue();
+	for (auto& r : reqs)
+		to_write.push(std::move(r));
+
+	auto received = std::string();
+	while (!to_write.empty()) {
+		auto res = to_write.write_to(writer.get());
+		if (res < 0) {
+			assert(errno == EAGAIN || errno == EWOULDBLOCK);
+			drain(reader.get(), received);
+			continue;
+		}
+	}
+	drain(reader.get(), received);
+	return received;
+}
+
+}
+
+int main() {
+	auto reqs = make_requests();
+	auto expected = std::string();
+	for (auto const& r : reqs)
+		expected += r;
+
+	auto start = std::chrono::steady_clock::now();
+	auto flat = flush_flat(reqs);
+	auto t_flat = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	auto queued = flush_queue(reqs);
+	auto t_queue = seconds_since(start);
+
+	assert(flat == expected);
+	assert(queued == expected);
+
+	std::cout << num_requests << " requests, "
+		  << expected.size() << " bytes" << std::endl
+		  << "flat buffer: " << t_flat << "s" << std::endl
+		  << "write queue: " << t_queue << "s" << std::endl
+		  ;
+
+	/* Partial writes in the middle of chunks.  */
+	{
+		int sockets[2];
+		auto res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+		assert(res >= 0);
+		auto writer = Net::Fd(sockets[0]);
+		auto reader = Net::Fd(sockets[1]);
+		set_nonblocking(writer.get());
+		set_nonblocking(reader.get());
+		auto q = Net::WriteQueue();
+		q.push("");
+		assert(q.empty());
+		auto big = std::string(1 << 20, 'x');
+		big[0] = 'a';
+		big.back() = 'z';
+		q.push(big);
+		q.push("tail");
+		assert(q.size() == big.size() + 4);
+		auto received = std::string();
+		while (!q.empty()) {
+			auto before = q.size();
+			auto res = q.write_to(writer.get());
+			if (res < 0) {
+				drain(reader.get(), received);
+				continue;
+			}
+			assert(q.size() == before - std::size_t(res));
+		}
+		drain(reader.get(), received);
+		assert(received == big + "tail");
+		assert(q.write_to(writer.get()) == 0);
+	}
+
+	return 0;
+}
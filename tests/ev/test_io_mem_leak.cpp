@@ -4,6 +4,8 @@
 #include<stdlib.h>
 
 unsigned long count = 0;
+/* Total number of allocations ever made.  */
+unsigned long allocs = 0;
 
 /* Memory leak detection.  */
 #if !USE_VALGRIND || TEST_IO_MEM_LEAK_ALLOW_VALGRIND
@@ -27,6 +29,7 @@ unsigned long count = 0;
 
 void* operator new(size_t size) {
 	++count;
+	++allocs;
 	return malloc(size);
 }
 void operator delete(void* p) noexcept {
@@ -49,10 +52,17 @@ void operator delete(void* p, size_t) noexcept {
 #include"Ev/Io.hpp"
 #include"Ev/start.hpp"
 #include"Ev/yield.hpp"
+#include<iostream>
 
 #define NUM_LOOPS 200
 #define MAX_COUNT 10
 
+/* Allocations per link of a long `then` chain, when
+ * building it, and when running through it.  */
+#define CHAIN_LENGTH 1000
+#define MAX_ALLOCS_PER_THEN 2
+#define MAX_ALLOCS_PER_STEP 4
+
 Ev::Io<int> loop(unsigned long n, bool& flag) {
 	return Ev::yield().then([n, &flag]() {
 		/* Confirm the loop executed at least once.  */
@@ -67,7 +77,39 @@ Ev::Io<int> loop(unsigned long n, bool& flag) {
 	});
 }
 
+void test_chain_allocs() {
+	auto start = allocs;
+	auto io = Ev::lift(0);
+	for (auto i = 0; i < CHAIN_LENGTH; ++i)
+		io = std::move(io).then([](int x) {
+			return Ev::lift(x + 1);
+		});
+	auto built = allocs;
+
+	auto result = 0;
+	io.run([&result](int x) {
+		result = x;
+	}, [](std::exception_ptr) {
+		assert(false);
+	});
+	auto ran = allocs;
+	assert(result == CHAIN_LENGTH);
+
+#if !USE_VALGRIND || TEST_IO_MEM_LEAK_ALLOW_VALGRIND
+	std::cout << "then: " << double(built - start) / CHAIN_LENGTH
+		  << " allocations per link; "
+		  << "run: " << double(ran - built) / CHAIN_LENGTH
+		  << " allocations per link"
+		  << std::endl;
+	assert(built - start <= MAX_ALLOCS_PER_THEN * CHAIN_LENGTH);
+	assert(ran - built <= MAX_ALLOCS_PER_STEP * CHAIN_LENGTH);
+#endif /* !USE_VALGRIND */
+}
+
 int main() {
+	test_chain_allocs();
+	assert(count < MAX_COUNT);
+
 	auto flag = bool(false);
 	auto ec = Ev::start(loop(NUM_LOOPS, flag));
 	assert(flag);
@@ -31,9 +31,9 @@ auto num_completed = std::size_t(0);
 auto hit_max = false;
 
 /* Do nothing useful.  */
-Ev::Io<void> be_busy(bool should_throw) {
-	return Ev::lift().then([]() {
-		++num_running;
+Ev::Io<void> be_busy(bool should_throw, std::size_t units) {
+	return Ev::lift().then([units]() {
+		num_running += units;
 		assert(num_running <= max);
 		if (num_running == max)
 			hit_max = true;
@@ -44,9 +44,9 @@ Ev::Io<void> be_busy(bool should_throw) {
 			act += Ev::yield();
 		}
 		return act;
-	}).then([]() {
-		assert(num_running != 0);
-		--num_running;
+	}).then([units]() {
+		assert(num_running >= units);
+		num_running -= units;
 		return Ev::lift();
 	}).then([should_throw]() {
 		if (should_throw)
@@ -56,8 +56,13 @@ Ev::Io<void> be_busy(bool should_throw) {
 }
 
 /* Run one thread.  */
-Ev::Io<void> action(Ev::Semaphore& sem, bool should_throw) {
-	return sem.run(be_busy(should_throw)).then([should_throw]() {
+Ev::Io<void> action( Ev::Semaphore& sem, bool should_throw
+		   , std::size_t units
+		   ) {
+	auto act = (units == 1) ? sem.run(be_busy(should_throw, 1))
+		 : sem.run(units, be_busy(should_throw, units))
+		 ;
+	return std::move(act).then([should_throw]() {
 		assert(!should_throw);
 		++num_completed;
 		return Ev::lift();
@@ -73,7 +78,13 @@ Ev::Io<void> launch_loop(Ev::Semaphore& sem, std::size_t remaining) {
 	return Ev::yield().then([&sem, remaining]() {
 		if (remaining == 0)
 			return Ev::lift();
-		return Ev::concurrent(action(sem, (remaining % 2) == 0))
+		/* Mostly single units, some multiple units.  */
+		auto units = (remaining % 7 == 0) ? (remaining % 5) + 2
+			   : std::size_t(1)
+			   ;
+		return Ev::concurrent(action( sem, (remaining % 2) == 0
+					    , units
+					    ))
 		     + launch_loop(sem, remaining - 1)
 		     ;
 	});
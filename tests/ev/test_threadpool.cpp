@@ -0,0 +1,151 @@
+#undef NDEBUG
+#include"Ev/Io.hpp"
+#include"Ev/ThreadPool.hpp"
+#include"Ev/start.hpp"
+#include<assert.h>
+#include<condition_variable>
+#include<memory>
+#include<mutex>
+#include<vector>
+
+namespace {
+
+/* Blocks a background thread until released.  */
+class Gate {
+private:
+	std::mutex mtx;
+	std::condition_variable cnd;
+	bool open;
+public:
+	Gate() : open(false) { }
+	void wait() {
+		auto l = std::unique_lock<std::mutex>(mtx);
+		while (!open)
+			cnd.wait(l);
+	}
+	void release() {
+		{
+			auto l = std::unique_lock<std::mutex>(mtx);
+			open = true;
+		}
+		cnd.notify_all();
+	}
+};
+
+/* Starts all the actions at once, and passes the
+ * results in the order they finished.  */
+Ev::Io<std::vector<int>> run_all(std::vector<Ev::Io<int>> acts) {
+	return Ev::Io<std::vector<int>>([acts
+					]( std::function<void(std::vector<int>)> pass
+					 , std::function<void(std::exception_ptr)> fail
+					 ) {
+		auto results = std::make_shared<std::vector<int>>();
+		auto n = acts.size();
+		for (auto& act : acts)
+			act.run([results, n, pass](int i) {
+				results->push_back(i);
+				if (results->size() == n)
+					pass(std::move(*results));
+			}, fail);
+	});
+}
+
+std::vector<Ev::Io<int>>
+make_work(Ev::ThreadPool& tp, int n, std::mutex* mtx = nullptr, std::vector<int>* order = nullptr) {
+	auto rv = std::vector<Ev::Io<int>>();
+	for (auto i = 0; i < n; ++i)
+		rv.push_back(tp.background<int>([i, mtx, order]() {
+			if (order) {
+				auto l = std::unique_lock<std::mutex>(*mtx);
+				order->push_back(i);
+			}
+			return i;
+		}));
+	return rv;
+}
+
+void check_sum(std::vector<int> const& results, int n) {
+	assert(int(results.size()) == n);
+	auto sum = 0;
+	for (auto i : results)
+		sum += i;
+	assert(sum == n * (n - 1) / 2);
+}
+
+}
+
+int main() {
+	assert(Ev::ThreadPool::default_num_threads() >= 4);
+
+	{
+		/* Interactive work is not stuck behind bulk
+		 * work, even with the only general thread
+		 * blocked.  */
+		auto tp = Ev::ThreadPool(2);
+		auto gate = Gate();
+		auto acts = std::vector<Ev::Io<int>>();
+		acts.push_back(tp.background<int>([&gate]() {
+			gate.wait();
+			return 1;
+		}));
+		acts.push_back(tp.background<int>([]() {
+			return 2;
+		}, Ev::ThreadPool::Interactive).then([&gate](int i) {
+			gate.release();
+			return Ev::lift(i);
+		}));
+		auto code = run_all(std::move(acts)
+		).then([](std::vector<int> order) {
+			assert((order == std::vector<int>{2, 1}));
+			return Ev::lift(0);
+		});
+		assert(Ev::start(code) == 0);
+	}
+
+	{
+		/* Many results at once, resizing, and
+		 * statistics.  */
+		auto tp = Ev::ThreadPool(4);
+		auto code = run_all(make_work(tp, 1000)
+		).then([&](std::vector<int> results) {
+			check_sum(results, 1000);
+			tp.set_num_threads(8);
+			assert(tp.get_stats().threads == 8);
+			return run_all(make_work(tp, 1000));
+		}).then([&](std::vector<int> results) {
+			check_sum(results, 1000);
+			tp.set_num_threads(2);
+			assert(tp.get_stats().threads == 2);
+			return run_all(make_work(tp, 1000));
+		}).then([&](std::vector<int> results) {
+			check_sum(results, 1000);
+			auto s = tp.get_stats();
+			assert(s.completed == 3000);
+			assert(s.busy == 0);
+			assert(s.interactive_queued == 0);
+			assert(s.bulk_queued == 0);
+			assert(s.max_wait >= s.mean_wait);
+			assert(s.max_run >= s.mean_run);
+			return Ev::lift(0);
+		});
+		assert(Ev::start(code) == 0);
+	}
+
+	{
+		/* A single thread does work in order.  */
+		auto tp = Ev::ThreadPool(1);
+		auto mtx = std::mutex();
+		auto order = std::vector<int>();
+		auto code = run_all(make_work(tp, 100, &mtx, &order)
+		).then([&](std::vector<int> results) {
+			for (auto i = 0; i < 100; ++i) {
+				assert(order[i] == i);
+				assert(results[i] == i);
+			}
+			return Ev::lift(0);
+		});
+		assert(Ev::start(code) == 0);
+	}
+
+	return 0;
+}
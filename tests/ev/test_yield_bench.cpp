@@ -0,0 +1,101 @@
+#undef NDEBUG
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include<assert.h>
+#include<chrono>
+#include<iostream>
+#include<memory>
+#include<vector>
+
+namespace {
+
+/* Valgrind is far too slow for the full run.  */
+#if USE_VALGRIND
+auto const num_yields = std::size_t(10000);
+auto const num_tasks = std::size_t(1000);
+#else
+auto const num_yields = std::size_t(1000000);
+auto const num_tasks = std::size_t(100000);
+#endif
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+Ev::Io<void> loop(std::size_t n) {
+	if (n == 0)
+		return Ev::lift();
+	return Ev::yield().then([n]() {
+		return loop(n - 1);
+	});
+}
+
+/* Starts a concurrent task without nesting its start
+ * into a larger action.  */
+void spawn(Ev::Io<void> io) {
+	Ev::concurrent(std::move(io)).run([]() { }, [](std::exception_ptr) {
+		assert(false);
+	});
+}
+
+}
+
+int main() {
+	auto start = std::chrono::steady_clock::now();
+	auto code = loop(num_yields).then([]() {
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	auto secs = seconds_since(start);
+	std::cout << num_yields << " yields: " << secs << "s, "
+		  << (secs / num_yields * 1e9) << "ns/yield"
+		  << std::endl;
+
+	/* Concurrent tasks run in the order they were
+	 * started, including with a budget.  */
+	auto order = std::make_shared<std::vector<std::size_t>>();
+	start = std::chrono::steady_clock::now();
+	code = Ev::lift().then([order]() {
+		for (auto i = std::size_t(0); i < num_tasks; ++i)
+			spawn(Ev::lift().then([order, i]() {
+				order->push_back(i);
+				return Ev::lift();
+			}));
+		return Ev::lift();
+	}).then([]() {
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	secs = seconds_since(start);
+	std::cout << num_tasks << " concurrent tasks: " << secs << "s, "
+		  << (secs / num_tasks * 1e9) << "ns/task"
+		  << std::endl;
+	assert(order->size() == num_tasks);
+	for (auto i = std::size_t(0); i < num_tasks; ++i)
+		assert((*order)[i] == i);
+
+	Ev::set_yield_budget(3);
+	order->clear();
+	code = Ev::lift().then([order]() {
+		for (auto i = std::size_t(0); i < 10; ++i)
+			spawn(Ev::yield().then([order, i]() {
+				order->push_back(i);
+				return Ev::lift();
+			}));
+		return Ev::lift();
+	}).then([]() {
+		return loop(10);
+	}).then([]() {
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	assert(order->size() == 10);
+	for (auto i = std::size_t(0); i < 10; ++i)
+		assert((*order)[i] == i);
+	Ev::set_yield_budget(0);
+
+	return 0;
+}
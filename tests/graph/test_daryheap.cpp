@@ -0,0 +1,85 @@
+#undef NDEBUG
+#include"Graph/DaryHeap.hpp"
+#include<algorithm>
+#include<assert.h>
+#include<map>
+#include<random>
+
+int main() {
+	{
+		auto h = Graph::DaryHeap<int>();
+		assert(h.empty());
+		h.push(3, 30);
+		h.push(1, 10);
+		h.push(7, 70);
+		h.push(5, 50);
+		assert(h.size() == 4);
+		assert(h.contains(7));
+		assert(!h.contains(2));
+		assert(!h.contains(100));
+		assert(h.top() == 1);
+		assert(h.top_cost() == 10);
+
+		/* Decrease-key moves it to the front.  */
+		h.decrease(7, 5);
+		assert(h.top() == 7);
+		assert(h.pop() == 7);
+		assert(!h.contains(7));
+		assert(h.pop() == 1);
+		assert(h.pop() == 3);
+
+		/* Can be pushed again after being popped.  */
+		h.push(1, 60);
+		assert(h.pop() == 5);
+		assert(h.pop() == 1);
+		assert(h.empty());
+
+		h.push(2, 2);
+		h.push(4, 4);
+		h.clear();
+		assert(h.empty());
+		assert(!h.contains(2));
+	}
+
+	/* Random operations against a reference.  */
+	auto engine = std::mt19937(42);
+	auto key_dist = std::uniform_int_distribution<std::uint32_t>(0, 999);
+	auto cost_dist = std::uniform_int_distribution<int>(0, 100000);
+	auto h = Graph::DaryHeap<int, 3>();
+	auto ref = std::map<std::uint32_t, int>();
+	for (auto i = 0; i < 100000; ++i) {
+		auto k = key_dist(engine);
+		auto c = cost_dist(engine);
+		auto it = ref.find(k);
+		if (it == ref.end()) {
+			h.push(k, c);
+			ref[k] = c;
+		} else if (c < it->second) {
+			h.decrease(k, c);
+			it->second = c;
+		}
+		assert(h.size() == ref.size());
+
+		if (i % 3 == 0) {
+			auto best = std::min_element( ref.begin(), ref.end()
+						    , []( std::pair<std::uint32_t const, int> const& a
+							, std::pair<std::uint32_t const, int> const& b
+							) {
+				return a.second < b.second;
+			});
+			assert(h.top_cost() == best->second);
+			auto k = h.pop();
+			assert(ref[k] == best->second);
+			ref.erase(k);
+		}
+	}
+	auto prev = -1;
+	while (!h.empty()) {
+		auto c = h.top_cost();
+		assert(c >= prev);
+		prev = c;
+		h.pop();
+	}
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+#undef NDEBUG
+#include"Graph/Dijkstra.hpp"
+#include"Graph/IndexedDijkstra.hpp"
+#include"Ln/NodeId.hpp"
+#include<assert.h>
+#include<chrono>
+#include<iomanip>
+#include<iostream>
+#include<map>
+#include<random>
+#include<sstream>
+#include<vector>
+
+namespace {
+
+#if USE_VALGRIND
+auto const num_nodes = std::uint32_t(500);
+auto const num_edges = std::size_t(2000);
+#else
+auto const num_nodes = std::uint32_t(20000);
+auto const num_edges = std::size_t(80000);
+#endif
+
+struct Edge {
+	std::uint32_t destination;
+	double cost;
+};
+
+Ln::NodeId make_node_id(std::uint32_t i) {
+	auto os = std::ostringstream();
+	os << "02" << std::hex << std::setfill('0') << std::setw(64) << i;
+	return Ln::NodeId(os.str());
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+}
+
+int main() {
+	/* Synthetic graph: a ring so that every node is
+	 * reachable, plus random chords.  */
+	auto engine = std::mt19937(12345);
+	auto node_dist = std::uniform_int_distribution<std::uint32_t>(
+		0, num_nodes - 1
+	);
+	auto cost_dist = std::uniform_int_distribution<int>(1, 1000);
+	auto adj = std::vector<std::vector<Edge>>(num_nodes);
+	for (auto n = std::uint32_t(0); n < num_nodes; ++n)
+		adj[n].push_back(Edge{ (n + 1) % num_nodes
+				     , double(cost_dist(engine))
+				     });
+	for (auto i = std::size_t(num_nodes); i < num_edges; ++i)
+		adj[node_dist(engine)].push_back(Edge{ node_dist(engine)
+						     , double(cost_dist(engine))
+						     });
+	auto ids = std::vector<Ln::NodeId>();
+	for (auto n = std::uint32_t(0); n < num_nodes; ++n)
+		ids.push_back(make_node_id(n));
+	/* Map back from node ID, for the Node-keyed run.  */
+	auto index_of = std::map<Ln::NodeId, std::uint32_t>();
+	for (auto n = std::uint32_t(0); n < num_nodes; ++n)
+		index_of[ids[n]] = n;
+
+	/* Node-keyed interface.  */
+	auto start = std::chrono::steady_clock::now();
+	auto keyed = Graph::Dijkstra<Ln::NodeId>(ids[0]);
+	while (auto n = keyed.current()) {
+		for (auto const& e : adj[index_of[*n]])
+			keyed.neighbor(ids[e.destination], e.cost);
+		keyed.end_neighbors();
+	}
+	auto keyed_result = std::move(keyed).finalize();
+	auto keyed_time = seconds_since(start);
+
+	/* Dense-index interface.  */
+	start = std::chrono::steady_clock::now();
+	auto indexed = Graph::IndexedDijkstra<double>(0, 0, num_nodes);
+	for ( auto u = indexed.current()
+	    ; u != indexed.none
+	    ; u = indexed.current()
+	    ) {
+		for (auto const& e : adj[u])
+			indexed.neighbor(e.destination, e.cost);
+		indexed.end_neighbors();
+	}
+	auto indexed_time = seconds_since(start);
+
+	std::cout << "Dijkstra on " << num_nodes << " nodes, "
+		  << num_edges << " edges: "
+		  << "Node-keyed " << keyed_time << "s, "
+		  << "indexed " << indexed_time << "s"
+		  << std::endl;
+
+	/* Both should agree.  */
+	assert(keyed_result.size() == num_nodes);
+	assert(indexed.reached_count() == num_nodes);
+	auto on_shortest_path = [&]( std::uint32_t p
+				   , std::uint32_t n
+				   ) {
+		for (auto const& e : adj[p])
+			if ( e.destination == n
+			  && indexed.cost(p) + e.cost == indexed.cost(n)
+			   )
+				return true;
+		return false;
+	};
+	for (auto n = std::uint32_t(0); n < num_nodes; ++n) {
+		auto const& tn = *keyed_result[ids[n]];
+		assert(tn.data.second == indexed.cost(n));
+		if (n == 0) {
+			assert(!tn.parent);
+			assert(indexed.parent(n) == indexed.none);
+			continue;
+		}
+		/* With ties, the parents may differ, but both
+		 * have to be on a shortest path.  */
+		assert(on_shortest_path(indexed.parent(n), n));
+		assert(on_shortest_path( index_of[*tn.parent->data.first]
+				       , n
+				       ));
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+#undef NDEBUG
+#include"Graph/IndexedDijkstra.hpp"
+#include<assert.h>
+#include<random>
+#include<vector>
+
+namespace {
+
+typedef Graph::IndexedDijkstra<double> Dijkstra;
+
+struct Edge {
+	std::uint32_t source;
+	std::uint32_t destination;
+	double cost;
+};
+
+}
+
+int main() {
+	{
+		/*
+		 * 0 --5-- 2
+		 *  \     /
+		 *   1   1
+		 *    \ /
+		 *     1
+		 */
+		auto dijkstra = Dijkstra(0);
+		assert(dijkstra.current() == 0);
+		assert(dijkstra.reached(0));
+		assert(!dijkstra.reached(1));
+		assert(dijkstra.parent(0) == Dijkstra::none);
+
+		dijkstra.neighbor(1, 1);
+		dijkstra.neighbor(2, 5);
+		dijkstra.end_neighbors();
+		assert(dijkstra.reached_count() == 3);
+		assert(dijkstra.cost(2) == 5);
+		assert(dijkstra.parent(2) == 0);
+
+		/* 1 is nearer, so it should come first.  */
+		assert(dijkstra.current() == 1);
+		dijkstra.neighbor(0, 1);
+		dijkstra.neighbor(2, 1);
+		dijkstra.end_neighbors();
+		/* 2 should now be reached by route 0->1->2.  */
+		assert(dijkstra.cost(2) == 2);
+		assert(dijkstra.parent(2) == 1);
+
+		assert(dijkstra.current() == 2);
+		dijkstra.neighbor(0, 5);
+		dijkstra.neighbor(1, 1);
+		dijkstra.end_neighbors();
+
+		assert(dijkstra.current() == Dijkstra::none);
+		assert(dijkstra.cost(0) == 0);
+		assert(dijkstra.cost(1) == 1);
+		assert(dijkstra.cost(2) == 2);
+		assert(dijkstra.parent(1) == 0);
+		assert(dijkstra.parent(2) == 1);
+	}
+
+	/* Random graphs against Bellman-Ford.  */
+	auto engine = std::mt19937(1);
+	for (auto round = 0; round < 20; ++round) {
+		auto const num_nodes = std::uint32_t(200);
+		auto node_dist = std::uniform_int_distribution<std::uint32_t>(
+			0, num_nodes - 1
+		);
+		auto cost_dist = std::uniform_int_distribution<int>(0, 100);
+		auto edges = std::vector<Edge>();
+		auto adj = std::vector<std::vector<Edge>>(num_nodes);
+		for (auto i = 0; i < 600; ++i) {
+			auto e = Edge{ node_dist(engine), node_dist(engine)
+				     , double(cost_dist(engine))
+				     };
+			edges.push_back(e);
+			adj[e.source].push_back(e);
+		}
+
+		/* Only hint half the size, so arrays have to grow.  */
+		auto dijkstra = Dijkstra(0, 0, num_nodes / 2);
+		while (dijkstra.current() != Dijkstra::none) {
+			for (auto const& e : adj[dijkstra.current()])
+				dijkstra.neighbor(e.destination, e.cost);
+			dijkstra.end_neighbors();
+		}
+
+		auto const inf = 1e300;
+		auto dist = std::vector<double>(num_nodes, inf);
+		dist[0] = 0;
+		for (auto i = std::uint32_t(0); i < num_nodes; ++i)
+			for (auto const& e : edges)
+				if ( dist[e.source] != inf
+				  && dist[e.source] + e.cost < dist[e.destination]
+				   )
+					dist[e.destination] = dist[e.source] + e.cost;
+
+		auto reached = std::size_t(0);
+		for (auto n = std::uint32_t(0); n < num_nodes; ++n) {
+			if (dist[n] == inf) {
+				assert(!dijkstra.reached(n));
+				continue;
+			}
+			++reached;
+			assert(dijkstra.reached(n));
+			assert(dijkstra.cost(n) == dist[n]);
+			/* Parent is on a shortest path.  */
+			auto p = dijkstra.parent(n);
+			if (n == 0) {
+				assert(p == Dijkstra::none);
+				continue;
+			}
+			auto found = false;
+			for (auto const& e : adj[p])
+				if (e.destination == n && dist[p] + e.cost == dist[n])
+					found = true;
+			assert(found);
+		}
+		assert(reached == dijkstra.reached_count());
+	}
+
+	return 0;
+}
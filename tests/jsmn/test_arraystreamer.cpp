@@ -0,0 +1,151 @@
+#undef NDEBUG
+#include"Jsmn/ArrayStreamer.hpp"
+#include"Jsmn/Object.hpp"
+#include"Jsmn/ParseError.hpp"
+#include"Jsmn/Parser.hpp"
+#include<algorithm>
+#include<assert.h>
+#include<string>
+#include<vector>
+
+namespace {
+
+auto const input = std::string(R"JSON(
+{ "jsonrpc": "2.0", "id": 42
+, "result": { "other": [1, 2]
+            , "channels": [ {"a": "x,]}\"y", "b": [1, [2]]}
+                          , 3
+                          , "s"
+                          , []
+                          ]
+            , "after": {"channels": [5]}
+            }
+}
+{"id": 43, "result": {"channels": [{"c": 1}]}}
+{"result": {"channels": [7]}, "id": 42}
+[ {"result": {"channels": [8]}} ]
+)JSON");
+
+struct Run {
+	std::vector<std::string> selected;
+	std::vector<Jsmn::Object> elements;
+	std::vector<Jsmn::Object> datums;
+};
+
+Run run(std::size_t chunk) {
+	auto r = Run();
+	auto streamer = Jsmn::ArrayStreamer([&r]( std::string const& id
+						, std::string const& k1
+						, std::string const& k2
+						) {
+		r.selected.push_back(id + " " + k1 + " " + k2);
+		if (id != "42" || k1 != "result" || k2 != "channels")
+			return Jsmn::ArrayStreamer::Visitor(nullptr);
+		return Jsmn::ArrayStreamer::Visitor([&r](Jsmn::Object o) {
+			r.elements.push_back(std::move(o));
+		});
+	});
+	auto out = std::string();
+	for (auto i = std::size_t(0); i < input.size(); i += chunk) {
+		auto len = std::min(chunk, input.size() - i);
+		streamer.feed(&input[i], len, out);
+	}
+	Jsmn::Parser parser;
+	r.datums = parser.feed(out);
+	return r;
+}
+
+}
+
+int main() {
+	for (auto chunk : {std::size_t(1), std::size_t(7), input.size()}) {
+		auto r = run(chunk);
+
+		/* Only arrays at the second level of objects.  */
+		assert(r.selected.size() == 4);
+		assert(r.selected[0] == "42 result other");
+		assert(r.selected[1] == "42 result channels");
+		assert(r.selected[2] == "43 result channels");
+		/* id not known yet.  */
+		assert(r.selected[3] == " result channels");
+
+		assert(r.elements.size() == 4);
+		assert(std::string(r.elements[0]["a"]) == "x,]}\"y");
+		assert(double(r.elements[0]["b"][1][0]) == 2);
+		assert(double(r.elements[1]) == 3);
+		assert(std::string(r.elements[2]) == "s");
+		assert(r.elements[3].is_array());
+		assert(r.elements[3].size() == 0);
+
+		/* The rest is passed through.  */
+		assert(r.datums.size() == 4);
+		auto first = r.datums[0];
+		assert(double(first["id"]) == 42);
+		assert(first["result"]["other"].size() == 2);
+		assert(first["result"]["channels"].is_array());
+		assert(first["result"]["channels"].size() == 0);
+		assert(first["result"]["after"]["channels"].size() == 1);
+		assert(r.datums[1]["result"]["channels"].size() == 1);
+		assert(r.datums[2]["result"]["channels"].size() == 1);
+		assert(r.datums[3][0]["result"]["channels"].size() == 1);
+	}
+
+	/* Invalid elements are reported.  */
+	{
+		auto streamer = Jsmn::ArrayStreamer([]( std::string const&
+						      , std::string const&
+						      , std::string const&
+						      ) {
+			return [](Jsmn::Object) { };
+		});
+		auto text = std::string(R"JSON({"r": {"c": [{]]}})JSON");
+		auto out = std::string();
+		auto thrown = false;
+		try {
+			streamer.feed(text.c_str(), text.size(), out);
+		} catch (Jsmn::ParseError const&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	/* With a failer, the rest of that array is dropped
+	 * and later data still streams.  */
+	{
+		auto visited = std::vector<double>();
+		auto failed = std::vector<std::string>();
+		auto streamer = Jsmn::ArrayStreamer([&visited]( std::string const&
+							      , std::string const&
+							      , std::string const&
+							      ) {
+			return [&visited](Jsmn::Object o) {
+				visited.push_back(double(o));
+			};
+		}, [&failed]( std::string const& id
+			    , std::exception_ptr e
+			    ) {
+			failed.push_back(id);
+			auto parse_error = false;
+			try {
+				std::rethrow_exception(e);
+			} catch (Jsmn::ParseError const&) {
+				parse_error = true;
+			}
+			assert(parse_error);
+		});
+		auto text = std::string(R"JSON(
+		{"id": 7, "r": {"c": [1, {], 2]}}
+		{"id": 8, "r": {"c": [3]}}
+		)JSON");
+		auto out = std::string();
+		streamer.feed(text.c_str(), text.size(), out);
+		assert((visited == std::vector<double>{1, 3}));
+		assert((failed == std::vector<std::string>{"7"}));
+		auto parser = Jsmn::Parser();
+		auto datums = parser.feed(out);
+		assert(datums.size() == 2);
+		assert(datums[0]["r"]["c"].size() == 0);
+		assert(datums[1]["r"]["c"].size() == 0);
+	}
+
+	return 0;
+}
@@ -41,5 +41,20 @@ int main() {
 		assert(i == js.size());
 	}
 
+	/* Elements remain valid after the containing object
+	 * and parser are gone.  */
+	auto leaf = Jsmn::Object();
+	auto empty = Jsmn::Object();
+	{
+		Jsmn::Parser p;
+		auto js = p.feed(R"JSON({"a": [{"b": "c"}, {}], "d": {"e": 1}})JSON")[0];
+		leaf = js["a"][0]["b"];
+		empty = js["d"];
+	}
+	assert(std::string(leaf) == "c");
+	/* Non-arrays iterate as empty.  */
+	assert(empty.begin() == empty.end());
+	assert(empty["missing"].is_null());
+
 	return 0;
 }
@@ -8,8 +8,48 @@
 #include"Ev/start.hpp"
 #include"S/Bus.hpp"
 #include<assert.h>
+#include<chrono>
+#include<iostream>
+#include<sstream>
+#include<string>
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+/* Object with many keys, one of them escaped.  */
+void test_large_object(bool with_escape) {
+	auto os = std::ostringstream();
+	os << "{";
+	for (auto i = 0; i < 100; ++i)
+		os << "\"k" << i << "\": " << i << ", ";
+	if (with_escape)
+		os << "\"esc\\u0061ped\": 100, ";
+	/* Duplicate key: first one wins.  */
+	os << "\"k5\": 1000 }";
+	auto o = Jsmn::Object::parse_json(os.str().c_str());
+	for (auto pass = 0; pass < 2; ++pass) {
+		for (auto i = 0; i < 100; ++i) {
+			auto key = std::string("k") + std::to_string(i);
+			assert(o.has(key));
+			assert(double(o[key]) == double(i));
+		}
+		assert(!o.has("k100"));
+		assert(o[std::string("k100")].is_null());
+		assert(o.has("escaped") == with_escape);
+		assert(!o.has("esc\\u0061ped"));
+	}
+}
+
+}
 
 int main() {
+	test_large_object(false);
+	test_large_object(true);
+
 	auto bus = S::Bus();
 	Boss::Mod::Waiter waiter (bus);
 	Ev::ThreadPool tp;
@@ -24,6 +64,11 @@ int main() {
 				.start_object("subobj")
 					.field("i", i)
 				.end_object()
+				.field("active", (i % 2) == 0)
+				.field("base_fee_millisatoshi", i % 1000)
+				.field("fee_per_millionth", i % 100)
+				.field("delay", 14)
+				.field("tab\tbed", i)
 			.end_object()
 			;
 	}
@@ -40,6 +85,45 @@ int main() {
 	}).then([&](std::vector<Jsmn::Object> result) {
 		assert(result.size() == 1);
 		assert(result[0].is_array());
+
+		/* Field access, as modules do for each channel
+		 * in a listchannels result.  */
+		auto start = std::chrono::steady_clock::now();
+		auto i = 0;
+		auto total = 0.0;
+		for (auto o : result[0]) {
+			assert(o.has("dummy"));
+			assert(!o.has("destination"));
+			assert(bool(o["active"]) == ((i % 2) == 0));
+			total += double(o["base_fee_millisatoshi"]);
+			total += double(o["fee_per_millionth"]);
+			total += double(o["delay"]);
+			assert(double(o["subobj"]["i"]) == double(i));
+			assert(double(o["tab\tbed"]) == double(i));
+			++i;
+		}
+		assert(i == 200000);
+		assert(total > 0);
+		std::cout << "field access: "
+			  << seconds_since(start) << "s" << std::endl
+			  ;
+
+		/* Loops that compare against `end()` at each
+		 * step, as GossipGraphTracker does; this is
+		 * quadratic unless the end is cached.  */
+		start = std::chrono::steady_clock::now();
+		i = 0;
+		for ( auto it = result[0].begin()
+		    ; it != result[0].end()
+		    ; ++it
+		    )
+			++i;
+		assert(i == 200000);
+		auto elapsed = seconds_since(start);
+		std::cout << "end() per step: "
+			  << elapsed << "s" << std::endl
+			  ;
+		assert(elapsed < 5.0);
 		return Ev::lift();
 	}).catching<Boss::Mod::Waiter::TimedOut>([](Boss::Mod::Waiter::TimedOut const&) {
 		assert(0); /* Should not happen.  */
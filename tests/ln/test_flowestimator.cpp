@@ -0,0 +1,113 @@
+#undef NDEBUG
+#include"Ln/FlowEstimator.hpp"
+#include"Ln/GossipGraph.hpp"
+#include<assert.h>
+#include<memory>
+
+namespace {
+
+auto const A = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000003");
+auto const D = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000004");
+auto const E = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000005");
+auto const F = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000006");
+
+void add_both( Ln::GossipGraph::Builder& builder
+	     , Ln::NodeId const& x, Ln::NodeId const& y
+	     , char const* scid
+	     , std::uint64_t capacity
+	     , bool active = true
+	     ) {
+	auto ch = Ln::GossipGraph::Channel();
+	ch.scid = Ln::Scid(scid);
+	ch.capacity = Ln::Amount::sat(capacity);
+	ch.base_fee = 1000;
+	ch.proportional_fee = 1;
+	ch.delay = 14;
+	ch.active = active;
+	builder.add_channel(x, y, ch);
+	builder.add_channel(y, x, ch);
+}
+
+}
+
+int main() {
+	auto builder = Ln::GossipGraph::Builder();
+	/* Direct.  */
+	add_both(builder, A, D, "1x1x0", 30000);
+	/* Two hops.  */
+	add_both(builder, A, B, "2x1x0", 100000);
+	add_both(builder, B, D, "3x1x0", 60000);
+	/* Three hops, but large.  */
+	add_both(builder, A, C, "4x1x0", 300000);
+	add_both(builder, C, E, "5x1x0", 300000);
+	add_both(builder, E, D, "6x1x0", 300000);
+	/* Four hops is too long.  */
+	add_both(builder, B, F, "7x1x0", 900000);
+	add_both(builder, F, C, "8x1x0", 900000, false);
+	auto graph = std::make_shared<Ln::GossipGraph>(
+		std::move(builder).build()
+	);
+	auto est = Ln::FlowEstimator(graph);
+	auto none = std::vector<Ln::NodeId>();
+
+	{
+		auto r = est.estimate(A, D, none, 3, 10);
+		/* A-C-E-D first as it has the best plausible
+		 * capacity, 300000 / 4; then A-B-D, 60000 / 3;
+		 * then A-D, 30000 / 2.  */
+		assert(r.paths == 3);
+		assert(r.flow == Ln::Amount::sat(390000));
+		assert(r.plausible == Ln::Amount::sat(75000 + 20000 + 15000));
+
+		/* Scratch space is reset.  */
+		auto r2 = est.estimate(A, D, none, 3, 10);
+		assert(r2.paths == 3);
+		assert(r2.plausible == r.plausible);
+	}
+	{
+		/* Path limit.  */
+		auto r = est.estimate(A, D, none, 3, 1);
+		assert(r.paths == 1);
+		assert(r.plausible == Ln::Amount::sat(75000));
+	}
+	{
+		/* Hop limit.  */
+		auto r = est.estimate(A, D, none, 2, 10);
+		assert(r.paths == 2);
+		assert(r.flow == Ln::Amount::sat(90000));
+		assert(r.plausible == Ln::Amount::sat(35000));
+
+		r = est.estimate(A, D, none, 1, 10);
+		assert(r.paths == 1);
+		assert(r.plausible == Ln::Amount::sat(15000));
+	}
+	{
+		/* Excluded nodes.  */
+		auto r = est.estimate(A, D, {C}, 3, 10);
+		assert(r.paths == 2);
+		assert(r.plausible == Ln::Amount::sat(35000));
+
+		/* Excluding the endpoints is ignored.  */
+		r = est.estimate(A, D, {A, D}, 3, 10);
+		assert(r.paths == 3);
+	}
+	{
+		/* The other way around.  */
+		auto r = est.estimate(D, A, none, 3, 10);
+		assert(r.paths == 3);
+		assert(r.flow == Ln::Amount::sat(390000));
+	}
+	{
+		/* Unknown or inactive.  */
+		auto G = Ln::NodeId("030000000000000000000000000000000000000000000000000000000000000007");
+		assert(est.estimate(A, G, none, 3, 10).paths == 0);
+		assert(est.estimate(A, A, none, 3, 10).paths == 0);
+		auto r = est.estimate(F, C, none, 1, 10);
+		assert(r.paths == 0);
+		assert(r.flow == Ln::Amount::sat(0));
+	}
+
+	return 0;
+}
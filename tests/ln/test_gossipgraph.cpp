@@ -0,0 +1,117 @@
+#undef NDEBUG
+#include"Ln/GossipGraph.hpp"
+#include<assert.h>
+
+namespace {
+
+auto const A = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000003");
+auto const D = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000004");
+auto const E = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000005");
+
+Ln::GossipGraph::Channel make_channel( char const* scid
+				     , std::uint32_t base
+				     , std::uint32_t ppm
+				     ) {
+	auto ch = Ln::GossipGraph::Channel();
+	ch.scid = Ln::Scid(scid);
+	ch.capacity = Ln::Amount::sat(1000000);
+	ch.base_fee = base;
+	ch.proportional_fee = ppm;
+	ch.delay = 14;
+	ch.active = true;
+	return ch;
+}
+
+}
+
+int main() {
+	{
+		/* Empty graph.  */
+		auto g = Ln::GossipGraph();
+		assert(g.num_nodes() == 0);
+		assert(g.num_channels() == 0);
+		assert(g.lookup(A) == Ln::GossipGraph::none);
+		assert(g.find(Ln::Scid("1x1x1")).empty());
+	}
+
+	auto builder = Ln::GossipGraph::Builder();
+	/* Deliberately out of order.  */
+	builder.add_channel(C, A, make_channel("2x1x0", 3, 30));
+	builder.add_channel(A, B, make_channel("1x1x0", 1, 10));
+	builder.add_channel(B, A, make_channel("1x1x0", 2, 20));
+	builder.add_channel(A, C, make_channel("2x1x0", 4, 40));
+	builder.add_channel(B, C, make_channel("3x1x0", 5, 50));
+	/* Node without channels.  */
+	builder.add_node(E);
+	/* Duplicate node.  */
+	builder.add_node(A);
+	auto g = std::move(builder).build();
+
+	assert(g.num_nodes() == 4);
+	assert(g.num_channels() == 5);
+	assert(g.lookup(D) == Ln::GossipGraph::none);
+
+	/* Nodes are indexed in sorted order.  */
+	auto a = g.lookup(A);
+	auto b = g.lookup(B);
+	auto c = g.lookup(C);
+	auto e = g.lookup(E);
+	assert(a == 0 && b == 1 && c == 2 && e == 3);
+	assert(g.node(b) == B);
+
+	/* Outgoing.  */
+	assert(g.outgoing(a).size() == 2);
+	for (auto const& ch : g.outgoing(a)) {
+		assert(ch.source == a);
+		assert( (ch.destination == b && ch.base_fee == 1)
+		     || (ch.destination == c && ch.base_fee == 4)
+		      );
+	}
+	assert(g.outgoing(b).size() == 2);
+	assert(g.outgoing(c).size() == 1);
+	assert(g.outgoing(c).begin()->destination == a);
+	assert(g.outgoing(e).empty());
+
+	/* Incoming.  */
+	assert(g.incoming(a).size() == 2);
+	for (auto i : g.incoming(a))
+		assert(g.channel(i).destination == a);
+	assert(g.incoming(b).size() == 1);
+	assert(g.channel(*g.incoming(b).begin()).proportional_fee == 10);
+	assert(g.incoming(c).size() == 2);
+	assert(g.incoming(e).empty());
+
+	/* index_of round-trips.  */
+	for (auto const& ch : g.outgoing(b))
+		assert(&g.channel(g.index_of(ch)) == &ch);
+
+	/* By scid.  */
+	auto both = g.find(Ln::Scid("1x1x0"));
+	assert(both.size() == 2);
+	for (auto i : both)
+		assert(g.channel(i).scid == Ln::Scid("1x1x0"));
+	auto one = g.find(Ln::Scid("3x1x0"));
+	assert(one.size() == 1);
+	assert(g.channel(*one.begin()).source == b);
+	assert(g.find(Ln::Scid("4x1x0")).empty());
+	assert(g.find(Ln::Scid("0x1x0")).empty());
+
+	/* In-place update keeps the structure.  */
+	assert(g.generation() == 0);
+	auto c3 = *g.find(Ln::Scid("3x1x0")).begin();
+	auto attrs = make_channel("9x9x9", 7, 70);
+	attrs.active = false;
+	assert(!Ln::GossipGraph::same_attributes(g.channel(c3), attrs));
+	g.update(c3, attrs);
+	assert(Ln::GossipGraph::same_attributes(g.channel(c3), attrs));
+	assert(g.channel(c3).scid == Ln::Scid("3x1x0"));
+	assert(g.channel(c3).source == b);
+	assert(g.channel(c3).destination == c);
+	assert(!g.channel(c3).active);
+	g.set_generation(42);
+	assert(g.generation() == 42);
+
+	return 0;
+}
@@ -2,6 +2,7 @@
 #include"Ln/NodeId.hpp"
 #include<assert.h>
 #include<sstream>
+#include<stdexcept>
 
 #include<iostream>
 
@@ -47,5 +48,25 @@ int main() {
 	ss >> std::ws >> a;
 	assert(a == Ln::NodeId("037dda58c0e1b81237f1fecf4cea99e9aaa5918fdbd0fb87042219f0b008ad10c1"));
 
+	/* Raw buffers.  */
+	std::uint8_t buf[33];
+	a.to_buffer(buf);
+	assert(buf[0] == 0x03 && buf[1] == 0x7d && buf[32] == 0xc1);
+	b = Ln::NodeId();
+	b.from_buffer(buf);
+	assert(a == b);
+	Ln::NodeId().to_buffer(buf);
+	assert(buf[0] == 0 && buf[32] == 0);
+	b.from_buffer(buf);
+	assert(!b);
+	buf[0] = 0x04;
+	auto thrown = false;
+	try {
+		b.from_buffer(buf);
+	} catch (std::range_error const&) {
+		thrown = true;
+	}
+	assert(thrown);
+
 	return 0;
 }
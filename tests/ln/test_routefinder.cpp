@@ -0,0 +1,273 @@
+#undef NDEBUG
+#include"Ln/GossipGraph.hpp"
+#include"Ln/RouteFinder.hpp"
+#include<assert.h>
+#include<memory>
+
+namespace {
+
+auto const A = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000001");
+auto const B = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000002");
+auto const C = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000003");
+auto const D = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000004");
+auto const E = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000005");
+auto const F = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000006");
+
+Ln::GossipGraph::Channel make_channel( char const* scid
+				     , std::uint32_t base
+				     , std::uint32_t ppm
+				     , std::uint32_t delay
+				     , std::uint64_t capacity = 1000000
+				     ) {
+	auto ch = Ln::GossipGraph::Channel();
+	ch.scid = Ln::Scid(scid);
+	ch.capacity = Ln::Amount::sat(capacity);
+	ch.base_fee = base;
+	ch.proportional_fee = ppm;
+	ch.delay = delay;
+	ch.active = true;
+	return ch;
+}
+
+void add_both( Ln::GossipGraph::Builder& builder
+	     , Ln::NodeId const& x, Ln::NodeId const& y
+	     , Ln::GossipGraph::Channel const& xy
+	     , Ln::GossipGraph::Channel const& yx
+	     ) {
+	builder.add_channel(x, y, xy);
+	builder.add_channel(y, x, yx);
+}
+
+void check_hop( Ln::RouteFinder::Hop const& hop
+	      , Ln::NodeId const& id
+	      , char const* channel
+	      , int direction
+	      , std::uint64_t amount
+	      , std::uint32_t delay
+	      ) {
+	assert(hop.id == id);
+	assert(hop.channel == Ln::Scid(channel));
+	assert(hop.direction == direction);
+	assert(hop.amount == Ln::Amount::msat(amount));
+	assert(hop.delay == delay);
+}
+
+Ln::RouteFinder::Query query( Ln::NodeId const& source
+			    , Ln::NodeId const& destination
+			    , std::uint64_t amount
+			    ) {
+	auto q = Ln::RouteFinder::Query();
+	q.source = source;
+	q.destination = destination;
+	q.amount = Ln::Amount::msat(amount);
+	return q;
+}
+
+}
+
+int main() {
+	assert(Ln::RouteFinder::fee(1000, 1000, Ln::Amount::msat(100000))
+	       == Ln::Amount::msat(1100));
+	/* Rounds down.  */
+	assert(Ln::RouteFinder::fee(0, 1, Ln::Amount::msat(1999999))
+	       == Ln::Amount::msat(1));
+	assert(Ln::RouteFinder::fee(0, 1000, Ln::Amount::btc(1))
+	       == Ln::Amount::sat(100000));
+
+	auto builder = Ln::GossipGraph::Builder();
+	/* The fees of channels out of A do not matter, as A
+	 * is always the source.  */
+	add_both( builder, A, B
+		, make_channel("1x1x0", 99999, 99999, 99)
+		, make_channel("1x1x0", 0, 0, 1)
+		);
+	add_both( builder, B, D
+		, make_channel("2x1x0", 1000, 1000, 10)
+		, make_channel("2x1x0", 0, 0, 1)
+		);
+	add_both( builder, A, C
+		, make_channel("3x1x0", 99999, 99999, 99)
+		, make_channel("3x1x0", 0, 0, 1)
+		);
+	add_both( builder, C, D
+		, make_channel("4x1x0", 2000, 0, 5)
+		, make_channel("4x1x0", 0, 0, 1)
+		);
+	add_both( builder, B, C
+		, make_channel("5x1x0", 0, 0, 1)
+		, make_channel("5x1x0", 10000, 0, 1)
+		);
+	/* Cheapest, but small.  */
+	add_both( builder, A, E
+		, make_channel("6x1x0", 0, 0, 1, 50)
+		, make_channel("6x1x0", 0, 0, 1, 50)
+		);
+	add_both( builder, E, D
+		, make_channel("7x1x0", 500, 0, 1, 50)
+		, make_channel("7x1x0", 0, 0, 1, 50)
+		);
+	builder.add_node(F);
+	auto graph = std::make_shared<Ln::GossipGraph>(
+		std::move(builder).build()
+	);
+	auto finder = Ln::RouteFinder(graph);
+
+	{
+		/* Single cheapest route.  */
+		auto routes = finder.find(query(A, D, 100000));
+		assert(routes.size() == 1);
+		auto const& r = routes[0];
+		assert(r.fee == Ln::Amount::msat(1100));
+		assert(r.hops.size() == 2);
+		check_hop(r.hops[0], B, "1x1x0", 0, 101100, 19);
+		check_hop(r.hops[1], D, "2x1x0", 0, 100000, 9);
+	}
+	{
+		/* All the alternatives, best first; ties in fee
+		 * are broken by delay.  */
+		auto q = query(A, D, 100000);
+		q.count = 10;
+		auto routes = finder.find(q);
+		assert(routes.size() == 4);
+
+		assert(routes[0].fee == Ln::Amount::msat(1100));
+		assert(routes[0].hops[0].id == B);
+
+		assert(routes[1].fee == Ln::Amount::msat(2000));
+		assert(routes[1].hops.size() == 2);
+		check_hop(routes[1].hops[0], C, "3x1x0", 0, 102000, 14);
+		check_hop(routes[1].hops[1], D, "4x1x0", 0, 100000, 9);
+
+		assert(routes[2].fee == Ln::Amount::msat(2000));
+		assert(routes[2].hops.size() == 3);
+		check_hop(routes[2].hops[0], B, "1x1x0", 0, 102000, 15);
+		check_hop(routes[2].hops[1], C, "5x1x0", 0, 102000, 14);
+		check_hop(routes[2].hops[2], D, "4x1x0", 0, 100000, 9);
+
+		assert(routes[3].fee == Ln::Amount::msat(11100));
+		assert(routes[3].hops.size() == 3);
+		check_hop(routes[3].hops[0], C, "3x1x0", 0, 111100, 20);
+		check_hop(routes[3].hops[1], B, "5x1x0", 1, 101100, 19);
+		check_hop(routes[3].hops[2], D, "2x1x0", 0, 100000, 9);
+	}
+	{
+		/* Fee budget.  */
+		auto q = query(A, D, 100000);
+		q.count = 10;
+		q.max_fee = Ln::Amount::msat(1500);
+		auto routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].hops[0].id == B);
+	}
+	{
+		/* CLTV limit.  */
+		auto q = query(A, D, 100000);
+		q.max_delay = 18;
+		auto routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].hops[0].id == C);
+		assert(routes[0].hops.size() == 2);
+	}
+	{
+		/* Hop limit.  */
+		auto q = query(A, D, 100000);
+		q.count = 10;
+		q.max_hops = 2;
+		assert(finder.find(q).size() == 2);
+		q.max_hops = 1;
+		assert(finder.find(q).empty());
+	}
+	{
+		/* Excluded nodes.  */
+		auto q = query(A, D, 100000);
+		q.count = 10;
+		q.exclude_nodes.push_back(B);
+		/* Excluding the source or destination is
+		 * ignored.  */
+		q.exclude_nodes.push_back(A);
+		q.exclude_nodes.push_back(D);
+		auto routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].hops[0].id == C);
+	}
+	{
+		/* Excluded channel directions.  */
+		auto q = query(A, D, 100000);
+		q.exclude_channels.emplace_back(Ln::Scid("2x1x0"), 1);
+		auto routes = finder.find(q);
+		assert(routes[0].hops[1].channel == Ln::Scid("2x1x0"));
+
+		q.exclude_channels.emplace_back(Ln::Scid("2x1x0"), 0);
+		routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].hops[0].id == C);
+		assert(routes[0].hops.size() == 2);
+	}
+	{
+		/* Small payments can use small channels.  */
+		auto routes = finder.find(query(A, D, 10000));
+		assert(routes.size() == 1);
+		assert(routes[0].fee == Ln::Amount::msat(500));
+		check_hop(routes[0].hops[0], E, "6x1x0", 0, 10500, 10);
+		check_hop(routes[0].hops[1], D, "7x1x0", 1, 10000, 9);
+	}
+	{
+		/* Scratch space is reset between queries, and
+		 * routes from other sources work.  */
+		auto routes = finder.find(query(D, A, 100000));
+		assert(routes.size() == 1);
+		assert(routes[0].fee == Ln::Amount::msat(0));
+		routes = finder.find(query(A, D, 100000));
+		assert(routes[0].fee == Ln::Amount::msat(1100));
+	}
+	{
+		/* No route.  */
+		assert(finder.find(query(A, F, 1000)).empty());
+		auto G = Ln::NodeId("020000000000000000000000000000000000000000000000000000000000000007");
+		assert(finder.find(query(A, G, 1000)).empty());
+		assert(finder.find(query(A, A, 1000)).empty());
+	}
+	{
+		/* The cheapest route is too long, but a costlier
+		 * one within the hop limit shares its nodes.  */
+		auto builder = Ln::GossipGraph::Builder();
+		add_both( builder, A, B
+			, make_channel("10x1x0", 0, 0, 1)
+			, make_channel("10x1x0", 0, 0, 1)
+			);
+		add_both( builder, B, D
+			, make_channel("11x1x0", 5000, 0, 1)
+			, make_channel("11x1x0", 0, 0, 1)
+			);
+		add_both( builder, B, C
+			, make_channel("12x1x0", 0, 0, 1)
+			, make_channel("12x1x0", 0, 0, 1)
+			);
+		add_both( builder, C, D
+			, make_channel("13x1x0", 100, 0, 1)
+			, make_channel("13x1x0", 0, 0, 1)
+			);
+		auto finder = Ln::RouteFinder(
+			std::make_shared<Ln::GossipGraph>(
+				std::move(builder).build()
+			)
+		);
+
+		auto q = query(A, D, 100000);
+		auto routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].fee == Ln::Amount::msat(100));
+		assert(routes[0].hops.size() == 3);
+
+		q.max_hops = 2;
+		q.count = 10;
+		routes = finder.find(q);
+		assert(routes.size() == 1);
+		assert(routes[0].fee == Ln::Amount::msat(5000));
+		assert(routes[0].hops.size() == 2);
+		check_hop(routes[0].hops[0], B, "10x1x0", 0, 105000, 10);
+		check_hop(routes[0].hops[1], D, "11x1x0", 0, 100000, 9);
+	}
+
+	return 0;
+}
@@ -5,6 +5,17 @@
 #include<S/Bus.hpp>
 #include<assert.h>
 #include<memory>
+#include<string>
+
+namespace {
+struct Named {
+	std::string name;
+};
+}
+template<>
+struct S::Key<Named> {
+	static std::string const& get(Named const& n) { return n.name; }
+};
 
 Ev::Io<void> io_main() {
 	auto bus = std::make_shared<S::Bus>();
@@ -64,6 +75,36 @@ Ev::Io<void> io_main() {
 			assert(*flag2);
 			return Ev::lift();
 		});
+	}).then([=]() {
+		/* Keyed subscriptions only see values with their
+		 * key, unkeyed ones see everything.  */
+		auto foo = std::make_shared<int>(0);
+		auto bar = std::make_shared<int>(0);
+		auto any = std::make_shared<int>(0);
+		bus->subscribe<Named>("foo", [=](Named const& n) {
+			assert(n.name == "foo");
+			++*foo;
+			return Ev::lift();
+		});
+		bus->subscribe<Named>("bar", [=](Named const& n) {
+			assert(n.name == "bar");
+			++*bar;
+			return Ev::lift();
+		});
+		bus->subscribe<Named>([=](Named const& n) {
+			++*any;
+			return Ev::lift();
+		});
+		return bus->raise(Named{"foo"}).then([=]() {
+			return bus->raise(Named{"baz"});
+		}).then([=]() {
+			return bus->raise(Named{"foo"});
+		}).then([=]() {
+			assert(*foo == 2);
+			assert(*bar == 0);
+			assert(*any == 3);
+			return Ev::lift();
+		});
 	}).then([bus] () {
 		/* This function just keeps the bus alive.  */
 		return Ev::lift();
@@ -0,0 +1,108 @@
+#undef NDEBUG
+#include<Ev/Io.hpp>
+#include<Ev/start.hpp>
+#include<S/Bus.hpp>
+#include<assert.h>
+#include<chrono>
+#include<iostream>
+#include<memory>
+#include<stdexcept>
+
+namespace {
+
+struct Tick {
+	int n;
+};
+struct Fail { };
+
+#if USE_VALGRIND
+auto const num_raises = 100;
+#else
+auto const num_raises = 2000;
+#endif
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+Ev::Io<void> raise_loop(S::Bus& bus, int n) {
+	if (n == 0)
+		return Ev::lift();
+	return bus.raise(Tick{n}).then([&bus, n]() {
+		return raise_loop(bus, n - 1);
+	});
+}
+
+void report( char const* what, int subscribers
+	   , double seconds
+	   ) {
+	std::cout << what << ", " << subscribers << " subscribers: "
+		  << (num_raises / seconds) << " raises/s, "
+		  << (seconds / num_raises * 1e6) << "us/raise"
+		  << std::endl;
+}
+
+void bench(int subscribers) {
+	auto bus = S::Bus();
+	auto count = std::make_shared<std::size_t>(0);
+	for (auto i = 0; i < subscribers; ++i)
+		bus.subscribe<Tick>([count](Tick const&) {
+			++*count;
+			return Ev::lift();
+		});
+
+	auto start = std::chrono::steady_clock::now();
+	auto code = raise_loop(bus, num_raises).then([]() {
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	report("raise", subscribers, seconds_since(start));
+	assert(*count == std::size_t(num_raises * subscribers));
+
+	*count = 0;
+	start = std::chrono::steady_clock::now();
+	for (auto i = 0; i < num_raises; ++i)
+		bus.raise_sync(Tick{i});
+	report("raise_sync", subscribers, seconds_since(start));
+	assert(*count == std::size_t(num_raises * subscribers));
+}
+
+}
+
+int main() {
+	for (auto subscribers : {1, 10, 50})
+		bench(subscribers);
+
+	/* Errors reach whoever raised.  */
+	auto bus = S::Bus();
+	auto count = std::make_shared<std::size_t>(0);
+	bus.subscribe<Fail>([count](Fail const&) {
+		++*count;
+		return Ev::lift();
+	});
+	bus.subscribe<Fail>([](Fail const&) -> Ev::Io<void> {
+		throw std::runtime_error("oops");
+	});
+	auto thrown = false;
+	try {
+		bus.raise_sync(Fail{});
+	} catch (std::runtime_error const&) {
+		thrown = true;
+	}
+	assert(thrown);
+	assert(*count == 1);
+
+	thrown = false;
+	auto code = bus.raise(Fail{}).catching<std::runtime_error>([&](std::runtime_error const&) {
+		thrown = true;
+		return Ev::lift();
+	}).then([]() {
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	assert(thrown);
+	assert(*count == 2);
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+#undef NDEBUG
+#include"Sqlite3.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include<assert.h>
+#include<stdexcept>
+#include<thread>
+#include<vector>
+
+namespace {
+
+int count_rows(Sqlite3::Tx& tx) {
+	auto res = tx.query("SELECT COUNT(*) FROM \"foo\";").execute();
+	auto count = 0;
+	for (auto& r : res)
+		count = r.get<int>(0);
+	return count;
+}
+
+}
+
+int main() {
+	auto db = Sqlite3::Db(":memory:");
+	auto const main_thread = std::this_thread::get_id();
+
+	auto order = std::vector<int>();
+	auto thrown = false;
+
+	auto code = Ev::lift().then([&]() {
+		return db.transact_background([&](Sqlite3::Tx& tx) {
+			assert(std::this_thread::get_id() != main_thread);
+			tx.query_execute("CREATE TABLE \"foo\" (c1 INTEGER);");
+			tx.commit();
+		});
+	}).then([&]() {
+		assert(std::this_thread::get_id() == main_thread);
+
+		/* Main-thread transactions wait for the
+		 * background one.  */
+		return Ev::concurrent(db.transact_background([](Sqlite3::Tx& tx) {
+			tx.query("INSERT INTO \"foo\" VALUES(:c1);")
+				.bind(":c1", 1)
+				.execute();
+			tx.commit();
+		}).then([&]() {
+			order.push_back(1);
+			return Ev::lift();
+		}));
+	}).then([&]() {
+		return Ev::yield(3);
+	}).then([&]() {
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		order.push_back(2);
+		assert(count_rows(tx) == 1);
+		tx.commit();
+		return Ev::lift();
+	}).then([&]() {
+		assert((order == std::vector<int>{1, 2}));
+
+		/* Not committed, so rolled back.  */
+		return db.transact_background([](Sqlite3::Tx& tx) {
+			tx.query("INSERT INTO \"foo\" VALUES(:c1);")
+				.bind(":c1", 2)
+				.execute();
+			return count_rows(tx);
+		});
+	}).then([&](int count) {
+		assert(count == 2);
+
+		/* Thrown exceptions are passed back.  */
+		return db.transact_background([](Sqlite3::Tx& tx) {
+			tx.query("INSERT INTO \"foo\" VALUES(:c1);")
+				.bind(":c1", 3)
+				.execute();
+			throw std::runtime_error("oops");
+		}).catching<std::runtime_error>([&](std::runtime_error const&) {
+			thrown = true;
+			return Ev::lift();
+		});
+	}).then([&]() {
+		assert(thrown);
+
+		/* Old interface still works afterwards.  */
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		assert(count_rows(tx) == 1);
+		tx.commit();
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}
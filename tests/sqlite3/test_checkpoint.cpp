@@ -0,0 +1,83 @@
+#undef NDEBUG
+#include"Sqlite3.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/start.hpp"
+#include<assert.h>
+#include<stdlib.h>
+#include<unistd.h>
+#include<vector>
+
+namespace {
+
+int count_rows(Sqlite3::Tx& tx) {
+	auto res = tx.query("SELECT COUNT(*) FROM \"foo\";").execute();
+	auto count = 0;
+	for (auto& r : res)
+		count = r.get<int>(0);
+	return count;
+}
+
+}
+
+int main() {
+	auto tmpl = std::string("/tmp/clboss-test-checkpoint-XXXXXX");
+	auto modifiable = std::vector<char>(tmpl.begin(), tmpl.end());
+	modifiable.push_back('\0');
+	auto fd = mkstemp(modifiable.data());
+	assert(fd >= 0);
+	close(fd);
+	auto filename = std::string(modifiable.data());
+
+	{
+		/* Not in WAL mode, checkpoint does nothing.  */
+		auto db = Sqlite3::Db(":memory:");
+		auto code = db.checkpoint().then([&](Sqlite3::Db::Checkpoint c) {
+			assert(c.wal_frames == -1);
+			assert(c.checkpointed_frames == -1);
+			return Ev::lift(0);
+		});
+		assert(Ev::start(code) == 0);
+	}
+
+	{
+		auto config = Sqlite3::Db::Config();
+		config.wal = true;
+		config.synchronous = "NORMAL";
+		config.cache_size = -2000;
+		auto db = Sqlite3::Db(filename, config);
+		assert(db.filename() != "");
+
+		auto code = db.transact().then([&](Sqlite3::Tx tx) {
+			tx.query_execute("CREATE TABLE \"foo\" (c1 INTEGER);");
+			for (auto i = 0; i < 100; ++i)
+				tx.query("INSERT INTO \"foo\" VALUES(:c1);")
+					.bind(":c1", i)
+					.execute();
+			tx.commit();
+			return db.checkpoint();
+		}).then([&](Sqlite3::Db::Checkpoint c) {
+			assert(c.wal_frames > 0);
+			assert(c.checkpointed_frames == c.wal_frames);
+			assert(c.seconds >= 0);
+
+			/* Log was truncated.  */
+			return db.checkpoint();
+		}).then([&](Sqlite3::Db::Checkpoint c) {
+			assert(c.wal_frames == 0);
+			return db.transact();
+		}).then([&](Sqlite3::Tx tx) {
+			assert(count_rows(tx) == 100);
+			auto res = tx.query("PRAGMA journal_mode;").execute();
+			for (auto& r : res)
+				assert(r.get<std::string>(0) == "wal");
+			tx.commit();
+			return Ev::lift(0);
+		});
+		assert(Ev::start(code) == 0);
+	}
+
+	unlink(filename.c_str());
+	unlink((filename + "-wal").c_str());
+	unlink((filename + "-shm").c_str());
+	return 0;
+}
@@ -0,0 +1,151 @@
+#undef NDEBUG
+#include"Sqlite3.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/start.hpp"
+#include<assert.h>
+#include<chrono>
+#include<iostream>
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	auto d = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double>(d).count();
+}
+
+auto const insert_sql = R"QRY(
+	INSERT INTO "foo"
+	VALUES(:c1, :c2)
+	     ;
+	)QRY";
+auto const select_sql = R"QRY(
+	SELECT c2 FROM "foo" WHERE c1 = :c1;
+	)QRY";
+
+auto const num_rows = 20000;
+
+/* Inserts and reads back rows one query at a time,
+ * like modules do for each event.  */
+double run(std::size_t cache_size) {
+	auto config = Sqlite3::Db::Config();
+	config.statement_cache_size = cache_size;
+	auto db = Sqlite3::Db(":memory:", config);
+
+	auto time = 0.0;
+	auto code = db.transact().then([&](Sqlite3::Tx tx) {
+		tx.query_execute(R"QRY(
+		CREATE TABLE "foo"
+		     ( c1 INTEGER PRIMARY KEY
+		     , c2 TEXT NOT NULL
+		     );
+		)QRY");
+
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0; i < num_rows; ++i)
+			tx.query(insert_sql)
+				.bind(":c1", i)
+				.bind(":c2", std::to_string(i))
+				.execute()
+				;
+		for (auto i = 0; i < num_rows; ++i) {
+			auto found = false;
+			auto fetch = tx.query(select_sql)
+				.bind(":c1", i)
+				.execute()
+				;
+			for (auto& r : fetch) {
+				assert(r.get<std::string>(0) == std::to_string(i));
+				found = true;
+			}
+			assert(found);
+		}
+		time = seconds_since(start);
+
+		auto stats = db.statement_cache_stats();
+		if (cache_size == 0) {
+			assert(stats.hits == 0);
+			assert(stats.size == 0);
+		} else {
+			assert(stats.misses == 2);
+			assert(stats.hits == 2 * num_rows - 2);
+			assert(stats.size == 2);
+		}
+
+		tx.commit();
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+	return time;
+}
+
+}
+
+int main() {
+	auto config = Sqlite3::Db::Config();
+	config.statement_cache_size = 2;
+	auto db = Sqlite3::Db(":memory:", config);
+
+	auto code = db.transact().then([&](Sqlite3::Tx tx) {
+		tx.query_execute("CREATE TABLE \"foo\" (c1 INTEGER, c2 TEXT);");
+
+		/* Bindings do not leak into the next use.  */
+		tx.query(insert_sql)
+			.bind(":c1", 1)
+			.bind(":c2", "one")
+			.execute()
+			;
+		tx.query(insert_sql)
+			.bind(":c1", 2)
+			.execute()
+			;
+		auto count = 0;
+		auto fetch = tx.query(R"QRY(
+		SELECT c1 FROM "foo" WHERE c2 IS NULL;
+		)QRY").execute();
+		for (auto& r : fetch) {
+			assert(r.get<int>(0) == 2);
+			++count;
+		}
+		assert(count == 1);
+
+		/* The same SQL in use twice at once gets two
+		 * statements.  */
+		auto before = db.statement_cache_stats();
+		auto q1 = tx.query(select_sql);
+		auto q2 = tx.query(select_sql);
+		auto after = db.statement_cache_stats();
+		assert(after.misses == before.misses + 2);
+
+		/* A statement abandoned mid-iteration can be
+		 * reused.  */
+		{
+			auto all = tx.query("SELECT c1 FROM \"foo\";")
+				.execute();
+			auto it = all.begin();
+			assert(it != all.end());
+		}
+		auto n = 0;
+		auto all = tx.query("SELECT c1 FROM \"foo\";").execute();
+		for (auto& r : all) {
+			(void) r;
+			++n;
+		}
+		assert(n == 2);
+
+		/* Only 2 are kept.  */
+		assert(db.statement_cache_stats().size <= 2);
+
+		tx.commit();
+		return Ev::lift(0);
+	});
+	assert(Ev::start(code) == 0);
+
+	auto t_prepare = run(0);
+	auto t_cached = run(64);
+	std::cout << num_rows << " inserts and selects: "
+		  << "prepared each time " << t_prepare << "s, "
+		  << "cached " << t_cached << "s"
+		  << std::endl;
+
+	return 0;
+}
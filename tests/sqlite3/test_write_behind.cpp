@@ -0,0 +1,135 @@
+#undef NDEBUG
+#include"Sqlite3.hpp"
+#include"Ev/Io.hpp"
+#include"Ev/concurrent.hpp"
+#include"Ev/start.hpp"
+#include"Ev/yield.hpp"
+#include<assert.h>
+#include<stdexcept>
+#include<string>
+#include<vector>
+
+namespace {
+
+Ev::Io<void> insert(Sqlite3::Db& db, int c1) {
+	return db.write_behind([c1](Sqlite3::Tx& tx) {
+		tx.query("INSERT INTO \"foo\" VALUES(:c1);")
+			.bind(":c1", c1)
+			.execute();
+	});
+}
+
+std::vector<int> get_rows(Sqlite3::Tx& tx) {
+	auto rv = std::vector<int>();
+	auto res = tx.query("SELECT c1 FROM \"foo\" ORDER BY rowid;")
+		.execute();
+	for (auto& r : res)
+		rv.push_back(r.get<int>(0));
+	return rv;
+}
+
+}
+
+int main() {
+	auto config = Sqlite3::Db::Config();
+	config.write_behind_rows = 3;
+	auto db = Sqlite3::Db(":memory:", config);
+
+	auto rows = std::vector<int>();
+	auto woken = false;
+
+	auto code = Ev::lift().then([&]() {
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		tx.query_execute("CREATE TABLE \"foo\" (c1 INTEGER);");
+		tx.commit();
+		return insert(db, 1);
+	}).then([&]() {
+		return insert(db, 2);
+	}).then([&]() {
+		assert(db.write_behind_pending() == 2);
+
+		/* A transaction sees the queued writes, even if
+		 * it does not commit.  */
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		assert(db.write_behind_pending() == 0);
+		assert((get_rows(tx) == std::vector<int>{1, 2}));
+		return Ev::lift();
+	}).then([&]() {
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		assert((get_rows(tx) == std::vector<int>{1, 2}));
+		tx.commit();
+
+		/* Reaching the threshold flushes.  */
+		return insert(db, 3);
+	}).then([&]() {
+		return insert(db, 4);
+	}).then([&]() {
+		assert(db.write_behind_pending() == 2);
+		return insert(db, 5);
+	}).then([&]() {
+		assert(db.write_behind_pending() == 0);
+
+		/* Explicit flush, keeping order.  */
+		return insert(db, 6);
+	}).then([&]() {
+		return db.flush();
+	}).then([&]() {
+		assert(db.write_behind_pending() == 0);
+		return db.transact_background([&](Sqlite3::Tx& tx) {
+			rows = get_rows(tx);
+		});
+	}).then([&]() {
+		assert((rows == std::vector<int>{1, 2, 3, 4, 5, 6}));
+
+		/* A failing mutation is dropped alone, and the
+		 * error is kept rather than thrown at whoever
+		 * started the transaction.  */
+		return insert(db, 7);
+	}).then([&]() {
+		return db.write_behind([](Sqlite3::Tx& tx) {
+			tx.query_execute("INSERT INTO \"foo\" VALUES(100);");
+			throw std::runtime_error("oops");
+		});
+	}).then([&]() {
+		return insert(db, 8);
+	}).then([&]() {
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		assert((get_rows(tx) == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+		tx.commit();
+		auto failures = db.take_write_behind_failures();
+		assert((failures == std::vector<std::string>{"oops"}));
+		assert(db.take_write_behind_failures().empty());
+
+		/* Waiting for queued writes blocks until one is
+		 * queued.  */
+		return Ev::concurrent(db.wait_write_behind().then([&]() {
+			woken = true;
+			return Ev::lift();
+		}));
+	}).then([&]() {
+		return Ev::yield(10);
+	}).then([&]() {
+		assert(!woken);
+		return insert(db, 9);
+	}).then([&]() {
+		return Ev::yield(10);
+	}).then([&]() {
+		assert(woken);
+		/* And returns at once while there are.  */
+		return db.wait_write_behind();
+	}).then([&]() {
+		return db.flush();
+	}).then([&]() {
+		return db.transact();
+	}).then([&](Sqlite3::Tx tx) {
+		assert((get_rows(tx) == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9}));
+		tx.commit();
+		return Ev::lift(0);
+	});
+
+	return Ev::start(code);
+}